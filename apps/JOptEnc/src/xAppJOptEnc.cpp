@@ -66,12 +66,41 @@ PictureFormat, PictureType, BitDepth and ChromaFormat is not necessary for PNG/B
 usage::jpeg-specific --------------------------------------------------------
  -q    Quality            JPEG Quality (Q, 0-100, 0=lowest quality, 100=highest quality)
  -ri   RestartInterval    Restart interval in number of MCUs [0=disabled] (optional, default 0) 
+ -prg  Progressive        Progressive JPEG (SOF2) output, Advanced implementation only (default 0) [optional]
+                          [0 = baseline sequential, 1 = progressive, RestartInterval is ignored]
+ -pss  ProgressiveScript  Progressive scan script (default = libjpeg simple progression) [optional]
+                          [scans separated by ';', every scan as Components:Ss-Se:Ah:Al,
+                          e.g. "012:0-0:0:0;0:1-63:0:0;1:1-63:0:0;2:1-63:0:0"]
+ -ari  Arithmetic         Arithmetic coded JPEG (SOF9) output, Advanced implementation only (default 0) [optional]
+                          [0 = Huffman coding, 1 = arithmetic coding, HuffmanOptimization is ignored,
+                          not widely supported by decoders - intended for archival storage]
 
 usage::rdoq-specific --------------------------------------------------------
  -rol  OptimizeLuma       Apply RDOQ to luma blocks   (default 1) [optional]
  -roc  OptimizeChroma     Apply RDOQ to chroma blocks (default 1) [optional]
  -rpz  ProcessZeroCoeffs  Try optimize coeffs initially quantized to 0 (default 0) [optional]
  -rnp  NumBlockOptPasses  Number of optimization passes over one block (default 1) [optional]
+                          [ignored by Trellis mode, 0 disables RDOQ]
+ -rmode RDOQMode          RDOQ algorithm (default Greedy) [optional]
+                          [Greedy = per coefficient zero/+1/-1 search repeated NumBlockOptPasses times,
+                          Trellis = single pass dynamic programming over zig-zag positions with
+                          transform domain distortion and pixel domain final check]
+ -rls  LambdaStrategy     Lagrange multiplier selection (default Estimate) [optional]
+                          [Estimate = main and two auxiliary operating points for every frame,
+                          Reuse = previous estimate reused for up to LambdaMaxReuse frames
+                          while main point rate and distortion stay within LambdaMaxDrift,
+                          Model = analytic Q -> lambda model, no pre-analysis]
+ -rlr  LambdaMaxReuse     Max number of frames coded with one lambda estimate (default 8) [optional]
+ -rld  LambdaMaxDrift     Relative rate/distortion change forcing re-estimation (default 0.05) [optional]
+ -rlk  LambdaSubsampling  Estimate lambda on every k-th MCU of diagonal lattice, 2 = checkerboard
+                          (default 1 = entire picture) [optional]
+ -hto  HuffOptimize       Huffman tables derived from picture statistics (two-pass encoding) (default 0) [optional]
+                          [0 = default (ITU T.81 Annex K.3) tables, 1 = optimized tables,
+                          2 = optimized tables + second RDOQ pass with rate of optimized tables]
+ -rdd  DistDomain         Domain of distortion used to evaluate RDOQ candidates (default Pixel) [optional]
+                          [Pixel = IDCT + SSD for every candidate, Transform = coefficient domain
+                          delta with pixel domain final check, Verify = Transform + report
+                          transform vs pixel domain disagreement]
  -qtl  QuantTabLayout     Select quantization table layout used during encoding:
                           [0 = default (RFC2435), 1 = flat, 2 = semi-flat] (default 0) [optional]
 usage::valiation ------------------------------------------------------------
@@ -86,6 +115,10 @@ usage::valiation ------------------------------------------------------------
 
 usage::software_operation ---------------------------------------------------
  -cp   CalkPSNR           Calculate PSNR for reconstructed picture (default 1) [optional]
+ -nth  NumberOfThreads    Number of threads used by advanced implementation. Frames are
+                          encoded concurrently, single picture uses parallel slices
+                          (RestartInterval != 0) (optional, default -1=all hardware threads). Output is identical
+                          for any number of threads.
  -v    VerboseLevel       Verbose level (optional, default=1)
 
  -c    "config.cfg"       External config file - in INI format (optional)
@@ -128,11 +161,21 @@ void xAppJPEG::registerCmdParams()
   m_CfgParser.addCmdParm("imp", "Implementation" , "", "Implementation" );
   m_CfgParser.addCmdParm("q"  , "Quality"        , "", "Quality"        );
   m_CfgParser.addCmdParm("ri" , "RestartInterval", "", "RestartInterval");  
+  m_CfgParser.addCmdParm("prg", "Progressive"      , "", "Progressive"      );
+  m_CfgParser.addCmdParm("pss", "ProgressiveScript", "", "ProgressiveScript");
+  m_CfgParser.addCmdParm("ari", "Arithmetic"       , "", "Arithmetic"       );
   //rdoq-specific
   m_CfgParser.addCmdParm("rol", "OptimizeLuma"     , "", "OptimizeLuma"     );
   m_CfgParser.addCmdParm("roc", "OptimizeChroma"   , "", "OptimizeChroma"   );
   m_CfgParser.addCmdParm("rpz", "ProcessZeroCoeffs", "", "ProcessZeroCoeffs");
   m_CfgParser.addCmdParm("rnp", "NumBlockOptPasses", "", "NumBlockOptPasses");
+  m_CfgParser.addCmdParm("rdd", "DistDomain"       , "", "DistDomain"       );
+  m_CfgParser.addCmdParm("rmode", "RDOQMode"       , "", "RDOQMode"         );
+  m_CfgParser.addCmdParm("rls", "LambdaStrategy"   , "", "LambdaStrategy"   );
+  m_CfgParser.addCmdParm("rlr", "LambdaMaxReuse"   , "", "LambdaMaxReuse"   );
+  m_CfgParser.addCmdParm("rld", "LambdaMaxDrift"   , "", "LambdaMaxDrift"   );
+  m_CfgParser.addCmdParm("rlk", "LambdaSubsampling", "", "LambdaSubsampling");
+  m_CfgParser.addCmdParm("hto", "HuffOptimize"     , "", "HuffOptimize"     );
   m_CfgParser.addCmdParm("qtl", "QuantTabLayout"   , "", "QuantTabLayout"   );
   //validation 
   m_CfgParser.addCmdParm("ipa", "InvalidPelActn"  , "", "InvalidPelActn"  );
@@ -211,12 +254,37 @@ bool xAppJPEG::readConfiguration()
   m_Quality         = m_CfgParser.getParam1stArg("Quality"         , NOT_VALID);
   if(m_Quality < 0 || m_Quality > 100) { m_ErrorLog += "!  Quality value have to be in range [0-100]\n"; AnyError = true; }
   m_RestartInterval = m_CfgParser.getParam1stArg("RestartInterval" , 0  );
+  m_Progressive       = m_CfgParser.getParam1stArg("Progressive"      , 0  );
+  m_ProgressiveScript = m_CfgParser.getParam1stArg("ProgressiveScript", std::string(""));
+  if(m_Progressive && m_Implementation != eImpl::Advanded) { m_ErrorLog += "!  Progressive mode is supported by Advanced implementation only\n"; AnyError = true; }
+  if(m_Progressive && !m_ProgressiveScript.empty())
+  {
+    std::vector<JPEG::xJFIF::xSOS> ScanScript;
+    if(!JPEG::xAdvancedEncoder::ParseScanScript(ScanScript, m_ProgressiveScript, m_ChromaFormat == eCrF::CF400 ? 1 : 3)) { m_ErrorLog += "!  ProgressiveScript is invalid\n"; AnyError = true; }
+  }
+  m_Arithmetic        = m_CfgParser.getParam1stArg("Arithmetic"       , 0  );
+  if(m_Arithmetic && m_Implementation != eImpl::Advanded) { m_ErrorLog += "!  Arithmetic coding is supported by Advanced implementation only\n"; AnyError = true; }
+  if(m_Arithmetic && m_Progressive                      ) { m_ErrorLog += "!  Arithmetic coding cannot be combined with progressive mode\n"  ; AnyError = true; }
   
   //rdoq-specific -----------------------------------------------------------------------------------------------------
   m_OptimizeLuma      = m_CfgParser.getParam1stArg("OptimizeLuma"     , 1);
   m_OptimizeChroma    = m_CfgParser.getParam1stArg("OptimizeChroma"   , 1);
   m_ProcessZeroCoeffs = m_CfgParser.getParam1stArg("ProcessZeroCoeffs", 0);
   m_NumBlockOptPasses = m_CfgParser.getParam1stArg("NumBlockOptPasses", 1);
+  m_DistDomain        = m_CfgParser.cvtParam1stArg("DistDomain"       , eDstD::Pixel, xStrToDstD);
+  if(m_DistDomain == eDstD::INVALID) { m_ErrorLog += "!  DistDomain is invalid\n"; AnyError = true; }
+  m_RDOQMode          = m_CfgParser.cvtParam1stArg("RDOQMode"         , eRDOM::Greedy, xStrToRDOM);
+  if(m_RDOQMode == eRDOM::INVALID) { m_ErrorLog += "!  RDOQMode is invalid\n"; AnyError = true; }
+  m_LambdaStrategy    = m_CfgParser.cvtParam1stArg("LambdaStrategy"   , eLmbS::Estimate, xStrToLmbS);
+  if(m_LambdaStrategy == eLmbS::INVALID) { m_ErrorLog += "!  LambdaStrategy is invalid\n"; AnyError = true; }
+  m_LambdaMaxReuse    = m_CfgParser.getParam1stArg("LambdaMaxReuse"   , 8);
+  if(m_LambdaMaxReuse < 1) { m_ErrorLog += "!  LambdaMaxReuse value have to be positive\n"; AnyError = true; }
+  m_LambdaMaxDrift    = m_CfgParser.getParam1stArg("LambdaMaxDrift"   , 0.05);
+  if(m_LambdaMaxDrift < 0) { m_ErrorLog += "!  LambdaMaxDrift value cannot be negative\n"; AnyError = true; }
+  m_LambdaSubsampling = m_CfgParser.getParam1stArg("LambdaSubsampling", 1);
+  if(m_LambdaSubsampling < 1) { m_ErrorLog += "!  LambdaSubsampling value have to be positive\n"; AnyError = true; }
+  m_HuffOptimize      = m_CfgParser.getParam1stArg("HuffOptimize"     , 0);
+  if(m_HuffOptimize < 0 || m_HuffOptimize > 2) { m_ErrorLog += "!  HuffOptimize value have to be in range 0-2\n"; AnyError = true; }
   m_QuantTabLayout    = m_CfgParser.cvtParam1stArg("QuantTabLayout"   , eQTLa::Default, xStrToQTLa);
   
   //validation --------------------------------------------------------------------------------------------------------
@@ -241,6 +309,7 @@ bool xAppJPEG::readConfiguration()
   m_PrintFrame = m_VerboseLevel >= 2;
   m_GatherTime = m_VerboseLevel >= 3;
   m_PrintDebug = m_VerboseLevel >= 4;
+  m_NumThreads = m_NumberOfThreads > 0 ? m_NumberOfThreads : xThreadPool::getNumHardwareThreads();
 
   return !AnyError;
 }
@@ -264,18 +333,28 @@ std::string xAppJPEG::formatConfiguration()
   Config += fmt::format("Implementation    = {}\n", xImplToStr(m_Implementation));
   Config += fmt::format("Quality           = {}\n", m_Quality        );
   Config += fmt::format("RestartInterval   = {}\n", m_RestartInterval);
+  Config += fmt::format("Progressive       = {}\n", m_Progressive    );
+  if(m_Progressive) { Config += fmt::format("ProgressiveScript = {}\n", m_ProgressiveScript.empty() ? "(default)" : m_ProgressiveScript); }
+  Config += fmt::format("Arithmetic        = {}\n", m_Arithmetic     );
   //rdoq-specific
   Config += fmt::format("OptimizeLuma      = {}\n", m_OptimizeLuma     );
   Config += fmt::format("OptimizeChroma    = {}\n", m_OptimizeChroma   );
   Config += fmt::format("ProcessZeroCoeffs = {}\n", m_ProcessZeroCoeffs);
   Config += fmt::format("NumBlockOptPasses = {}\n", m_NumBlockOptPasses);
+  Config += fmt::format("DistDomain        = {}\n", xDstDToStr(m_DistDomain));
+  Config += fmt::format("RDOQMode          = {}\n", xRDOMToStr(m_RDOQMode));
+  Config += fmt::format("LambdaStrategy    = {}\n", xLmbSToStr(m_LambdaStrategy));
+  Config += fmt::format("LambdaMaxReuse    = {}\n", m_LambdaMaxReuse   );
+  Config += fmt::format("LambdaMaxDrift    = {}\n", m_LambdaMaxDrift   );
+  Config += fmt::format("LambdaSubsampling = {}\n", m_LambdaSubsampling);
+  Config += fmt::format("HuffOptimize      = {}\n", m_HuffOptimize     );
   Config += fmt::format("QuantTabLayout    = {}\n", xQTLaToStr(m_QuantTabLayout));
   //validation 
   Config += fmt::format("InvalidPelActn    = {}\n", xActn2Str(m_InvalidPelActn));
   Config += fmt::format("NameMismatchActn  = {}\n", xActn2Str(m_NameMismatchActn));
   //operation
   Config += fmt::format("CalkPSNR          = {:d}\n", m_CalkPSNR);
-  //Config += fmt::format("NumberOfThreads   = {}{}\n", m_NumberOfThreads, m_NumberOfThreads == NOT_VALID ? "  (all)" : "");
+  Config += fmt::format("NumberOfThreads   = {}{}\n", m_NumberOfThreads, m_NumberOfThreads == NOT_VALID ? "  (all)" : "");
   Config += fmt::format("VerboseLevel      = {}\n", m_VerboseLevel);
   Config += "\n";
   //derrived
@@ -288,6 +367,7 @@ std::string xAppJPEG::formatConfiguration()
   Config += fmt::format("PrintFrame        = {:d}\n", m_PrintFrame);
   Config += fmt::format("GatherTime        = {:d}\n", m_GatherTime);
   Config += fmt::format("PrintDebug        = {:d}\n", m_PrintDebug);
+  Config += fmt::format("NumThreads        = {:d}\n", m_NumThreads);
 
   return Config;
 }
@@ -407,11 +487,15 @@ eAppRes xAppJPEG::setupSeqAndBuffs()
     if(!OpenSucces) { xCfgINI::printError(fmt::format("ERROR --> OutputFile opening failure ({})", m_OutputFile)); return eAppRes::Error; }
   }
 
+  //frame-parallel encoding
+  xSetupFrameSlots();
+
   return eAppRes::Good;
 }
 eAppRes xAppJPEG::ceaseSeqAndBuffs()
 {
   if(m_WriteBit) { m_OutFile.flush(); m_OutFile.closeFile(); }
+  xCeaseFrameSlots();
   //TODO
 
   return eAppRes::Good;
@@ -433,14 +517,9 @@ void xAppJPEG::createProcessors()
     }
     break;
   case eImpl::Advanded:
-    m_EncoderRDOQ.setVerboseLevel(m_VerboseLevel);
-    m_EncoderRDOQ.create(m_PictureSize, m_ChromaFormat);
-    m_EncoderRDOQ.initBaseMarkers();
-    m_EncoderRDOQ.initQuant(m_Quality, m_QuantTabLayout);
-    m_EncoderRDOQ.initEntropy(m_RestartInterval);
-    m_EncoderRDOQ.setMarkerEmit(true, true, true);
-    m_EncoderRDOQ.setRDOQ(m_OptimizeLuma, m_OptimizeChroma, m_ProcessZeroCoeffs, m_NumBlockOptPasses);
-    m_EncoderRDOQ.setGatherTimeStats(m_PrintDebug);
+    for(JPEG::xAdvancedEncoder* Encoder : m_SlotEncoderRDOQ) { xConfigureEncoderRDOQ(*Encoder); }
+    m_LambdaHistory.reset();
+    if(m_NumFrameSlots > 1) { m_ThreadPool.create(m_NumFrameSlots); }
     if(m_Decode)
     {
       m_DecoderSimple.setVerboseLevel(m_VerboseLevel);
@@ -455,6 +534,73 @@ void xAppJPEG::createProcessors()
   if(m_CvtClrSpc) { m_FramePSNR_RGB.resize(m_NumFrames, xMakeVec4<flt64>(std::numeric_limits<flt64>::quiet_NaN())); }
   m_FrameBits    .resize(m_NumFrames, 0);
 }
+void xAppJPEG::xConfigureEncoderRDOQ(JPEG::xAdvancedEncoder& Encoder)
+{
+  Encoder.setVerboseLevel(m_VerboseLevel);
+  Encoder.create(m_PictureSize, m_ChromaFormat);
+  Encoder.initBaseMarkers();
+  Encoder.initQuant(m_Quality, m_QuantTabLayout);
+  Encoder.initEntropy(m_RestartInterval);
+  Encoder.setMarkerEmit(true, true, true);
+  Encoder.setRDOQ(m_OptimizeLuma, m_OptimizeChroma, m_ProcessZeroCoeffs, m_NumBlockOptPasses);
+  Encoder.setDistDomain(m_DistDomain);
+  Encoder.setRDOQMode(m_RDOQMode);
+  Encoder.setLambdaStrategy(m_LambdaStrategy, m_LambdaMaxReuse, m_LambdaMaxDrift);
+  Encoder.setLambdaSubsampling(m_LambdaSubsampling);
+  Encoder.setHuffmanOptimization(m_HuffOptimize >= 1, m_HuffOptimize >= 2);
+  Encoder.setProgressive(m_Progressive, m_ProgressiveScript);
+  Encoder.setArithmetic(m_Arithmetic);
+  Encoder.setGatherTimeStats(m_PrintDebug);
+  Encoder.setNumThreads(m_NumFrameSlots > 1 ? 1 : m_NumThreads); //frames in parallel or slices in parallel
+}
+void xAppJPEG::xSetupFrameSlots()
+{
+  //only advanced encoder can work on several frames at once
+  m_NumFrameSlots = m_Implementation == eImpl::Advanded ? xMax(xMin(m_NumThreads, m_NumFrames), 1) : 1;
+
+  m_SlotPicOrg4XX  .resize(m_NumFrameSlots, nullptr);
+  m_SlotPicOrgRGB  .resize(m_NumFrameSlots, nullptr);
+  m_SlotOutBuffer  .resize(m_NumFrameSlots, nullptr);
+  m_SlotEncoderRDOQ.resize(m_NumFrameSlots, nullptr);
+
+  m_SlotPicOrg4XX  [0] = m_PicOrg4XX;
+  m_SlotPicOrgRGB  [0] = m_PicOrgRGB;
+  m_SlotOutBuffer  [0] = &m_OutBuffer;
+  m_SlotEncoderRDOQ[0] = &m_EncoderRDOQ;
+
+  for(int32 SlotIdx = 1; SlotIdx < m_NumFrameSlots; SlotIdx++)
+  {
+    m_SlotPicOrg4XX  [SlotIdx] = new xPicYUV(m_PictureSize, m_BitDepth, m_ChromaFormat, m_PicMargin);
+    if(m_PicOrgRGB != nullptr) { m_SlotPicOrgRGB[SlotIdx] = new xPicP(m_PictureSize, m_BitDepth, 0); }
+    m_SlotOutBuffer  [SlotIdx] = new xByteBuffer(m_OutBuffer.getBufferSize());
+    m_SlotEncoderRDOQ[SlotIdx] = new JPEG::xAdvancedEncoder;
+  }
+}
+void xAppJPEG::xCeaseFrameSlots()
+{
+  if(m_ThreadPool.isCreated()) { m_ThreadPool.destroy(); }
+  xSelectFrameSlot(0);
+
+  for(int32 SlotIdx = 1; SlotIdx < m_NumFrameSlots; SlotIdx++)
+  {
+    m_SlotEncoderRDOQ[SlotIdx]->destroy();
+    delete m_SlotEncoderRDOQ[SlotIdx];
+    delete m_SlotOutBuffer  [SlotIdx];
+    if(m_SlotPicOrgRGB[SlotIdx] != nullptr) { delete m_SlotPicOrgRGB[SlotIdx]; }
+    delete m_SlotPicOrg4XX  [SlotIdx];
+  }
+  m_SlotPicOrg4XX  .clear();
+  m_SlotPicOrgRGB  .clear();
+  m_SlotOutBuffer  .clear();
+  m_SlotEncoderRDOQ.clear();
+  m_NumFrameSlots = 1;
+}
+void xAppJPEG::xSelectFrameSlot(int32 SlotIdx)
+{
+  if(m_SlotPicOrg4XX.empty()) { return; }
+  m_PicOrg4XX = m_SlotPicOrg4XX[SlotIdx];
+  m_PicOrgRGB = m_SlotPicOrgRGB[SlotIdx];
+}
 
 //---------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
 
@@ -462,110 +608,178 @@ eAppRes xAppJPEG::processAllFrames()
 {
   m_ProcBegTime = tClock::now(); m_ProcBegTicks = xTSC();
 
+  eAppRes Result = m_NumFrameSlots > 1 ? xProcessFramesParallel() : xProcessFramesSerial();
+  if(Result == eAppRes::Error) { return eAppRes::Error; }
+
+  m_ProcEndTime = tClock::now(); m_ProcEndTicks = xTSC();
+
+  return eAppRes::Good;
+}
+eAppRes xAppJPEG::xProcessFramesSerial()
+{
   for(int32 f = 0; f < m_NumFrames; f++)
   {
     if(m_PrintDebug) { fmt::print("Frame {:08d} ", f); }
 
+    eAppRes LoadResult = xLoadFrame();
+    if(LoadResult != eAppRes::Good) { return eAppRes::Error; }
+
     uint64 T0 = m_GatherTime ? xTSC() : 0;
+    xEncodeFrame(0, f);
+    uint64 T1 = m_GatherTime ? xTSC() : 0;
+    if(m_GatherTime) { m_Ticks__Encode += T1 - T0; }
 
-    //reading
-    xSeqBase::tResult ReadResult = !m_CvtClrSpc ? m_SeqOrg->readFrame(m_PicOrg4XX) : m_SeqOrg->readFrame(m_PicOrgRGB);
-    if(!ReadResult) { xCfgINI::printError(fmt::format("ERROR --> InputFile read error ({}) {}", m_InputFile, ReadResult.format())); return eAppRes::Error; }
-    if(m_ReorderRGB) { reorderRGB(); }
+    eAppRes FinishResult = xFinishFrame(f, &m_OutBuffer);
+    if(FinishResult != eAppRes::Good) { return eAppRes::Error; }
+  }
+  return eAppRes::Good;
+}
+eAppRes xAppJPEG::xProcessFramesParallel()
+{
+  //frames are loaded and finished (written, decoded, measured) in order, only encoding runs concurrently
+  for(int32 FrameIdxFirst = 0; FrameIdxFirst < m_NumFrames; FrameIdxFirst += m_NumFrameSlots)
+  {
+    const int32 NumFramesInBatch = xMin(m_NumFrameSlots, m_NumFrames - FrameIdxFirst);
 
+    for(int32 SlotIdx = 0; SlotIdx < NumFramesInBatch; SlotIdx++)
+    {
+      xSelectFrameSlot(SlotIdx);
+      eAppRes LoadResult = xLoadFrame();
+      if(LoadResult != eAppRes::Good) { return eAppRes::Error; }
+    }
+
+    uint64 T0 = m_GatherTime ? xTSC() : 0;
+    for(int32 SlotIdx = 0; SlotIdx < NumFramesInBatch; SlotIdx++)
+    {
+      m_ThreadPool.addWaitingTask([this, SlotIdx, FrameIdxFirst](int32 /*ThreadIdx*/) { xEncodeFrame(SlotIdx, FrameIdxFirst + SlotIdx); });
+    }
+    m_ThreadPool.waitUntilTasksFinished();
     uint64 T1 = m_GatherTime ? xTSC() : 0;
+    if(m_GatherTime) { m_Ticks__Encode += T1 - T0; }
 
-    //validation
-    if(m_InvalidPelActn != eActn::SKIP)
+    for(int32 SlotIdx = 0; SlotIdx < NumFramesInBatch; SlotIdx++)
     {
-      eAppRes ValidationRes = validateFrames();
-      if(ValidationRes != eAppRes::Good) { return eAppRes::Error; }
+      const int32 FrameIdx = FrameIdxFirst + SlotIdx;
+      if(m_PrintDebug) { fmt::print("Frame {:08d} ", FrameIdx); }
+      xSelectFrameSlot(SlotIdx);
+      eAppRes FinishResult = xFinishFrame(FrameIdx, m_SlotOutBuffer[SlotIdx]);
+      if(FinishResult != eAppRes::Good) { return eAppRes::Error; }
     }
+  }
+  xSelectFrameSlot(0);
+  return eAppRes::Good;
+}
+eAppRes xAppJPEG::xLoadFrame()
+{
+  uint64 T0 = m_GatherTime ? xTSC() : 0;
 
-    uint64 T2 = m_GatherTime ? xTSC() : 0;
+  //reading
+  xSeqBase::tResult ReadResult = !m_CvtClrSpc ? m_SeqOrg->readFrame(m_PicOrg4XX) : m_SeqOrg->readFrame(m_PicOrgRGB);
+  if(!ReadResult) { xCfgINI::printError(fmt::format("ERROR --> InputFile read error ({}) {}", m_InputFile, ReadResult.format())); return eAppRes::Error; }
+  if(m_ReorderRGB) { reorderRGB(); }
 
-    if(m_CvtClrSpc) { cvtRGBtoYCbCr(); }
+  uint64 T1 = m_GatherTime ? xTSC() : 0;
 
-    uint64 T3 = m_GatherTime ? xTSC() : 0;
+  //validation
+  if(m_InvalidPelActn != eActn::SKIP)
+  {
+    eAppRes ValidationRes = validateFrames();
+    if(ValidationRes != eAppRes::Good) { return eAppRes::Error; }
+  }
 
-    //encoding
-    m_OutBuffer.reset();
-    switch(m_Implementation)
-    {
-      case eImpl::Simple  : m_EncoderSimple.encode(m_PicOrg4XX, &m_OutBuffer); break;
-      case eImpl::Advanded: m_EncoderRDOQ  .encode(m_PicOrg4XX, &m_OutBuffer); break;
-    }    
+  uint64 T2 = m_GatherTime ? xTSC() : 0;
 
-    uint64 T4 = m_GatherTime ? xTSC() : 0;
+  if(m_CvtClrSpc) { cvtRGBtoYCbCr(); }
 
-    //writting output
-    m_FrameBits[f] = m_OutBuffer.getDataSize() << 3;
-    if(m_WriteBit) { m_OutBuffer.write(&m_OutFile); }
-    m_OutFile.flush();
+  uint64 T3 = m_GatherTime ? xTSC() : 0;
 
-    uint64 T5 = m_GatherTime ? xTSC() : 0;
+  if(m_GatherTime)
+  {
+    m_Ticks_LoadOrg += T1 - T0;
+    m_TicksValidate += T2 - T1;
+    m_Ticks_RGB2YUV += T3 - T2;
+  }
 
-    //jpeg decompression
-    if(m_Decode)
+  return eAppRes::Good;
+}
+void xAppJPEG::xEncodeFrame(int32 SlotIdx, int32 FrameIdx)
+{
+  xByteBuffer* OutBuffer = m_SlotOutBuffer[SlotIdx];
+  OutBuffer->reset();
+  switch(m_Implementation)
+  {
+    case eImpl::Simple  : m_EncoderSimple.encode(m_SlotPicOrg4XX[SlotIdx], OutBuffer); break;
+    case eImpl::Advanded:
+      m_SlotEncoderRDOQ[SlotIdx]->setLambdaHistory(&m_LambdaHistory, FrameIdx); //previous frame may be coded by other slot
+      m_SlotEncoderRDOQ[SlotIdx]->encode(m_SlotPicOrg4XX[SlotIdx], OutBuffer);
+      break;
+  }
+}
+eAppRes xAppJPEG::xFinishFrame(int32 f, xByteBuffer* OutBuffer)
+{
+  uint64 T4 = m_GatherTime ? xTSC() : 0;
+
+  //writting output
+  m_FrameBits[f] = OutBuffer->getDataSize() << 3;
+  if(m_WriteBit) { OutBuffer->write(&m_OutFile); }
+  m_OutFile.flush();
+
+  uint64 T5 = m_GatherTime ? xTSC() : 0;
+
+  //jpeg decompression
+  if(m_Decode)
+  {
+    switch(m_Implementation)
     {
-      switch(m_Implementation)
-      {
-      case eImpl::Simple  : m_DecoderSimple.init(&m_OutBuffer); m_DecoderSimple.decode(&m_OutBuffer, m_PicRec4XX); break;
-      case eImpl::Advanded: m_DecoderSimple.init(&m_OutBuffer); m_DecoderSimple.decode(&m_OutBuffer, m_PicRec4XX); break;
-      }      
-    }
+    case eImpl::Simple  : m_DecoderSimple.init(OutBuffer); m_DecoderSimple.decode(OutBuffer, m_PicRec4XX); break;
+    case eImpl::Advanded: m_DecoderSimple.init(OutBuffer); m_DecoderSimple.decode(OutBuffer, m_PicRec4XX); break;
+    }      
+  }
 
-    uint64 T6 = m_GatherTime ? xTSC() : 0;
+  uint64 T6 = m_GatherTime ? xTSC() : 0;
 
-    if(m_CalkPSNR) { m_FramePSNR_YUV[f] = calcPicPSNR(m_PicRec4XX, m_PicOrg4XX, true); }
+  if(m_CalkPSNR) { m_FramePSNR_YUV[f] = calcPicPSNR(m_PicRec4XX, m_PicOrg4XX, true); }
 
-    uint64 T7 = m_GatherTime ? xTSC() : 0;
+  uint64 T7 = m_GatherTime ? xTSC() : 0;
 
-    if(m_CvtClrSpc) { cvtYCbCrToRGB(); }
+  if(m_CvtClrSpc) { cvtYCbCrToRGB(); }
 
-    uint64 T8 = m_GatherTime ? xTSC() : 0;
+  uint64 T8 = m_GatherTime ? xTSC() : 0;
 
-    if(m_CalkPSNR && m_CvtClrSpc) { m_FramePSNR_RGB[f] = calcPicPSNR(m_PicRecRGB, m_PicOrgRGB, true); }
+  if(m_CalkPSNR && m_CvtClrSpc) { m_FramePSNR_RGB[f] = calcPicPSNR(m_PicRecRGB, m_PicOrgRGB, true); }
 
-    uint64 T9 = m_GatherTime ? xTSC() : 0;
+  uint64 T9 = m_GatherTime ? xTSC() : 0;
 
-    //write recon
-    if(m_WriteRecon)
-    {
-      if(m_ReorderRGB) { reorderRGB(); }
-      xSeqBase::tResult WriteResult = !m_CvtClrSpc ? m_SeqRec->writeFrame(m_PicRec4XX) : m_SeqRec->writeFrame(m_PicRecRGB);
-      if(!WriteResult) { xCfgINI::printError(fmt::format("ERROR --> InputFile write error ({}) {}", m_ReconFile, WriteResult.format())); return eAppRes::Error; }
-    }
+  //write recon
+  if(m_WriteRecon)
+  {
+    if(m_ReorderRGB) { reorderRGB(); }
+    xSeqBase::tResult WriteResult = !m_CvtClrSpc ? m_SeqRec->writeFrame(m_PicRec4XX) : m_SeqRec->writeFrame(m_PicRecRGB);
+    if(!WriteResult) { xCfgINI::printError(fmt::format("ERROR --> InputFile write error ({}) {}", m_ReconFile, WriteResult.format())); return eAppRes::Error; }
+  }
 
-    uint64 T10 = m_GatherTime ? xTSC() : 0;
+  uint64 T10 = m_GatherTime ? xTSC() : 0;
 
-    if(m_GatherTime)
-    {
-      m_Ticks_LoadOrg += T1  - T0;
-      m_TicksValidate += T2  - T1;
-      m_Ticks_RGB2YUV += T3  - T2;
-      m_Ticks__Encode += T4  - T3;
-      m_TicksWriteBit += T5  - T4;
-      m_Ticks__Decode += T6  - T5;
-      m_Ticks_YUV2RGB += T8  - T7;
-      m_TicksCalcPSNR += (T7  - T6) + (T9 - T8);
-      m_TicksWriteRec += T10 - T9;      
-    }
+  if(m_GatherTime)
+  {
+    m_TicksWriteBit += T5  - T4;
+    m_Ticks__Decode += T6  - T5;
+    m_Ticks_YUV2RGB += T8  - T7;
+    m_TicksCalcPSNR += (T7  - T6) + (T9 - T8);
+    m_TicksWriteRec += T10 - T9;      
+  }
 
-    if(m_PrintDebug)
-    { 
-      if(m_CalkPSNR)
-      {
-        fmt::print("PSNR[dB]: Y={:2.2f} Cb={:2.2f} Cr={:2.2f}", m_FramePSNR_YUV[f][0], m_FramePSNR_YUV[f][1], m_FramePSNR_YUV[f][2]);
-        if(m_CvtClrSpc) { fmt::print(" R={:2.2f} G={:2.2f} B={:2.2f} ", m_FramePSNR_RGB[f][0], m_FramePSNR_RGB[f][1], m_FramePSNR_RGB[f][2]); }
-      }
-      fmt::print("Size={:d}B ", m_FrameBits[f]>>3);
-      fmt::print("\n");
+  if(m_PrintDebug)
+  { 
+    if(m_CalkPSNR)
+    {
+      fmt::print("PSNR[dB]: Y={:2.2f} Cb={:2.2f} Cr={:2.2f}", m_FramePSNR_YUV[f][0], m_FramePSNR_YUV[f][1], m_FramePSNR_YUV[f][2]);
+      if(m_CvtClrSpc) { fmt::print(" R={:2.2f} G={:2.2f} B={:2.2f} ", m_FramePSNR_RGB[f][0], m_FramePSNR_RGB[f][1], m_FramePSNR_RGB[f][2]); }
     }
+    fmt::print("Size={:d}B ", m_FrameBits[f]>>3);
+    fmt::print("\n");
   }
 
-  m_ProcEndTime = tClock::now(); m_ProcEndTicks = xTSC();
-
   return eAppRes::Good;
 }
 void xAppJPEG::reorderRGB()
@@ -748,6 +962,11 @@ void xAppJPEG::combineFrameStats()
   m_Bitrate           = (flt64)(TotalBits*m_FrameRate)/((flt64)(m_NumFrames));
   m_BitsPerPixel      = (flt64)(TotalBits)/(flt64)((uint64)m_NumFrames*m_PictureSize.getMul());
   m_ComprRatio        = m_AvgFrameBytes / (flt64)(OneFrameSize);
+
+  if(m_Implementation == eImpl::Advanded && (m_PrintDebug || m_DistDomain == eDstD::Verify))
+  {
+    for(JPEG::xAdvancedEncoder* Encoder : m_SlotEncoderRDOQ) { m_EncoderStats += Encoder->formatAndResetStats("  ") + "\n"; }
+  }
 }
 
 std::string xAppJPEG::formatResultsStdOut()
@@ -794,6 +1013,12 @@ std::string xAppJPEG::formatResultsStdOut()
     if(m_WriteRecon) { Result += fmt::format("AvgTime      WriteRec {:9.2f} us\n", AvgDurationWriteRec.count()); }
   }
 
+  if(!m_EncoderStats.empty())
+  {
+    Result += fmt::format("\nENCODER STATS:\n");
+    Result += m_EncoderStats;
+  }
+
 //  if(m_PrintDebug)
 //  {
 //    Result += fmt::format("\nENCODER TIME STATS:\n");
@@ -13,6 +13,7 @@
 #include "xJPEG_CodecSimple.h"
 #include "xJPEG_Encoder.h"
 #include "xMiscUtilsCORE.h"
+#include "xThreadPool.h"
 
 namespace PMBB_NAMESPACE::JPEG {
 
@@ -45,11 +46,21 @@ public:
   eImpl       m_Implementation ;
   int32       m_Quality        ;
   int32       m_RestartInterval;
+  int32       m_Progressive    ;
+  std::string m_ProgressiveScript;
+  int32       m_Arithmetic     ;
   //rdoq-specific
   int32       m_OptimizeLuma     ;
   int32       m_OptimizeChroma   ;
   int32       m_ProcessZeroCoeffs;
   int32       m_NumBlockOptPasses;
+  eDstD       m_DistDomain       ;
+  eRDOM       m_RDOQMode         ;
+  eLmbS       m_LambdaStrategy   ;
+  int32       m_LambdaMaxReuse   ;
+  flt64       m_LambdaMaxDrift   ;
+  int32       m_LambdaSubsampling;
+  int32       m_HuffOptimize     ;
   eQTLa       m_QuantTabLayout   ;
   //validation 
   eActn       m_InvalidPelActn  ;
@@ -71,7 +82,7 @@ public:
   bool  m_PrintFrame    = false;
   bool  m_GatherTime    = false;
   bool  m_PrintDebug    = false;
-
+  int32 m_NumThreads    = 1;
 
 protected:
   //processing data
@@ -99,6 +110,15 @@ protected:
 #endif //X_PMBB_HAS_JPEG_TURBO
   JPEG::xAdvancedEncoder m_EncoderRDOQ;
 
+  //frame-parallel encoding (slot 0 aliases m_PicOrg4XX, m_PicOrgRGB, m_OutBuffer and m_EncoderRDOQ)
+  int32                                m_NumFrameSlots = 1;
+  std::vector<xPicYUV*               > m_SlotPicOrg4XX;
+  std::vector<xPicP*                 > m_SlotPicOrgRGB;
+  std::vector<xByteBuffer*           > m_SlotOutBuffer;
+  std::vector<JPEG::xAdvancedEncoder*> m_SlotEncoderRDOQ;
+  JPEG::xLambdaHistory                 m_LambdaHistory; //reused lambda follows frame order, not slot order
+  xThreadPool                          m_ThreadPool;
+
   //data & stats
   std::vector<flt64V4> m_FramePSNR_YUV;
   std::vector<flt64V4> m_FramePSNR_RGB;
@@ -111,6 +131,8 @@ protected:
   flt64   m_BitsPerPixel;
   flt64   m_ComprRatio;
 
+  std::string m_EncoderStats;
+
   tTimePoint m_ProcBegTime  = tTimePoint::min();
   tTimePoint m_ProcEndTime  = tTimePoint::min();
   uint64     m_ProcBegTicks = 0;
@@ -141,6 +163,18 @@ public:
   void        createProcessors ();
   eAppRes     processAllFrames ();
 
+protected:
+  void        xConfigureEncoderRDOQ(JPEG::xAdvancedEncoder& Encoder);
+  void        xSetupFrameSlots ();
+  void        xCeaseFrameSlots ();
+  void        xSelectFrameSlot (int32 SlotIdx);
+  eAppRes     xProcessFramesSerial  ();
+  eAppRes     xProcessFramesParallel();
+  eAppRes     xLoadFrame  ();
+  void        xEncodeFrame(int32 SlotIdx, int32 FrameIdx);
+  eAppRes     xFinishFrame(int32 FrameIdx, xByteBuffer* OutBuffer);
+
+public:
   void        reorderRGB    ();
   eAppRes     validateFrames();
   void        cvtRGBtoYCbCr ();
@@ -3,8 +3,8 @@ set(SRCLIST_COMMON_H src/xCommonDefPMBB-BASE.h)
 set(SRCLIST_UTILS_H src/xCfgINI.h   src/xFile.h   src/xMemory.h   src/xString.h)
 set(SRCLIST_UTILS_C src/xCfgINI.cpp src/xFile.cpp src/xMemory.cpp src/xString.cpp)
 
-set(SRCLIST_PROC_H src/xProcInfo.h  )
-set(SRCLIST_PROC_C src/xProcInfo.cpp)
+set(SRCLIST_PROC_H src/xProcInfo.h   src/xThreadPool.h  )
+set(SRCLIST_PROC_C src/xProcInfo.cpp src/xThreadPool.cpp)
 
 set(SRCLIST_DISPATCH_H src/xDispatch.h)
 set(SRCLIST_DISPATCH_C ""             )
@@ -0,0 +1,77 @@
+/*
+    SPDX-FileCopyrightText: 2019-2024 Jakub Stankowski <jakub.stankowski@put.poznan.pl>
+    SPDX-License-Identifier: BSD-3-Clause
+*/
+
+#include "xThreadPool.h"
+
+namespace PMBB_BASE {
+
+//===============================================================================================================================================================================================================
+// xThreadPool
+//===============================================================================================================================================================================================================
+void xThreadPool::create(int32 NumThreads)
+{
+  assert(NumThreads > 0 && m_Threads.empty());
+  m_Terminate     = false;
+  m_NumUnfinished = 0;
+  m_Threads.reserve(NumThreads);
+  for(int32 ThreadIdx = 0; ThreadIdx < NumThreads; ThreadIdx++)
+  {
+    m_Threads.emplace_back(&xThreadPool::xWorkerFunc, this, ThreadIdx);
+  }
+}
+void xThreadPool::destroy()
+{
+  if(m_Threads.empty()) { return; }
+  waitUntilTasksFinished();
+  {
+    std::lock_guard<std::mutex> LockManager(m_Mutex);
+    m_Terminate = true;
+  }
+  m_CondWaiting.notify_all();
+  for(std::thread& Thread : m_Threads) { Thread.join(); }
+  m_Threads.clear();
+}
+void xThreadPool::addWaitingTask(tTask Task)
+{
+  {
+    std::lock_guard<std::mutex> LockManager(m_Mutex);
+    m_WaitingTasks.push(std::move(Task));
+    m_NumUnfinished++;
+  }
+  m_CondWaiting.notify_one();
+}
+void xThreadPool::waitUntilTasksFinished()
+{
+  std::unique_lock<std::mutex> LockManager(m_Mutex);
+  m_CondFinished.wait(LockManager, [this]() { return m_NumUnfinished == 0; });
+}
+void xThreadPool::xWorkerFunc(int32 ThreadIdx)
+{
+  while(true)
+  {
+    tTask Task;
+    {
+      std::unique_lock<std::mutex> LockManager(m_Mutex);
+      m_CondWaiting.wait(LockManager, [this]() { return m_Terminate || !m_WaitingTasks.empty(); });
+      if(m_WaitingTasks.empty()) { return; } //terminate only when queue is drained
+      Task = std::move(m_WaitingTasks.front());
+      m_WaitingTasks.pop();
+    }
+
+    Task(ThreadIdx);
+
+    bool AllFinished = false;
+    {
+      std::lock_guard<std::mutex> LockManager(m_Mutex);
+      m_NumUnfinished--;
+      AllFinished = m_NumUnfinished == 0;
+    }
+    if(AllFinished) { m_CondFinished.notify_all(); }
+  }
+}
+
+//===============================================================================================================================================================================================================
+
+} //end of namespace PMBB_BASE
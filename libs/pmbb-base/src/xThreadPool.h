@@ -0,0 +1,56 @@
+/*
+    SPDX-FileCopyrightText: 2019-2024 Jakub Stankowski <jakub.stankowski@put.poznan.pl>
+    SPDX-License-Identifier: BSD-3-Clause
+*/
+
+#pragma once
+
+#include "xCommonDefPMBB-BASE.h"
+#include <vector>
+#include <queue>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+
+namespace PMBB_BASE {
+
+//===============================================================================================================================================================================================================
+// xThreadPool - fixed set of worker threads consuming tasks from one shared FIFO queue
+//===============================================================================================================================================================================================================
+
+class xThreadPool
+{
+public:
+  using tTask = std::function<void(int32 ThreadIdx)>;
+
+protected:
+  std::vector<std::thread> m_Threads;
+  std::queue<tTask>        m_WaitingTasks;
+  std::mutex               m_Mutex;
+  std::condition_variable  m_CondWaiting;
+  std::condition_variable  m_CondFinished;
+  int32                    m_NumUnfinished = 0; //waiting + in progress
+  bool                     m_Terminate     = false;
+
+public:
+  ~xThreadPool() { destroy(); }
+
+  void  create (int32 NumThreads);
+  void  destroy();
+
+  void  addWaitingTask        (tTask Task);
+  void  waitUntilTasksFinished();
+
+  int32 getNumThreads() const { return (int32)m_Threads.size(); }
+  bool  isCreated    () const { return !m_Threads.empty(); }
+
+  static int32 getNumHardwareThreads() { return std::max((int32)std::thread::hardware_concurrency(), 1); }
+
+protected:
+  void xWorkerFunc(int32 ThreadIdx);
+};
+
+//===============================================================================================================================================================================================================
+
+} //end of namespace PMBB_BASE
@@ -10,6 +10,8 @@
 #include "../src/xCommonDefPMBB-BASE.h"
 #include "../src/xCfgINI.h"
 #include "../src/xString.h"
+#include "../src/xThreadPool.h"
+#include <atomic>
 
 using namespace PMBB_BASE;
 
@@ -219,3 +221,53 @@ Negative  = -1
 }
 
 //===============================================================================================================================================================================================================
+// xThreadPool
+//===============================================================================================================================================================================================================
+TEST_CASE("xThreadPool")
+{
+  constexpr int32 NumThreads = 4;
+  constexpr int32 NumTasks   = 1024;
+
+  xThreadPool ThreadPool;
+  ThreadPool.create(NumThreads);
+  REQUIRE(ThreadPool.getNumThreads() == NumThreads);
+
+  SUBCASE("all tasks executed")
+  {
+    std::vector<int32>  Results(NumTasks, 0);
+    std::atomic<int32>  NumExecuted = 0;
+    std::atomic<bool>   ThreadIdxOK = true;
+    for(int32 TaskIdx = 0; TaskIdx < NumTasks; TaskIdx++)
+    {
+      ThreadPool.addWaitingTask([&, TaskIdx](int32 ThreadIdx)
+      {
+        if(ThreadIdx < 0 || ThreadIdx >= NumThreads) { ThreadIdxOK = false; }
+        Results[TaskIdx] = TaskIdx * 3;
+        NumExecuted++;
+      });
+    }
+    ThreadPool.waitUntilTasksFinished();
+
+    CHECK(NumExecuted == NumTasks);
+    CHECK(ThreadIdxOK);
+    bool AllCorrect = true;
+    for(int32 TaskIdx = 0; TaskIdx < NumTasks; TaskIdx++) { if(Results[TaskIdx] != TaskIdx * 3) { AllCorrect = false; } }
+    CHECK(AllCorrect);
+  }
+
+  SUBCASE("reuse after wait")
+  {
+    std::atomic<int32> Counter = 0;
+    for(int32 Round = 0; Round < 8; Round++)
+    {
+      for(int32 TaskIdx = 0; TaskIdx < NumThreads * 2; TaskIdx++) { ThreadPool.addWaitingTask([&](int32) { Counter++; }); }
+      ThreadPool.waitUntilTasksFinished();
+      CHECK(Counter == (Round + 1) * NumThreads * 2);
+    }
+  }
+
+  ThreadPool.destroy();
+  CHECK(!ThreadPool.isCreated());
+}
+
+//===============================================================================================================================================================================================================
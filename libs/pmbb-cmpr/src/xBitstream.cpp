@@ -224,30 +224,18 @@ void xBitstreamWriter::writeBit(uint32 Bit)
   m_TmpBuff = (m_TmpBuff<<1) | Bit;
   m_RemainigTmpBufferBits -= 1;
 }
-void xBitstreamWriter::writeBits(uint32 Bits, uint32 NumberOfBitsToWrite)
+void xBitstreamWriter::xWriteBitsAndFlush(uint32 Bits, uint32 NumberOfBitsToWrite)
 {
-  assert( NumberOfBitsToWrite <= c_TmpBuffBits );
-  assert( (Bits & (0xFFFFFFFF >> (c_TmpBuffBits - NumberOfBitsToWrite))) == Bits);
-  //Bits &= Mask;
+  assert(m_RemainigTmpBufferBits < NumberOfBitsToWrite);
 
-  if(m_RemainigTmpBufferBits >= NumberOfBitsToWrite)
-  {
-    m_TmpBuff = (m_TmpBuff<<NumberOfBitsToWrite) | Bits;
-    m_RemainigTmpBufferBits -= NumberOfBitsToWrite;
-  }
-  else
-  {
-    uint32 Delta = NumberOfBitsToWrite - m_RemainigTmpBufferBits;
-    m_TmpBuff = (m_TmpBuff<<m_RemainigTmpBufferBits) | (Bits >> Delta);
-    m_RemainigTmpBufferBits = 0;
+  uint32 Delta = NumberOfBitsToWrite - m_RemainigTmpBufferBits;
+  m_TmpBuff = (m_TmpBuff<<m_RemainigTmpBufferBits) | ((uint64)Bits >> Delta);
+  m_RemainigTmpBufferBits = 0;
 
-    xFlushEntireTmpToByteBuffer();
+  xFlushEntireTmpToByteBuffer();
 
-    //uint32 Mask = (0xFFFFFFFF >> (c_TmpBuffBits - NumberOfBitsToWrite));
-    //Mask >>= m_RemainigTmpBufferBits;
-    m_TmpBuff = Bits; // (Bits & Mask);
-    m_RemainigTmpBufferBits = c_TmpBuffBits - Delta;
-  }  
+  m_TmpBuff = Bits; //already written bits are shifted out before next flush
+  m_RemainigTmpBufferBits = c_TmpBuffBits - Delta;
 }
 void xBitstreamWriter::writeByte(uint32 Byte)
 {
@@ -91,7 +91,18 @@ public:
   void         clear ();
 
   void         writeBit  (uint32 Bit);
-  void         writeBits (uint32 Bits, uint32 NumberOfBits);
+  inline void  writeBits (uint32 Bits, uint32 NumberOfBitsToWrite)
+  {
+    assert(NumberOfBitsToWrite <= 32);
+    assert(((uint64)Bits >> NumberOfBitsToWrite) == 0);
+    //fast path - flush only when accumulator is full
+    if(m_RemainigTmpBufferBits >= NumberOfBitsToWrite)
+    {
+      m_TmpBuff = (m_TmpBuff<<NumberOfBitsToWrite) | Bits;
+      m_RemainigTmpBufferBits -= NumberOfBitsToWrite;
+    }
+    else { xWriteBitsAndFlush(Bits, NumberOfBitsToWrite); }
+  }
   void         writeByte (uint32 Byte);  
   uint32       writeAlign(uint32 Bit );
 
@@ -105,6 +116,7 @@ public:
   bool         getIsFluchedToBuff() const { return m_RemainigTmpBufferBits==32; } 
 
 protected:
+  void         xWriteBitsAndFlush(uint32 Bits, uint32 NumberOfBitsToWrite);
   uint32       xFlushEntireTmpToByteBuffer();
 };
 
@@ -204,6 +204,24 @@ static inline uint64 xLZCNT(uint64 Val) { return Val ? (uint64)__builtin_clzll(V
 #endif
 #endif //X_SIMD_HAS_AVX
 
+//=============================================================================================================================================================================
+// Trailing zero count
+//=============================================================================================================================================================================
+#if X_SIMD_HAS_AVX
+static inline uint32 xTZCNT(uint32 Val) { return (uint32)_tzcnt_u32(Val); }
+static inline uint64 xTZCNT(uint64 Val) { return (uint64)_tzcnt_u64(Val); }
+#else //X_SIMD_HAS_AVX
+#if defined(X_PMBB_COMPILER_MSVC)
+static inline uint32 xTZCNT(uint32 Val) { unsigned long Index; return (uint32)(_BitScanForward  (&Index, Val) ? Index : 32); }
+static inline uint64 xTZCNT(uint64 Val) { unsigned long Index; return (uint64)(_BitScanForward64(&Index, Val) ? Index : 64); }
+#elif (defined(X_PMBB_COMPILER_GCC) || defined(X_PMBB_COMPILER_CLANG))
+static inline uint32 xTZCNT(uint32 Val) { return Val ? (uint32)__builtin_ctz  (Val) : 32; }
+static inline uint64 xTZCNT(uint64 Val) { return Val ? (uint64)__builtin_ctzll(Val) : 64; }
+#else
+#error Unrecognized compiler
+#endif
+#endif //X_SIMD_HAS_AVX
+
 //=============================================================================================================================================================================
 // Num significant bits (similar to xLog2, but returns 0 for Val==0, uses faster (i.e. on Zen) lzcnt
 //=============================================================================================================================================================================
@@ -63,9 +63,9 @@ static inline __m512i _mm512_setr_epi16(short  e0, short  e1, short  e2, short
 }
 #endif
 //===============================================================================================================================================================================================================
-// _mm512_setr_epi32 is missing in GCC
+// _mm512_setr_epi32 is missing in GCC (newer GCC versions provide it as a macro - defining function with the same name would expand to recursive _mm512_set_epi32 overload)
 //===============================================================================================================================================================================================================
-#if defined(__GNUC__) && !defined(__clang__) && X_SIMD_CAN_USE_AVX512
+#if defined(__GNUC__) && !defined(__clang__) && X_SIMD_CAN_USE_AVX512 && !defined(_mm512_setr_epi32)
 static inline __m512i _mm512_setr_epi32(short  e0, short  e1, short  e2, short  e3, short  e4, short  e5, short  e6, short e7,
                                         short  e8, short  e9, short e10, short e11, short e12, short e13, short e14, short e15)
 {
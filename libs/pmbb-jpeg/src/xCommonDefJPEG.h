@@ -40,6 +40,35 @@ enum class eQTLa //JPEG Quantization Table Layout
 eQTLa       xStrToQTLa(const std::string& QTLa);
 std::string xQTLaToStr(eQTLa QTLa             );
 
+enum class eDstD //RDOQ Distortion Domain
+{
+  INVALID   = NOT_VALID,
+  Pixel     = 0, //full InvScan + InvScale + IDCT + SSD for every trial
+  Transform = 1, //coefficient domain delta for every trial, pixel domain SSD for final block accept
+  Verify    = 2, //as Transform, additionally measures pixel domain SSD for every trial and gathers disagreement stats
+};
+eDstD       xStrToDstD(const std::string& DstD);
+std::string xDstDToStr(eDstD DstD             );
+
+enum class eRDOM //RDOQ Mode
+{
+  INVALID   = NOT_VALID,
+  Greedy    = 0, //per coefficient zero/+1/-1 search repeated NumBlockOptPasses times
+  Trellis   = 1, //dynamic programming over zig-zag positions, states track zero run preceding nonzero coefficient
+};
+eRDOM       xStrToRDOM(const std::string& RDOM);
+std::string xRDOMToStr(eRDOM RDOM             );
+
+enum class eLmbS //RDOQ Lambda Strategy
+{
+  INVALID   = NOT_VALID,
+  Estimate  = 0, //estimate from main and two auxiliary operating points for every frame
+  Reuse     = 1, //reuse previous estimate, re-estimate every N frames or when main point rate/distortion drifts
+  Model     = 2, //analytic Q -> lambda model, no pre-analysis passes
+};
+eLmbS       xStrToLmbS(const std::string& LmbS);
+std::string xLmbSToStr(eLmbS LmbS             );
+
 //=============================================================================================================================================================================
 
 } //end of namespace PMBB::JPEG
\ No newline at end of file
@@ -37,6 +37,49 @@ std::string xQTLaToStr(eQTLa QTLa)
          QTLa == eQTLa::SemiFlat ? "SemiFlat" :
                                    "INVALID"  ;
 }
+eDstD xStrToDstD(const std::string& DstD)
+{
+  std::string DstDL = xString::toLower(DstD);
+  return DstDL == "pixel"     ? eDstD::Pixel     :
+         DstDL == "transform" ? eDstD::Transform :
+         DstDL == "verify"    ? eDstD::Verify    :
+                                eDstD::INVALID   ;
+}
+std::string xDstDToStr(eDstD DstD)
+{
+  return DstD == eDstD::Pixel     ? "Pixel"     :
+         DstD == eDstD::Transform ? "Transform" :
+         DstD == eDstD::Verify    ? "Verify"    :
+                                    "INVALID"   ;
+}
+eRDOM xStrToRDOM(const std::string& RDOM)
+{
+  std::string RDOML = xString::toLower(RDOM);
+  return RDOML == "greedy"  ? eRDOM::Greedy  :
+         RDOML == "trellis" ? eRDOM::Trellis :
+                              eRDOM::INVALID ;
+}
+std::string xRDOMToStr(eRDOM RDOM)
+{
+  return RDOM == eRDOM::Greedy  ? "Greedy"  :
+         RDOM == eRDOM::Trellis ? "Trellis" :
+                                  "INVALID" ;
+}
+eLmbS xStrToLmbS(const std::string& LmbS)
+{
+  std::string LmbSL = xString::toLower(LmbS);
+  return LmbSL == "estimate" ? eLmbS::Estimate :
+         LmbSL == "reuse"    ? eLmbS::Reuse    :
+         LmbSL == "model"    ? eLmbS::Model    :
+                               eLmbS::INVALID  ;
+}
+std::string xLmbSToStr(eLmbS LmbS)
+{
+  return LmbS == eLmbS::Estimate ? "Estimate" :
+         LmbS == eLmbS::Reuse    ? "Reuse"    :
+         LmbS == eLmbS::Model    ? "Model"    :
+                                   "INVALID"  ;
+}
 
 //=============================================================================================================================================================================
 
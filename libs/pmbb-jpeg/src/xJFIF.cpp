@@ -3,6 +3,7 @@
     SPDX-License-Identifier: BSD-3-Clause
 */
 #include "xJFIF.h"
+#include "xJPEG_Stuffing.h"
 
 namespace PMBB_NAMESPACE::JPEG {
 
@@ -242,6 +243,85 @@ void xJFIF::xHuffTable::InitDefault(uint8 Idx, eHuffClass Class, eCmp Cmp)
     }
   }
 }
+void xJFIF::xHuffTable::InitOptimal(uint8 Idx, eHuffClass Class, const uint32* SymbolCount, int32 NumSymbols)
+{
+  constexpr int32 c_NumSymbolsExt = 257; //256 symbols + reserved one, which guarantees that no code consists of all 1 bits
+  constexpr int32 c_MaxCodeSize   = 32;
+
+  m_Class = Class;
+  m_Idx   = Idx;
+
+  int64 Count    [c_NumSymbolsExt];
+  int64 Freq     [c_NumSymbolsExt];
+  int32 CodeSize [c_NumSymbolsExt];
+  int32 Others   [c_NumSymbolsExt];
+  int32 NumCodes [c_MaxCodeSize + 1];
+  memset(Count   , 0, sizeof(Count   ));
+  memset(NumCodes, 0, sizeof(NumCodes));
+
+  int64 TotalCount = 0;
+  for(int32 i = 0; i < NumSymbols; i++) { Count[i] = SymbolCount[i]; TotalCount += SymbolCount[i]; }
+  if(TotalCount == 0) { Count[0] = 1; } //table has to define at least one code
+  Count[256] = 1;
+
+  //Figure K.1 - code sizes
+  for(;;)
+  {
+    memcpy(Freq, Count, sizeof(Freq));
+    memset(CodeSize, 0, sizeof(CodeSize));
+    for(int32 i = 0; i < c_NumSymbolsExt; i++) { Others[i] = -1; }
+
+    for(;;)
+    {
+      //least frequent symbol V1 and next least frequent V2 (ties resolved towards larger symbol value)
+      int32 V1 = -1, V2 = -1;
+      for(int32 i = 0; i < c_NumSymbolsExt; i++) { if(Freq[i] && (V1 < 0 || Freq[i] <= Freq[V1])) { V1 = i; } }
+      for(int32 i = 0; i < c_NumSymbolsExt; i++) { if(Freq[i] && i != V1 && (V2 < 0 || Freq[i] <= Freq[V2])) { V2 = i; } }
+      if(V2 < 0) { break; }
+
+      Freq[V1] += Freq[V2];
+      Freq[V2]  = 0;
+      CodeSize[V1]++; while(Others[V1] >= 0) { V1 = Others[V1]; CodeSize[V1]++; }
+      Others[V1] = V2;
+      CodeSize[V2]++; while(Others[V2] >= 0) { V2 = Others[V2]; CodeSize[V2]++; }
+    }
+
+    //degenerate (Fibonacci-like) distributions can produce codes longer than NumCodes can hold (libjpeg fails there) - flatten counts and rebuild, nonzero counts stay nonzero
+    bool Overflow = false;
+    for(int32 i = 0; i < c_NumSymbolsExt; i++) { Overflow |= CodeSize[i] > c_MaxCodeSize; }
+    if(!Overflow) { break; }
+    for(int32 i = 0; i < c_NumSymbolsExt; i++) { Count[i] = (Count[i] + 1) >> 1; }
+  }
+
+  //Figure K.2 - number of codes of each size
+  for(int32 i = 0; i < c_NumSymbolsExt; i++) { if(CodeSize[i]) { assert(CodeSize[i] <= c_MaxCodeSize); NumCodes[CodeSize[i]]++; } }
+
+  //Figure K.3 - limit code lengths to 16 bits
+  for(int32 i = c_MaxCodeSize; i > 16; i--)
+  {
+    while(NumCodes[i] > 0)
+    {
+      int32 j = i - 2;
+      while(NumCodes[j] == 0) { j--; }
+      NumCodes[i    ] -= 2;
+      NumCodes[i - 1] += 1;
+      NumCodes[j + 1] += 2;
+      NumCodes[j    ] -= 1;
+    }
+  }
+  int32 LongestSize = 16;
+  while(NumCodes[LongestSize] == 0) { LongestSize--; }
+  NumCodes[LongestSize]--; //remove reserved symbol
+
+  for(int32 i = 0; i < 16; i++) { m_CodeLengths[i] = (byte)NumCodes[i + 1]; }
+
+  //Figure K.4 - symbols sorted by code size
+  m_CodeSymbols.clear();
+  for(int32 Size = 1; Size <= c_MaxCodeSize; Size++)
+  {
+    for(int32 i = 0; i < c_NumSymbolsExt - 1; i++) { if(CodeSize[i] == Size) { m_CodeSymbols.push_back((byte)i); } }
+  }
+}
 bool xJFIF::xHuffTable::Validate() const
 {
   return true;
@@ -387,6 +467,56 @@ void xJFIF::WriteSOF0(xByteBuffer* Output, int32 Height, int32 Width, int32 BitD
   SOF0.Init(Height, Width, BitDepth, ChromaFormat, NumQuantTables);
   WriteSOF0(Output, SOF0);
 }
+bool xJFIF::ReadSOF2(xByteBuffer* Input, xSOF0& SOF2)
+{
+  if(xPeekMarker(Input) != eMarker::SOF2) { return false; }
+
+  [[maybe_unused]]eMarker Marker        = xReadMarker(Input); //Marker
+  [[maybe_unused]]int32   SegmentLength = xRead16    (Input); //Length
+
+  SOF2.Absorb(Input);
+  return SOF2.Validate();
+}
+void xJFIF::WriteSOF2(xByteBuffer* Output, xSOF0& SOF2)
+{
+  xWriteMarker(Output, eMarker::SOF2           ); //Marker - 2=progressive
+  xWrite16    (Output, (uint16)SOF2.getLength()); //Length
+  SOF2.Emit(Output);
+}
+bool xJFIF::ReadSOF9(xByteBuffer* Input, xSOF0& SOF9)
+{
+  if(xPeekMarker(Input) != eMarker::SOF9) { return false; }
+
+  [[maybe_unused]]eMarker Marker        = xReadMarker(Input); //Marker
+  [[maybe_unused]]int32   SegmentLength = xRead16    (Input); //Length
+
+  SOF9.Absorb(Input);
+  return SOF9.Validate();
+}
+void xJFIF::WriteSOF9(xByteBuffer* Output, xSOF0& SOF9)
+{
+  xWriteMarker(Output, eMarker::SOF9           ); //Marker - 9=sequential, arithmetic coding
+  xWrite16    (Output, (uint16)SOF9.getLength()); //Length
+  SOF9.Emit(Output);
+}
+bool xJFIF::ReadDAC(xByteBuffer* Input)
+{
+  if(xPeekMarker(Input) != eMarker::DAC) { return false; }
+
+  [[maybe_unused]]eMarker Marker        = xReadMarker(Input); //Marker
+  int32                   SegmentLength = xRead16    (Input); //Length
+  if(SegmentLength < 2 || (SegmentLength & 1)) { return false; }
+
+  bool Default = true;
+  for(int32 i = 0; i < (SegmentLength - 2) >> 1; i++)
+  {
+    uint8 TcTb = xRead8(Input); //table class (4bits) and table destination (4bits)
+    uint8 Cs   = xRead8(Input); //conditioning table value
+    if((TcTb >> 4) == 0) { Default &= (Cs == 0x10); } //DC - U=1, L=0
+    else                 { Default &= (Cs == 5   ); } //AC - Kx=5
+  }
+  return Default;
+}
 bool xJFIF::ReadDHT(xByteBuffer* Input , std::vector<xHuffTable>& HuffTables)
 {
   if(xPeekMarker(Input) != eMarker::DHT) { return false; }
@@ -467,6 +597,15 @@ void xJFIF::WriteSOS(xByteBuffer* Output, int32 NumComponents, int32 LumaHuffTab
   SOS.Init(NumComponents, LumaHuffTabIdx, ChromaHuffTabIdx);
   WriteSOS(Output, SOS);
 }
+bool xJFIF::SkipSegment(xByteBuffer* Input)
+{
+  if(xPeekMarker(Input) == eMarker::ERR) { return false; }
+
+  [[maybe_unused]]eMarker Marker        = xReadMarker(Input); //Marker
+  int32                   SegmentLength = xRead16(Input); //Length
+  xSkip(Input, SegmentLength - 2);
+  return true;
+}
 int8 xJFIF::ReadRST(xByteBuffer* Input)
 {
   eMarker Marker = xReadMarker(Input);
@@ -565,41 +704,14 @@ int64 xJFIF::SeekNextSegment(std::ifstream* Input, eMarker Marker)
 }
 void xJFIF::AddStuffing(xByteBuffer* Output, xByteBuffer* Input)
 {
-  byte* Src     = Input->getReadPtr();
-  byte* LastSrc = Src + Input->getDataSize();
-  byte* Dst     = Output->getWritePtr();
-
-  while(Src<LastSrc)
-  {    
-    *(Dst++) = *(Src++);   
-    if(*(Src - 1) == 0xFF)
-    {
-      *(Dst++) = 0x00;
-    }
-  }  
-
-  int32 OutputLength = (int32)(Dst - Output->getWritePtr());
+  int32 OutputLength = xStuffing::AddStuffing(Output->getWritePtr(), Input->getReadPtr(), Input->getDataSize());
   Output->modifyWritten(OutputLength);
 }
 void xJFIF::RemoveStuffing(xByteBuffer* Output, xByteBuffer* Input)
 {
-  byte* Src     = Input->getReadPtr();
-  byte* LastSrc = Src + Input->getDataSize();
-  byte* Dst     = Output->getWritePtr();
-
-  while(Src<LastSrc)
-  {    
-    *(Dst++) = *(Src++);   
-    if(*(Src - 1) == 0xFF)
-    {
-      if(*Src == 0x00) { Src++; } //stuffing
-      else             { Src--; Dst--; break; } //marker
-    }
-  }
-
-  int32 InputLength  = (int32)(Src - Input->getReadPtr());
-  Input->modifyRead(InputLength);
-  int32 OutputLength = (int32)(Dst - Output->getWritePtr());
+  int32 InputLength  = 0;
+  int32 OutputLength = xStuffing::RemoveStuffing(Output->getWritePtr(), Input->getReadPtr(), Input->getDataSize(), InputLength);
+  Input ->modifyRead   (InputLength );
   Output->modifyWritten(OutputLength);
 }
 
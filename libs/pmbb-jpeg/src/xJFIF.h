@@ -249,6 +249,7 @@ public:
     int32 Absorb     (xByteBuffer* Input );
     int32 Emit       (xByteBuffer* Output) const; 
     void  InitDefault(uint8 Idx, eHuffClass Class, eCmp Cmp);
+    void  InitOptimal(uint8 Idx, eHuffClass Class, const uint32* SymbolCount, int32 NumSymbols); //ITU T.81 Annex K.2 - 16 bit length limited
     bool  Validate   () const;
     int32 getLength  () const { return 1 + 16 + (int32)m_CodeSymbols.size(); }
 
@@ -292,6 +293,13 @@ public:
     void   setHuffTableId  (int32 HuffTableIdDC, int32 HuffTableIdAC, eCmp Cmp)       { m_HuffTableId[(int32)Cmp] = (((HuffTableIdDC & 0x03) << 4) + (HuffTableIdAC & 0x03)); }
     int32  getHuffTableIdDC(                                          eCmp Cmp) const { return ((m_HuffTableId[(int32)Cmp] >> 4) & 0x03); }
     int32  getHuffTableIdAC(                                          eCmp Cmp) const { return ((m_HuffTableId[(int32)Cmp]     ) & 0x03); }
+    //progressive scan parameters - spectral selection (Ss, Se) and successive approximation bit positions (Ah, Al)
+    void   setSpectralSelection     (int32 Start, int32 End )       { m_SpectralSelectionStart = Start; m_SpectralSelectionEnd = End; }
+    int32  getSpectralSelectionStart(                       ) const { return m_SpectralSelectionStart; }
+    int32  getSpectralSelectionEnd  (                       ) const { return m_SpectralSelectionEnd  ; }
+    void   setSuccessiveApprox      (int32 High, int32 Low  )       { m_SuccessiveApproximation = ((High & 0x0F) << 4) + (Low & 0x0F); }
+    int32  getSuccessiveApproxHigh  (                       ) const { return (m_SuccessiveApproximation >> 4) & 0x0F; }
+    int32  getSuccessiveApproxLow   (                       ) const { return (m_SuccessiveApproximation     ) & 0x0F; }
   };
 
 //-----------------------------------------------------------------------------------------------------------------------------------------------------------------------------
@@ -313,6 +321,11 @@ public:
   static bool    ReadSOF0        (xByteBuffer* Input , xSOF0& SOF0);
   static void    WriteSOF0       (xByteBuffer* Output, xSOF0& SOF0);
   static void    WriteSOF0       (xByteBuffer* Output, int32 Height, int32 Width, int32 BitDepth, eCrF ChromaFormat, int32 NumQuantTables);
+  static bool    ReadSOF2        (xByteBuffer* Input , xSOF0& SOF2); //progressive DCT - same segment layout as SOF0
+  static void    WriteSOF2       (xByteBuffer* Output, xSOF0& SOF2);
+  static bool    ReadSOF9        (xByteBuffer* Input , xSOF0& SOF9); //sequential DCT, arithmetic coding - same segment layout as SOF0
+  static void    WriteSOF9       (xByteBuffer* Output, xSOF0& SOF9);
+  static bool    ReadDAC         (xByteBuffer* Input ); //only default conditioning values are accepted (L=0, U=1, Kx=5)
   
   static bool    ReadDHT         (xByteBuffer* Input , std::vector<xHuffTable>& HuffTables);
   static void    WriteDHT        (xByteBuffer* Output, std::vector<xHuffTable>& HuffTables);
@@ -333,6 +346,8 @@ public:
   static bool    ReadEOI         (xByteBuffer* Input ) { return (xReadMarker(Input )==eMarker::EOI); }
   static void    WriteEOI        (xByteBuffer* Output) { xWriteMarker(Output, eMarker::EOI); }
 
+  static bool    SkipSegment     (xByteBuffer* Input ); //any segment with length field
+
 public:
   static eMarker IdentifySegment (xByteBuffer* Input ) { return xPeekMarker(Input ); }
   static int32   FindSegment     (xByteBuffer* Input , eMarker Marker);
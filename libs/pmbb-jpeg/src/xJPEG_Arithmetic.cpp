@@ -0,0 +1,175 @@
+/*
+    SPDX-FileCopyrightText: 2020-2024 Jakub Stankowski <jakub.stankowski@put.poznan.pl>
+    SPDX-License-Identifier: BSD-3-Clause
+*/
+#include "xJPEG_Arithmetic.h"
+#include <cmath>
+
+namespace PMBB_NAMESPACE::JPEG {
+
+//=============================================================================================================================================================================
+// xArithCommon
+//=============================================================================================================================================================================
+const uint32 xArithCommon::c_QeTable[c_StateFixed + 1] =
+{
+  0x5A1D0181, 0x2586020E, 0x11140310, 0x080B0412, 0x03D80514, 0x01DA0617,
+  0x00E50719, 0x006F081C, 0x0036091E, 0x001A0A21, 0x000D0B23, 0x00060C09,
+  0x00030D0A, 0x00010D0C, 0x5A7F0F8F, 0x3F251024, 0x2CF21126, 0x207C1227,
+  0x17B91328, 0x1182142A, 0x0CEF152B, 0x09A1162D, 0x072F172E, 0x055C1830,
+  0x04061931, 0x03031A33, 0x02401B34, 0x01B11C36, 0x01441D38, 0x00F51E39,
+  0x00B71F3B, 0x008A203C, 0x0068213E, 0x004E223F, 0x003B2320, 0x002C0921,
+  0x5AE125A5, 0x484C2640, 0x3A0D2741, 0x2EF12843, 0x261F2944, 0x1F332A45,
+  0x19A82B46, 0x15182C48, 0x11772D49, 0x0E742E4A, 0x0BFB2F4B, 0x09F8304D,
+  0x0861314E, 0x0706324F, 0x05CD3330, 0x04DE3432, 0x040F3532, 0x03633633,
+  0x02D43734, 0x025C3835, 0x01F83936, 0x01A43A37, 0x01603B38, 0x01253C39,
+  0x00F63D3A, 0x00CB3E3B, 0x00AB3F3D, 0x008F203D, 0x5B1241C1, 0x4D044250,
+  0x412C4351, 0x37D84452, 0x2FE84553, 0x293C4654, 0x23794756, 0x1EDF4857,
+  0x1AA94957, 0x174E4A48, 0x14244B48, 0x119C4C4A, 0x0F6B4D4A, 0x0D514E4B,
+  0x0BB64F4D, 0x0A40304D, 0x583251D0, 0x4D1C5258, 0x438E5359, 0x3BDD545A,
+  0x34EE555B, 0x2EAE565C, 0x299A575D, 0x25164756, 0x557059D8, 0x4CA95A5F,
+  0x44D95B60, 0x3E225C61, 0x38245D63, 0x32B45E63, 0x2E17565D, 0x56A860DF,
+  0x4F466165, 0x47E56266, 0x41CF6367, 0x3C3D6468, 0x375E5D63, 0x52316669,
+  0x4C0F676A, 0x4639686B, 0x415E6367, 0x56276AE9, 0x50E76B6C, 0x4B85676D,
+  0x55976D6E, 0x504F6B6F, 0x5A106FEE, 0x55226D70, 0x59EB6FF0, 0x5A1D7171,
+};
+void xArithCommon::xInitCosts(uint16* Cost, const uint32* Count, int32 NumBins)
+{
+  for(int32 BinIdx = 0; BinIdx < NumBins; BinIdx++)
+  {
+    const flt64 Total = (flt64)Count[2 * BinIdx] + (flt64)Count[2 * BinIdx + 1] + 1.0;
+    for(int32 Bit = 0; Bit < 2; Bit++)
+    {
+      const flt64 Prob = ((flt64)Count[2 * BinIdx + Bit] + 0.5) / Total;
+      Cost[2 * BinIdx + Bit] = (uint16)xMin(std::lround(-std::log2(Prob) * c_CostScale), (long)UINT16_MAX);
+    }
+  }
+}
+
+//=============================================================================================================================================================================
+// xArithEncoder
+//=============================================================================================================================================================================
+void xArithEncoder::finish()
+{
+  //find C in coding interval with the largest number of trailing zero bits
+  const uint32 Temp = (m_A - 1 + m_C) & 0xFFFF0000;
+  m_C = Temp < m_C ? Temp + 0x8000 : Temp;
+
+  //send remaining bytes
+  m_C <<= m_CT;
+  if(m_C & 0xF8000000) { xEmitCarry  (); }
+  else                 { xEmitNoCarry(); }
+
+  //final bytes are emitted only if they are not 0x00
+  if(m_C & 0x7FFF800)
+  {
+    xEmitZeros();
+    xEmitByte((m_C >> 19) & 0xFF);
+    if(m_C & 0x7F800) { xEmitByte((m_C >> 11) & 0xFF); }
+  }
+}
+void xArithEncoder::xRenormalize()
+{
+  do
+  {
+    m_A <<= 1;
+    m_C <<= 1;
+    if(--m_CT == 0) //another byte is ready for output
+    {
+      const uint32 Temp = m_C >> 19;
+      if     (Temp >  0xFF) { xEmitCarry  (); m_Buffer = (int32)(Temp & 0xFF); } //spacer bits guarantee new buffer byte is not 0xFF
+      else if(Temp == 0xFF) { m_SC++; } //stack 0xFF byte (may overflow later)
+      else                  { xEmitNoCarry(); m_Buffer = (int32)Temp; }
+      m_C &= 0x7FFFF;
+      m_CT += 8;
+    }
+  } while(m_A < 0x8000);
+}
+void xArithEncoder::xEmitCarry()
+{
+  if(m_Buffer >= 0) { xEmitZeros(); xEmitByte(m_Buffer + 1); }
+  m_ZC += m_SC;
+  m_SC  = 0;
+}
+void xArithEncoder::xEmitNoCarry()
+{
+  if     (m_Buffer == 0) { m_ZC++; } //zero bytes are postponed - trailing ones are never emitted
+  else if(m_Buffer >  0) { xEmitZeros(); xEmitByte(m_Buffer); }
+  if(m_SC)
+  {
+    xEmitZeros();
+    for(; m_SC > 0; m_SC--) { m_ByteBuffer->appendU8(0xFF); m_ByteBuffer->appendU8(0x00); }
+  }
+}
+
+//=============================================================================================================================================================================
+// xArithDecoder
+//=============================================================================================================================================================================
+void xArithDecoder::finish()
+{
+  while(m_ByteBuffer->getDataSize() > 0)
+  {
+    const byte* Data = m_ByteBuffer->getReadPtr();
+    if     (Data[0] != 0xFF                                      ) { m_ByteBuffer->modifyRead(1); }
+    else if(m_ByteBuffer->getDataSize() >= 2 && Data[1] == 0x00) { m_ByteBuffer->modifyRead(2); }
+    else                                                          { break; } //marker
+  }
+  m_ByteBuffer = nullptr;
+}
+void xArithDecoder::xRenormalize()
+{
+  if(--m_CT < 0) //fetch next byte
+  {
+    m_C = (m_C << 8) | xFetchByte();
+    if((m_CT += 8) < 0) { if(++m_CT == 0) { m_A = 0x8000; } } //initial bytes - A is 0x10000 after shift below
+  }
+  m_A <<= 1;
+}
+int32 xArithDecoder::xFetchByte()
+{
+  if(m_MarkerReached || m_ByteBuffer->getDataSize() == 0) { return 0; }
+  const byte* Data = m_ByteBuffer->getReadPtr();
+  if(Data[0] != 0xFF) { m_ByteBuffer->modifyRead(1); return Data[0]; }
+  if(m_ByteBuffer->getDataSize() >= 2 && Data[1] == 0x00) { m_ByteBuffer->modifyRead(2); return 0xFF; } //stuffing
+  m_MarkerReached = true; //marker is not consumed
+  return 0;
+}
+
+//=============================================================================================================================================================================
+// xArithEstimatorDC
+//=============================================================================================================================================================================
+int32 xArithEstimatorDC::calcDC(int32 DeltaDC, int32 ContextDC) const
+{
+  const int32 S0 = ContextDC;
+  if(DeltaDC == 0) { return m_Cost[S0][0]; }
+
+  const int32 Sign = DeltaDC < 0 ? 1 : 0;
+  const int32 V    = (Sign ? -DeltaDC : DeltaDC) - 1;
+  int32 Cost = m_Cost[S0][1] + m_Cost[S0 + 1][Sign];
+  int32 St   = S0 + 2 + Sign;
+  if(V == 0) { return Cost + m_Cost[St][0]; }
+
+  const int32 NumCatBits = 31 - (int32)xLZCNT((uint32)V);
+  Cost += m_Cost[St][1];
+  St = c_OffsetX1DC;
+  for(int32 i = 0; i < NumCatBits; i++, St++) { Cost += m_Cost[St][1]; }
+  Cost += m_Cost[St][0];
+  St += c_OffsetM;
+  for(int32 b = NumCatBits - 1; b >= 0; b--) { Cost += m_Cost[St][(V >> b) & 1]; }
+  return Cost;
+}
+
+//=============================================================================================================================================================================
+// xArithEstimatorAC
+//=============================================================================================================================================================================
+bool xArithEstimatorAC::init(const xArithCounterAC& Counter)
+{
+  xInitCosts(&m_Cost[0][0], Counter.getCount(), c_NumBinsAC);
+  m_ZeroCost[0] = 0;
+  m_ZeroCost[1] = 0;
+  for(int32 k = 1; k < xJPEG_Constants::c_BlockArea; k++) { m_ZeroCost[k + 1] = m_ZeroCost[k] + m_Cost[3 * (k - 1) + 1][0]; }
+  return true;
+}
+
+//=============================================================================================================================================================================
+
+} //end of namespace PMBB::JPEG
@@ -0,0 +1,226 @@
+/*
+    SPDX-FileCopyrightText: 2020-2024 Jakub Stankowski <jakub.stankowski@put.poznan.pl>
+    SPDX-License-Identifier: BSD-3-Clause
+*/
+#pragma once
+#include "xCommonDefJPEG.h"
+#include "xJPEG_Constants.h"
+#include "xByteBuffer.h"
+
+namespace PMBB_NAMESPACE::JPEG {
+
+//=====================================================================================================================================================================================
+// adaptive binary arithmetic coding (QM-coder) - ITU T.81 Annex D
+// every binary decision is coded in context of single statistics bin - [0..6] probability estimation state index, [7] MPS value
+//=====================================================================================================================================================================================
+
+class xArithCommon
+{
+public:
+  static constexpr int32 c_NumBinsDC  = 64;  //DC statistics area (ITU T.81 Table F.4)
+  static constexpr int32 c_NumBinsAC  = 256; //AC statistics area (ITU T.81 Table F.5)
+  static constexpr uint8 c_StateFixed = 113; //non-adaptive state (Qe = 0x5A1D) - sign of AC coefficients
+
+  //statistics area layout
+  static constexpr int32 c_OffsetX1DC     = 20;  //DC magnitude categories
+  static constexpr int32 c_OffsetX2LowAC  = 189; //AC magnitude categories, K <= Kx
+  static constexpr int32 c_OffsetX2HighAC = 217; //AC magnitude categories, K >  Kx
+  static constexpr int32 c_OffsetM        = 14;  //magnitude bits relative to last magnitude category bin
+
+  //default conditioning - valid when no DAC segment is present (ITU T.81 F.1.4.4.1.4 and F.1.4.4.2.1)
+  static constexpr int32 c_DefaultL  = 0;
+  static constexpr int32 c_DefaultU  = 1;
+  static constexpr int32 c_DefaultKx = 5;
+
+  //cost of binary decision is expressed in 1/c_CostScale bit units
+  static constexpr int32 c_Log2CostScale = 5;
+  static constexpr int32 c_CostScale     = 1 << c_Log2CostScale;
+
+protected:
+  //probability estimation state machine (ITU T.81 Table D.2) - [0..6] next index after LPS, [7] MPS switch, [8..15] next index after MPS, [16..31] Qe
+  static const uint32 c_QeTable[c_StateFixed + 1];
+
+  //cost of both decisions of every bin, count of unused decision is biased by 1/2
+  static void xInitCosts(uint16* Cost, const uint32* Count, int32 NumBins);
+
+public:
+  //conditioning category of next DC difference (ITU T.81 F.1.4.4.1.2) - MagCat is 2^(magnitude category - 1) of |DeltaDC|-1 (0 for |DeltaDC| = 1)
+  static inline int32 NextContextDC(int32 Sign, int32 MagCat)
+  {
+    if(MagCat < ((1 << c_DefaultL) >> 1)) { return 0;             } //zero category
+    if(MagCat > ((1 << c_DefaultU) >> 1)) { return 12 + Sign * 4; } //large category
+    return 4 + Sign * 4;                                             //small category
+  }
+  static inline int32 NextContextDC(int32 DeltaDC)
+  {
+    if(DeltaDC == 0) { return 0; }
+    const int32 V = xAbs(DeltaDC) - 1;
+    return NextContextDC(DeltaDC < 0 ? 1 : 0, V ? 1 << (31 - (int32)xLZCNT((uint32)V)) : 0);
+  }
+};
+
+//=====================================================================================================================================================================================
+
+class xArithEncoder : public xArithCommon
+{
+protected:
+  xByteBuffer* m_ByteBuffer = nullptr;
+  uint32       m_A      = 0; //interval size
+  uint32       m_C      = 0; //code register
+  int32        m_CT     = 0; //bit shift counter
+  int32        m_Buffer = 0; //buffered output byte (-1 = none), may still be changed by carry
+  int32        m_SC     = 0; //number of stacked 0xFF bytes (may still overflow)
+  int32        m_ZC     = 0; //number of postponed 0x00 bytes
+
+public:
+  void init  (xByteBuffer* ByteBuffer) { m_ByteBuffer = ByteBuffer; m_A = 0x10000; m_C = 0; m_CT = 11; m_Buffer = -1; m_SC = 0; m_ZC = 0; }
+  void finish(); //ITU T.81 D.1.8 - flushes code register, trailing zero bytes are omitted
+
+  void encodeBit(uint8& Bin, int32 Bit)
+  {
+    const uint32 State = Bin;
+    const uint32 Entry = c_QeTable[State & 0x7F];
+    const uint32 Qe    = Entry >> 16;
+    m_A -= Qe;
+    if(Bit != (int32)(State >> 7)) //LPS
+    {
+      if(m_A >= Qe) { m_C += m_A; m_A = Qe; } //conditional exchange
+      Bin = (uint8)((State & 0x80) ^ (Entry & 0xFF));
+    }
+    else //MPS
+    {
+      if(m_A >= 0x8000) { return; } //no renormalization required
+      if(m_A <  Qe    ) { m_C += m_A; m_A = Qe; } //conditional exchange
+      Bin = (uint8)((State & 0x80) ^ ((Entry >> 8) & 0xFF));
+    }
+    xRenormalize();
+  }
+
+protected:
+  void xRenormalize();
+  void xEmitByte      (int32 Byte) { m_ByteBuffer->appendU8((uint8)Byte); if(Byte == 0xFF) { m_ByteBuffer->appendU8(0x00); } } //with stuffing
+  void xEmitZeros     () { for(; m_ZC > 0; m_ZC--) { m_ByteBuffer->appendU8(0x00); } }
+  void xEmitCarry     (); //buffered byte incremented, stacked 0xFF bytes turn into 0x00
+  void xEmitNoCarry   (); //buffered byte and stacked 0xFF bytes are final
+};
+
+//=====================================================================================================================================================================================
+
+class xArithDecoder : public xArithCommon
+{
+protected:
+  xByteBuffer* m_ByteBuffer = nullptr;
+  int32        m_A  = 0;
+  int32        m_C  = 0;
+  int32        m_CT = 0;
+  bool         m_MarkerReached = false; //after marker zero data is supplied until decoding is complete
+
+public:
+  void init  (xByteBuffer* ByteBuffer) { m_ByteBuffer = ByteBuffer; m_A = 0; m_C = 0; m_CT = -16; m_MarkerReached = false; } //first decision fetches 2 initial bytes
+  void finish(); //skips remaining bytes of entropy coded segment - buffer is left at next marker
+
+  int32 decodeBit(uint8& Bin)
+  {
+    while(m_A < 0x8000) { xRenormalize(); }
+
+    uint32 State = Bin;
+    const uint32 Entry = c_QeTable[State & 0x7F];
+    const int32  Qe    = (int32)(Entry >> 16);
+    m_A -= Qe;
+    const int32 Temp = m_A << m_CT;
+    if(m_C >= Temp)
+    {
+      m_C -= Temp;
+      if(m_A < Qe) { m_A = Qe; Bin = (uint8)((State & 0x80) ^ ((Entry >> 8) & 0xFF)); }                 //MPS
+      else         { m_A = Qe; Bin = (uint8)((State & 0x80) ^ ( Entry       & 0xFF)); State ^= 0x80; } //LPS
+    }
+    else if(m_A < 0x8000)
+    {
+      if(m_A < Qe) { Bin = (uint8)((State & 0x80) ^ ( Entry       & 0xFF)); State ^= 0x80; } //LPS
+      else         { Bin = (uint8)((State & 0x80) ^ ((Entry >> 8) & 0xFF));                 } //MPS
+    }
+    return (int32)(State >> 7);
+  }
+
+protected:
+  void  xRenormalize();
+  int32 xFetchByte  ();
+};
+
+//=====================================================================================================================================================================================
+// rate estimation - decisions are counted per statistics bin and cost of each decision is derived from its empirical probability
+//=====================================================================================================================================================================================
+
+class xArithCounterDC : public xArithCommon
+{
+protected:
+  uint32 m_Count[c_NumBinsDC][2];
+
+public:
+  bool init  (                      ) { memset(m_Count, 0, sizeof(m_Count)); return true; }
+  void count (int32 BinIdx, int32 Bit) { m_Count[BinIdx][Bit]++; }
+
+  const uint32* getCount() const { return &m_Count[0][0]; }
+};
+
+class xArithCounterAC : public xArithCommon
+{
+protected:
+  uint32 m_Count[c_NumBinsAC][2];
+
+public:
+  bool init  (                      ) { memset(m_Count, 0, sizeof(m_Count)); return true; }
+  void count (int32 BinIdx, int32 Bit) { m_Count[BinIdx][Bit]++; }
+
+  const uint32* getCount() const { return &m_Count[0][0]; }
+};
+
+//=====================================================================================================================================================================================
+
+class xArithEstimatorDC : public xArithCommon
+{
+protected:
+  uint16 m_Cost[c_NumBinsDC][2];
+
+public:
+  bool  init  (const xArithCounterDC& Counter) { xInitCosts(&m_Cost[0][0], Counter.getCount(), c_NumBinsDC); return true; }
+  int32 calcDC(int32 DeltaDC, int32 ContextDC) const;
+};
+
+class xArithEstimatorAC : public xArithCommon
+{
+protected:
+  uint16 m_Cost    [c_NumBinsAC][2];
+  int32  m_ZeroCost[xJPEG_Constants::c_BlockArea + 1]; //[k] - accumulated cost of "zero" decisions at positions 1..k-1
+
+public:
+  bool  init(const xArithCounterAC& Counter);
+
+  //magnitude of nonzero coefficient at Pos (categories and bits, sign excluded)
+  int32 calcMag(int32 Pos, int32 AbsCoeff) const
+  {
+    int32 St = 3 * (Pos - 1) + 2;
+    const int32 V = AbsCoeff - 1;
+    if(V == 0) { return m_Cost[St][0]; }
+    if(V == 1) { return m_Cost[St][1] + m_Cost[St][0]; }
+    const int32 NumCatBits = 31 - (int32)xLZCNT((uint32)V);
+    int32 Cost = 2 * m_Cost[St][1];
+    St = Pos <= c_DefaultKx ? c_OffsetX2LowAC : c_OffsetX2HighAC;
+    for(int32 i = 1; i < NumCatBits; i++, St++) { Cost += m_Cost[St][1]; }
+    Cost += m_Cost[St][0];
+    St += c_OffsetM;
+    for(int32 b = NumCatBits - 1; b >= 0; b--) { Cost += m_Cost[St][(V >> b) & 1]; }
+    return Cost;
+  }
+  //nonzero coefficient at Pos preceded by nonzero one at PrevPos (0 - DC) - "not EOB" decision, run of zeros, sign and magnitude
+  int32 calcRun(int32 PrevPos, int32 Pos, int32 AbsCoeff) const
+  {
+    return m_Cost[3 * PrevPos][0] + m_ZeroCost[Pos] - m_ZeroCost[PrevPos + 1] + m_Cost[3 * (Pos - 1) + 1][1] + c_CostScale + calcMag(Pos, AbsCoeff);
+  }
+  //EOB after last nonzero coefficient at LastPos (0 - DC)
+  int32 calcEOB(int32 LastPos) const { return LastPos < xJPEG_Constants::c_BlockArea - 1 ? m_Cost[3 * LastPos][1] : 0; }
+};
+
+//=====================================================================================================================================================================================
+
+} //end of namespace PMBB::JPEG
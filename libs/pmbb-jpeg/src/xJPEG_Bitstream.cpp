@@ -0,0 +1,114 @@
+/*
+    SPDX-FileCopyrightText: 2020-2024 Jakub Stankowski <jakub.stankowski@put.poznan.pl>
+    SPDX-License-Identifier: BSD-3-Clause
+*/
+#include "xJPEG_Bitstream.h"
+
+namespace PMBB_NAMESPACE::JPEG {
+
+//=====================================================================================================================================================================================
+// xBitstreamWriterJPEG
+//=====================================================================================================================================================================================
+
+void xBitstreamWriterJPEG::init()
+{
+  assert(m_ByteBuffer);
+  m_TmpBuff               = 0;
+  m_RemainigTmpBufferBits = c_TmpBuffBits;
+  m_ByteAligned           = true;
+  m_InitialDataSize       = m_ByteBuffer->getDataSize();
+  m_NumStuffedBytes       = 0;
+}
+void xBitstreamWriterJPEG::uninit()
+{
+  xCheckAlignment();
+  assert(m_ByteAligned);
+  if(m_RemainigTmpBufferBits != c_TmpBuffBits)
+  {
+    const uint32 NumBytes = c_TmpBuffBytes - (m_RemainigTmpBufferBits >> 3);
+    xFlushBytesWithStuffing(m_TmpBuff << m_RemainigTmpBufferBits, NumBytes);
+    m_RemainigTmpBufferBits = c_TmpBuffBits;
+  }
+}
+uint32 xBitstreamWriterJPEG::writeAlign(uint32 Bit)
+{
+  assert(Bit==0 || Bit==1);
+  uint32 NumBitsUntilByteAligned = getNumBitsUntilByteAligned();
+  if(NumBitsUntilByteAligned)
+  {
+    uint32 Bits = Bit == 0 ? 0 : (1<<NumBitsUntilByteAligned)-1;
+    writeBits(Bits, NumBitsUntilByteAligned);
+  }
+  m_ByteAligned = true;
+  return NumBitsUntilByteAligned;
+}
+void xBitstreamWriterJPEG::xFlushBytesWithStuffing(uint64 Word, uint32 NumBytes)
+{
+  for(uint32 ByteIdx = 0; ByteIdx < NumBytes; ByteIdx++)
+  {
+    uint8 Byte = (uint8)(Word >> (c_TmpBuffBits - 8)); Word <<= 8;
+    m_ByteBuffer->appendU8(Byte);
+    if(Byte == 0xFF) { m_ByteBuffer->appendU8(0x00); m_NumStuffedBytes++; }
+  }
+}
+
+//=====================================================================================================================================================================================
+// xBitstreamReaderJPEG
+//=====================================================================================================================================================================================
+
+void xBitstreamReaderJPEG::init()
+{
+  assert(m_ByteBuffer);
+  m_TmpBuff               = 0;
+  m_RemainigTmpBufferBits = 0;
+  m_ByteAligned           = true;
+  m_MarkerReached         = false;
+  m_NumPaddedBits         = 0;
+}
+void xBitstreamReaderJPEG::uninit()
+{
+  xCheckAlignment();
+  assert(m_ByteAligned);
+  //return unread bytes (with their stuffing) to bound buffer, padding bits are placed after all real bits
+  uint32 NumRealBits = m_RemainigTmpBufferBits > m_NumPaddedBits ? m_RemainigTmpBufferBits - m_NumPaddedBits : 0;
+  int32  NumRewind   = 0;
+  for(uint32 ByteIdx = 0; ByteIdx < (NumRealBits >> 3); ByteIdx++)
+  {
+    uint8 Byte = (uint8)(m_TmpBuff >> (c_TmpBuffBits - 8 - (ByteIdx << 3)));
+    NumRewind += Byte == 0xFF ? 2 : 1;
+  }
+  m_ByteBuffer->modifyRead(-NumRewind);
+  m_TmpBuff               = 0;
+  m_RemainigTmpBufferBits = 0;
+  m_NumPaddedBits         = 0;
+}
+uint32 xBitstreamReaderJPEG::readAlign()
+{
+  uint32 Bits = 0;
+  uint32 NumBitsUntilByteAligned = getNumBitsUntilByteAligned();
+  if(NumBitsUntilByteAligned) { Bits = readBits(NumBitsUntilByteAligned); }
+  m_ByteAligned = true;
+  return Bits;
+}
+void xBitstreamReaderJPEG::xRefillWithUnstuffing()
+{
+  while(m_RemainigTmpBufferBits <= c_TmpBuffBits - 8)
+  {
+    uint32 Byte    = 0;
+    bool   Padding = true;
+    if(!m_MarkerReached && m_ByteBuffer->getDataSize() > 0)
+    {
+      const byte* Src = m_ByteBuffer->getReadPtr();
+      if     (Src[0] != 0xFF                                   ) { Byte = Src[0]; Padding = false; m_ByteBuffer->modifyRead(1); }
+      else if(m_ByteBuffer->getDataSize() > 1 && Src[1] == 0x00) { Byte = 0xFF  ; Padding = false; m_ByteBuffer->modifyRead(2); } //stuffing
+      else                                                       { m_MarkerReached = true; } //marker - left in buffer
+    }
+    if(Padding) { m_NumPaddedBits += 8; } //marker or end of data - feed zeros
+    m_TmpBuff |= (uint64)Byte << (c_TmpBuffBits - 8 - m_RemainigTmpBufferBits);
+    m_RemainigTmpBufferBits += 8;
+  }
+}
+
+//=====================================================================================================================================================================================
+
+} //end of namespace PMBB::JPEG
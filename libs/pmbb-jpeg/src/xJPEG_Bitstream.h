@@ -0,0 +1,129 @@
+/*
+    SPDX-FileCopyrightText: 2020-2024 Jakub Stankowski <jakub.stankowski@put.poznan.pl>
+    SPDX-License-Identifier: BSD-3-Clause
+*/
+#pragma once
+#include "xCommonDefJPEG.h"
+#include "xBitstream.h"
+
+namespace PMBB_NAMESPACE::JPEG {
+
+//=====================================================================================================================================================================================
+
+static inline bool xHasByteFF(uint64 Word) //zero byte test on inverted word
+{
+  constexpr uint64 c_ByteLSBs = 0x0101010101010101ull;
+  constexpr uint64 c_ByteMSBs = 0x8080808080808080ull;
+  return ((~Word - c_ByteLSBs) & Word & c_ByteMSBs) != 0;
+}
+
+//=====================================================================================================================================================================================
+// xBitstreamWriterJPEG - bitstream writer for entropy coded segment, inserts stuffing byte (0x00) after every 0xFF while flushing
+//=====================================================================================================================================================================================
+
+class xBitstreamWriterJPEG : public xBitstream
+{
+protected:
+  int32 m_InitialDataSize = 0; //data already present in bound buffer (markers)
+  int32 m_NumStuffedBytes = 0;
+
+public:
+  xBitstreamWriterJPEG() : xBitstream() { m_RemainigTmpBufferBits = c_TmpBuffBits; };
+
+  void   init  ();
+  void   uninit();
+
+  inline void writeBits(uint32 Bits, uint32 NumberOfBitsToWrite)
+  {
+    assert(NumberOfBitsToWrite <= 32);
+    assert(((uint64)Bits >> NumberOfBitsToWrite) == 0);
+
+    if(m_RemainigTmpBufferBits >= NumberOfBitsToWrite)
+    {
+      m_TmpBuff = (m_TmpBuff << NumberOfBitsToWrite) | Bits;
+      m_RemainigTmpBufferBits -= NumberOfBitsToWrite;
+    }
+    else
+    {
+      uint32 Delta = NumberOfBitsToWrite - m_RemainigTmpBufferBits;
+      m_TmpBuff = (m_TmpBuff << m_RemainigTmpBufferBits) | ((uint64)Bits >> Delta);
+      xFlushEntireTmpWithStuffing();
+      m_TmpBuff = Bits; //already written bits are shifted out before next flush
+      m_RemainigTmpBufferBits = c_TmpBuffBits - Delta;
+    }
+  }
+
+  uint32 writeAlign(uint32 Bit);
+
+  //written entropy coded bits - excluding stuffing and data present before init
+  uint32 getWrittenBits() const { return ((m_ByteBuffer->getDataSize() - m_InitialDataSize - m_NumStuffedBytes) << 3) + (c_TmpBuffBits - m_RemainigTmpBufferBits); }
+  int32  getNumStuffedBytes() const { return m_NumStuffedBytes; }
+
+protected:
+  inline void xFlushEntireTmpWithStuffing()
+  {
+    if(!xHasByteFF(m_TmpBuff)) { m_ByteBuffer->appendU64_BE(m_TmpBuff); }
+    else                       { xFlushBytesWithStuffing(m_TmpBuff, c_TmpBuffBytes); }
+    m_RemainigTmpBufferBits = c_TmpBuffBits;
+  }
+  void xFlushBytesWithStuffing(uint64 Word, uint32 NumBytes); //Word aligned to MSB
+};
+
+//=====================================================================================================================================================================================
+// xBitstreamReaderJPEG - bitstream reader for entropy coded segment, removes stuffing byte (0x00) following every 0xFF while refilling
+// reading stops before marker (RST/EOI) - further bits are zeros, uninit leaves bound buffer positioned at marker
+//=====================================================================================================================================================================================
+
+class xBitstreamReaderJPEG : public xBitstream
+{
+protected:
+  bool   m_MarkerReached = false;
+  uint32 m_NumPaddedBits = 0; //zero bits appended after marker was reached
+
+public:
+  xBitstreamReaderJPEG() : xBitstream() { m_RemainigTmpBufferBits = 0; };
+
+  void   init  ();
+  void   uninit();
+
+  inline uint32 peekBits(uint32 NumberOfBitsToPeek)
+  {
+    assert(NumberOfBitsToPeek > 0 && NumberOfBitsToPeek <= 32);
+    if(m_RemainigTmpBufferBits < NumberOfBitsToPeek) { xRefill(); }
+    return (uint32)(m_TmpBuff >> (c_TmpBuffBits - NumberOfBitsToPeek));
+  }
+  inline void skipBits(uint32 NumberOfBitsToSkip)
+  {
+    assert(NumberOfBitsToSkip <= m_RemainigTmpBufferBits);
+    m_TmpBuff               <<= NumberOfBitsToSkip;
+    m_RemainigTmpBufferBits  -= NumberOfBitsToSkip;
+  }
+  inline uint32 readBits(uint32 NumberOfBitsToRead) { uint32 Bits = peekBits(NumberOfBitsToRead); skipBits(NumberOfBitsToRead); return Bits; }
+  uint32        readAlign();
+
+  bool   getMarkerReached() const { return m_MarkerReached; }
+
+protected:
+  //fast path - 8 bytes without 0xFF, bits of partially fetched byte are left below valid bits (next refill ORs the same bits in place)
+  inline void xRefill()
+  {
+    if(m_ByteBuffer->getDataSize() >= (int32)c_TmpBuffBytes)
+    {
+      uint64 Word = m_ByteBuffer->peekU64_BE();
+      if(!xHasByteFF(Word))
+      {
+        uint32 NumBytes = (c_TmpBuffBits - m_RemainigTmpBufferBits) >> 3;
+        m_TmpBuff |= Word >> m_RemainigTmpBufferBits;
+        m_RemainigTmpBufferBits += NumBytes << 3;
+        m_ByteBuffer->modifyRead(NumBytes);
+        return;
+      }
+    }
+    xRefillWithUnstuffing();
+  }
+  void xRefillWithUnstuffing();
+};
+
+//=====================================================================================================================================================================================
+
+} //end of namespace PMBB::JPEG
@@ -26,6 +26,7 @@ void xCodecCommon::initCodecCommon(int32V2 PictureSize, eCrF ChromaFormat)
 
   for(int32 CmpIdx = 0; CmpIdx < m_NumOfComponents; CmpIdx++)
   {
+    assert(m_SampFactorHor[CmpIdx] <= c_MSF && m_SampFactorVer[CmpIdx] <= c_MSF);
     m_Log2MCUsWidth [CmpIdx] = c_L2BS + m_SampFactorHor[CmpIdx] - 1;
     m_Log2MCUsHeight[CmpIdx] = c_L2BS + m_SampFactorVer[CmpIdx] - 1;
 
@@ -38,6 +39,11 @@ void xCodecCommon::initCodecCommon(int32V2 PictureSize, eCrF ChromaFormat)
     m_NumBlocks     [CmpIdx] = (m_MCUsMulWidth[CmpIdx] >> c_L2BS) * (m_MCUsMulHeight[CmpIdx] >> c_L2BS);
 
     m_ScanlineHeight[CmpIdx] = c_BS * m_SampFactorVer[CmpIdx];
+
+    const int32 CmpWidthNonIntlv  = (m_PictureWidth  * m_SampFactorHor[CmpIdx] + m_SampFactorHor[0] - 1) / m_SampFactorHor[0]; //ITU T.81 A.1.1 - rounded up
+    const int32 CmpHeightNonIntlv = (m_PictureHeight * m_SampFactorVer[CmpIdx] + m_SampFactorVer[0] - 1) / m_SampFactorVer[0];
+    m_NumBlocksNonIntlvH[CmpIdx] = xNumUnitsCoveringLength(CmpWidthNonIntlv , c_L2BS);
+    m_NumBlocksNonIntlvV[CmpIdx] = xNumUnitsCoveringLength(CmpHeightNonIntlv, c_L2BS);
   }
 
   m_NumMCUsInWidth  = xNumUnitsCoveringLength(m_PictureWidth,  m_Log2MCUsWidth [0]);
@@ -19,6 +19,7 @@ protected:
   static constexpr int32 c_L2BS = xJPEG_Constants::c_Log2BlockSize;
   static constexpr int32 c_BS   = xJPEG_Constants::c_BlockSize;
   static constexpr int32 c_BA   = xJPEG_Constants::c_BlockArea;
+  static constexpr int32 c_MSF  = 2; //max sampling factor (in both directions) of supported chroma formats
 
 protected:
   int32V2 m_PictureSize     = { NOT_VALID, NOT_VALID };
@@ -40,6 +41,8 @@ protected:
   std::array<int32, c_NC> m_MCUsMulHeight ;
   std::array<int32, c_NC> m_NumBlocks     ;
   std::array<int32, c_NC> m_ScanlineHeight;
+  std::array<int32, c_NC> m_NumBlocksNonIntlvH; //non-interleaved scan (progressive mode) - blocks covering component samples only (ITU T.81 A.2.2)
+  std::array<int32, c_NC> m_NumBlocksNonIntlvV;
 
   int32   m_NumMCUsInWidth  = NOT_VALID;
   int32   m_NumMCUsInHeight = NOT_VALID;
@@ -66,6 +69,13 @@ public:
 protected:
   void initCodecCommon(int32V2 PictureSize, eCrF ChromaFormat);
 
+  //non-interleaved scan visits blocks in component raster order, blocks are stored in MCU order
+  int32 xGetBlockIdxNonIntlv(int32 CmpIdx, int32 BlockPosH, int32 BlockPosV) const
+  {
+    const int32 MCU_Idx = (BlockPosV / m_SampFactorVer[CmpIdx]) * m_NumMCUsInWidth + (BlockPosH / m_SampFactorHor[CmpIdx]);
+    return MCU_Idx * m_SampFactorHor[CmpIdx] * m_SampFactorVer[CmpIdx] + (BlockPosV % m_SampFactorVer[CmpIdx]) * m_SampFactorHor[CmpIdx] + (BlockPosH % m_SampFactorHor[CmpIdx]);
+  }
+
   static inline void loadEntireBlock(uint16* restrict Dst, const uint16* Src, int32 SrcStride)
   {
     for(int32 y = 0; y < c_BS; y++)
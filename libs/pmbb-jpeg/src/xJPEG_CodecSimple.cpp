@@ -1,4 +1,4 @@
-/*
+﻿/*
     SPDX-FileCopyrightText: 2020-2024 Jakub Stankowski <jakub.stankowski@put.poznan.pl>
     SPDX-License-Identifier: BSD-3-Clause
 */
@@ -208,28 +208,19 @@ void xEncoderSimple::xEncodeBlock(const uint16* SamplesOrg, eCmp CmpId)
   //const int32 HuffTabIdDC = m_SOS .getHuffTableIdDC(CmpId);
   //const int32 HuffTabIdAC = m_SOS .getHuffTableIdAC(CmpId);
 
-  int16 CoeffsTrans[c_BA];
-  int16 CoeffsQuant[c_BA];
   int16 CoeffsScan [c_BA];
 
   uint64 TP0 = m_GatherTimeStats ? xTSC() : 0;
-  xTransform::FwdTransformDCT_8x8(CoeffsTrans, SamplesOrg);
-  CoeffsTrans[0] -= xTransformConstants::c_FwdDcCorr; //DC correction - JPEG requires 128 to be subtracted from every input sample - could be done be DC -= 
+  m_Quant.FwdTransformQuantScan(CoeffsScan, SamplesOrg, QuantTabId); //fused transform, DC correction, quantization and scan
   uint64 TP1 = m_GatherTimeStats ? xTSC() : 0;
-  m_Quant.QuantScale(CoeffsQuant, CoeffsTrans, QuantTabId);
-  uint64 TP2 = m_GatherTimeStats ? xTSC() : 0;
-  xScan::Scan(CoeffsScan, CoeffsQuant);
-  uint64 TP3 = m_GatherTimeStats ? xTSC() : 0;
   //m_EntropyEnc.EncodeBlock(CoeffsScan, CmpId, HuffTabIdDC, HuffTabIdAC);
   m_EntropyEncDefault.EncodeBlock(CoeffsScan, CmpId);
-  uint64 TP4 = m_GatherTimeStats ? xTSC() : 0;
+  uint64 TP2 = m_GatherTimeStats ? xTSC() : 0;
 
   if (m_GatherTimeStats)
   {
-    m_TotalEntropyTicks   += TP1 - TP0;
-    m_TotalScanTicks      += TP2 - TP1;
-    m_TotalQuantTicks     += TP3 - TP2;
-    m_TotalTransformTicks += TP4 - TP3;
+    m_TotalTransformTicks += TP1 - TP0; //fused kernel - quantization and scan are included in transform time
+    m_TotalEntropyTicks   += TP2 - TP1;
   }
 }
 
@@ -256,13 +247,12 @@ void xDecoderSimple::init(int32V2 PictureSize, eCrF ChromaFormat, int32 Quality,
   m_HT[2].InitDefault(1, xJFIF::xHuffTable::eHuffClass::DC, eCmp::CB); //any chroma so use CB
   m_HT[3].InitDefault(1, xJFIF::xHuffTable::eHuffClass::AC, eCmp::CB);
   m_SOS.Init(m_SOF0.getNumComponents(), 0, 1);
+  m_Progressive = false;
+  m_Arithmetic  = false;
 
   //init toolbox
   m_Quant     .Init(m_QT);
   m_EntropyDec.Init(m_HT);
-  int32 NumBlocksInMCU      = m_SampFactorHor[0] * m_SampFactorVer[0] + m_SampFactorHor[1] * m_SampFactorVer[1] * 2;
-  int32 MaxEncodedSliceSize = m_NumMCUsInSlice * NumBlocksInMCU * 256;
-  m_EntropyBuffer.resize(MaxEncodedSliceSize);
 }
 bool xDecoderSimple::init(xByteBuffer* InputBuffer)
 {
@@ -278,6 +268,8 @@ bool xDecoderSimple::init(xByteBuffer* InputBuffer)
 
   m_QT.clear();
   m_HT.clear();
+  m_Progressive = false;
+  m_Arithmetic  = false;
   
   bool Result = xJFIF::ReadSOI(InputBuffer);
   if(Result == false) { return false; }
@@ -304,6 +296,18 @@ bool xDecoderSimple::init(xByteBuffer* InputBuffer)
         Result = xJFIF::ReadSOF0(InputBuffer, m_SOF0);
         if(Result) { ReadSOF0 = true; } else { return false; }
         break;
+      case xJFIF::eMarker::SOF2:
+        Result = xJFIF::ReadSOF2(InputBuffer, m_SOF0);
+        if(Result) { ReadSOF0 = true; m_Progressive = true; } else { return false; }
+        break;
+      case xJFIF::eMarker::SOF9:
+        Result = xJFIF::ReadSOF9(InputBuffer, m_SOF0);
+        if(Result) { ReadSOF0 = true; m_Arithmetic = true; } else { return false; }
+        break;
+      case xJFIF::eMarker::DAC:
+        Result = xJFIF::ReadDAC(InputBuffer);
+        if(!Result) { return false; } //custom conditioning is not supported
+        break;
       case xJFIF::eMarker::DHT:
         Result = xJFIF::ReadDHT(InputBuffer, m_HT);
         if(Result) { ReadDHT = true; } else { return false; }
@@ -326,6 +330,7 @@ bool xDecoderSimple::init(xByteBuffer* InputBuffer)
 
   //test if all required
   if(!ReadDQT || !ReadSOF0 || !ReadSOS) { return false; }
+  if(m_Progressive && ReadDRI && m_RestartInterval != 0) { return false; } //restart intervals in progressive mode are not supported
 
   if(!ReadAPP0) { m_APP0.InitDefault();  }
   if(!ReadDRI ) { m_RestartInterval = 0; }
@@ -365,22 +370,38 @@ bool xDecoderSimple::init(xByteBuffer* InputBuffer)
     }
   }
 
+  if(m_Progressive)
+  {
+    for(int32 CmpIdx = 0; CmpIdx < m_NumOfComponents; CmpIdx++) { m_CmpCoeffsScan[CmpIdx].resize(m_MCUsMulWidth[CmpIdx] * m_MCUsMulHeight[CmpIdx]); }
+  }
+
   //init toolbox
   m_Quant     .Init(m_QT);
   m_EntropyDec.Init(m_HT);
-  int32 NumBlocksInMCU      = m_SampFactorHor[0] * m_SampFactorVer[0] + m_SampFactorHor[1] * m_SampFactorVer[1] * 2;
-  int32 MaxEncodedSliceSize = m_NumMCUsInSlice * NumBlocksInMCU * 256;
-  m_EntropyBuffer.resize(MaxEncodedSliceSize);
   return true;
 }
 void xDecoderSimple::decode(xByteBuffer* InputBuffer, xPicYUV* OutputPicture)
 {
+  xInitOutputSize();
+  assert(OutputPicture->isSameSize(getOutputSize(), eCmp::LM));
+
+  if(m_Progressive) { xDecodePictureProgressive(InputBuffer, OutputPicture); return; }
+
   int32 StartOfScanOffset = xJFIF::FindSegment(InputBuffer, xJFIF::eMarker::SOS);
   InputBuffer->modifyRead(StartOfScanOffset);
   xJFIF::SkipSOS(InputBuffer);
   xDecodePicture(InputBuffer, OutputPicture);
   xJFIF::ReadEOI(InputBuffer);
 }
+void xDecoderSimple::xInitOutputSize()
+{
+  const int32V2 OutputSize = getOutputSize();
+  for(int32 CmpIdx = 0; CmpIdx < m_NumOfComponents; CmpIdx++)
+  {
+    m_OutCmpWidth [CmpIdx] = OutputSize.getX() >> m_ShiftHor[CmpIdx];
+    m_OutCmpHeight[CmpIdx] = OutputSize.getY() >> m_ShiftVer[CmpIdx];
+  }
+}
 void xDecoderSimple::xDecodePicture(xByteBuffer* InputBuffer, xPicYUV* OutputPicture)
 {
   tTimePoint BegTime = tClock::now(); //for time calibration
@@ -415,13 +436,9 @@ void xDecoderSimple::xDecodeSlice(xByteBuffer* InputBuffer, xPicYUV* OutputPictu
 {
   uint64 TP0 = xTSC();
 
-  m_EntropyBuffer.reset();
-
-  //copy from input and remove stuffing until next marker
-  xJFIF::RemoveStuffing(&m_EntropyBuffer, InputBuffer);
-  uint64 TP1 = xTSC();
-
-  m_EntropyDec.StartSlice(&m_EntropyBuffer);
+  //entropy decoder reads stuffed data directly from input until next marker
+  if(m_Arithmetic) { m_EntropyDecAri.StartSlice(InputBuffer); }
+  else             { m_EntropyDec   .StartSlice(InputBuffer); }
   uint16*     CmpPtrV   [] = { OutputPicture->getAddr  (eCmp::LM), OutputPicture->getAddr  (eCmp::CB), OutputPicture->getAddr  (eCmp::CR), nullptr };
   const int32 CmpStrideV[] = { OutputPicture->getStride(eCmp::LM), OutputPicture->getStride(eCmp::CB), OutputPicture->getStride(eCmp::CR),       0 };
 
@@ -431,15 +448,15 @@ void xDecoderSimple::xDecodeSlice(xByteBuffer* InputBuffer, xPicYUV* OutputPictu
     xDecodeMCU(CmpPtrV, CmpStrideV, MCU_Idx);
   }
 
-  m_EntropyDec.FinishSlice();
+  if(m_Arithmetic) { m_EntropyDecAri.FinishSlice(); }
+  else             { m_EntropyDec   .FinishSlice(); }
 
-  uint64 TP2 = xTSC();
+  uint64 TP1 = xTSC();
 
   m_TotalSliceIters    += 1;
-  m_TotalSliceTicks    += TP2 - TP0;
-  m_TotalStuffingTicks += TP1 - TP0;
+  m_TotalSliceTicks    += TP1 - TP0;
 }
-void xDecoderSimple::xDecodeMCU(uint16* CmpPtrV[], const int32 CmpStrideV[], int32 MCU_Idx)
+void xDecoderSimple::xDecodeMCU(uint16* CmpPtrV[], const int32 CmpStrideV[], int32 MCU_Idx, const int16* CoeffsScanV[])
 {
   uint64 TP = m_GatherTimeStats ? xTSC() : 0;
 
@@ -447,35 +464,40 @@ void xDecoderSimple::xDecodeMCU(uint16* CmpPtrV[], const int32 CmpStrideV[], int
   int32 MCU_PosV    = MCU_Idx / m_NumMCUsInWidth;
   int32 MCU_PosH    = MCU_Idx % m_NumMCUsInWidth;
 
-  //dec samples buffer
+  //dec samples buffer - reduced block (scaled decoding) is stored in top-left corner
   uint16 SamplesDec[c_BA];
+  const int32 Log2OutBS = c_L2BS - m_Log2Scale;
+  const int32 OutBS     = 1 << Log2OutBS;
 
   //encode blocks
   for(int32 CmpIdx = 0; CmpIdx < m_NumOfComponents; CmpIdx++)
   {
-    const int32 MCU_PelPosV = MCU_PosV << (2 + m_SampFactorVer[CmpIdx]);
-    const int32 MCU_PelPosH = MCU_PosH << (2 + m_SampFactorHor[CmpIdx]);
+    const int32 MCU_PelPosV = MCU_PosV << (Log2OutBS + m_SampFactorVer[CmpIdx] - 1);
+    const int32 MCU_PelPosH = MCU_PosH << (Log2OutBS + m_SampFactorHor[CmpIdx] - 1);
 
     uint16* restrict CmpPtr    = CmpPtrV   [CmpIdx];
     const int32      CmpStride = CmpStrideV[CmpIdx];
+    int32            BlockIdx  = MCU_Idx * m_SampFactorVer[CmpIdx] * m_SampFactorHor[CmpIdx];
 
     for(int32 V = 0; V < m_SampFactorVer[CmpIdx]; V++)
     {
-      const int32 BlockPosV = MCU_PelPosV + (V << c_L2BS);
-      const int32 BlockResV = m_CmpHeight[CmpIdx] - BlockPosV;
+      const int32 BlockPosV = MCU_PelPosV + (V << Log2OutBS);
+      const int32 BlockResV = m_OutCmpHeight[CmpIdx] - BlockPosV;
       uint16* restrict BlockPtrV = CmpPtr + BlockPosV * CmpStride;
 
       for(int32 H = 0; H < m_SampFactorHor[CmpIdx]; H++)
       {
-        const int32 BlockPosH = MCU_PelPosH + (H << c_L2BS);
-        const int32 BlockResH = m_CmpWidth[CmpIdx] - BlockPosH;
+        const int32 BlockPosH = MCU_PelPosH + (H << Log2OutBS);
+        const int32 BlockResH = m_OutCmpWidth[CmpIdx] - BlockPosH;
         uint16* restrict BlockPtr = BlockPtrV + BlockPosH;
 
-        xDecodeBlock(SamplesDec, (eCmp)CmpIdx);
+        if(CoeffsScanV == nullptr) { xDecodeBlock(SamplesDec, (eCmp)CmpIdx); }
+        else                       { xReconstructBlock(SamplesDec, CoeffsScanV[CmpIdx] + (BlockIdx << xJPEG_Constants::c_Log2BlockArea), (eCmp)CmpIdx); }
+        BlockIdx++;
 
-        if     (BlockResV >= 8 && BlockResH >= 8) { storeEntireBlock (BlockPtr, SamplesDec, CmpStride); } //C++20 TODO use [[likely]]
-        else if(BlockResV >  0 && BlockResH >  0) { storePartialBlock(BlockPtr, SamplesDec, CmpStride, xMin(BlockResH, c_BS), xMin(BlockResV, c_BS)); }
-        else                                      { /* do nothing */ }
+        if     (BlockResV >= OutBS && BlockResH >= OutBS && m_Log2Scale == 0) { storeEntireBlock (BlockPtr, SamplesDec, CmpStride); } //C++20 TODO use [[likely]]
+        else if(BlockResV >  0     && BlockResH >  0                        ) { storePartialBlock(BlockPtr, SamplesDec, CmpStride, xMin(BlockResH, OutBS), xMin(BlockResV, OutBS)); }
+        else                                                                  { /* do nothing */ }
       }
     }
   }
@@ -484,33 +506,149 @@ void xDecoderSimple::xDecodeMCU(uint16* CmpPtrV[], const int32 CmpStrideV[], int
 }
 void xDecoderSimple::xDecodeBlock(uint16* SamplesDec, eCmp CmpId)
 {
-  int32 QuantTabId  = m_SOF0.getQuantTableId (CmpId);
   int32 HuffTabIdDC = m_SOS .getHuffTableIdDC(CmpId);
   int32 HuffTabIdAC = m_SOS .getHuffTableIdAC(CmpId);
     
   int16 CoeffsScan [c_BA];
+
+  uint64 TP0 = m_GatherTimeStats ? xTSC() : 0;
+  if(m_Arithmetic) { m_EntropyDecAri.DecodeBlock(CoeffsScan, CmpId, HuffTabIdDC, HuffTabIdAC); } //table selectors point to conditioning tables
+  else             { m_EntropyDec   .DecodeBlock(CoeffsScan, CmpId, HuffTabIdDC, HuffTabIdAC); }
+  if(m_GatherTimeStats) { m_TotalEntropyTicks += xTSC() - TP0; }
+
+  xReconstructBlock(SamplesDec, CoeffsScan, CmpId);
+}
+void xDecoderSimple::xReconstructBlock(uint16* SamplesDec, const int16* CoeffsScan, eCmp CmpId)
+{
+  int32 QuantTabId  = m_SOF0.getQuantTableId (CmpId);
+
   int16 CoeffsQuant[c_BA];
   int16 CoeffsTrans[c_BA];
 
-  uint64 TP0 = m_GatherTimeStats ? xTSC() : 0;
-  m_EntropyDec.DecodeBlock(CoeffsScan, CmpId, HuffTabIdDC, HuffTabIdAC);
   uint64 TP1 = m_GatherTimeStats ? xTSC() : 0;
-  xScan::InvScan(CoeffsQuant, CoeffsScan);
-  uint64 TP2 = m_GatherTimeStats ? xTSC() : 0;
-  m_Quant.InvScale(CoeffsTrans, CoeffsQuant, QuantTabId);
+  uint64 TP2 = TP1;
+  if(m_Log2Scale == c_L2BS)
+  {
+    CoeffsTrans[0] = (int16)((int32)CoeffsScan[0] * (int32)m_Quant.getQuantizer(QuantTabId).getQuantCoeffs()[0]); //1/8 scale - only DC is needed
+  }
+  else
+  {
+    xScan::InvScan(CoeffsQuant, CoeffsScan);
+    TP2 = m_GatherTimeStats ? xTSC() : 0;
+    m_Quant.InvScale(CoeffsTrans, CoeffsQuant, QuantTabId);
+  }
   uint64 TP3 = m_GatherTimeStats ? xTSC() : 0;
   CoeffsTrans[0] += xTransformConstants::c_InvDcCorr; //DC correction - JPEG requires 128 to be subtracted from every input sample - could be done be DC -= 
-  xTransform::InvTransformDCT_8x8(SamplesDec, CoeffsTrans);
+  if(m_Log2Scale == 0) { xTransform::InvTransformDCT_8x8       (SamplesDec, CoeffsTrans, xEntropyCommon::findLastNonZero(CoeffsScan)); } //last nonzero coeff selects sparse inverse transform (DC only, 4x4 only or full)
+  else                 { xTransform::InvTransformDCT_8x8_Scaled(SamplesDec, CoeffsTrans, m_Log2Scale                                ); }
   uint64 TP4 = m_GatherTimeStats ? xTSC() : 0;
 
   if (m_GatherTimeStats)
   {
-    m_TotalEntropyTicks   += TP1 - TP0;
     m_TotalScanTicks      += TP2 - TP1;
     m_TotalQuantTicks     += TP3 - TP2;
     m_TotalTransformTicks += TP4 - TP3;
   }
 }
+void xDecoderSimple::xDecodePictureProgressive(xByteBuffer* InputBuffer, xPicYUV* OutputPicture)
+{
+  tTimePoint BegTime = tClock::now(); //for time calibration
+  uint64     BegTick = xTSC();
+
+  for(int32 CmpIdx = 0; CmpIdx < m_NumOfComponents; CmpIdx++) { std::fill(m_CmpCoeffsScan[CmpIdx].begin(), m_CmpCoeffsScan[CmpIdx].end(), (int16)0); }
+
+  //every scan can be preceded by its own Huffman tables
+  if(xJFIF::IdentifySegment(InputBuffer) == xJFIF::eMarker::SOI) { xJFIF::ReadSOI(InputBuffer); }
+  bool ContinueReadingSegments = true;
+  while(ContinueReadingSegments)
+  {
+    xJFIF::eMarker Type = xJFIF::IdentifySegment(InputBuffer);
+    switch(Type)
+    {
+      case xJFIF::eMarker::DHT:
+      {
+        std::vector<xJFIF::xHuffTable> HuffTables;
+        xJFIF::ReadDHT(InputBuffer, HuffTables);
+        m_EntropyDecPrg.Init(HuffTables);
+        break;
+      }
+      case xJFIF::eMarker::SOS:
+      {
+        xJFIF::xSOS Scan;
+        xJFIF::ReadSOS(InputBuffer, Scan);
+        xDecodeScanProgressive(InputBuffer, Scan);
+        break;
+      }
+      case xJFIF::eMarker::EOI:
+        xJFIF::ReadEOI(InputBuffer);
+        ContinueReadingSegments = false;
+        break;
+      case xJFIF::eMarker::ERR: //truncated or corrupted stream - reconstruct what was decoded
+        ContinueReadingSegments = false;
+        break;
+      default:
+        xJFIF::SkipSegment(InputBuffer);
+        break;
+    }
+  }
+
+  //reconstruction
+  uint16*      CmpPtrV    [] = { OutputPicture->getAddr  (eCmp::LM), OutputPicture->getAddr  (eCmp::CB), OutputPicture->getAddr  (eCmp::CR), nullptr };
+  const int32  CmpStrideV [] = { OutputPicture->getStride(eCmp::LM), OutputPicture->getStride(eCmp::CB), OutputPicture->getStride(eCmp::CR),       0 };
+  const int16* CoeffsScanV[] = { m_CmpCoeffsScan[0].data(), m_CmpCoeffsScan[1].data(), m_CmpCoeffsScan[2].data(), nullptr };
+  for(int32 MCU_Idx = 0; MCU_Idx < m_NumMCUsInArea; MCU_Idx++)
+  {
+    xDecodeMCU(CmpPtrV, CmpStrideV, MCU_Idx, CoeffsScanV);
+  }
+
+  m_TotalPictureIters += 1;
+  m_TotalPictureTime  += tClock::now() - BegTime; //for time calibration
+  m_TotalPictureTicks += xTSC() - BegTick;
+}
+void xDecoderSimple::xDecodeScanProgressive(xByteBuffer* InputBuffer, const xJFIF::xSOS& Scan)
+{
+  uint64 TP0 = xTSC();
+
+  m_EntropyDecPrg.StartScan(InputBuffer, Scan);
+
+  if(Scan.getNumComponents() > 1) //interleaved (DC only) - MCU order
+  {
+    for(int32 MCU_Idx = 0; MCU_Idx < m_NumMCUsInArea; MCU_Idx++)
+    {
+      for(int32 ScanCmpIdx = 0; ScanCmpIdx < Scan.getNumComponents(); ScanCmpIdx++)
+      {
+        const int32 CmpIdx         = (int32)Scan.getCmpId(eCmp(ScanCmpIdx));
+        const int32 HuffTabIdDC    = Scan.getHuffTableIdDC(eCmp(ScanCmpIdx));
+        const int32 NumBlocksInMCU = m_SampFactorVer[CmpIdx] * m_SampFactorHor[CmpIdx];
+        const int32 BlockIdxFirst  = MCU_Idx * NumBlocksInMCU;
+        for(int32 BlockIdx = BlockIdxFirst; BlockIdx < BlockIdxFirst + NumBlocksInMCU; BlockIdx++)
+        {
+          m_EntropyDecPrg.DecodeBlock(m_CmpCoeffsScan[CmpIdx].data() + (BlockIdx << xJPEG_Constants::c_Log2BlockArea), eCmp(CmpIdx), HuffTabIdDC, 0);
+        }
+      }
+    }
+  }
+  else //non-interleaved (single component) - raster order of component blocks
+  {
+    const int32 CmpIdx      = (int32)Scan.getCmpId(eCmp::LM);
+    const int32 HuffTabIdDC = Scan.getHuffTableIdDC(eCmp::LM);
+    const int32 HuffTabIdAC = Scan.getHuffTableIdAC(eCmp::LM);
+
+    for(int32 BlockPosV = 0; BlockPosV < m_NumBlocksNonIntlvV[CmpIdx]; BlockPosV++)
+    {
+      for(int32 BlockPosH = 0; BlockPosH < m_NumBlocksNonIntlvH[CmpIdx]; BlockPosH++)
+      {
+        const int32 BlockIdx = xGetBlockIdxNonIntlv(CmpIdx, BlockPosH, BlockPosV);
+        m_EntropyDecPrg.DecodeBlock(m_CmpCoeffsScan[CmpIdx].data() + (BlockIdx << xJPEG_Constants::c_Log2BlockArea), eCmp(CmpIdx), HuffTabIdDC, HuffTabIdAC);
+      }
+    }
+  }
+
+  m_EntropyDecPrg.FinishScan();
+
+  m_TotalSliceIters += 1;
+  m_TotalSliceTicks += xTSC() - TP0;
+}
 
 //=====================================================================================================================================================================================
 
@@ -76,20 +76,40 @@ class xDecoderSimple : public xCodecSimple
 {
 protected:
   xEntropyDecoder m_EntropyDec;
+  //progressive mode (SOF2) - coefficients of all scans are accumulated before reconstruction
+  bool                       m_Progressive = false;
+  xEntropyDecoderProgressive m_EntropyDecPrg;
+  std::vector<int16>         m_CmpCoeffsScan[c_NC];
+  //arithmetic coding (SOF9) - default conditioning only
+  bool                       m_Arithmetic = false;
+  xEntropyDecoderArith       m_EntropyDecAri;
+  //scaled decoding - output reduced by 2^Log2Scale in both directions (1/2, 1/4, 1/8), every block is reconstructed by reduced size inverse transform
+  int32                      m_Log2Scale = 0;
+  std::array<int32, c_NC>    m_OutCmpWidth ;
+  std::array<int32, c_NC>    m_OutCmpHeight;
 
 public: 
   void   create () { xCreate (); }
   void   destroy() { xDestroy(); }   
 
+  void    setLog2Scale (int32 Log2Scale) { assert(Log2Scale >= 0 && Log2Scale <= c_L2BS); m_Log2Scale = Log2Scale; }
+  int32   getLog2Scale () const { return m_Log2Scale; }
+  int32V2 getOutputSize() const { return { (m_PictureWidth + (1 << m_Log2Scale) - 1) >> m_Log2Scale, (m_PictureHeight + (1 << m_Log2Scale) - 1) >> m_Log2Scale }; } //size of OutputPicture expected by decode
+
   void   init   (int32V2 PictureSize, eCrF ChromaFormat, int32 Quality, int32 RestartInterval);
   bool   init   (xByteBuffer* InputBuffer);
-  void   decode (xByteBuffer* InputBuffer, xPicYUV* OutputPicture); //assumes same parameters as previous valid one - does not parse headers
+  void   decode (xByteBuffer* InputBuffer, xPicYUV* OutputPicture); //assumes same parameters as previous valid one - does not parse headers (except per scan DHT and SOS in progressive mode)
   
 protected:
+  void   xInitOutputSize();
   void   xDecodePicture(xByteBuffer* InputBuffer, xPicYUV* OutputPicture);
   void   xDecodeSlice  (xByteBuffer* InputBuffer, xPicYUV* OutputPicture, int32 MCU_IdxFirst, int32 MCU_IdxLast); //slice - a MCUs between begin, reset or end
-  void   xDecodeMCU    (uint16* CmpPtrV[], const int32 CmpStrideV[], int32 MCU_Idx);
+  void   xDecodeMCU    (uint16* CmpPtrV[], const int32 CmpStrideV[], int32 MCU_Idx, const int16* CoeffsScanV[] = nullptr); //CoeffsScanV != nullptr - reconstruct already decoded coefficients
   void   xDecodeBlock  (uint16* SamplesDec, eCmp CmpId);
+  void   xReconstructBlock(uint16* SamplesDec, const int16* CoeffsScan, eCmp CmpId);
+
+  void   xDecodePictureProgressive(xByteBuffer* InputBuffer, xPicYUV* OutputPicture);
+  void   xDecodeScanProgressive   (xByteBuffer* InputBuffer, const xJFIF::xSOS& Scan);
 };
 
 //=====================================================================================================================================================================================
@@ -14,6 +14,7 @@ class xJPEG_Constants
 public:
   static constexpr int32 c_MaxQuantTabs  = 4;
   static constexpr int32 c_MaxHuffTabs   = 4;
+  static constexpr int32 c_MaxArithTabs  = 4;
   static constexpr int32 c_MaxComponents = 4;
 
   static constexpr int32 c_Log2BlockSize = 3;
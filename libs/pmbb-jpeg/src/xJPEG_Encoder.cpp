@@ -10,11 +10,41 @@
 #include "xMemory.h"
 #include "xPixelOps.h"
 #include "xDistortion.h"
+#include "xString.h"
+#include <limits>
+#include <cmath>
+#include <charconv>
+#include <algorithm>
 
 namespace PMBB_NAMESPACE::JPEG {
 
 //=====================================================================================================================================================================================
 
+void xLambdaHistory::reset()
+{
+  std::lock_guard<std::mutex> LockManager(m_Mutex);
+  m_NextFrameIdx = 0;
+  m_State        = xState();
+}
+xLambdaHistory::xState xLambdaHistory::acquire(int32 FrameIdx)
+{
+  std::unique_lock<std::mutex> LockManager(m_Mutex);
+  m_CondPublished.wait(LockManager, [this, FrameIdx]() { return m_NextFrameIdx == FrameIdx; });
+  return m_State;
+}
+void xLambdaHistory::publish(int32 FrameIdx, const xState& State)
+{
+  {
+    std::lock_guard<std::mutex> LockManager(m_Mutex);
+    assert(m_NextFrameIdx == FrameIdx);
+    m_State        = State;
+    m_NextFrameIdx = FrameIdx + 1;
+  }
+  m_CondPublished.notify_all();
+}
+
+//=====================================================================================================================================================================================
+
 void xAdvancedEncoder::create(int32V2 PictureSize, eCrF ChromaFormat)
 {
   initCodecCommon(PictureSize, ChromaFormat);
@@ -22,29 +52,42 @@ void xAdvancedEncoder::create(int32V2 PictureSize, eCrF ChromaFormat)
   for(int32 CmpIdx = 0; CmpIdx < m_NumOfComponents; CmpIdx++)
   {
     const int32 Area = m_MCUsMulWidth[CmpIdx] * m_MCUsMulHeight[CmpIdx];
-    m_CmpCoeffsTransOrg[CmpIdx] = (int16*)xMemory::xAlignedMallocPageAuto(Area * sizeof(int16));
-    m_CmpCoeffsTransRec[CmpIdx] = (int16*)xMemory::xAlignedMallocPageAuto(Area * sizeof(int16));
-    m_CmpCoeffsScan    [CmpIdx] = (int16*)xMemory::xAlignedMallocPageAuto(Area * sizeof(int16));
-    m_CmpCoeffsScanAux [CmpIdx] = (int16*)xMemory::xAlignedMallocPageAuto(Area * sizeof(int16));
-    m_CmpCoeffsScanOpt [CmpIdx] = (int16*)xMemory::xAlignedMallocPageAuto(Area * sizeof(int16));
+    m_CmpCoeffsTransOrg    [CmpIdx] = (int16*)xMemory::xAlignedMallocPageAuto(Area * sizeof(int16));
+    m_CmpCoeffsTransRec    [CmpIdx] = (int16*)xMemory::xAlignedMallocPageAuto(Area * sizeof(int16));
+    m_CmpCoeffsTransRecAuxD[CmpIdx] = (int16*)xMemory::xAlignedMallocPageAuto(Area * sizeof(int16));
+    m_CmpCoeffsTransRecAuxI[CmpIdx] = (int16*)xMemory::xAlignedMallocPageAuto(Area * sizeof(int16));
+    m_CmpCoeffsScan        [CmpIdx] = (int16*)xMemory::xAlignedMallocPageAuto(Area * sizeof(int16));
+    m_CmpCoeffsScanAuxD    [CmpIdx] = (int16*)xMemory::xAlignedMallocPageAuto(Area * sizeof(int16));
+    m_CmpCoeffsScanAuxI    [CmpIdx] = (int16*)xMemory::xAlignedMallocPageAuto(Area * sizeof(int16));
+    m_CmpCoeffsScanOpt     [CmpIdx] = (int16*)xMemory::xAlignedMallocPageAuto(Area * sizeof(int16));
+    m_CmpBlockInfo         [CmpIdx] = (xBlockInfo*)xMemory::xAlignedMallocPageAuto((Area >> xJPEG_Constants::c_Log2BlockArea) * sizeof(xBlockInfo));
+    m_CmpBlockInfoOpt      [CmpIdx] = (xBlockInfo*)xMemory::xAlignedMallocPageAuto((Area >> xJPEG_Constants::c_Log2BlockArea) * sizeof(xBlockInfo));
   }
 
-  m_PicRec.create(PictureSize, 8, ChromaFormat, 16);
-  m_EntropyBuffer.create(256);
+  m_PicRec    .create(PictureSize, 8, ChromaFormat, 16);
+  m_PicRecAuxD.create(PictureSize, 8, ChromaFormat, 16);
+  m_PicRecAuxI.create(PictureSize, 8, ChromaFormat, 16);
 }
 void xAdvancedEncoder::destroy()
 {
   for(int32 CmpIdx = 0; CmpIdx < m_NumOfComponents; CmpIdx++)
   {
-    xMemory::xAlignedFreeNull(m_CmpCoeffsTransOrg[CmpIdx]);
-    xMemory::xAlignedFreeNull(m_CmpCoeffsTransRec[CmpIdx]);
-    xMemory::xAlignedFreeNull(m_CmpCoeffsScan    [CmpIdx]);
-    xMemory::xAlignedFreeNull(m_CmpCoeffsScanAux [CmpIdx]);
-    xMemory::xAlignedFreeNull(m_CmpCoeffsScanOpt [CmpIdx]);
+    xMemory::xAlignedFreeNull(m_CmpCoeffsTransOrg    [CmpIdx]);
+    xMemory::xAlignedFreeNull(m_CmpCoeffsTransRec    [CmpIdx]);
+    xMemory::xAlignedFreeNull(m_CmpCoeffsTransRecAuxD[CmpIdx]);
+    xMemory::xAlignedFreeNull(m_CmpCoeffsTransRecAuxI[CmpIdx]);
+    xMemory::xAlignedFreeNull(m_CmpCoeffsScan        [CmpIdx]);
+    xMemory::xAlignedFreeNull(m_CmpCoeffsScanAuxD    [CmpIdx]);
+    xMemory::xAlignedFreeNull(m_CmpCoeffsScanAuxI    [CmpIdx]);
+    xMemory::xAlignedFreeNull(m_CmpCoeffsScanOpt     [CmpIdx]);
+    xMemory::xAlignedFreeNull(m_CmpBlockInfo         [CmpIdx]);
+    xMemory::xAlignedFreeNull(m_CmpBlockInfoOpt      [CmpIdx]);
   }
 
-  m_EntropyBuffer.destroy();
-  m_PicRec.destroy();
+  xCeaseThreading();
+  m_PicRec    .destroy();
+  m_PicRecAuxD.destroy();
+  m_PicRecAuxI.destroy();
 }
 void xAdvancedEncoder::initBaseMarkers()
 {
@@ -55,7 +98,8 @@ void xAdvancedEncoder::initBaseMarkers()
 }
 void xAdvancedEncoder::initQuant(int32 Quality, eQTLa QuantTabLayout)
 {
-  m_Quality = Quality;
+  m_Quality   = Quality;
+  m_LambdaAge = 0; //previous estimate not valid for new quantizer
 
   //init markers
   m_QT.resize(2);
@@ -100,16 +144,22 @@ void xAdvancedEncoder::initEntropy(int32 RestartInterval)
   m_HT[1].InitDefault(0, xJFIF::xHuffTable::eHuffClass::AC, eCmp::LM);
   m_HT[2].InitDefault(1, xJFIF::xHuffTable::eHuffClass::DC, eCmp::CB); //any chroma so use CB
   m_HT[3].InitDefault(1, xJFIF::xHuffTable::eHuffClass::AC, eCmp::CB); //any chroma so use CB
+  m_HTDefault = m_HT;
 
   //init toolbox
-  m_EntropyEnc.Init(m_HT);
-  m_EntropyEst.Init(m_HT);
+  m_EntropyEnc    .Init(m_HT);
+  m_EntropyEst    .Init(m_HT);
+  m_EntropyEstAuxD.Init(m_HT);
+  m_EntropyEstAuxI.Init(m_HT);
+  m_EntropyCnt    .Init(m_HT);
 
   m_NumMCUsInSlice = RestartInterval != 0 ? RestartInterval : m_NumMCUsInArea;
+  m_NumSlices      = (m_NumMCUsInArea + m_NumMCUsInSlice - 1) / m_NumMCUsInSlice;
   int32 NumBlocksInMCU = 0;
   for(int32 CmpIdx = 0; CmpIdx < m_NumOfComponents; CmpIdx++) { NumBlocksInMCU += m_SampFactorHor[CmpIdx] * m_SampFactorVer[CmpIdx]; }
-  int32 MaxEncodedSliceSize = m_NumMCUsInSlice * NumBlocksInMCU * c_BA * 2;
-  m_EntropyBuffer.resize(MaxEncodedSliceSize);
+  m_MaxEncodedSliceSize = m_NumMCUsInSlice * NumBlocksInMCU * c_BA * 2;
+
+  xInitThreading();
 }
 void xAdvancedEncoder::setMarkerEmit(bool EmitAPP0, bool EmitQuantTabs, bool EmitHuffmanTabs)
 {
@@ -124,34 +174,46 @@ void xAdvancedEncoder::setRDOQ(bool OptimizeLuma, bool OptimizeChroma, bool Proc
   m_OptimizeChroma    = OptimizeChroma;
   m_ProcessZeroCoeffs = ProcessZeroCoeffs;
   m_NumBlockOptPasses = NumBlockOptPasses;
-  if (m_UseRDOQ) { m_EntropyEst.Init(m_HT); }
+  if (m_UseRDOQ) { m_EntropyEst.Init(m_HT); m_EntropyEstAuxD.Init(m_HT); m_EntropyEstAuxI.Init(m_HT); }
+}
+void xAdvancedEncoder::setLambdaStrategy(eLmbS LambdaStrategy, int32 MaxReuse, flt64 MaxDrift)
+{
+  m_LambdaStrategy = LambdaStrategy;
+  m_LambdaMaxReuse = xMax(MaxReuse, 1);
+  m_LambdaMaxDrift = MaxDrift;
+  m_LambdaAge      = 0;
+}
+void xAdvancedEncoder::setNumThreads(int32 NumThreads)
+{
+  m_NumThreads = xMax(NumThreads, 1);
+  xInitThreading();
+}
+bool xAdvancedEncoder::setProgressive(bool Progressive, const std::string& ScanScript)
+{
+  m_ScanScript.clear();
+  bool Result = true;
+  if     (!Progressive       ) { }
+  else if(ScanScript.empty()) { InitDefaultScanScript(m_ScanScript, m_NumOfComponents); }
+  else                        { Result = ParseScanScript(m_ScanScript, ScanScript, m_NumOfComponents); }
+  m_Progressive = Progressive && Result;
+  return Result;
 }
 void xAdvancedEncoder::encode(const xPicYUV* InputPicture, xByteBuffer* OutputBuffer)
 {
   xJFIF::WriteSOI (OutputBuffer);
   if(m_EmitAPP0       ) { xJFIF::WriteAPP0(OutputBuffer, m_APP0); }
   if(m_EmitQuantTabs  ) { xJFIF::WriteDQT(OutputBuffer, m_QT); }
-  if(m_RestartInterval) { xJFIF::WriteDRI(OutputBuffer, m_RestartInterval); }
-  xJFIF::WriteSOF0(OutputBuffer, m_SOF0);
-  if(m_EmitHuffTabs   ) { xJFIF::WriteDHT(OutputBuffer, m_HT); }
-  xJFIF::WriteSOS (OutputBuffer, m_SOS);
-  xEncodePicture(OutputBuffer, InputPicture);
+  if(m_RestartInterval && !m_Progressive) { xJFIF::WriteDRI(OutputBuffer, m_RestartInterval); } //progressive scans are coded without restart intervals
+  if     (m_Progressive) { xJFIF::WriteSOF2(OutputBuffer, m_SOF0); }
+  else if(m_Arithmetic ) { xJFIF::WriteSOF9(OutputBuffer, m_SOF0); } //default conditioning - no DAC segment
+  else                   { xJFIF::WriteSOF0(OutputBuffer, m_SOF0); }
+  xEncodePicture(OutputBuffer, InputPicture); //writes DHT and SOS - Huffman tables can be derived from picture
   xJFIF::WriteEOI(OutputBuffer);
 }
 xAdvancedEncoder::tDistBits xAdvancedEncoder::calcDistBits(const xPicYUV* Picture)
 {
-  const int16* ConstCmpCoeffsTransOrg[] = { m_CmpCoeffsTransOrg[0], m_CmpCoeffsTransOrg[1], m_CmpCoeffsTransOrg[2], m_CmpCoeffsTransOrg[3] };
-  const int16* ConstCmpCoeffsTransRec[] = { m_CmpCoeffsTransRec[0], m_CmpCoeffsTransRec[1], m_CmpCoeffsTransRec[2], m_CmpCoeffsTransRec[3] };
-  const int16* ConstCmpCoeffsScan    [] = { m_CmpCoeffsScan    [0], m_CmpCoeffsScan    [1], m_CmpCoeffsScan    [2], m_CmpCoeffsScan    [3] };
-
   xFwdTransformPic(m_CmpCoeffsTransOrg, Picture);
-  xFwdQuantScanPic(m_CmpCoeffsScan    , ConstCmpCoeffsTransOrg, m_QuantMain);
-  xInvScanQuantPic(m_CmpCoeffsTransRec, ConstCmpCoeffsScan    , m_QuantMain);
-  xInvTransformPic(&m_PicRec          , ConstCmpCoeffsTransRec);
-  int64V4 EstNumBits = xHuffEstPic (ConstCmpCoeffsScan);
-  int64V4 Distortion = xCalcPicSSDs(Picture, &m_PicRec);
-
-  return std::make_tuple(Distortion, EstNumBits);
+  return xEvalOperatingPoint(m_CmpCoeffsScan, m_CmpCoeffsTransRec, &m_PicRec, &m_EntropyEst, Picture, m_QuantMain, true, m_CmpBlockInfo);
 }
 std::string xAdvancedEncoder::formatAndResetStats(const std::string Prefix)
 {
@@ -165,7 +227,6 @@ std::string xAdvancedEncoder::formatAndResetStats(const std::string Prefix)
   tDurationUS AvgLambdaTime    = std::chrono::duration_cast<tDurationUS>(m_TotalLambdaTime   ) / m_TotalPictureIters;
   tDurationUS AvgOptimizeTime  = std::chrono::duration_cast<tDurationUS>(m_TotalOptimizeTime ) / m_TotalPictureIters;
   tDurationUS AvgEntropyTime   = std::chrono::duration_cast<tDurationUS>(m_TotalEntropyTime  ) / m_TotalPictureIters;
-  tDurationUS AvgStuffingTime  = std::chrono::duration_cast<tDurationUS>(m_TotalStuffingTime ) / m_TotalPictureIters;
 
   Result += Prefix;
   Result += fmt::format("PicIters={} "          , m_TotalPictureIters);
@@ -175,7 +236,20 @@ std::string xAdvancedEncoder::formatAndResetStats(const std::string Prefix)
   Result += fmt::format("LmbdT={:.0f}us "       , AvgLambdaTime   .count());
   Result += fmt::format("RateDistOptT={:.0f}us ", AvgOptimizeTime .count());
   Result += fmt::format("EntrT={:.0f}us "       , AvgEntropyTime  .count());
-  Result += fmt::format("StffT={:.0f}us "       , AvgStuffingTime .count());
+  if(m_UseRDOQ) { Result += fmt::format("LmbdEst={}/{} ", m_TotalLambdaEstIters, m_TotalPictureIters); }
+
+  if(m_DistDomain == eDstD::Verify && m_VerifyNumTrials > 0)
+  {
+    flt64 AvgAbsDiff = (flt64)m_VerifySumAbsDiff / (flt64)m_VerifyNumTrials;
+    flt64 RelAbsDiff = (flt64)m_VerifySumAbsDiff / (flt64)xMax(m_VerifySumDistPix, (int64)1);
+    Result += fmt::format("\n{}DistVerify Trials={} AvgAbsDiff={:.2f} MaxAbsDiff={} RelAbsDiff={:.4f}% Blocks={} Reverts={}", Prefix, m_VerifyNumTrials, AvgAbsDiff, m_VerifyMaxAbsDiff, RelAbsDiff * 100.0, m_VerifyNumBlocks, m_VerifyNumReverts);
+    m_VerifyNumTrials  = 0;
+    m_VerifySumDistPix = 0;
+    m_VerifySumAbsDiff = 0;
+    m_VerifyMaxAbsDiff = 0;
+    m_VerifyNumBlocks  = 0;
+    m_VerifyNumReverts = 0;
+  }
   
   m_TotalPictureTime   = (tDuration)0;
   m_TotalTransformTime = (tDuration)0;
@@ -183,114 +257,176 @@ std::string xAdvancedEncoder::formatAndResetStats(const std::string Prefix)
   m_TotalLambdaTime    = (tDuration)0;
   m_TotalOptimizeTime  = (tDuration)0;
   m_TotalEntropyTime   = (tDuration)0;
-  m_TotalStuffingTime  = (tDuration)0;
 
-  m_TotalPictureIters = 0;
-  m_TotalSliceIters   = 0;
+  m_TotalPictureIters   = 0;
+  m_TotalSliceIters     = 0;
+  m_TotalLambdaEstIters = 0;
 
   return Result;
 }
 
+bool xAdvancedEncoder::ParseScanScript(std::vector<xJFIF::xSOS>& ScanScript, const std::string& ScanScriptS, int32 NumComponents)
+{
+  auto ParseInt = [](const std::string& S, int32& Value) { auto [Ptr, Err] = std::from_chars(S.data(), S.data() + S.size(), Value); return Err == std::errc() && Ptr == S.data() + S.size(); };
+
+  ScanScript.clear();
+  for(const std::string& ScanS : xString::split(ScanScriptS, ';'))
+  {
+    std::vector<std::string> Fields = xString::split(ScanS, ':');
+    if(Fields.size() != 4) { return false; }
+    std::vector<std::string> Spectral = xString::split(Fields[1], '-');
+    if(Spectral.size() != 2) { return false; }
+
+    int32 Ss, Se, Ah, Al;
+    if(!ParseInt(Spectral[0], Ss) || !ParseInt(Spectral[1], Se) || !ParseInt(Fields[2], Ah) || !ParseInt(Fields[3], Al)) { return false; }
+    if(Ah < 0 || Ah > 13 || Al < 0 || Al > 13) { return false; }
+
+    const std::string& CmpsS = Fields[0];
+    if(CmpsS.empty() || (int32)CmpsS.size() > NumComponents) { return false; }
+
+    xJFIF::xSOS Scan;
+    Scan.setNumComponents((int32)CmpsS.size());
+    for(int32 ScanCmpIdx = 0; ScanCmpIdx < (int32)CmpsS.size(); ScanCmpIdx++)
+    {
+      const int32 CmpIdx = CmpsS[ScanCmpIdx] - '0';
+      if(CmpIdx < 0 || CmpIdx >= NumComponents) { return false; }
+      const int32 HuffTabIdx = CmpIdx == 0 ? 0 : 1; //same as sequential mode - luma 0, chroma 1
+      Scan.setCmpId      (eCmp(CmpIdx), eCmp(ScanCmpIdx));
+      Scan.setHuffTableId(HuffTabIdx, HuffTabIdx, eCmp(ScanCmpIdx));
+    }
+    Scan.setSpectralSelection(Ss, Se);
+    Scan.setSuccessiveApprox (Ah, Al);
+    ScanScript.push_back(Scan);
+  }
+
+  return ValidateScanScript(ScanScript, NumComponents);
+}
+void xAdvancedEncoder::InitDefaultScanScript(std::vector<xJFIF::xSOS>& ScanScript, int32 NumComponents)
+{
+  //same as IJG libjpeg jpeg_simple_progression() - DC without lowest bit, low frequency luma, chroma, remaining luma, then refinement of lowest bits
+  const std::string ScanScriptS = NumComponents == 3 ?
+    "012:0-0:0:1;0:1-5:0:2;2:1-63:0:1;1:1-63:0:1;0:6-63:0:2;0:1-63:2:1;012:0-0:1:0;2:1-63:1:0;1:1-63:1:0;0:1-63:1:0" :
+    "0:0-0:0:1;0:1-5:0:2;0:6-63:0:2;0:1-63:2:1;0:0-0:1:0;0:1-63:1:0";
+  [[maybe_unused]] bool Result = ParseScanScript(ScanScript, ScanScriptS, NumComponents);
+  assert(Result);
+}
+bool xAdvancedEncoder::ValidateScanScript(const std::vector<xJFIF::xSOS>& ScanScript, int32 NumComponents)
+{
+  //lowest already sent bit of every coefficient (NOT_VALID = not sent yet)
+  int32 CoeffAl[c_NC][c_BA];
+  for(int32 CmpIdx = 0; CmpIdx < c_NC; CmpIdx++) { for(int32 k = 0; k < c_BA; k++) { CoeffAl[CmpIdx][k] = NOT_VALID; } }
+
+  for(const xJFIF::xSOS& Scan : ScanScript)
+  {
+    const int32 Ss = Scan.getSpectralSelectionStart();
+    const int32 Se = Scan.getSpectralSelectionEnd  ();
+    const int32 Ah = Scan.getSuccessiveApproxHigh  ();
+    const int32 Al = Scan.getSuccessiveApproxLow   ();
+
+    if(Ss < 0 || Se >= c_BA || Ss > Se || Al > 13) { return false; }
+    if(Ss == 0 && Se != 0                        ) { return false; } //DC and AC coefficients never share scan
+    if(Ss != 0 && Scan.getNumComponents() != 1   ) { return false; } //AC scans are non-interleaved
+    if(Ah != 0 && Ah != Al + 1                   ) { return false; } //refinement sends single bit
+
+    int32 PrevCmpIdx = NOT_VALID;
+    for(int32 ScanCmpIdx = 0; ScanCmpIdx < Scan.getNumComponents(); ScanCmpIdx++)
+    {
+      const int32 CmpIdx = (int32)Scan.getCmpId(eCmp(ScanCmpIdx));
+      if(CmpIdx <= PrevCmpIdx || CmpIdx >= NumComponents) { return false; } //frame order, no duplicates
+      PrevCmpIdx = CmpIdx;
+      if(Ss != 0 && CoeffAl[CmpIdx][0] == NOT_VALID) { return false; } //AC scans have to follow first DC scan
+
+      for(int32 k = Ss; k <= Se; k++)
+      {
+        if(CoeffAl[CmpIdx][k] != (Ah == 0 ? NOT_VALID : Ah)) { return false; }
+        CoeffAl[CmpIdx][k] = Al;
+      }
+    }
+  }
+
+  //decoded coefficients have to be equal to coded ones
+  for(int32 CmpIdx = 0; CmpIdx < NumComponents; CmpIdx++) { for(int32 k = 0; k < c_BA; k++) { if(CoeffAl[CmpIdx][k] != 0) { return false; } } }
+  return true;
+}
+
 //---------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
 
 void xAdvancedEncoder::xEncodePicture(xByteBuffer* Buffer, const xPicYUV* Picture)
 {
   const int16* ConstCmpCoeffsTransOrg[] = { m_CmpCoeffsTransOrg[0], m_CmpCoeffsTransOrg[1], m_CmpCoeffsTransOrg[2], m_CmpCoeffsTransOrg[3] };
-  const int16* ConstCmpCoeffsTransRec[] = { m_CmpCoeffsTransRec[0], m_CmpCoeffsTransRec[1], m_CmpCoeffsTransRec[2], m_CmpCoeffsTransRec[3] };
   const int16* ConstCmpCoeffsScan    [] = { m_CmpCoeffsScan    [0], m_CmpCoeffsScan    [1], m_CmpCoeffsScan    [2], m_CmpCoeffsScan    [3] };
-  const int16* ConstCmpCoeffsScanAux [] = { m_CmpCoeffsScanAux [0], m_CmpCoeffsScanAux [1], m_CmpCoeffsScanAux [2], m_CmpCoeffsScanAux [3] };
   const int16* ConstCmpCoeffsScanOpt [] = { m_CmpCoeffsScanOpt [0], m_CmpCoeffsScanOpt [1], m_CmpCoeffsScanOpt [2], m_CmpCoeffsScanOpt [3] };
+  const xBlockInfo* ConstCmpBlockInfo   [] = { m_CmpBlockInfo   [0], m_CmpBlockInfo   [1], m_CmpBlockInfo   [2], m_CmpBlockInfo   [3] };
+  const xBlockInfo* ConstCmpBlockInfoOpt[] = { m_CmpBlockInfoOpt[0], m_CmpBlockInfoOpt[1], m_CmpBlockInfoOpt[2], m_CmpBlockInfoOpt[3] };
 
   tTimePoint TP0 = m_GatherTimeStats ? tClock::now() : tTimePoint();
+  tTimePoint TP1 = TP0;
 
-  xFwdTransformPic(m_CmpCoeffsTransOrg, Picture);
+  if(m_UseRDOQ) //RDOQ and lambda estimation require unquantized transform coeffs
+  {
+    xFwdTransformPic(m_CmpCoeffsTransOrg, Picture);
+    TP1 = m_GatherTimeStats ? tClock::now() : tTimePoint();
+    xFwdQuantScanPic(m_CmpCoeffsScan, ConstCmpCoeffsTransOrg, m_QuantMain, m_CmpBlockInfo);
+  }
+  else
+  {
+    xFwdTransformQuantScanPic(m_CmpCoeffsScan, Picture, m_QuantMain, m_CmpBlockInfo);
+    TP1 = m_GatherTimeStats ? tClock::now() : tTimePoint(); //fused - entire time is reported as transform time
+  }
 
-  tTimePoint TP1 = m_GatherTimeStats ? tClock::now() : tTimePoint();
+  tTimePoint TP2 = m_GatherTimeStats ? tClock::now() : tTimePoint();
 
-  xFwdQuantScanPic(m_CmpCoeffsScan, ConstCmpCoeffsTransOrg, m_QuantMain);
+  const bool OptimizeHuffman = m_OptimizeHuffman && !(m_Arithmetic && !m_Progressive);
+  const bool Arithmetic      = m_Arithmetic && !m_Progressive;
 
-  tTimePoint TP2 = m_GatherTimeStats ? tClock::now() : tTimePoint();
+  if(OptimizeHuffman) { xSetHuffTables(m_HTDefault); } //every frame starts from default tables - frames stay independent
 
-  if(m_UseRDOQ)
-  {
-    //base point
-    xInvScanQuantPic(m_CmpCoeffsTransRec, ConstCmpCoeffsScan, m_QuantMain);
-    xInvTransformPic(&m_PicRec          , ConstCmpCoeffsTransRec);
-    int64V4 EstNumBitsMain = xHuffEstPic (ConstCmpCoeffsScan);
-    int64V4 DistortionMain = xCalcPicSSDs(Picture, &m_PicRec);
-
-    //lower point
-    int64V4 EstNumBitsAuxD = { 0,0,0,0 };
-    int64V4 DistortionAuxD = { 0,0,0,0 };
-    if(m_Quality > 1)
-    {
-      xFwdQuantScanPic(m_CmpCoeffsScanAux , ConstCmpCoeffsTransOrg, m_QuantAuxD);
-      xInvScanQuantPic(m_CmpCoeffsTransRec, ConstCmpCoeffsScanAux , m_QuantAuxD);
-      xInvTransformPic(&m_PicRec          , ConstCmpCoeffsTransRec);
-      EstNumBitsAuxD = xHuffEstPic (ConstCmpCoeffsScanAux);
-      DistortionAuxD = xCalcPicSSDs(Picture, &m_PicRec);
-    }
-    
-    //higher point
-    int64V4 EstNumBitsAuxI = { 0,0,0,0 };
-    int64V4 DistortionAuxI = { 0,0,0,0 };
-    if(m_Quality < 100)
-    {
-      xFwdQuantScanPic(m_CmpCoeffsScanAux, ConstCmpCoeffsTransOrg, m_QuantAuxI);
-      xInvScanQuantPic(m_CmpCoeffsTransRec, ConstCmpCoeffsScanAux, m_QuantAuxI);
-      xInvTransformPic(&m_PicRec, ConstCmpCoeffsTransRec);
-      EstNumBitsAuxI = xHuffEstPic(ConstCmpCoeffsScanAux);
-      DistortionAuxI = xCalcPicSSDs(Picture, &m_PicRec);
-    }
-
-    //local lambda
-    int64V4 DeltaEstNumBitsD = EstNumBitsMain - EstNumBitsAuxD;
-    int64V4 DeltaDistortionD = DistortionMain - DistortionAuxD;
-    int64V4 DeltaEstNumBitsI = EstNumBitsMain - EstNumBitsAuxI;
-    int64V4 DeltaDistortionI = DistortionMain - DistortionAuxI;
-
-    flt64V4 LambdaD = -(flt64V4)DeltaDistortionD / (flt64V4)DeltaEstNumBitsD;
-    flt64V4 LambdaI = -(flt64V4)DeltaDistortionI / (flt64V4)DeltaEstNumBitsI;
-    if     (m_Quality > 1 && m_Quality < 100) { m_Lambda = (LambdaD + LambdaI) / 2.0; }
-    else if(m_Quality > 1                   ) { m_Lambda = LambdaD; }
-    else if(m_Quality < 100                 ) { m_Lambda = LambdaI; }
-
-    if(m_VerboseLevel >= 5)
-    {
-      std::string Dump = "LambdaEstimation\n";
-      Dump += fmt::format("QuantMain EstNumBits={:d} {:d} {:d}    Distortion={:d} {:d} {:d}\n", EstNumBitsMain[0], EstNumBitsMain[1], EstNumBitsMain[2], DistortionMain[0], DistortionMain[1], DistortionMain[2]);
-      Dump += fmt::format("QuantAuxD EstNumBits={:d} {:d} {:d}    Distortion={:d} {:d} {:d}\n", EstNumBitsAuxD[0], EstNumBitsAuxD[1], EstNumBitsAuxD[2], DistortionAuxD[0], DistortionAuxD[1], DistortionAuxD[2]);
-      Dump += fmt::format("QuantAuxI EstNumBits={:d} {:d} {:d}    Distortion={:d} {:d} {:d}\n", EstNumBitsAuxI[0], EstNumBitsAuxI[1], EstNumBitsAuxI[2], DistortionAuxI[0], DistortionAuxI[1], DistortionAuxI[2]);
-      Dump += fmt::format("LambdaD = {} {} {}\n", LambdaD[0], LambdaD[1], LambdaD[2]);
-      Dump += fmt::format("LambdaI = {} {} {}\n", LambdaI[0], LambdaI[1], LambdaI[2]);
-      Dump += fmt::format("Lambda  = {} {} {}\n", m_Lambda[0], m_Lambda[1], m_Lambda[2]);
-      fmt::print(Dump);
-    }
-  }
+  if(Arithmetic && m_UseRDOQ) { xTrainArithModel(ConstCmpCoeffsScan, ConstCmpBlockInfo); } //RDOQ and lambda estimation work with arithmetic coding rate
+
+  if(m_UseRDOQ) { xUpdateLambda(Picture); }
 
   tTimePoint TP3 = m_GatherTimeStats ? tClock::now() : tTimePoint();
 
   if(m_UseRDOQ)
   {
-    xOptimizePic(m_CmpCoeffsScanOpt, ConstCmpCoeffsScan, Picture);
+    xOptimizePic(m_CmpCoeffsScanOpt, m_CmpBlockInfoOpt, ConstCmpCoeffsScan, ConstCmpBlockInfo, Picture);
 
     if(!m_OptimizeLuma)
     {
       const int32 AreaLm = m_MCUsMulWidth[(int32)eCmp::LM] * m_MCUsMulHeight[(int32)eCmp::LM];
       memcpy(m_CmpCoeffsScanOpt[(int32)eCmp::LM], m_CmpCoeffsScan[(int32)eCmp::LM], AreaLm * sizeof(int16));
+      memcpy(m_CmpBlockInfoOpt [(int32)eCmp::LM], m_CmpBlockInfo [(int32)eCmp::LM], m_NumBlocks[(int32)eCmp::LM] * sizeof(xBlockInfo));
     }
     if(!m_OptimizeChroma)
     {
       const int32 AreaCb = m_MCUsMulWidth[(int32)eCmp::CB] * m_MCUsMulHeight[(int32)eCmp::CB];
       memcpy(m_CmpCoeffsScanOpt[(int32)eCmp::CB], m_CmpCoeffsScan[(int32)eCmp::CB], AreaCb * sizeof(int16));
+      memcpy(m_CmpBlockInfoOpt [(int32)eCmp::CB], m_CmpBlockInfo [(int32)eCmp::CB], m_NumBlocks[(int32)eCmp::CB] * sizeof(xBlockInfo));
       const int32 AreaCr = m_MCUsMulWidth[(int32)eCmp::CR] * m_MCUsMulHeight[(int32)eCmp::CR];
       memcpy(m_CmpCoeffsScanOpt[(int32)eCmp::CR], m_CmpCoeffsScan[(int32)eCmp::CR], AreaCr * sizeof(int16));
+      memcpy(m_CmpBlockInfoOpt [(int32)eCmp::CR], m_CmpBlockInfo [(int32)eCmp::CR], m_NumBlocks[(int32)eCmp::CR] * sizeof(xBlockInfo));
     }
   }
+
+  if(OptimizeHuffman) { xOptimizeHuffTabs(m_UseRDOQ ? ConstCmpCoeffsScanOpt : ConstCmpCoeffsScan, m_UseRDOQ ? ConstCmpBlockInfoOpt : ConstCmpBlockInfo, Picture); }
   
   tTimePoint TP4 = m_GatherTimeStats ? tClock::now() : tTimePoint();
 
-  xHuffEncPic(Buffer, m_UseRDOQ ? ConstCmpCoeffsScanOpt : ConstCmpCoeffsScan);
+  if(m_Progressive) //all scans are coded from final (optimized) coefficients
+  {
+    xPrgEncPic(Buffer, m_UseRDOQ ? ConstCmpCoeffsScanOpt : ConstCmpCoeffsScan);
+  }
+  else if(Arithmetic)
+  {
+    xJFIF::WriteSOS(Buffer, m_SOS); //table selectors point to (default) conditioning tables
+    xAriEncPic(Buffer, m_UseRDOQ ? ConstCmpCoeffsScanOpt : ConstCmpCoeffsScan, m_UseRDOQ ? ConstCmpBlockInfoOpt : ConstCmpBlockInfo);
+  }
+  else
+  {
+    if(m_EmitHuffTabs) { xJFIF::WriteDHT(Buffer, m_HT); }
+    xJFIF::WriteSOS(Buffer, m_SOS);
+    xHuffEncPic(Buffer, m_UseRDOQ ? ConstCmpCoeffsScanOpt : ConstCmpCoeffsScan, m_UseRDOQ ? ConstCmpBlockInfoOpt : ConstCmpBlockInfo);
+  }
 
   tTimePoint TP5 = m_GatherTimeStats ? tClock::now() : tTimePoint();
   
@@ -302,6 +438,272 @@ void xAdvancedEncoder::xEncodePicture(xByteBuffer* Buffer, const xPicYUV* Pictur
   m_TotalOptimizeTime  += TP4 - TP3;
 }
 
+void xAdvancedEncoder::xUpdateLambda(const xPicYUV* Picture)
+{
+  if(m_LambdaStrategy == eLmbS::Model) { m_Lambda = xCalcLambdaModel(m_Quality) / (flt64)m_EntropyEst.getRateScale(); return; } //model is fitted to distortion per bit
+
+  if(m_LambdaStrategy == eLmbS::Reuse && m_LambdaHistory != nullptr)
+  {
+    //reuse decision depends on previous frame - state is taken from and handed back to frame ordered history
+    const xLambdaHistory::xState Prev = m_LambdaHistory->acquire(m_LambdaFrameIdx);
+    m_Lambda = Prev.Lambda; m_LambdaAge = Prev.Age; m_LambdaRefBits = Prev.RefBits; m_LambdaRefDist = Prev.RefDist;
+    xEstimateLambda(Picture);
+    m_LambdaHistory->publish(m_LambdaFrameIdx, { m_Lambda, m_LambdaAge, m_LambdaRefBits, m_LambdaRefDist });
+    return;
+  }
+
+  xEstimateLambda(Picture);
+}
+void xAdvancedEncoder::xEstimateLambda(const xPicYUV* Picture)
+{
+  //base, lower and higher point - independent chains (own scan/rec buffers and estimator), sharing only read-only transform coeffs
+  tDistBits DistBitsMain = std::make_tuple(xMakeVec4<int64>(0), xMakeVec4<int64>(0));
+  tDistBits DistBitsAuxD = std::make_tuple(xMakeVec4<int64>(0), xMakeVec4<int64>(0));
+  tDistBits DistBitsAuxI = std::make_tuple(xMakeVec4<int64>(0), xMakeVec4<int64>(0));
+  //sparse - rate and distortion gathered only on subset of MCUs, without full picture reconstruction
+  const bool Sparse = m_LambdaSubsampling > 1;
+  auto EvalMain = [&]() { DistBitsMain = Sparse ? xEvalOperatingPointSparse(m_CmpCoeffsScan    , &m_EntropyEst    , Picture, m_QuantMain, false) : xEvalOperatingPoint(m_CmpCoeffsScan    , m_CmpCoeffsTransRec    , &m_PicRec    , &m_EntropyEst    , Picture, m_QuantMain, false, m_CmpBlockInfo); };
+  auto EvalAuxD = [&]() { DistBitsAuxD = Sparse ? xEvalOperatingPointSparse(m_CmpCoeffsScanAuxD, &m_EntropyEstAuxD, Picture, m_QuantAuxD, true ) : xEvalOperatingPoint(m_CmpCoeffsScanAuxD, m_CmpCoeffsTransRecAuxD, &m_PicRecAuxD, &m_EntropyEstAuxD, Picture, m_QuantAuxD, true ); };
+  auto EvalAuxI = [&]() { DistBitsAuxI = Sparse ? xEvalOperatingPointSparse(m_CmpCoeffsScanAuxI, &m_EntropyEstAuxI, Picture, m_QuantAuxI, true ) : xEvalOperatingPoint(m_CmpCoeffsScanAuxI, m_CmpCoeffsTransRecAuxI, &m_PicRecAuxI, &m_EntropyEstAuxI, Picture, m_QuantAuxI, true ); };
+
+  if(m_LambdaStrategy == eLmbS::Reuse && m_LambdaAge > 0 && m_LambdaAge < m_LambdaMaxReuse)
+  {
+    //main point only - keep previous lambda as long as rate and distortion do not drift
+    EvalMain();
+    const int64 Bits = std::get<1>(DistBitsMain).getSum();
+    const int64 Dist = std::get<0>(DistBitsMain).getSum();
+    const bool  DriftBits = (flt64)xAbs(Bits - m_LambdaRefBits) > m_LambdaMaxDrift * (flt64)m_LambdaRefBits;
+    const bool  DriftDist = (flt64)xAbs(Dist - m_LambdaRefDist) > m_LambdaMaxDrift * (flt64)m_LambdaRefDist;
+    if(!DriftBits && !DriftDist) { m_LambdaAge++; return; }
+
+    if(m_ThreadPool.isCreated())
+    {
+      if(m_Quality > 1  ) { m_ThreadPool.addWaitingTask([&](int32 /*ThreadIdx*/) { EvalAuxD(); }); }
+      if(m_Quality < 100) { m_ThreadPool.addWaitingTask([&](int32 /*ThreadIdx*/) { EvalAuxI(); }); }
+      m_ThreadPool.waitUntilTasksFinished();
+    }
+    else
+    {
+      if(m_Quality > 1  ) { EvalAuxD(); }
+      if(m_Quality < 100) { EvalAuxI(); }
+    }
+  }
+  else if(m_ThreadPool.isCreated())
+  {
+                          m_ThreadPool.addWaitingTask([&](int32 /*ThreadIdx*/) { EvalMain(); });
+    if(m_Quality > 1  ) { m_ThreadPool.addWaitingTask([&](int32 /*ThreadIdx*/) { EvalAuxD(); }); }
+    if(m_Quality < 100) { m_ThreadPool.addWaitingTask([&](int32 /*ThreadIdx*/) { EvalAuxI(); }); }
+    m_ThreadPool.waitUntilTasksFinished();
+  }
+  else
+  {
+                          EvalMain();
+    if(m_Quality > 1  ) { EvalAuxD(); }
+    if(m_Quality < 100) { EvalAuxI(); }
+  }
+
+  auto [DistortionMain, EstNumBitsMain] = DistBitsMain;
+  auto [DistortionAuxD, EstNumBitsAuxD] = DistBitsAuxD;
+  auto [DistortionAuxI, EstNumBitsAuxI] = DistBitsAuxI;
+
+  //local lambda
+  auto CalcSlope  = [](const tDistBits& Main, const tDistBits& Aux) -> flt64V4 { return -(flt64V4)(std::get<0>(Main) - std::get<0>(Aux)) / (flt64V4)(std::get<1>(Main) - std::get<1>(Aux)); };
+  auto CalcLambda = [&](const flt64V4& LambdaD, const flt64V4& LambdaI) -> flt64V4
+  {
+    if     (m_Quality > 1 && m_Quality < 100) { return (LambdaD + LambdaI) / 2.0; }
+    else if(m_Quality > 1                   ) { return LambdaD; }
+    else                                      { return LambdaI; }
+  };
+
+  flt64V4 LambdaD = CalcSlope(DistBitsMain, DistBitsAuxD);
+  flt64V4 LambdaI = CalcSlope(DistBitsMain, DistBitsAuxI);
+  m_Lambda = CalcLambda(LambdaD, LambdaI);
+
+  if(m_VerboseLevel >= 5)
+  {
+    std::string Dump = "LambdaEstimation\n";
+    Dump += fmt::format("QuantMain EstNumBits={:d} {:d} {:d}    Distortion={:d} {:d} {:d}\n", EstNumBitsMain[0], EstNumBitsMain[1], EstNumBitsMain[2], DistortionMain[0], DistortionMain[1], DistortionMain[2]);
+    Dump += fmt::format("QuantAuxD EstNumBits={:d} {:d} {:d}    Distortion={:d} {:d} {:d}\n", EstNumBitsAuxD[0], EstNumBitsAuxD[1], EstNumBitsAuxD[2], DistortionAuxD[0], DistortionAuxD[1], DistortionAuxD[2]);
+    Dump += fmt::format("QuantAuxI EstNumBits={:d} {:d} {:d}    Distortion={:d} {:d} {:d}\n", EstNumBitsAuxI[0], EstNumBitsAuxI[1], EstNumBitsAuxI[2], DistortionAuxI[0], DistortionAuxI[1], DistortionAuxI[2]);
+    Dump += fmt::format("LambdaD = {} {} {}\n", LambdaD[0], LambdaD[1], LambdaD[2]);
+    Dump += fmt::format("LambdaI = {} {} {}\n", LambdaI[0], LambdaI[1], LambdaI[2]);
+    Dump += fmt::format("Lambda  = {} {} {}\n", m_Lambda[0], m_Lambda[1], m_Lambda[2]);
+    if(Sparse) //full picture reference for sparse estimation accuracy
+    {
+      tDistBits FullMain = xEvalOperatingPoint(m_CmpCoeffsScan    , m_CmpCoeffsTransRec    , &m_PicRec    , &m_EntropyEst    , Picture, m_QuantMain, false);
+      tDistBits FullAuxD = m_Quality > 1   ? xEvalOperatingPoint(m_CmpCoeffsScanAuxD, m_CmpCoeffsTransRecAuxD, &m_PicRecAuxD, &m_EntropyEstAuxD, Picture, m_QuantAuxD, true) : FullMain;
+      tDistBits FullAuxI = m_Quality < 100 ? xEvalOperatingPoint(m_CmpCoeffsScanAuxI, m_CmpCoeffsTransRecAuxI, &m_PicRecAuxI, &m_EntropyEstAuxI, Picture, m_QuantAuxI, true) : FullMain;
+      flt64V4   LambdaFull = CalcLambda(CalcSlope(FullMain, FullAuxD), CalcSlope(FullMain, FullAuxI));
+      Dump += fmt::format("LambdaFull = {} {} {}    (Subsampling={} Sparse/Full = {:.4f} {:.4f} {:.4f})\n", LambdaFull[0], LambdaFull[1], LambdaFull[2], m_LambdaSubsampling, m_Lambda[0] / LambdaFull[0], m_Lambda[1] / LambdaFull[1], m_Lambda[2] / LambdaFull[2]);
+    }
+    fmt::print(Dump);
+  }
+
+  m_LambdaAge     = 1;
+  m_LambdaRefBits = EstNumBitsMain.getSum();
+  m_LambdaRefDist = DistortionMain.getSum();
+  m_TotalLambdaEstIters++;
+}
+flt64V4 xAdvancedEncoder::xCalcLambdaModel(int32 Quality)
+{
+  //fitted to LambdaD/LambdaI estimates (default tables, Q=5..98): quadratic in quantizer scaling at high quality,
+  //saturating at medium quality, steep growth at low quality where most of AC coefficients is quantized to zero
+  //Lambda = A*S^2 / (1 + A*S^2/Sat) + Low*(S/1000)^3.25, S = IJG scaling factor in percent
+  const flt64 S = Quality <= 0 ? 5000.0 : Quality < 50 ? 5000.0 / (flt64)Quality : (flt64)(200 - 2 * xMin(Quality, 100));
+  auto Model = [S](flt64 A, flt64 Sat, flt64 Low) { const flt64 AS2 = A * S * S; return AS2 / (1.0 + AS2 / Sat) + Low * std::pow(S / 1000.0, 3.25); };
+  const flt64 LambdaLm = Model(0.074, 47.0, 2737.0);
+  const flt64 LambdaCh = Model(0.118, 49.0, 7597.0);
+  return { LambdaLm, LambdaCh, LambdaCh, 0.0 };
+}
+
+void xAdvancedEncoder::xSetHuffTables(const std::vector<xJFIF::xHuffTable>& HuffTables)
+{
+  m_HT = HuffTables;
+  m_EntropyEnc    .Init(m_HT);
+  m_EntropyEst    .Init(m_HT);
+  m_EntropyEstAuxD.Init(m_HT);
+  m_EntropyEstAuxI.Init(m_HT);
+  for(xEntropyEncoder*   EntropyEnc : m_GroupEntropyEnc ) { EntropyEnc->Init(m_HT); }
+  for(xEntropyEstimator* EntropyEst : m_ThreadEntropyEst) { EntropyEst->Init(m_HT); }
+}
+void xAdvancedEncoder::xOptimizeHuffTabs(const int16* CoeffsScanV[], const xBlockInfo* BlockInfoV[], const xPicYUV* Picture)
+{
+  std::vector<xJFIF::xHuffTable> HuffTables = m_HT;
+
+  if(m_HuffmanReRDOQ && m_UseRDOQ)
+  {
+    //second RDOQ iteration with rate estimated using picture statistics - every symbol must stay codable, so unused ones get a (long) code
+    xCountSymbolsPic(CoeffsScanV, BlockInfoV);
+    m_EntropyCnt.BuildOptimalTables(HuffTables, true);
+    xSetHuffTables(HuffTables);
+    for(int32 CmpIdx = 0; CmpIdx < m_NumOfComponents; CmpIdx++) //cached rate was estimated with previous tables
+    {
+      for(int32 BlockIdx = 0; BlockIdx < m_NumBlocks[CmpIdx]; BlockIdx++) { m_CmpBlockInfo[CmpIdx][BlockIdx].setNumBits(NOT_VALID); }
+    }
+    const int16*      ConstCmpCoeffsScan[] = { m_CmpCoeffsScan[0], m_CmpCoeffsScan[1], m_CmpCoeffsScan[2], m_CmpCoeffsScan[3] };
+    const xBlockInfo* ConstCmpBlockInfo [] = { m_CmpBlockInfo [0], m_CmpBlockInfo [1], m_CmpBlockInfo [2], m_CmpBlockInfo [3] };
+    xOptimizePic(m_CmpCoeffsScanOpt, m_CmpBlockInfoOpt, ConstCmpCoeffsScan, ConstCmpBlockInfo, Picture);
+  }
+
+  //final tables have to match final coeffs
+  xCountSymbolsPic(CoeffsScanV, BlockInfoV);
+  m_EntropyCnt.BuildOptimalTables(HuffTables);
+  xSetHuffTables(HuffTables);
+}
+void xAdvancedEncoder::xTrainArithModel(const int16* CoeffsScanV[], const xBlockInfo* BlockInfoV[])
+{
+  //cost of every binary decision from its frequency in picture coded with main quantizer
+  m_EntropyEncAri.ResetCounters();
+  xAriEncPic(nullptr, CoeffsScanV, BlockInfoV);
+  const xArithCounterDC* ArithCountersDC = m_EntropyEncAri.getArithCountersDC();
+  const xArithCounterAC* ArithCountersAC = m_EntropyEncAri.getArithCountersAC();
+  m_EntropyEst    .InitArith(ArithCountersDC, ArithCountersAC);
+  m_EntropyEstAuxD.InitArith(ArithCountersDC, ArithCountersAC);
+  m_EntropyEstAuxI.InitArith(ArithCountersDC, ArithCountersAC);
+  for(xEntropyEstimator* EntropyEst : m_ThreadEntropyEst) { EntropyEst->InitArith(ArithCountersDC, ArithCountersAC); }
+}
+void xAdvancedEncoder::xCountSymbolsPic(const int16* CoeffsScanV[], const xBlockInfo* BlockInfoV[])
+{
+  m_EntropyCnt.Init(m_HT); //resets counters
+
+  int32 LastDC[c_NC] = { 0 };
+  for(int32 MCU_Idx = 0; MCU_Idx < m_NumMCUsInArea; MCU_Idx++)
+  {
+    if(MCU_Idx % m_NumMCUsInSlice == 0) { memset(LastDC, 0, sizeof(LastDC)); } //DC prediction reset at every RST
+
+    for(int32 CmpIdx = 0; CmpIdx < m_NumOfComponents; CmpIdx++)
+    {
+      const int32 HuffTabIdDC    = m_SOS.getHuffTableIdDC(eCmp(CmpIdx));
+      const int32 HuffTabIdAC    = m_SOS.getHuffTableIdAC(eCmp(CmpIdx));
+      const int32 NumBlocksInMCU = m_SampFactorVer[CmpIdx] * m_SampFactorHor[CmpIdx];
+      const int32 BlockIdxFirst  = MCU_Idx * NumBlocksInMCU;
+      for(int32 BlockIdx = BlockIdxFirst; BlockIdx < BlockIdxFirst + NumBlocksInMCU; BlockIdx++)
+      {
+        const int16* CoeffsScan = CoeffsScanV[CmpIdx] + (BlockIdx << xJPEG_Constants::c_Log2BlockArea);
+        m_EntropyCnt.CountBlock(CoeffsScan, BlockInfoV[CmpIdx][BlockIdx], LastDC[CmpIdx], HuffTabIdDC, HuffTabIdAC);
+        LastDC[CmpIdx] = CoeffsScan[0];
+      }
+    }
+  }
+}
+
+xAdvancedEncoder::tDistBits xAdvancedEncoder::xEvalOperatingPoint(int16* CoeffsScanV[], int16* CoeffsTransRecV[], xPicYUV* PicRec, xEntropyEstimator* EntropyEst, const xPicYUV* Picture, const xQuantizerSet& Quant, bool Quantize, xBlockInfo* BlockInfoV[])
+{
+  const int16* ConstCoeffsTransOrg[] = { m_CmpCoeffsTransOrg[0], m_CmpCoeffsTransOrg[1], m_CmpCoeffsTransOrg[2], m_CmpCoeffsTransOrg[3] };
+  const int16* ConstCoeffsTransRec[] = { CoeffsTransRecV    [0], CoeffsTransRecV    [1], CoeffsTransRecV    [2], CoeffsTransRecV    [3] };
+  const int16* ConstCoeffsScan    [] = { CoeffsScanV        [0], CoeffsScanV        [1], CoeffsScanV        [2], CoeffsScanV        [3] };
+
+  if(Quantize) { xFwdQuantScanPic(CoeffsScanV, ConstCoeffsTransOrg, Quant, BlockInfoV); }
+  xInvScanQuantPic(CoeffsTransRecV, ConstCoeffsScan, Quant);
+  xInvTransformPic(PicRec         , ConstCoeffsTransRec, ConstCoeffsScan);
+  int64V4 EstNumBits = xHuffEstPic (EntropyEst, ConstCoeffsScan, BlockInfoV);
+  int64V4 Distortion = xCalcPicSSDs(Picture, PicRec);
+
+  return std::make_tuple(Distortion, EstNumBits);
+}
+xAdvancedEncoder::tDistBits xAdvancedEncoder::xEvalOperatingPointSparse(int16* CoeffsScanV[], xEntropyEstimator* EntropyEst, const xPicYUV* Picture, const xQuantizerSet& Quant, bool Quantize)
+{
+  const int16* ConstCoeffsTransOrg[] = { m_CmpCoeffsTransOrg[0], m_CmpCoeffsTransOrg[1], m_CmpCoeffsTransOrg[2], m_CmpCoeffsTransOrg[3] };
+  const uint16* CmpPtrs   [] = { Picture->getAddr  (eCmp::LM), Picture->getAddr  (eCmp::CB), Picture->getAddr  (eCmp::CR), nullptr };
+  const int32   CmpStrides[] = { Picture->getStride(eCmp::LM), Picture->getStride(eCmp::CB), Picture->getStride(eCmp::CR),       0 };
+
+  //quantization is cheap - entire picture is quantized, so DC predictors of selected blocks are exact
+  if(Quantize) { xFwdQuantScanPic(CoeffsScanV, ConstCoeffsTransOrg, Quant); }
+
+  int64V4 EstNumBits = xMakeVec4<int64>(0);
+  int64V4 Distortion = xMakeVec4<int64>(0);
+  uint16  SamplesOrg[c_BA];
+
+  //MCUs on diagonal lattice - checkerboard for Subsampling=2
+  for(int32 MCU_PosV = 0; MCU_PosV < m_NumMCUsInHeight; MCU_PosV++)
+  {
+    for(int32 MCU_PosH = MCU_PosV % m_LambdaSubsampling; MCU_PosH < m_NumMCUsInWidth; MCU_PosH += m_LambdaSubsampling)
+    {
+      const int32 MCU_Idx    = MCU_PosV * m_NumMCUsInWidth + MCU_PosH;
+      const bool  SliceStart = (MCU_Idx % m_NumMCUsInSlice) == 0;
+
+      for(int32 CmpIdx = 0; CmpIdx < m_NumOfComponents; CmpIdx++)
+      {
+        const int32 QuantTabId  = m_SOF0.getQuantTableId(eCmp(CmpIdx));
+        const int32 HuffTabIdDC = m_SOS.getHuffTableIdDC(eCmp(CmpIdx));
+        const int32 HuffTabIdAC = m_SOS.getHuffTableIdAC(eCmp(CmpIdx));
+        const int32 MCU_PelPosV = MCU_PosV << (2 + m_SampFactorVer[CmpIdx]);
+        const int32 MCU_PelPosH = MCU_PosH << (2 + m_SampFactorHor[CmpIdx]);
+
+        int32 BlockIdx = MCU_Idx * m_SampFactorVer[CmpIdx] * m_SampFactorHor[CmpIdx];
+        for(int32 V = 0; V < m_SampFactorVer[CmpIdx]; V++)
+        {
+          const int32 BlockPosV = MCU_PelPosV + V * c_BS;
+          const int32 BlockResV = m_CmpHeight[CmpIdx] - BlockPosV;
+          for(int32 H = 0; H < m_SampFactorHor[CmpIdx]; H++)
+          {
+            const int32   BlockPosH   = MCU_PelPosH + H * c_BS;
+            const int32   BlockResH   = m_CmpWidth[CmpIdx] - BlockPosH;
+            const uint16* BlockPtr    = CmpPtrs[CmpIdx] + BlockPosV * CmpStrides[CmpIdx] + BlockPosH;
+            const int16*  CoeffsScan  = CoeffsScanV[CmpIdx] + (BlockIdx << xJPEG_Constants::c_Log2BlockArea);
+            const int32   LastDC      = (SliceStart && V == 0 && H == 0) ? 0 : CoeffsScan[-c_BA];
+
+            //rate of every coded block, distortion of picture samples only (as in full picture evaluation)
+            EstNumBits[CmpIdx] += EntropyEst->EstimateBlockStateless(CoeffsScan, LastDC, HuffTabIdDC, HuffTabIdAC);
+            if(BlockResV >= 8 && BlockResH >= 8) //C++20 TODO use [[likely]]
+            {
+              loadEntireBlock(SamplesOrg, BlockPtr, CmpStrides[CmpIdx]);
+              Distortion[CmpIdx] += xCalcDistBLK(CoeffsScan, SamplesOrg, QuantTabId, xEntropyCommon::findLastNonZero(CoeffsScan), Quant);
+            }
+            else if(BlockResV > 0 && BlockResH > 0)
+            {
+              loadExtendBlock(SamplesOrg, BlockPtr, CmpStrides[CmpIdx], xMin(BlockResH, c_BS), xMin(BlockResV, c_BS));
+              Distortion[CmpIdx] += xCalcDistPartBLK(CoeffsScan, SamplesOrg, QuantTabId, xMin(BlockResH, c_BS), xMin(BlockResV, c_BS), Quant);
+            }
+            BlockIdx++;
+          }
+        }
+      }
+    }
+  }
+
+  return std::make_tuple(Distortion, EstNumBits);
+}
 int64V4 xAdvancedEncoder::xCalcPicSSDs(const xPicYUV* Tst, const xPicYUV* Ref)
 {
   int64V4 SSDs = xMakeVec4<int64>(0);
@@ -313,124 +715,249 @@ int64V4 xAdvancedEncoder::xCalcPicSSDs(const xPicYUV* Tst, const xPicYUV* Ref)
   return SSDs;
 }
 
+void xAdvancedEncoder::xInitThreading()
+{
+  xCeaseThreading();
+  if(m_NumThreads <= 1 || m_HT.empty()) { return; }
+
+  m_ThreadPool.create(m_NumThreads);
+
+  //slices are independent (DC prediction reset at every RST) - split them into contiguous groups, one per thread
+  if(m_RestartInterval != 0 && m_NumSlices > 1)
+  {
+    m_NumSliceGroups = xMin(m_NumThreads, m_NumSlices);
+    const int32 MaxSlicesInGroup    = (m_NumSlices + m_NumSliceGroups - 1) / m_NumSliceGroups;
+    const int32 MaxStuffedGroupSize = MaxSlicesInGroup * (2 * m_MaxEncodedSliceSize + 2); //worst case stuffing + RST marker
+    for(int32 GroupIdx = 0; GroupIdx < m_NumSliceGroups; GroupIdx++)
+    {
+      xEntropyEncoder* EntropyEnc = new xEntropyEncoder;
+      EntropyEnc->Init(m_HT);
+      m_GroupEntropyEnc   .push_back(EntropyEnc);
+      m_GroupOutputBuffer .push_back(new xByteBuffer(MaxStuffedGroupSize));
+    }
+  }
+
+  //RDOQ bands - estimator is stateless except DC predictor, so each thread needs its own
+  for(int32 ThreadIdx = 0; ThreadIdx < m_NumThreads; ThreadIdx++)
+  {
+    xEntropyEstimator* EntropyEst = new xEntropyEstimator;
+    EntropyEst->Init(m_HT);
+    m_ThreadEntropyEst.push_back(EntropyEst);
+  }
+}
+void xAdvancedEncoder::xCeaseThreading()
+{
+  if(m_ThreadPool.isCreated()) { m_ThreadPool.destroy(); }
+
+  for(xEntropyEncoder* EntropyEnc    : m_GroupEntropyEnc   ) { delete EntropyEnc   ; }
+  for(xByteBuffer*     OutputBuffer  : m_GroupOutputBuffer ) { delete OutputBuffer ; }
+  for(xEntropyEstimator* EntropyEst  : m_ThreadEntropyEst  ) { delete EntropyEst   ; }
+  m_GroupEntropyEnc   .clear();
+  m_GroupOutputBuffer .clear();
+  m_ThreadEntropyEst  .clear();
+  m_NumSliceGroups = 0;
+}
+
 void xAdvancedEncoder::xFwdTransformPic(int16* CoeffsTransV[], const xPicYUV* Picture)
 {
   const uint16* CmpPtrV   [] = {Picture->getAddr  (eCmp::LM), Picture->getAddr  (eCmp::CB), Picture->getAddr  (eCmp::CR), nullptr};
   const int32   CmpStrideV[] = {Picture->getStride(eCmp::LM), Picture->getStride(eCmp::CB), Picture->getStride(eCmp::CR),       0};
 
-  //loop over MCUs
-  for (int32 MCU_Idx = 0; MCU_Idx < m_NumMCUsInArea; MCU_Idx++)
+  //loop over runs of MCUs
+  for (int32 MCU_Idx = 0; MCU_Idx < m_NumMCUsInArea; MCU_Idx += c_MCUsInBatch)
   {
-    xFwdTransformMCU(CoeffsTransV, CmpPtrV, CmpStrideV, MCU_Idx);
+    xFwdTransformMCU(CoeffsTransV, CmpPtrV, CmpStrideV, MCU_Idx, xMin(c_MCUsInBatch, m_NumMCUsInArea - MCU_Idx));
   }
 }
-void xAdvancedEncoder::xFwdTransformMCU(int16* CoeffsTransV[], const uint16* CmpPtrV[], const int32 CmpStrideV[], int32 MCU_Idx)
+void xAdvancedEncoder::xFwdTransformMCU(int16* CoeffsTransV[], const uint16* CmpPtrV[], const int32 CmpStrideV[], int32 FirstMCU_Idx, int32 NumMCUs)
 {
-  //calculate MCU position
-  int32 MCU_PosV = MCU_Idx / m_NumMCUsInWidth;
-  int32 MCU_PosH = MCU_Idx % m_NumMCUsInWidth;
-
-  //org samples buffer
-  uint16 SamplesOrg[c_BA];
+  //org samples buffer - blocks of consecutive MCUs are stored in the same order as transformed coeffs
+  uint16 SamplesOrg[c_MaxBlocksInBatch * c_BA];
 
   //transform blocks
   for(int32 CmpIdx = 0; CmpIdx < m_NumOfComponents; CmpIdx++)
   {
-    const int32 MCU_PelPosV = MCU_PosV << (2 + m_SampFactorVer[CmpIdx]);
-    const int32 MCU_PelPosH = MCU_PosH << (2 + m_SampFactorHor[CmpIdx]);
-
     const uint16* CmpPtr    = CmpPtrV   [CmpIdx];
     const int32   CmpStride = CmpStrideV[CmpIdx];
+    assert(NumMCUs <= c_MCUsInBatch && m_SampFactorVer[CmpIdx] * m_SampFactorHor[CmpIdx] <= c_MaxBlocksInMCU); //SamplesOrg capacity
 
-    int32 BlockIdx = MCU_Idx * m_SampFactorVer[CmpIdx] * m_SampFactorHor[CmpIdx];
-    for(int32 V = 0; V < m_SampFactorVer[CmpIdx]; V++)
+    int32 NumBlocks = 0;
+    for(int32 MCU_Idx = FirstMCU_Idx; MCU_Idx < FirstMCU_Idx + NumMCUs; MCU_Idx++)
     {
-      const int32 BlockPosV = MCU_PelPosV + V * c_BS;
-      const int32 BlockResV = m_CmpHeight[CmpIdx] - BlockPosV;
-      for(int32 H = 0; H < m_SampFactorHor[CmpIdx]; H++)
-      {        
-        const int32   BlockPosH = MCU_PelPosH + H * c_BS;
-        const int32   BlockResH = m_CmpWidth[CmpIdx] - BlockPosH;
-        const uint16* BlockPtr  = CmpPtr + BlockPosV * CmpStride + BlockPosH;     
-        if     (BlockResV >= 8 && BlockResH >= 8) { loadEntireBlock(SamplesOrg, BlockPtr, CmpStride); } //C++20 TODO use [[likely]]
-        else if(BlockResV >  0 && BlockResH >  0) { loadExtendBlock(SamplesOrg, BlockPtr, CmpStride, xMin(BlockResH, c_BS), xMin(BlockResV, c_BS)); }
-        else                                      {
-          zeroEntireBlock(SamplesOrg);
-        }
+      //calculate MCU position
+      const int32 MCU_PosV    = MCU_Idx / m_NumMCUsInWidth;
+      const int32 MCU_PosH    = MCU_Idx % m_NumMCUsInWidth;
+      const int32 MCU_PelPosV = MCU_PosV << (2 + m_SampFactorVer[CmpIdx]);
+      const int32 MCU_PelPosH = MCU_PosH << (2 + m_SampFactorHor[CmpIdx]);
 
-        const int32 CoeffTransOffset = BlockIdx << xJPEG_Constants::c_Log2BlockArea;
-        xTransform::FwdTransformDCT_8x8(CoeffsTransV[CmpIdx] + CoeffTransOffset, SamplesOrg);
-        CoeffsTransV[CmpIdx][CoeffTransOffset] -= xTransformConstants::c_FwdDcCorr; //DC correction - JPEG requires 128 to be subtracted from every input sample - could be done be DC -= 
-        BlockIdx++;
+      for(int32 V = 0; V < m_SampFactorVer[CmpIdx]; V++)
+      {
+        const int32 BlockPosV = MCU_PelPosV + V * c_BS;
+        const int32 BlockResV = m_CmpHeight[CmpIdx] - BlockPosV;
+        for(int32 H = 0; H < m_SampFactorHor[CmpIdx]; H++)
+        {        
+          const int32   BlockPosH = MCU_PelPosH + H * c_BS;
+          const int32   BlockResH = m_CmpWidth[CmpIdx] - BlockPosH;
+          const uint16* BlockPtr  = CmpPtr + BlockPosV * CmpStride + BlockPosH;     
+          uint16*       Samples   = SamplesOrg + (NumBlocks << xJPEG_Constants::c_Log2BlockArea);
+          if     (BlockResV >= 8 && BlockResH >= 8) { loadEntireBlock(Samples, BlockPtr, CmpStride); } //C++20 TODO use [[likely]]
+          else if(BlockResV >  0 && BlockResH >  0) { loadExtendBlock(Samples, BlockPtr, CmpStride, xMin(BlockResH, c_BS), xMin(BlockResV, c_BS)); }
+          else                                      {
+            zeroEntireBlock(Samples);
+          }
+          NumBlocks++;
+        }
       }
     }
+
+    const int32 CoeffTransOffset = (FirstMCU_Idx * m_SampFactorVer[CmpIdx] * m_SampFactorHor[CmpIdx]) << xJPEG_Constants::c_Log2BlockArea;
+    int16*      CoeffsTrans      = CoeffsTransV[CmpIdx] + CoeffTransOffset;
+    xTransform::FwdTransformDCT_8x8xN(CoeffsTrans, SamplesOrg, NumBlocks);
+    for(int32 BlockIdx = 0; BlockIdx < NumBlocks; BlockIdx++)
+    {
+      CoeffsTrans[BlockIdx << xJPEG_Constants::c_Log2BlockArea] -= xTransformConstants::c_FwdDcCorr; //DC correction - JPEG requires 128 to be subtracted from every input sample - could be done be DC -= 
+    }
   }
 }
-void xAdvancedEncoder::xInvTransformPic(xPicYUV* Picture, const int16* CoeffsTransV[])
+void xAdvancedEncoder::xInvTransformPic(xPicYUV* Picture, const int16* CoeffsTransV[], const int16* CoeffsScanV[])
 {
         uint16* CmpPtrs   [] = {Picture->getAddr  (eCmp::LM), Picture->getAddr  (eCmp::CB), Picture->getAddr  (eCmp::CR), nullptr};
   const int32   CmpStrides[] = {Picture->getStride(eCmp::LM), Picture->getStride(eCmp::CB), Picture->getStride(eCmp::CR),       0};
 
-  //loop over MCUs
-  for(int32 MCU_Idx = 0; MCU_Idx < m_NumMCUsInArea; MCU_Idx++)
+  //loop over runs of MCUs
+  for(int32 MCU_Idx = 0; MCU_Idx < m_NumMCUsInArea; MCU_Idx += c_MCUsInBatch)
   {
-    xInvTransformMCU(CmpPtrs, CmpStrides, CoeffsTransV, MCU_Idx);
+    xInvTransformMCU(CmpPtrs, CmpStrides, CoeffsTransV, CoeffsScanV, MCU_Idx, xMin(c_MCUsInBatch, m_NumMCUsInArea - MCU_Idx));
   }
 }
-void xAdvancedEncoder::xInvTransformMCU(uint16* CmpPtrV[], const int32 CmpStrideV[], const int16* CoeffsTransV[], int32 MCU_Idx)
+void xAdvancedEncoder::xInvTransformMCU(uint16* CmpPtrV[], const int32 CmpStrideV[], const int16* CoeffsTransV[], const int16* CoeffsScanV[], int32 FirstMCU_Idx, int32 NumMCUs)
 {
-  //calculate MCU position
-  int32 MCU_PosV = MCU_Idx / m_NumMCUsInWidth;
-  int32 MCU_PosH = MCU_Idx % m_NumMCUsInWidth;
-
-  //org samples buffer
-  int16  CoeffsTrans[c_BA];
-  uint16 SamplesRec [c_BA];
+  //coeffs & rec samples buffers - sparse blocks (DC or 4x4 only) are transformed directly, remaining ones are gathered and passed to batched transform
+  int16         CoeffsTrans [c_MaxBlocksInBatch * c_BA];
+  uint16        SamplesRec  [c_MaxBlocksInBatch * c_BA];
+  uint16        SamplesFull [c_MaxBlocksInBatch * c_BA];
+  const uint16* SamplesPtrs [c_MaxBlocksInBatch];
+  int16         CoeffsSparse[c_BA];
 
   //transform blocks
   for(int32 CmpIdx = 0; CmpIdx < m_NumOfComponents; CmpIdx++)
   {
-    const int32 MCU_PelPosV = MCU_PosV << (2 + m_SampFactorVer[CmpIdx]);
-    const int32 MCU_PelPosH = MCU_PosH << (2 + m_SampFactorHor[CmpIdx]);
-
           uint16* CmpPtr    = CmpPtrV   [CmpIdx];
     const int32   CmpStride = CmpStrideV[CmpIdx];
+    assert(NumMCUs <= c_MCUsInBatch && m_SampFactorVer[CmpIdx] * m_SampFactorHor[CmpIdx] <= c_MaxBlocksInMCU); //CoeffsTrans and SamplesRec capacity
 
-    int32 BlockIdx = MCU_Idx * m_SampFactorVer[CmpIdx] * m_SampFactorHor[CmpIdx];
-    for(int32 V = 0; V < m_SampFactorVer[CmpIdx]; V++)
+    const int32 NumBlocks        = NumMCUs * m_SampFactorVer[CmpIdx] * m_SampFactorHor[CmpIdx];
+    const int32 CoeffTransOffset = (FirstMCU_Idx * m_SampFactorVer[CmpIdx] * m_SampFactorHor[CmpIdx]) << xJPEG_Constants::c_Log2BlockArea;
+    int32 NumFull = 0;
+    for(int32 BlockIdx = 0; BlockIdx < NumBlocks; BlockIdx++)
     {
-      const int32 BlockPosV = MCU_PelPosV + V * c_BS;
-      const int32 BlockResV = m_CmpHeight[CmpIdx] - BlockPosV;
-      for(int32 H = 0; H < m_SampFactorHor[CmpIdx]; H++)
+      const int32  Offset  = CoeffTransOffset + (BlockIdx << xJPEG_Constants::c_Log2BlockArea);
+      const int32  LastPos = xEntropyCommon::findLastNonZero(CoeffsScanV[CmpIdx] + Offset);
+      const int16* Coeffs  = CoeffsTransV[CmpIdx] + Offset;
+      int16* restrict Dst  = LastPos <= xTransform::c_LastPos4x4 ? CoeffsSparse : CoeffsTrans + (NumFull << xJPEG_Constants::c_Log2BlockArea);
+      memcpy(Dst, Coeffs, c_BA * sizeof(int16));
+      Dst[0] += xTransformConstants::c_InvDcCorr; //DC correction - JPEG requires 128 to be subtracted from every input sample - could be done be DC -= 
+      if(LastPos <= xTransform::c_LastPos4x4)
+      {
+        uint16* Samples = SamplesRec + (BlockIdx << xJPEG_Constants::c_Log2BlockArea);
+        xTransform::InvTransformDCT_8x8(Samples, CoeffsSparse, LastPos);
+        SamplesPtrs[BlockIdx] = Samples;
+      }
+      else
       {
-        const int32 BlockPosH = MCU_PelPosH + H * c_BS;
-        const int32 BlockResH = m_CmpWidth[CmpIdx] - BlockPosH;
-        uint16* restrict BlockPtr = CmpPtr + BlockPosV * CmpStride + BlockPosH;
-        const int32 CoeffTransOffset = BlockIdx << xJPEG_Constants::c_Log2BlockArea;
+        SamplesPtrs[BlockIdx] = SamplesFull + (NumFull << xJPEG_Constants::c_Log2BlockArea);
+        NumFull++;
+      }
+    }
+    xTransform::InvTransformDCT_8x8xN(SamplesFull, CoeffsTrans, NumFull);
+
+    int32 BlockIdx = 0;
+    for(int32 MCU_Idx = FirstMCU_Idx; MCU_Idx < FirstMCU_Idx + NumMCUs; MCU_Idx++)
+    {
+      //calculate MCU position
+      const int32 MCU_PosV    = MCU_Idx / m_NumMCUsInWidth;
+      const int32 MCU_PosH    = MCU_Idx % m_NumMCUsInWidth;
+      const int32 MCU_PelPosV = MCU_PosV << (2 + m_SampFactorVer[CmpIdx]);
+      const int32 MCU_PelPosH = MCU_PosH << (2 + m_SampFactorHor[CmpIdx]);
 
-        memcpy(CoeffsTrans, CoeffsTransV[CmpIdx] + CoeffTransOffset, c_BA * sizeof(int16));
-        CoeffsTrans[0] += xTransformConstants::c_InvDcCorr; //DC correction - JPEG requires 128 to be subtracted from every input sample - could be done be DC -= 
-        xTransform::InvTransformDCT_8x8(SamplesRec, CoeffsTrans);
+      for(int32 V = 0; V < m_SampFactorVer[CmpIdx]; V++)
+      {
+        const int32 BlockPosV = MCU_PelPosV + V * c_BS;
+        const int32 BlockResV = m_CmpHeight[CmpIdx] - BlockPosV;
+        for(int32 H = 0; H < m_SampFactorHor[CmpIdx]; H++)
+        {
+          const int32 BlockPosH = MCU_PelPosH + H * c_BS;
+          const int32 BlockResH = m_CmpWidth[CmpIdx] - BlockPosH;
+          uint16* restrict BlockPtr = CmpPtr + BlockPosV * CmpStride + BlockPosH;
+          const uint16*    Samples  = SamplesPtrs[BlockIdx];
 
-        if     (BlockResV >= 8 && BlockResH >= 8) { storeEntireBlock (BlockPtr, SamplesRec, CmpStride); } //C++20 TODO use [[likely]]
-        else if(BlockResV >  0 && BlockResH >  0) { storePartialBlock(BlockPtr, SamplesRec, CmpStride, xMin(BlockResH, c_BS), xMin(BlockResV, c_BS)); }
-        else                                      { /* do nothing */ }
+          if     (BlockResV >= 8 && BlockResH >= 8) { storeEntireBlock (BlockPtr, Samples, CmpStride); } //C++20 TODO use [[likely]]
+          else if(BlockResV >  0 && BlockResH >  0) { storePartialBlock(BlockPtr, Samples, CmpStride, xMin(BlockResH, c_BS), xMin(BlockResV, c_BS)); }
+          else                                      { /* do nothing */ }
 
-        BlockIdx++;
+          BlockIdx++;
+        }
       }
     }
   }
 }
 
-void xAdvancedEncoder::xFwdQuantScanPic(int16* CoeffsScanV[], const int16* CoeffsTransV[], const xQuantizerSet& Quant)
+void xAdvancedEncoder::xFwdTransformQuantScanPic(int16* CoeffsScanV[], const xPicYUV* Picture, const xQuantizerSet& Quant, xBlockInfo* BlockInfoV[])
+{
+  const uint16* CmpPtrV   [] = {Picture->getAddr  (eCmp::LM), Picture->getAddr  (eCmp::CB), Picture->getAddr  (eCmp::CR), nullptr};
+  const int32   CmpStrideV[] = {Picture->getStride(eCmp::LM), Picture->getStride(eCmp::CB), Picture->getStride(eCmp::CR),       0};
+
+  //org samples buffer
+  uint16 SamplesOrg[c_BA];
+
+  //loop over MCUs
+  for(int32 MCU_Idx = 0; MCU_Idx < m_NumMCUsInArea; MCU_Idx++)
+  {
+    //calculate MCU position
+    const int32 MCU_PosV = MCU_Idx / m_NumMCUsInWidth;
+    const int32 MCU_PosH = MCU_Idx % m_NumMCUsInWidth;
+
+    for(int32 CmpIdx = 0; CmpIdx < m_NumOfComponents; CmpIdx++)
+    {
+      const int32 MCU_PelPosV = MCU_PosV << (2 + m_SampFactorVer[CmpIdx]);
+      const int32 MCU_PelPosH = MCU_PosH << (2 + m_SampFactorHor[CmpIdx]);
+
+      const uint16*     CmpPtr    = CmpPtrV   [CmpIdx];
+      const int32       CmpStride = CmpStrideV[CmpIdx];
+      const xQuantizer& Quantizer = Quant.getQuantizer(m_SOF0.getQuantTableId(eCmp(CmpIdx)));
+
+      int32 BlockIdx = MCU_Idx * m_SampFactorVer[CmpIdx] * m_SampFactorHor[CmpIdx];
+      for(int32 V = 0; V < m_SampFactorVer[CmpIdx]; V++)
+      {
+        const int32 BlockPosV = MCU_PelPosV + V * c_BS;
+        const int32 BlockResV = m_CmpHeight[CmpIdx] - BlockPosV;
+        for(int32 H = 0; H < m_SampFactorHor[CmpIdx]; H++)
+        {
+          const int32   BlockPosH = MCU_PelPosH + H * c_BS;
+          const int32   BlockResH = m_CmpWidth[CmpIdx] - BlockPosH;
+          const uint16* BlockPtr  = CmpPtr + BlockPosV * CmpStride + BlockPosH;
+          if     (BlockResV >= 8 && BlockResH >= 8) { loadEntireBlock(SamplesOrg, BlockPtr, CmpStride); } //C++20 TODO use [[likely]]
+          else if(BlockResV >  0 && BlockResH >  0) { loadExtendBlock(SamplesOrg, BlockPtr, CmpStride, xMin(BlockResH, c_BS), xMin(BlockResV, c_BS)); }
+          else                                      { zeroEntireBlock(SamplesOrg); }
+
+          int16* CoeffsScan = CoeffsScanV[CmpIdx] + (BlockIdx << xJPEG_Constants::c_Log2BlockArea);
+          Quantizer.FwdTransformQuantScan(CoeffsScan, SamplesOrg);
+          if(BlockInfoV != nullptr) { xEntropyCommon::deriveBlockInfo(BlockInfoV[CmpIdx][BlockIdx], CoeffsScan); } //block is hot in cache
+          BlockIdx++;
+        }
+      }
+    }
+  }
+}
+void xAdvancedEncoder::xFwdQuantScanPic(int16* CoeffsScanV[], const int16* CoeffsTransV[], const xQuantizerSet& Quant, xBlockInfo* BlockInfoV[])
 {
   for(int32 CmpIdx = 0; CmpIdx < m_NumOfComponents; CmpIdx++)
   {
     int32 QuantTabIdx = m_SOF0.getQuantTableId(eCmp(CmpIdx));
-    xFwdQuantScanCmp(CoeffsScanV[CmpIdx], CoeffsTransV[CmpIdx], m_NumBlocks[CmpIdx], Quant.getQuantizer(QuantTabIdx));
+    xFwdQuantScanCmp(CoeffsScanV[CmpIdx], CoeffsTransV[CmpIdx], m_NumBlocks[CmpIdx], Quant.getQuantizer(QuantTabIdx), BlockInfoV != nullptr ? BlockInfoV[CmpIdx] : nullptr);
   }  
 }
-void xAdvancedEncoder::xFwdQuantScanCmp(int16* CoeffsScan, const int16* CoeffsTrans, int32 NumBlocks, const xQuantizer& Quant)
+void xAdvancedEncoder::xFwdQuantScanCmp(int16* CoeffsScan, const int16* CoeffsTrans, int32 NumBlocks, const xQuantizer& Quant, xBlockInfo* BlockInfo)
 {
   int16 CoeffsQuant[c_BA];
 
@@ -439,6 +966,7 @@ void xAdvancedEncoder::xFwdQuantScanCmp(int16* CoeffsScan, const int16* CoeffsTr
     const int32 BlockOffset = BlockIdx << xJPEG_Constants::c_Log2BlockArea;
     Quant.QuantScale(CoeffsQuant, CoeffsTrans + BlockOffset);
     xScan::Scan(CoeffsScan + BlockOffset, CoeffsQuant);
+    if(BlockInfo != nullptr) { xEntropyCommon::deriveBlockInfo(BlockInfo[BlockIdx], CoeffsScan + BlockOffset); } //block is hot in cache
   }
 }
 void xAdvancedEncoder::xInvScanQuantPic(int16* CoeffsTransV[], const int16* CoeffsScanV[], const xQuantizerSet& Quant)
@@ -461,36 +989,36 @@ void xAdvancedEncoder::xInvScanQuantCmp(int16* CoeffsTrans, const int16* CoeffsS
   }
 }
 
-int64V4 xAdvancedEncoder::xHuffEstPic(const int16* CoeffsScanV[])
+int64V4 xAdvancedEncoder::xHuffEstPic(xEntropyEstimator* EntropyEst, const int16* CoeffsScanV[], xBlockInfo* BlockInfoV[])
 {
   int64V4 EstNumBits = xMakeVec4<int64>(0);
   if(m_RestartInterval == 0) //no division - encode entire picture at once
   {
-    EstNumBits += xHuffEstSlc(CoeffsScanV, 0, m_NumMCUsInArea - 1);
+    EstNumBits += xHuffEstSlc(EntropyEst, CoeffsScanV, BlockInfoV, 0, m_NumMCUsInArea - 1);
   }
   else //divide picture into independent slices
   {
     for(int32 SliceIdx = 0, MCU_IdxFirst = 0; MCU_IdxFirst < m_NumMCUsInArea; SliceIdx++, MCU_IdxFirst += m_RestartInterval)
     {
       int32 MCU_IdxLast = xMin(m_NumMCUsInArea, MCU_IdxFirst + m_RestartInterval) - 1;
-      EstNumBits += xHuffEstSlc(CoeffsScanV, MCU_IdxFirst, MCU_IdxLast);
+      EstNumBits += xHuffEstSlc(EntropyEst, CoeffsScanV, BlockInfoV, MCU_IdxFirst, MCU_IdxLast);
       //if(MCU_IdxLast != m_NumMCUsInArea - 1) { xJFIF::WriteRST(OutputBuffer, (uint8)((uint32)SliceIdx & (uint32)0x07)); }
     }
   }
   return EstNumBits;
 }
-int64V4 xAdvancedEncoder::xHuffEstSlc(const int16* CoeffsScanV[], int32 MCU_IdxFirst, int32 MCU_IdxLast)
+int64V4 xAdvancedEncoder::xHuffEstSlc(xEntropyEstimator* EntropyEst, const int16* CoeffsScanV[], xBlockInfo* BlockInfoV[], int32 MCU_IdxFirst, int32 MCU_IdxLast)
 {
   int64V4 EstNumBits = xMakeVec4<int64>(0);
-  m_EntropyEst.StartSlice();
+  EntropyEst->StartSlice();
   //loop over MCUs
   for(int32 MCU_Idx = MCU_IdxFirst; MCU_Idx <= MCU_IdxLast; MCU_Idx++)
   {
-    EstNumBits += xHuffEstMCU(CoeffsScanV, MCU_Idx);
+    EstNumBits += xHuffEstMCU(EntropyEst, CoeffsScanV, BlockInfoV, MCU_Idx);
   }
   return EstNumBits;
 }
-int64V4 xAdvancedEncoder::xHuffEstMCU(const int16* CoeffsScanV[], int32 MCU_Idx)
+int64V4 xAdvancedEncoder::xHuffEstMCU(xEntropyEstimator* EntropyEst, const int16* CoeffsScanV[], xBlockInfo* BlockInfoV[], int32 MCU_Idx)
 {
   int64V4 EstNumBits = xMakeVec4<int64>(0);
 
@@ -505,45 +1033,57 @@ int64V4 xAdvancedEncoder::xHuffEstMCU(const int16* CoeffsScanV[], int32 MCU_Idx)
       for(int32 H = 0; H < m_SampFactorHor[CmpIdx]; H++)
       {
         const int32 CoeffScanOffset = BlockIdx << xJPEG_Constants::c_Log2BlockArea;        
-        EstNumBits[CmpIdx] += m_EntropyEst.EstimateBlock(CoeffsScanV[CmpIdx] + CoeffScanOffset, eCmp(CmpIdx), HuffTabIdDC, HuffTabIdAC);
+        if(BlockInfoV == nullptr) { EstNumBits[CmpIdx] += EntropyEst->EstimateBlock(CoeffsScanV[CmpIdx] + CoeffScanOffset, eCmp(CmpIdx), HuffTabIdDC, HuffTabIdAC); }
+        else
+        {
+          xBlockInfo& Info    = BlockInfoV[CmpIdx][BlockIdx];
+          const int32 NumBits = EntropyEst->EstimateBlock(CoeffsScanV[CmpIdx] + CoeffScanOffset, Info, eCmp(CmpIdx), HuffTabIdDC, HuffTabIdAC);
+          if(!EntropyEst->isArithmetic()) { Info.setNumBits(NumBits); } //Huffman rate depends only on DC predictor, which RDOQ sees identically
+          EstNumBits[CmpIdx] += NumBits;
+        }
         BlockIdx++;
       }
     }
   }
   return EstNumBits;
 }
-uint64 xAdvancedEncoder::xCalcDistBLK(const int16* ScanCoeffs, const uint16* SamplesOrg, int32 QuantTabId)
+uint64 xAdvancedEncoder::xCalcDistBLK(const int16* ScanCoeffs, const uint16* SamplesOrg, int32 QuantTabId, int32 LastPos, const xQuantizerSet& Quant)
 {
-  int16  TmpQuantCoeffs[c_BA];
-  int16  TmpTransCoeffs[c_BA];
-  uint16 TmpSamples    [c_BA];
-
-  xScan::InvScan(TmpQuantCoeffs, ScanCoeffs);
-  m_QuantMain.InvScale(TmpTransCoeffs, TmpQuantCoeffs, QuantTabId);
-  TmpTransCoeffs[0] += xTransformConstants::c_InvDcCorr; //DC correction - JPEG requires 128 to be subtracted from every input sample - could be done be DC -= 
-  xTransform::InvTransformDCT_8x8(TmpSamples, TmpTransCoeffs);
-  uint64 SSD = xDistortion::CalcSSD(SamplesOrg, TmpSamples, c_BS, c_BS, c_BS, c_BS);
-  return SSD;
+  return Quant.InvScanQuantTransformSSD(ScanCoeffs, SamplesOrg, QuantTabId, LastPos);
 }
 
-void xAdvancedEncoder::xOptimizePic(int16* OptCoeffsScanV[], const int16* CoeffsScanV[], const xPicYUV* Picture)
+void xAdvancedEncoder::xOptimizePic(int16* OptCoeffsScanV[], xBlockInfo* OptBlockInfoV[], const int16* CoeffsScanV[], const xBlockInfo* BlockInfoV[], const xPicYUV* Picture)
 {
-  if(m_RestartInterval == 0) //no division - encode entire picture at once
-  {
-    xOptimizeSlc(OptCoeffsScanV, CoeffsScanV, Picture, 0, m_NumMCUsInArea - 1);
-  }
-  else //divide picture into independent slices
+  if(m_ThreadPool.isCreated()) //MCU-row bands optimized in parallel, result does not depend on number of threads
   {
-    for(int32 SliceIdx = 0, MCU_IdxFirst = 0; MCU_IdxFirst < m_NumMCUsInArea; SliceIdx++, MCU_IdxFirst += m_RestartInterval)
+    for(int32 BandIdx = 0; BandIdx < m_NumMCUsInHeight; BandIdx++)
     {
-      int32 MCU_IdxLast = xMin(m_NumMCUsInArea, MCU_IdxFirst + m_RestartInterval) - 1;
-      xOptimizeSlc(OptCoeffsScanV, CoeffsScanV, Picture, MCU_IdxFirst, MCU_IdxLast);
+      m_ThreadPool.addWaitingTask([this, BandIdx, OptCoeffsScanV, OptBlockInfoV, CoeffsScanV, BlockInfoV, Picture](int32 ThreadIdx)
+      {
+        const int32 MCU_IdxFirst = BandIdx * m_NumMCUsInWidth;
+        const int32 MCU_IdxLast  = MCU_IdxFirst + m_NumMCUsInWidth - 1;
+        xOptimizeBnd(m_ThreadEntropyEst[ThreadIdx], OptCoeffsScanV, OptBlockInfoV, CoeffsScanV, BlockInfoV, Picture, MCU_IdxFirst, MCU_IdxLast);
+      });
     }
+    m_ThreadPool.waitUntilTasksFinished();
+  }
+  else //entire picture at once
+  {
+    xOptimizeBnd(&m_EntropyEst, OptCoeffsScanV, OptBlockInfoV, CoeffsScanV, BlockInfoV, Picture, 0, m_NumMCUsInArea - 1);
   }
 }
-void xAdvancedEncoder::xOptimizeSlc(int16* OptCoeffsScanV[], const int16* CoeffsScanV[], const xPicYUV* Picture, int32 MCU_IdxFirst, int32 MCU_IdxLast)
+void xAdvancedEncoder::xOptimizeBnd(xEntropyEstimator* EntropyEst, int16* OptCoeffsScanV[], xBlockInfo* OptBlockInfoV[], const int16* CoeffsScanV[], const xBlockInfo* BlockInfoV[], const xPicYUV* Picture, int32 MCU_IdxFirst, int32 MCU_IdxLast)
 {
-  m_EntropyEst.StartSlice();
+  //DC predictor - reset at slice start, otherwise seeded with quantized DC of preceding block (RDOQ never modifies DC, so it is known upfront)
+  if(MCU_IdxFirst % m_NumMCUsInSlice == 0) { EntropyEst->StartSlice(); }
+  else
+  {
+    for(int32 CmpIdx = 0; CmpIdx < m_NumOfComponents; CmpIdx++)
+    {
+      const int32 PrevBlockIdx = MCU_IdxFirst * m_SampFactorVer[CmpIdx] * m_SampFactorHor[CmpIdx] - 1;
+      EntropyEst->setLastDC(eCmp(CmpIdx), CoeffsScanV[CmpIdx][PrevBlockIdx << xJPEG_Constants::c_Log2BlockArea]);
+    }
+  }
 
   const uint16* CmpPtrV   [] = {Picture->getAddr  (eCmp::LM), Picture->getAddr  (eCmp::CB), Picture->getAddr  (eCmp::CR), nullptr};
   const int32   CmpStrideV[] = {Picture->getStride(eCmp::LM), Picture->getStride(eCmp::CB), Picture->getStride(eCmp::CR),       0};
@@ -551,10 +1091,11 @@ void xAdvancedEncoder::xOptimizeSlc(int16* OptCoeffsScanV[], const int16* Coeffs
   //loop over MCUs
   for(int32 MCU_Idx = MCU_IdxFirst; MCU_Idx <= MCU_IdxLast; MCU_Idx++)
   {
-    xOptimizeMCU(OptCoeffsScanV, CoeffsScanV, CmpPtrV, CmpStrideV, MCU_Idx);
+    if(MCU_Idx != MCU_IdxFirst && MCU_Idx % m_NumMCUsInSlice == 0) { EntropyEst->StartSlice(); } //next slice begins
+    xOptimizeMCU(EntropyEst, OptCoeffsScanV, OptBlockInfoV, CoeffsScanV, BlockInfoV, CmpPtrV, CmpStrideV, MCU_Idx);
   }
 }
-void xAdvancedEncoder::xOptimizeMCU(int16* OptCoeffsScanV[], const int16* CoeffsScanV[], const uint16* CmpPtrV[], const int32 CmpStrideV[], int32 MCU_Idx)
+void xAdvancedEncoder::xOptimizeMCU(xEntropyEstimator* EntropyEst, int16* OptCoeffsScanV[], xBlockInfo* OptBlockInfoV[], const int16* CoeffsScanV[], const xBlockInfo* BlockInfoV[], const uint16* CmpPtrV[], const int32 CmpStrideV[], int32 MCU_Idx)
 {
   //calculate MCU position
   int32 MCU_PosV = MCU_Idx / m_NumMCUsInWidth;
@@ -592,51 +1133,94 @@ void xAdvancedEncoder::xOptimizeMCU(int16* OptCoeffsScanV[], const int16* Coeffs
           else                                      { zeroEntireBlock(SamplesOrg); }
 
           const int32 CoeffTransOffset = BlockIdx << xJPEG_Constants::c_Log2BlockArea;
-          xOptimizeBLK(OptCoeffsScanV[CmpIdx] + CoeffTransOffset, CoeffsScanV[CmpIdx] + CoeffTransOffset, SamplesOrg, eCmp(CmpIdx));
+          if(m_RDOQMode == eRDOM::Trellis && !EntropyEst->isArithmetic()) { xTrellisBLK (EntropyEst, OptCoeffsScanV[CmpIdx] + CoeffTransOffset, OptBlockInfoV[CmpIdx][BlockIdx], CoeffsScanV[CmpIdx] + CoeffTransOffset, BlockInfoV[CmpIdx][BlockIdx], m_CmpCoeffsTransOrg[CmpIdx] + CoeffTransOffset, SamplesOrg, eCmp(CmpIdx)); }
+          else                                                            { xOptimizeBLK(EntropyEst, OptCoeffsScanV[CmpIdx] + CoeffTransOffset, OptBlockInfoV[CmpIdx][BlockIdx], CoeffsScanV[CmpIdx] + CoeffTransOffset, BlockInfoV[CmpIdx][BlockIdx], m_CmpCoeffsTransOrg[CmpIdx] + CoeffTransOffset, SamplesOrg, eCmp(CmpIdx)); }
+          EntropyEst->setLastDC(eCmp(CmpIdx), CoeffsScanV[CmpIdx][CoeffTransOffset]);
           BlockIdx++;
         }
       }
     }
   }
 }
-void xAdvancedEncoder::xOptimizeBLK(int16* OptCoeffScan, const int16* CoeffsScan, const uint16* SamplesOrg, eCmp CmpId)
+void xAdvancedEncoder::xOptimizeBLK(xEntropyEstimator* EntropyEst, int16* OptCoeffScan, xBlockInfo& OptInfo, const int16* CoeffsScan, const xBlockInfo& Info, const int16* CoeffsTrans, const uint16* SamplesOrg, eCmp CmpId)
 {
   const int32 QuantTabId  = m_SOF0.getQuantTableId(CmpId);
   const int32 HuffTabIdDC = m_SOS.getHuffTableIdDC(CmpId);
   const int32 HuffTabIdAC = m_SOS.getHuffTableIdAC(CmpId);  
   const flt64 Lambda      = m_Lambda[(int32)CmpId];
-  const int32 LastDC      = m_EntropyEst.getLastDC(CmpId);
+  const int32 LastDC      = EntropyEst->getLastDC(CmpId);
+
+  int32 LastNonZero = Info.getLastPos();
+  if(LastNonZero == 0) { memcpy(OptCoeffScan, CoeffsScan, c_BA * sizeof(int16)); OptInfo = Info; return; } //only DC - nothing to do here
 
-  int32 LastNonZero = xEntropyCommon::findLastNonZero(CoeffsScan);
-  if(LastNonZero == 0) { memcpy(OptCoeffScan, CoeffsScan, c_BA * sizeof(int16)); return; } //only DC - nothing to do here
+  //transform domain distortion - DCT is orthonormal, so SSD equals sum of squared dequantization errors (forward transform output has headroom)
+  const bool    UseTrnDist = m_DistDomain != eDstD::Pixel;
+  const bool    VerifyDist = m_DistDomain == eDstD::Verify;
+  const uint16* StepScan   = m_QuantMain.getQuantizer(QuantTabId).getQuantCoeffsScan();
+  const flt64   TrnToPix   = 1.0 / (flt64)(1 << (2 * xTransformConstants::c_Headroom));
+  int16         TransScan[c_BA];
+  int64         TrnDist = 0; //distortion of current TmpCoeffsScan state (in transform domain scale)
+  if(UseTrnDist) { xScan::Scan(TransScan, CoeffsTrans); TrnDist = xCalcDistTrnBLK(CoeffsScan, TransScan, StepScan); }
 
-  int32  BestBits = m_EntropyEst.EstimateBlockStateless(CoeffsScan, LastDC, HuffTabIdDC, HuffTabIdAC);
-  uint64 BestDist = xCalcDistBLK(CoeffsScan, SamplesOrg, QuantTabId);
-  double BestCost = (double)BestDist + Lambda * (double)BestBits;
+  int64 VerifyNumTrials = 0, VerifySumDistPix = 0, VerifySumAbsDiff = 0, VerifyMaxAbsDiff = 0;
 
   int16 TmpCoeffsScan[c_BA];
   memcpy(TmpCoeffsScan, CoeffsScan, c_BA * sizeof(int16));
 
+  //distortion of TmpCoeffsScan where coeff at Pos was changed from OrgCoeff
+  auto CalcTrialDist = [&](int32 Pos, int16 OrgCoeff) -> flt64
+  {
+    if(!UseTrnDist) { return (flt64)xCalcDistBLK(TmpCoeffsScan, SamplesOrg, QuantTabId, LastNonZero); }
+    int64 TrialTrnDist = TrnDist - xCalcDistTrnCoeff(OrgCoeff, TransScan[Pos], StepScan[Pos]) + xCalcDistTrnCoeff(TmpCoeffsScan[Pos], TransScan[Pos], StepScan[Pos]);
+    flt64 TrialDist    = (flt64)TrialTrnDist * TrnToPix;
+    if(VerifyDist)
+    {
+      int64 PixDist = (int64)xCalcDistBLK(TmpCoeffsScan, SamplesOrg, QuantTabId, LastNonZero);
+      int64 AbsDiff = xAbs(PixDist - (int64)std::llround(TrialDist));
+      VerifyNumTrials  += 1;
+      VerifySumDistPix += PixDist;
+      VerifySumAbsDiff += AbsDiff;
+      VerifyMaxAbsDiff  = xMax(VerifyMaxAbsDiff, AbsDiff);
+    }
+    return TrialDist;
+  };
+
+  //incremental rate estimation - BlockState follows TmpCoeffsScan
+  xEntropyEstimator::xBlockState BlockState;
+  EntropyEst->InitBlockState(BlockState, CoeffsScan, Info, LastDC, HuffTabIdDC, HuffTabIdAC);
+
+  const int32 InitBits = BlockState.getNumBits();
+  const flt64 InitDist = UseTrnDist ? (flt64)TrnDist * TrnToPix : (flt64)xCalcDistBLK(CoeffsScan, SamplesOrg, QuantTabId, LastNonZero);
+  int32  BestBits = InitBits;
+  double BestCost = InitDist + Lambda * (double)BestBits;
+
   for (int32 PassIdx = 0; PassIdx < m_NumBlockOptPasses; PassIdx++)
   {    
     for (int32 i = LastNonZero; i >= 1; i--)
     {
       const int16 OrgCoeff  = TmpCoeffsScan[i];
       if (!m_ProcessZeroCoeffs && OrgCoeff == 0) { continue; }
-      
+
+      //rate of all candidates (zero, +1, -1) is estimated in single call
+      const int16 Candidates[3] = { 0, (int16)(OrgCoeff + 1), (int16)(OrgCoeff - 1) };
+      int32       DeltaBits [3];
+      EntropyEst->EstimateDeltas(BlockState, i, Candidates, DeltaBits, 3);
+
       int16 BestCoeff = TmpCoeffsScan[i];
+      int32 BestDelta = 0;
       //try zero
       if(OrgCoeff != 0)
       {
         TmpCoeffsScan[i] = 0;
-        int32  CurrBits = m_EntropyEst.EstimateBlockStateless(TmpCoeffsScan, LastDC, HuffTabIdDC, HuffTabIdAC);
-        uint64 CurrDist = xCalcDistBLK(TmpCoeffsScan, SamplesOrg, QuantTabId);
-        double CurrCost = (double)CurrDist + Lambda * (double)CurrBits;
+        int32  CurrBits = BlockState.getNumBits() + DeltaBits[0];
+        flt64  CurrDist = CalcTrialDist(i, OrgCoeff);
+        double CurrCost = CurrDist + Lambda * (double)CurrBits;
         if (CurrCost < BestCost)
         {
           BestBits  = CurrBits;
           BestCost  = CurrCost;
           BestCoeff = 0;
+          BestDelta = DeltaBits[0];
         }
       }
 
@@ -644,14 +1228,15 @@ void xAdvancedEncoder::xOptimizeBLK(int16* OptCoeffScan, const int16* CoeffsScan
       if(OrgCoeff != -1)
       {
         TmpCoeffsScan[i] = OrgCoeff + 1;
-        int32  CurrBits = m_EntropyEst.EstimateBlockStateless(TmpCoeffsScan, LastDC, HuffTabIdDC, HuffTabIdAC);
-        uint64 CurrDist = xCalcDistBLK(TmpCoeffsScan, SamplesOrg, QuantTabId);
-        double CurrCost = (double)CurrDist + Lambda * (double)CurrBits;
+        int32  CurrBits = BlockState.getNumBits() + DeltaBits[1];
+        flt64  CurrDist = CalcTrialDist(i, OrgCoeff);
+        double CurrCost = CurrDist + Lambda * (double)CurrBits;
         if (CurrCost < BestCost)
         {
           BestBits = CurrBits;
           BestCost  = CurrCost;
           BestCoeff = OrgCoeff + 1;
+          BestDelta = DeltaBits[1];
         }
       }
 
@@ -659,72 +1244,225 @@ void xAdvancedEncoder::xOptimizeBLK(int16* OptCoeffScan, const int16* CoeffsScan
       if(OrgCoeff != 1)
       {
         TmpCoeffsScan[i] = OrgCoeff - 1;
-        int32  CurrBits = m_EntropyEst.EstimateBlockStateless(TmpCoeffsScan, LastDC, HuffTabIdDC, HuffTabIdAC);
-        uint64 CurrDist = xCalcDistBLK(TmpCoeffsScan, SamplesOrg, QuantTabId);
-        double CurrCost = (double)CurrDist + Lambda * (double)CurrBits;
+        int32  CurrBits = BlockState.getNumBits() + DeltaBits[2];
+        flt64  CurrDist = CalcTrialDist(i, OrgCoeff);
+        double CurrCost = CurrDist + Lambda * (double)CurrBits;
         if (CurrCost < BestCost)
         {
           BestBits = CurrBits;
           BestCost  = CurrCost;
           BestCoeff = OrgCoeff - 1;
+          BestDelta = DeltaBits[2];
         }
       }
 
       TmpCoeffsScan[i] = BestCoeff;
+      BlockState.update(i, BestCoeff, BestDelta);
+      if(UseTrnDist) { TrnDist += xCalcDistTrnCoeff(BestCoeff, TransScan[i], StepScan[i]) - xCalcDistTrnCoeff(OrgCoeff, TransScan[i], StepScan[i]); }
     }
   }
 
-  //int32 TestBits = m_EntropyEst.EstimateBlock(TmpCoeffsScan, CmpId, HuffTabIdDC, HuffTabIdAC);
-  memcpy(OptCoeffScan, TmpCoeffsScan, c_BA * sizeof(int16));
-}
+  //final accept in pixel domain - transform domain ignores rounding and clipping of reconstructed samples
+  bool Revert = false;
+  if(UseTrnDist)
+  {
+    uint64 InitDistPix = xCalcDistBLK(CoeffsScan   , SamplesOrg, QuantTabId, LastNonZero);
+    uint64 BestDistPix = xCalcDistBLK(TmpCoeffsScan, SamplesOrg, QuantTabId, LastNonZero);
+    Revert = ((double)BestDistPix + Lambda * (double)BestBits) > ((double)InitDistPix + Lambda * (double)InitBits);
+  }
 
-void xAdvancedEncoder::xHuffEncPic(xByteBuffer* OutputBuffer, const int16* CoeffsScanV[])
-{
-  if(m_RestartInterval == 0) //no division - encode entire picture at once
+  if(VerifyDist)
   {
-    xHuffEncSlc(OutputBuffer, CoeffsScanV, 0, m_NumMCUsInArea - 1);
+    std::lock_guard<std::mutex> LockManager(m_VerifyMutex);
+    m_VerifyNumTrials  += VerifyNumTrials;
+    m_VerifySumDistPix += VerifySumDistPix;
+    m_VerifySumAbsDiff += VerifySumAbsDiff;
+    m_VerifyMaxAbsDiff  = xMax(m_VerifyMaxAbsDiff, VerifyMaxAbsDiff);
+    m_VerifyNumBlocks  += 1;
+    m_VerifyNumReverts += Revert ? 1 : 0;
   }
-  else //divide picture into independent slices
+
+  //int32 TestBits = EntropyEst->EstimateBlock(TmpCoeffsScan, CmpId, HuffTabIdDC, HuffTabIdAC);
+  memcpy(OptCoeffScan, Revert ? CoeffsScan : TmpCoeffsScan, c_BA * sizeof(int16));
+  if(Revert) { OptInfo = Info; OptInfo.setNumBits(InitBits); }
+  else       { BlockState.storeBlockInfo(OptInfo); }
+}
+void xAdvancedEncoder::xTrellisBLK(xEntropyEstimator* EntropyEst, int16* OptCoeffScan, xBlockInfo& OptInfo, const int16* CoeffsScan, const xBlockInfo& Info, const int16* CoeffsTrans, const uint16* SamplesOrg, eCmp CmpId)
+{
+  const int32 QuantTabId  = m_SOF0.getQuantTableId(CmpId);
+  const int32 HuffTabIdDC = m_SOS.getHuffTableIdDC(CmpId);
+  const int32 HuffTabIdAC = m_SOS.getHuffTableIdAC(CmpId);
+  const flt64 Lambda      = m_Lambda[(int32)CmpId];
+  const int32 LastDC      = EntropyEst->getLastDC(CmpId);
+
+  int32 LastNonZero = Info.getLastPos();
+  if(LastNonZero == 0 && !m_ProcessZeroCoeffs) { memcpy(OptCoeffScan, CoeffsScan, c_BA * sizeof(int16)); OptInfo = Info; return; } //only DC - nothing to do here
+
+  //distortion is additive only in transform domain (DCT is orthonormal, forward transform output has headroom)
+  const xHuffEstimatorAC* HE       = EntropyEst->getHuffEstimatorAC(HuffTabIdAC);
+  const uint16*           StepScan = m_QuantMain.getQuantizer(QuantTabId).getQuantCoeffsScan();
+  const flt64             TrnToPix = 1.0 / (flt64)(1 << (2 * xTransformConstants::c_Headroom));
+  const flt64             CostEOB  = Lambda * (flt64)HE->calcEOB();
+  int16 TransScan[c_BA];
+  xScan::Scan(TransScan, CoeffsTrans);
+
+  //distortion of zeroed coefficients accumulated over positions [1, Pos]
+  flt64 ZeroDistAcc[c_BA];
+  ZeroDistAcc[0] = 0;
+  for(int32 Pos = 1; Pos < c_BA; Pos++) { ZeroDistAcc[Pos] = ZeroDistAcc[Pos - 1] + (flt64)xCalcDistTrnCoeff(0, TransScan[Pos], StepScan[Pos]) * TrnToPix; }
+
+  //trellis nodes - node at Pos represents nonzero coefficient at Pos preceded by zero run starting after node PrevPos (node 0 = DC = start of AC chain)
+  constexpr flt64 c_Inf = std::numeric_limits<flt64>::max();
+  flt64 NodeCost [c_BA];
+  int16 NodeCoeff[c_BA];
+  int8  NodePrev [c_BA];
+  NodeCost[0] = 0;
+
+  const int32 LastPos = m_ProcessZeroCoeffs ? c_BA - 1 : LastNonZero;
+  for(int32 Pos = 1; Pos <= LastPos; Pos++)
   {
-    for(int32 SliceIdx = 0, MCU_IdxFirst = 0; MCU_IdxFirst < m_NumMCUsInArea; SliceIdx++, MCU_IdxFirst += m_RestartInterval)
+    NodeCost[Pos] = c_Inf;
+
+    //candidates - quantized value and value decreased by one towards zero (zero is represented by skipping the node)
+    const int16 OrgCoeff = CoeffsScan[Pos];
+    int16 Candidates[2];
+    int32 NumCandidates = 0;
+    if     (OrgCoeff != 0                   ) { Candidates[NumCandidates++] = OrgCoeff; if(OrgCoeff != 1 && OrgCoeff != -1) { Candidates[NumCandidates++] = OrgCoeff > 0 ? OrgCoeff - 1 : OrgCoeff + 1; } }
+    else if(m_ProcessZeroCoeffs && TransScan[Pos] != 0) { Candidates[NumCandidates++] = TransScan[Pos] > 0 ? 1 : -1; }
+
+    for(int32 CandIdx = 0; CandIdx < NumCandidates; CandIdx++)
     {
-      int32 MCU_IdxLast = xMin(m_NumMCUsInArea, MCU_IdxFirst + m_RestartInterval) - 1;
-      xHuffEncSlc(OutputBuffer, CoeffsScanV, MCU_IdxFirst, MCU_IdxLast);
-      if(MCU_IdxLast != m_NumMCUsInArea - 1) { xJFIF::WriteRST(OutputBuffer, (uint8)((uint32)SliceIdx & (uint32)0x07)); }
+      const int16 Coeff      = Candidates[CandIdx];
+      const int32 NumBitsAC  = xNumSignificantBits((uint32)xAbs((int32)Coeff));
+      const flt64 CoeffDist  = (flt64)xCalcDistTrnCoeff(Coeff, TransScan[Pos], StepScan[Pos]) * TrnToPix;
+      for(int32 PrevPos = Pos - 1; PrevPos >= 0; PrevPos--)
+      {
+        if(NodeCost[PrevPos] == c_Inf) { continue; }
+        const int32 RunLength = Pos - PrevPos - 1;
+        const flt64 Cost      = NodeCost[PrevPos] + (ZeroDistAcc[Pos - 1] - ZeroDistAcc[PrevPos]) + CoeffDist + Lambda * (flt64)HE->calcRun(RunLength, NumBitsAC);
+        if(Cost < NodeCost[Pos]) { NodeCost[Pos] = Cost; NodeCoeff[Pos] = Coeff; NodePrev[Pos] = (int8)PrevPos; }
+      }
     }
   }
-}
-void xAdvancedEncoder::xHuffEncSlc(xByteBuffer* OutputBuffer, const int16* CoeffsScanV[], int32 MCU_IdxFirst, int32 MCU_IdxLast)
-{
-  tTimePoint TP0 = m_GatherTimeStats ? tClock::now() : tTimePoint();
 
-  m_EntropyBuffer.reset();
-  m_EntropyEnc.StartSlice(&m_EntropyBuffer);
+  //select last nonzero coefficient - remaining positions are zeroed and EOB is emitted (unless last is at 63)
+  int32 BestLast = 0;
+  flt64 BestCost = c_Inf;
+  for(int32 Pos = 0; Pos <= LastPos; Pos++)
+  {
+    if(NodeCost[Pos] == c_Inf) { continue; }
+    const flt64 Cost = NodeCost[Pos] + (ZeroDistAcc[c_BA - 1] - ZeroDistAcc[Pos]) + (Pos < c_BA - 1 ? CostEOB : 0);
+    if(Cost < BestCost) { BestCost = Cost; BestLast = Pos; }
+  }
 
-  //loop over MCUs
-  for(int32 MCU_Idx = MCU_IdxFirst; MCU_Idx <= MCU_IdxLast; MCU_Idx++)
+  //backtrack
+  int16 TmpCoeffsScan[c_BA];
+  memset(TmpCoeffsScan, 0, c_BA * sizeof(int16));
+  TmpCoeffsScan[0] = CoeffsScan[0];
+  uint64 TmpNonZeroMask = 1;
+  for(int32 Pos = BestLast; Pos > 0; Pos = NodePrev[Pos]) { TmpCoeffsScan[Pos] = NodeCoeff[Pos]; TmpNonZeroMask |= (uint64)1 << Pos; }
+
+  //final accept in pixel domain - transform domain ignores rounding and clipping of reconstructed samples
+  const int32  InitBits    = Info.isNumBitsValid() ? Info.getNumBits() : EntropyEst->EstimateBlockStateless(CoeffsScan, LastDC, HuffTabIdDC, HuffTabIdAC);
+  const int32  BestBits    = EntropyEst->EstimateBlockStateless(TmpCoeffsScan, LastDC, HuffTabIdDC, HuffTabIdAC);
+  const uint64 InitDistPix = xCalcDistBLK(CoeffsScan   , SamplesOrg, QuantTabId, LastNonZero);
+  const uint64 BestDistPix = xCalcDistBLK(TmpCoeffsScan, SamplesOrg, QuantTabId, BestLast   );
+  const bool   Revert      = ((flt64)BestDistPix + Lambda * (flt64)BestBits) > ((flt64)InitDistPix + Lambda * (flt64)InitBits);
+
+  if(m_DistDomain == eDstD::Verify) //one trial per block - distortion of selected path
   {
-    xHuffEncMCU(CoeffsScanV, MCU_Idx);
+    const int64 TrnDist = std::llround((flt64)xCalcDistTrnBLK(TmpCoeffsScan, TransScan, StepScan) * TrnToPix);
+    const int64 AbsDiff = xAbs((int64)BestDistPix - TrnDist);
+    std::lock_guard<std::mutex> LockManager(m_VerifyMutex);
+    m_VerifyNumTrials  += 1;
+    m_VerifySumDistPix += (int64)BestDistPix;
+    m_VerifySumAbsDiff += AbsDiff;
+    m_VerifyMaxAbsDiff  = xMax(m_VerifyMaxAbsDiff, AbsDiff);
+    m_VerifyNumBlocks  += 1;
+    m_VerifyNumReverts += Revert ? 1 : 0;
   }
 
-  m_EntropyEnc.FinishSlice();
+  memcpy(OptCoeffScan, Revert ? CoeffsScan : TmpCoeffsScan, c_BA * sizeof(int16));
+  if(Revert) { OptInfo = Info; OptInfo.setNumBits(InitBits); }
+  else       { OptInfo.set(TmpNonZeroMask, BestBits); }
+}
+uint64 xAdvancedEncoder::xCalcDistPartBLK(const int16* ScanCoeffs, const uint16* SamplesOrg, int32 QuantTabId, int32 Width, int32 Height, const xQuantizerSet& Quant)
+{
+  int16  CoeffsQuant[c_BA];
+  int16  CoeffsTrans[c_BA];
+  uint16 SamplesRec [c_BA];
+  xScan::InvScan(CoeffsQuant, ScanCoeffs);
+  Quant.getQuantizer(QuantTabId).InvScale(CoeffsTrans, CoeffsQuant);
+  CoeffsTrans[0] += xTransformConstants::c_InvDcCorr; //DC correction
+  xTransform::InvTransformDCT_8x8(SamplesRec, CoeffsTrans, xEntropyCommon::findLastNonZero(ScanCoeffs));
+  return xDistortion::CalcSSD(SamplesOrg, SamplesRec, c_BS, c_BS, Width, Height);
+}
+int64 xAdvancedEncoder::xCalcDistTrnBLK(const int16* ScanCoeffs, const int16* ScanTrans, const uint16* ScanStep)
+{
+  int64 SSD = 0;
+  for(int32 i = 0; i < c_BA; i++) { SSD += xCalcDistTrnCoeff(ScanCoeffs[i], ScanTrans[i], ScanStep[i]); }
+  return SSD;
+}
+
+void xAdvancedEncoder::xHuffEncPic(xByteBuffer* OutputBuffer, const int16* CoeffsScanV[], const xBlockInfo* BlockInfoV[])
+{
+  if(m_NumSliceGroups > 1) //groups of independent slices coded in parallel and concatenated in order
+  {
+    std::vector<tDuration> EntropyTimes (m_NumSliceGroups, (tDuration)0);
 
-  tTimePoint TP1 = m_GatherTimeStats ? tClock::now() : tTimePoint();
+    for(int32 GroupIdx = 0; GroupIdx < m_NumSliceGroups; GroupIdx++)
+    {
+      m_ThreadPool.addWaitingTask([this, GroupIdx, CoeffsScanV, BlockInfoV, &EntropyTimes](int32 /*ThreadIdx*/)
+      {
+        const int32 SliceIdxFirst = ( GroupIdx      * m_NumSlices) / m_NumSliceGroups;
+        const int32 SliceIdxLast  = ((GroupIdx + 1) * m_NumSlices) / m_NumSliceGroups - 1;
+        m_GroupOutputBuffer[GroupIdx]->reset();
+        xHuffEncGrp(m_GroupOutputBuffer[GroupIdx], CoeffsScanV, BlockInfoV, SliceIdxFirst, SliceIdxLast, m_GroupEntropyEnc[GroupIdx], EntropyTimes[GroupIdx]);
+      });
+    }
+    m_ThreadPool.waitUntilTasksFinished();
 
-  //copy to output and add stuffing
-  xJFIF::AddStuffing(OutputBuffer, &m_EntropyBuffer);
+    for(int32 GroupIdx = 0; GroupIdx < m_NumSliceGroups; GroupIdx++)
+    {
+      OutputBuffer->append(m_GroupOutputBuffer[GroupIdx]);
+      m_TotalEntropyTime += EntropyTimes[GroupIdx]; //accumulated over all threads
+    }
+  }
+  else //single slice or serial processing of slices
+  {
+    xHuffEncGrp(OutputBuffer, CoeffsScanV, BlockInfoV, 0, m_NumSlices - 1, &m_EntropyEnc, m_TotalEntropyTime);
+  }
 
-  tTimePoint TP2 = m_GatherTimeStats ? tClock::now() : tTimePoint();
+  if(m_GatherTimeStats) { m_TotalSliceIters += m_NumSlices; }
+}
+void xAdvancedEncoder::xHuffEncGrp(xByteBuffer* OutputBuffer, const int16* CoeffsScanV[], const xBlockInfo* BlockInfoV[], int32 SliceIdxFirst, int32 SliceIdxLast, xEntropyEncoder* EntropyEnc, tDuration& EntropyTime)
+{
+  for(int32 SliceIdx = SliceIdxFirst; SliceIdx <= SliceIdxLast; SliceIdx++)
+  {
+    int32 MCU_IdxFirst = SliceIdx * m_NumMCUsInSlice;
+    int32 MCU_IdxLast  = xMin(m_NumMCUsInArea, MCU_IdxFirst + m_NumMCUsInSlice) - 1;
+    xHuffEncSlc(OutputBuffer, CoeffsScanV, BlockInfoV, MCU_IdxFirst, MCU_IdxLast, EntropyEnc, EntropyTime);
+    if(MCU_IdxLast != m_NumMCUsInArea - 1) { xJFIF::WriteRST(OutputBuffer, (uint8)((uint32)SliceIdx & (uint32)0x07)); }
+  }
+}
+void xAdvancedEncoder::xHuffEncSlc(xByteBuffer* OutputBuffer, const int16* CoeffsScanV[], const xBlockInfo* BlockInfoV[], int32 MCU_IdxFirst, int32 MCU_IdxLast, xEntropyEncoder* EntropyEnc, tDuration& EntropyTime)
+{
+  tTimePoint TP0 = m_GatherTimeStats ? tClock::now() : tTimePoint();
 
-  if(m_GatherTimeStats)
+  //entropy coder inserts stuffing while writing directly to output
+  EntropyEnc->StartSlice(OutputBuffer);
+
+  //loop over MCUs
+  for(int32 MCU_Idx = MCU_IdxFirst; MCU_Idx <= MCU_IdxLast; MCU_Idx++)
   {
-    m_TotalSliceIters   += 1;
-    m_TotalEntropyTime  += TP2 - TP0;
-    m_TotalStuffingTime += TP2 - TP1;
+    xHuffEncMCU(EntropyEnc, CoeffsScanV, BlockInfoV, MCU_Idx);
   }
 
+  EntropyEnc->FinishSlice();
+
+  if(m_GatherTimeStats) { EntropyTime += tClock::now() - TP0; }
 }
-void xAdvancedEncoder::xHuffEncMCU(const int16* CoeffsScanV[], int32 MCU_Idx)
+void xAdvancedEncoder::xHuffEncMCU(xEntropyEncoder* EntropyEnc, const int16* CoeffsScanV[], const xBlockInfo* BlockInfoV[], int32 MCU_Idx)
 {
   //estimate blocks
   for(int32 CmpIdx = 0; CmpIdx < m_NumOfComponents; CmpIdx++)
@@ -738,13 +1476,120 @@ void xAdvancedEncoder::xHuffEncMCU(const int16* CoeffsScanV[], int32 MCU_Idx)
       for(int32 H = 0; H < m_SampFactorHor[CmpIdx]; H++)
       {
         const int32 CoeffScanOffset = BlockIdx << xJPEG_Constants::c_Log2BlockArea;        
-        m_EntropyEnc.EncodeBlock(CoeffsScanV[CmpIdx] + CoeffScanOffset, eCmp(CmpIdx), HuffTabIdDC, HuffTabIdAC);
+        EntropyEnc->EncodeBlock(CoeffsScanV[CmpIdx] + CoeffScanOffset, BlockInfoV[CmpIdx][BlockIdx], eCmp(CmpIdx), HuffTabIdDC, HuffTabIdAC);
         BlockIdx++;
       }
     }
   }
 }
 
+void xAdvancedEncoder::xAriEncPic(xByteBuffer* OutputBuffer, const int16* CoeffsScanV[], const xBlockInfo* BlockInfoV[])
+{
+  tTimePoint TP0 = m_GatherTimeStats ? tClock::now() : tTimePoint();
+
+  //slices are coded serially - arithmetic coding is inherently sequential and single picture pass dominates only at highest thread counts
+  for(int32 SliceIdx = 0; SliceIdx < m_NumSlices; SliceIdx++)
+  {
+    int32 MCU_IdxFirst = SliceIdx * m_NumMCUsInSlice;
+    int32 MCU_IdxLast  = xMin(m_NumMCUsInArea, MCU_IdxFirst + m_NumMCUsInSlice) - 1;
+
+    m_EntropyEncAri.StartSlice(OutputBuffer);
+    for(int32 MCU_Idx = MCU_IdxFirst; MCU_Idx <= MCU_IdxLast; MCU_Idx++) { xAriEncMCU(CoeffsScanV, BlockInfoV, MCU_Idx); }
+    m_EntropyEncAri.FinishSlice();
+
+    if(OutputBuffer != nullptr && MCU_IdxLast != m_NumMCUsInArea - 1) { xJFIF::WriteRST(OutputBuffer, (uint8)((uint32)SliceIdx & (uint32)0x07)); }
+  }
+
+  if(OutputBuffer != nullptr && m_GatherTimeStats) { m_TotalEntropyTime += tClock::now() - TP0; m_TotalSliceIters += m_NumSlices; }
+}
+void xAdvancedEncoder::xAriEncMCU(const int16* CoeffsScanV[], const xBlockInfo* BlockInfoV[], int32 MCU_Idx)
+{
+  for(int32 CmpIdx = 0; CmpIdx < m_NumOfComponents; CmpIdx++)
+  {
+    const int32 ArithTabIdDC   = m_SOS.getHuffTableIdDC(eCmp(CmpIdx));
+    const int32 ArithTabIdAC   = m_SOS.getHuffTableIdAC(eCmp(CmpIdx));
+    const int32 NumBlocksInMCU = m_SampFactorVer[CmpIdx] * m_SampFactorHor[CmpIdx];
+    const int32 BlockIdxFirst  = MCU_Idx * NumBlocksInMCU;
+    for(int32 BlockIdx = BlockIdxFirst; BlockIdx < BlockIdxFirst + NumBlocksInMCU; BlockIdx++)
+    {
+      m_EntropyEncAri.EncodeBlock(CoeffsScanV[CmpIdx] + (BlockIdx << xJPEG_Constants::c_Log2BlockArea), BlockInfoV[CmpIdx][BlockIdx], eCmp(CmpIdx), ArithTabIdDC, ArithTabIdAC);
+    }
+  }
+}
+
+void xAdvancedEncoder::xPrgEncPic(xByteBuffer* OutputBuffer, const int16* CoeffsScanV[])
+{
+  tTimePoint TP0 = m_GatherTimeStats ? tClock::now() : tTimePoint();
+
+  for(xJFIF::xSOS& Scan : m_ScanScript)
+  {
+    const bool IsDC = Scan.getSpectralSelectionStart() == 0;
+
+    //scan specific Huffman tables (DC refinement scans contain raw bits only) - always emitted, default tables do not define EOB run symbols
+    if(!IsDC || Scan.getSuccessiveApproxHigh() == 0)
+    {
+      std::vector<xJFIF::xHuffTable> HuffTables;
+      for(int32 ScanCmpIdx = 0; ScanCmpIdx < Scan.getNumComponents(); ScanCmpIdx++)
+      {
+        const int32 HuffTableId = IsDC ? Scan.getHuffTableIdDC(eCmp(ScanCmpIdx)) : Scan.getHuffTableIdAC(eCmp(ScanCmpIdx));
+        if(std::any_of(HuffTables.cbegin(), HuffTables.cend(), [HuffTableId](const xJFIF::xHuffTable& HT) { return HT.getIdx() == HuffTableId; })) { continue; }
+        xJFIF::xHuffTable HuffTable;
+        HuffTable.setIdx  (HuffTableId);
+        HuffTable.setClass(IsDC ? xJFIF::xHuffTable::eHuffClass::DC : xJFIF::xHuffTable::eHuffClass::AC);
+        HuffTables.push_back(HuffTable);
+      }
+      xPrgEncScn(nullptr, CoeffsScanV, Scan);
+      m_EntropyEncPrg.BuildOptimalTables(HuffTables);
+      m_EntropyEncPrg.Init(HuffTables);
+      xJFIF::WriteDHT(OutputBuffer, HuffTables);
+    }
+
+    xJFIF::WriteSOS(OutputBuffer, Scan);
+    xPrgEncScn(OutputBuffer, CoeffsScanV, Scan);
+  }
+
+  if(m_GatherTimeStats) { m_TotalEntropyTime += tClock::now() - TP0; }
+}
+void xAdvancedEncoder::xPrgEncScn(xByteBuffer* OutputBuffer, const int16* CoeffsScanV[], const xJFIF::xSOS& Scan)
+{
+  m_EntropyEncPrg.StartScan(OutputBuffer, Scan);
+
+  if(Scan.getNumComponents() > 1) //interleaved (DC only) - MCU order, same as sequential mode
+  {
+    for(int32 MCU_Idx = 0; MCU_Idx < m_NumMCUsInArea; MCU_Idx++)
+    {
+      for(int32 ScanCmpIdx = 0; ScanCmpIdx < Scan.getNumComponents(); ScanCmpIdx++)
+      {
+        const int32 CmpIdx         = (int32)Scan.getCmpId(eCmp(ScanCmpIdx));
+        const int32 HuffTabIdDC    = Scan.getHuffTableIdDC(eCmp(ScanCmpIdx));
+        const int32 NumBlocksInMCU = m_SampFactorVer[CmpIdx] * m_SampFactorHor[CmpIdx];
+        const int32 BlockIdxFirst  = MCU_Idx * NumBlocksInMCU;
+        for(int32 BlockIdx = BlockIdxFirst; BlockIdx < BlockIdxFirst + NumBlocksInMCU; BlockIdx++)
+        {
+          m_EntropyEncPrg.EncodeBlock(CoeffsScanV[CmpIdx] + (BlockIdx << xJPEG_Constants::c_Log2BlockArea), eCmp(CmpIdx), HuffTabIdDC, 0);
+        }
+      }
+    }
+  }
+  else //non-interleaved (single component) - raster order of component blocks
+  {
+    const int32 CmpIdx      = (int32)Scan.getCmpId(eCmp::LM);
+    const int32 HuffTabIdDC = Scan.getHuffTableIdDC(eCmp::LM);
+    const int32 HuffTabIdAC = Scan.getHuffTableIdAC(eCmp::LM);
+
+    for(int32 BlockPosV = 0; BlockPosV < m_NumBlocksNonIntlvV[CmpIdx]; BlockPosV++)
+    {
+      for(int32 BlockPosH = 0; BlockPosH < m_NumBlocksNonIntlvH[CmpIdx]; BlockPosH++)
+      {
+        const int32 BlockIdx = xGetBlockIdxNonIntlv(CmpIdx, BlockPosH, BlockPosV);
+        m_EntropyEncPrg.EncodeBlock(CoeffsScanV[CmpIdx] + (BlockIdx << xJPEG_Constants::c_Log2BlockArea), eCmp(CmpIdx), HuffTabIdDC, HuffTabIdAC);
+      }
+    }
+  }
+
+  m_EntropyEncPrg.FinishScan();
+}
+
 //=====================================================================================================================================================================================
 
 } //end of namespace PMBB::JPEG
\ No newline at end of file
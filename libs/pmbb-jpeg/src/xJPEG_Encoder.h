@@ -9,10 +9,41 @@
 #include "xPicYUV.h"
 #include "xJPEG_Quant.h"
 #include "xJPEG_Entropy.h"
+#include "xJPEG_TransformConstants.h"
+#include "xThreadPool.h"
 #include <array>
+#include <mutex>
+#include <condition_variable>
 
 namespace PMBB_NAMESPACE::JPEG {
 
+//=====================================================================================================================================================================================
+// lambda reuse history - state left by frame N-1 is handed to encoder of frame N, independently of which encoder instance coded frame N-1
+//=====================================================================================================================================================================================
+
+class xLambdaHistory
+{
+public:
+  struct xState
+  {
+    flt64V4 Lambda  = { 1.0, 1.0, 1.0, 1.0 };
+    int32   Age     = 0; //number of frames coded with current estimate (0 = no valid estimate)
+    int64   RefBits = 0; //main point rate and distortion at last estimation
+    int64   RefDist = 0;
+  };
+
+protected:
+  std::mutex              m_Mutex;
+  std::condition_variable m_CondPublished;
+  int32                   m_NextFrameIdx = 0; //frame allowed to acquire state
+  xState                  m_State;
+
+public:
+  void   reset  ();
+  xState acquire(int32 FrameIdx); //blocks until all preceding frames published their state
+  void   publish(int32 FrameIdx, const xState& State);
+};
+
 //=====================================================================================================================================================================================
 
 class xAdvancedEncoder : public xCodecImplCommon
@@ -20,6 +51,11 @@ class xAdvancedEncoder : public xCodecImplCommon
 public:
   using tDistBits = std::tuple<int64V4, int64V4>;
 
+protected:
+  static constexpr int32 c_MCUsInBatch      = 4; //consecutive MCUs transformed at once - blocks of each component are passed to batched transform
+  static constexpr int32 c_MaxBlocksInMCU   = c_MSF * c_MSF; //max number of blocks of one component in single MCU
+  static constexpr int32 c_MaxBlocksInBatch = c_MCUsInBatch * c_MaxBlocksInMCU;
+
 protected:
   int32 m_Quality;
 
@@ -33,7 +69,27 @@ protected:
   bool    m_OptimizeChroma    = false;  
   bool    m_ProcessZeroCoeffs = false;
   int32   m_NumBlockOptPasses = 0;
+  eDstD   m_DistDomain        = eDstD::Pixel;
+  eRDOM   m_RDOQMode          = eRDOM::Greedy;
   flt64V4 m_Lambda            = { 1.0, 1.0, 1.0, 1.0 };
+  //lambda strategy
+  eLmbS   m_LambdaStrategy    = eLmbS::Estimate;
+  int32   m_LambdaMaxReuse    = 8;    //max number of frames coded with one estimate
+  flt64   m_LambdaMaxDrift    = 0.05; //relative change of main point rate or distortion forcing re-estimation
+  int32   m_LambdaAge         = 0;    //number of frames coded with current estimate (0 = no valid estimate)
+  int64   m_LambdaRefBits     = 0;    //main point rate and distortion at last estimation
+  int64   m_LambdaRefDist     = 0;
+  int32   m_LambdaSubsampling = 1;    //estimation on MCUs with (PosH - PosV) % Subsampling == 0 only (1 = entire picture)
+  xLambdaHistory* m_LambdaHistory  = nullptr; //reuse state shared with encoders of other frames (nullptr = own state only)
+  int32           m_LambdaFrameIdx = 0;
+  //Huffman tables optimization
+  bool    m_OptimizeHuffman   = false;
+  bool    m_HuffmanReRDOQ     = false; //second RDOQ iteration driven by optimized tables
+  //progressive mode (SOF2)
+  bool    m_Progressive       = false;
+  std::vector<xJFIF::xSOS> m_ScanScript;
+  //arithmetic coding mode (SOF9)
+  bool    m_Arithmetic        = false;
 
   //Tools
   xQuantizerSet     m_QuantMain;
@@ -41,19 +97,41 @@ protected:
   xQuantizerSet     m_QuantAuxI;
   xEntropyEncoder   m_EntropyEnc;
   xEntropyEstimator m_EntropyEst;
+  xEntropyEstimator m_EntropyEstAuxD; //lambda estimation operating points are evaluated concurrently
+  xEntropyEstimator m_EntropyEstAuxI;
+  xEntropyCounter   m_EntropyCnt;
+  xEntropyEncoderProgressive m_EntropyEncPrg;
+  xEntropyEncoderArith       m_EntropyEncAri;
+  std::vector<xJFIF::xHuffTable> m_HTDefault;
  
   //Buffers
   xPicYUV* m_PicYCbCr444 = nullptr;
   xPicYUV* m_PicYCbCr4XX = nullptr;
 
-  int16*  m_CmpCoeffsTransOrg[c_NC];
-  int16*  m_CmpCoeffsTransRec[c_NC];
-  int16*  m_CmpCoeffsScan    [c_NC];
-  int16*  m_CmpCoeffsScanAux [c_NC];
-  int16*  m_CmpCoeffsScanOpt [c_NC];
+  int16*  m_CmpCoeffsTransOrg    [c_NC];
+  int16*  m_CmpCoeffsTransRec    [c_NC];
+  int16*  m_CmpCoeffsTransRecAuxD[c_NC];
+  int16*  m_CmpCoeffsTransRecAuxI[c_NC];
+  int16*  m_CmpCoeffsScan        [c_NC];
+  int16*  m_CmpCoeffsScanAuxD    [c_NC];
+  int16*  m_CmpCoeffsScanAuxI    [c_NC];
+  int16*  m_CmpCoeffsScanOpt     [c_NC];
+  xBlockInfo* m_CmpBlockInfo     [c_NC]; //side info of m_CmpCoeffsScan    blocks - non-zero mask and cached rate
+  xBlockInfo* m_CmpBlockInfoOpt  [c_NC]; //side info of m_CmpCoeffsScanOpt blocks
   xPicYUV m_PicRec;
+  xPicYUV m_PicRecAuxD;
+  xPicYUV m_PicRecAuxI;
+
+  int32 m_MaxEncodedSliceSize = 0; //without stuffing
 
-  xByteBuffer m_EntropyBuffer;
+  //Multithreading
+  int32       m_NumThreads     = 1;
+  int32       m_NumSlices      = 0;
+  int32       m_NumSliceGroups = 0; //groups of consecutive slices entropy coded in parallel (only when RestartInterval != 0)
+  xThreadPool m_ThreadPool;
+  std::vector<xEntropyEncoder*> m_GroupEntropyEnc;
+  std::vector<xByteBuffer*    > m_GroupOutputBuffer;
+  std::vector<xEntropyEstimator*> m_ThreadEntropyEst; //one per pool thread
 
   //Profiling
   tDuration  m_TotalTransformTime = (tDuration)0;
@@ -61,7 +139,16 @@ protected:
   tDuration  m_TotalLambdaTime    = (tDuration)0;
   tDuration  m_TotalOptimizeTime  = (tDuration)0;
   tDuration  m_TotalEntropyTime   = (tDuration)0;
-  tDuration  m_TotalStuffingTime  = (tDuration)0;
+  int64      m_TotalLambdaEstIters = 0;
+
+  //Transform vs pixel domain distortion verification (eDstD::Verify)
+  std::mutex m_VerifyMutex;
+  int64      m_VerifyNumTrials  = 0;
+  int64      m_VerifySumDistPix = 0;
+  int64      m_VerifySumAbsDiff = 0;
+  int64      m_VerifyMaxAbsDiff = 0;
+  int64      m_VerifyNumBlocks  = 0;
+  int64      m_VerifyNumReverts = 0; //blocks rejected by final pixel domain check
 
 public:
   void   create (int32V2 PictureSize, eCrF ChromaFormat);
@@ -72,6 +159,15 @@ public:
   void   initEntropy    (int32 RestartInterval);
   void   setMarkerEmit  (bool EmitAPP0, bool EmitQuantTabs, bool EmitHuffmanTabs);
   void   setRDOQ        (bool OptimizeLuma, bool OptimizeChroma, bool ProcessZeroCoeffs, int32 NumBlockOptPasses);
+  void   setNumThreads  (int32 NumThreads);
+  void   setDistDomain  (eDstD DistDomain) { m_DistDomain = DistDomain; }
+  void   setRDOQMode    (eRDOM RDOQMode  ) { m_RDOQMode   = RDOQMode;   }
+  void   setLambdaStrategy(eLmbS LambdaStrategy, int32 MaxReuse, flt64 MaxDrift);
+  void   setLambdaSubsampling(int32 LambdaSubsampling) { m_LambdaSubsampling = xMax(LambdaSubsampling, 1); m_LambdaAge = 0; }
+  void   setLambdaHistory(xLambdaHistory* LambdaHistory, int32 FrameIdx) { m_LambdaHistory = LambdaHistory; m_LambdaFrameIdx = FrameIdx; } //has to be set for every frame coded with Reuse strategy
+  void   setHuffmanOptimization(bool OptimizeHuffman, bool HuffmanReRDOQ) { m_OptimizeHuffman = OptimizeHuffman; m_HuffmanReRDOQ = HuffmanReRDOQ; }
+  bool   setProgressive (bool Progressive, const std::string& ScanScript); //empty ScanScript - default script
+  void   setArithmetic  (bool Arithmetic) { m_Arithmetic = Arithmetic; } //ignored in progressive mode, Huffman tables optimization does not apply
   
   void   encode(const xPicYUV* InputPicture, xByteBuffer* OutputBuffer);
 
@@ -79,33 +175,65 @@ public:
 
   std::string formatAndResetStats(const std::string Prefix);
 
+  //progressive scan script - scans separated by ';', every scan as "Components:Ss-Se:Ah:Al" (i.e. "012:0-0:0:1;0:1-5:0:2")
+  static bool ParseScanScript      (std::vector<xJFIF::xSOS>& ScanScript, const std::string& ScanScriptS, int32 NumComponents);
+  static void InitDefaultScanScript(std::vector<xJFIF::xSOS>& ScanScript, int32 NumComponents);
+  static bool ValidateScanScript   (const std::vector<xJFIF::xSOS>& ScanScript, int32 NumComponents); //ITU T.81 G.1.1.1 - complete, every coefficient bit sent once
+
 protected:
   void    xEncodePicture  (xByteBuffer* Buffer, const xPicYUV* Picture);
   int64V4 xCalcPicSSDs    (const xPicYUV* Tst, const xPicYUV* Ref);
+  tDistBits xEvalOperatingPoint(int16* CoeffsScanV[], int16* CoeffsTransRecV[], xPicYUV* PicRec, xEntropyEstimator* EntropyEst, const xPicYUV* Picture, const xQuantizerSet& Quant, bool Quantize, xBlockInfo* BlockInfoV[] = nullptr);
+  tDistBits xEvalOperatingPointSparse(int16* CoeffsScanV[], xEntropyEstimator* EntropyEst, const xPicYUV* Picture, const xQuantizerSet& Quant, bool Quantize);
+
+  void    xUpdateLambda   (const xPicYUV* Picture);
+  void    xEstimateLambda (const xPicYUV* Picture);
+  static flt64V4 xCalcLambdaModel(int32 Quality);
+
+  void    xSetHuffTables    (const std::vector<xJFIF::xHuffTable>& HuffTables);
+  void    xOptimizeHuffTabs (const int16* CoeffsScanV[], const xBlockInfo* BlockInfoV[], const xPicYUV* Picture);
+  void    xCountSymbolsPic  (const int16* CoeffsScanV[], const xBlockInfo* BlockInfoV[]);
+  void    xTrainArithModel  (const int16* CoeffsScanV[], const xBlockInfo* BlockInfoV[]);
+
+  void    xInitThreading  ();
+  void    xCeaseThreading ();
 
   void xFwdTransformPic(int16* CoeffsTransV[], const xPicYUV* Picture);
-  void xFwdTransformMCU(int16* CoeffsTransV[], const uint16* CmpPtrV[], const int32 CmpStrideV[], int32 MCU_Idx);
-  void xInvTransformPic(xPicYUV* Picture, const int16* CoeffsTransV[]);
-  void xInvTransformMCU(uint16* CmpPtrV[], const int32 CmpStrideV[], const int16* CoeffsTransV[], int32 MCU_Idx);
+  void xFwdTransformMCU(int16* CoeffsTransV[], const uint16* CmpPtrV[], const int32 CmpStrideV[], int32 FirstMCU_Idx, int32 NumMCUs);
+  void xInvTransformPic(xPicYUV* Picture, const int16* CoeffsTransV[], const int16* CoeffsScanV[]);
+  void xInvTransformMCU(uint16* CmpPtrV[], const int32 CmpStrideV[], const int16* CoeffsTransV[], const int16* CoeffsScanV[], int32 FirstMCU_Idx, int32 NumMCUs);
 
-  void        xFwdQuantScanPic(int16* CoeffScanV [], const int16* CoeffTransV[], const xQuantizerSet& Quant);
-  static void xFwdQuantScanCmp(int16* CoeffScan    , const int16* CoeffTrans   , int32 NumBlocks, const xQuantizer& Quant);
+  void        xFwdTransformQuantScanPic(int16* CoeffScanV[], const xPicYUV* Picture, const xQuantizerSet& Quant, xBlockInfo* BlockInfoV[]); //fused path - no unquantized coeffs are stored
+  void        xFwdQuantScanPic(int16* CoeffScanV [], const int16* CoeffTransV[], const xQuantizerSet& Quant, xBlockInfo* BlockInfoV[] = nullptr);
+  static void xFwdQuantScanCmp(int16* CoeffScan    , const int16* CoeffTrans   , int32 NumBlocks, const xQuantizer& Quant, xBlockInfo* BlockInfo);
   void        xInvScanQuantPic(int16* CoeffTransV[], const int16* CoeffScanV[] , const xQuantizerSet& Quant);
   static void xInvScanQuantCmp(int16* CoeffTrans   , const int16* CoeffScan    , int32 NumBlocks, const xQuantizer& Quant);
 
-  int64V4 xHuffEstPic(const int16* CoeffsScanV[]);
-  int64V4 xHuffEstSlc(const int16* CoeffsScanV[], int32 MCU_IdxFirst, int32 MCU_IdxLast);
-  int64V4 xHuffEstMCU(const int16* CoeffsScanV[], int32 MCU_Idx);
-
-  void   xOptimizePic(int16* OptCoeffsScanV[], const int16* CoeffsScanV[], const xPicYUV* Picture);
-  void   xOptimizeSlc(int16* OptCoeffsScanV[], const int16* CoeffsScanV[], const xPicYUV* Picture, int32 MCU_IdxFirst, int32 MCU_IdxLast);
-  void   xOptimizeMCU(int16* OptCoeffsScanV[], const int16* CoeffsScanV[], const uint16* CmpPtrV[], const int32 CmpStrideV[], int32 MCU_Idx);
-  void   xOptimizeBLK(int16* OptCoeffScan, const int16* CoeffsScan, const uint16* SamplesOrg, eCmp CmpId);
-  uint64 xCalcDistBLK(const int16* ScanCoeffs, const uint16* SamplesOrg, int32 QuantTabId);
-
-  void xHuffEncPic(xByteBuffer* OutputBuffer, const int16* CoeffsScanV[]);
-  void xHuffEncSlc(xByteBuffer* OutputBuffer, const int16* CoeffsScanV[], int32 MCU_IdxFirst, int32 MCU_IdxLast);
-  void xHuffEncMCU(const int16* CoeffsScanV[], int32 MCU_Idx);
+  int64V4 xHuffEstPic(xEntropyEstimator* EntropyEst, const int16* CoeffsScanV[], xBlockInfo* BlockInfoV[]); //BlockInfoV != nullptr - rate is taken from and cached in block info
+  int64V4 xHuffEstSlc(xEntropyEstimator* EntropyEst, const int16* CoeffsScanV[], xBlockInfo* BlockInfoV[], int32 MCU_IdxFirst, int32 MCU_IdxLast);
+  int64V4 xHuffEstMCU(xEntropyEstimator* EntropyEst, const int16* CoeffsScanV[], xBlockInfo* BlockInfoV[], int32 MCU_Idx);
+
+  void   xOptimizePic(int16* OptCoeffsScanV[], xBlockInfo* OptBlockInfoV[], const int16* CoeffsScanV[], const xBlockInfo* BlockInfoV[], const xPicYUV* Picture);
+  void   xOptimizeBnd(xEntropyEstimator* EntropyEst, int16* OptCoeffsScanV[], xBlockInfo* OptBlockInfoV[], const int16* CoeffsScanV[], const xBlockInfo* BlockInfoV[], const xPicYUV* Picture, int32 MCU_IdxFirst, int32 MCU_IdxLast);
+  void   xOptimizeMCU(xEntropyEstimator* EntropyEst, int16* OptCoeffsScanV[], xBlockInfo* OptBlockInfoV[], const int16* CoeffsScanV[], const xBlockInfo* BlockInfoV[], const uint16* CmpPtrV[], const int32 CmpStrideV[], int32 MCU_Idx);
+  void   xOptimizeBLK(xEntropyEstimator* EntropyEst, int16* OptCoeffScan, xBlockInfo& OptInfo, const int16* CoeffsScan, const xBlockInfo& Info, const int16* CoeffsTrans, const uint16* SamplesOrg, eCmp CmpId);
+  void   xTrellisBLK (xEntropyEstimator* EntropyEst, int16* OptCoeffScan, xBlockInfo& OptInfo, const int16* CoeffsScan, const xBlockInfo& Info, const int16* CoeffsTrans, const uint16* SamplesOrg, eCmp CmpId);
+  uint64 xCalcDistBLK(const int16* ScanCoeffs, const uint16* SamplesOrg, int32 QuantTabId, int32 LastPos) { return xCalcDistBLK(ScanCoeffs, SamplesOrg, QuantTabId, LastPos, m_QuantMain); }
+  uint64 xCalcDistBLK(const int16* ScanCoeffs, const uint16* SamplesOrg, int32 QuantTabId, int32 LastPos, const xQuantizerSet& Quant); //LastPos - last nonzero coeff position (or its upper bound)
+  static uint64 xCalcDistPartBLK(const int16* ScanCoeffs, const uint16* SamplesOrg, int32 QuantTabId, int32 Width, int32 Height, const xQuantizerSet& Quant); //top-left Width x Height samples of block (picture edge)
+  static int64 xCalcDistTrnBLK(const int16* ScanCoeffs, const int16* ScanTrans, const uint16* ScanStep);
+  static int64 xCalcDistTrnCoeff(int16 ScanCoeff, int16 ScanTrans, uint16 ScanStep) { int64 Err = (int64)ScanTrans - (((int64)ScanStep * (int64)ScanCoeff) << xTransformConstants::c_Headroom); return Err * Err; }
+
+  void xHuffEncPic(xByteBuffer* OutputBuffer, const int16* CoeffsScanV[], const xBlockInfo* BlockInfoV[]);
+  void xHuffEncGrp(xByteBuffer* OutputBuffer, const int16* CoeffsScanV[], const xBlockInfo* BlockInfoV[], int32 SliceIdxFirst, int32 SliceIdxLast, xEntropyEncoder* EntropyEnc, tDuration& EntropyTime);
+  void xHuffEncSlc(xByteBuffer* OutputBuffer, const int16* CoeffsScanV[], const xBlockInfo* BlockInfoV[], int32 MCU_IdxFirst, int32 MCU_IdxLast, xEntropyEncoder* EntropyEnc, tDuration& EntropyTime);
+  void xHuffEncMCU(xEntropyEncoder* EntropyEnc, const int16* CoeffsScanV[], const xBlockInfo* BlockInfoV[], int32 MCU_Idx);
+
+  void xPrgEncPic(xByteBuffer* OutputBuffer, const int16* CoeffsScanV[]);
+  void xPrgEncScn(xByteBuffer* OutputBuffer, const int16* CoeffsScanV[], const xJFIF::xSOS& Scan); //OutputBuffer == nullptr - gather symbol statistics only
+
+  void xAriEncPic(xByteBuffer* OutputBuffer, const int16* CoeffsScanV[], const xBlockInfo* BlockInfoV[]); //OutputBuffer == nullptr - count binary decisions only
+  void xAriEncMCU(const int16* CoeffsScanV[], const xBlockInfo* BlockInfoV[], int32 MCU_Idx);
 };
 
 //=====================================================================================================================================================================================
@@ -4,6 +4,7 @@
 */
 #include "xJPEG_Entropy.h"
 #include "xJPEG_HuffmanDefault.h"
+#include "xHelpersSIMD.h"
 
 namespace PMBB_NAMESPACE::JPEG {
 
@@ -30,6 +31,115 @@ int32 xEntropyCommon::findLastNonZeroSTD(const int16* ScanCoeff)
   return 0;
 }
 
+#if X_SIMD_CAN_USE_AVX512
+uint64 xEntropyCommon::extractSymbolsAVX512(const int16* ScanCoeff, int32* restrict NumBits, int32* restrict Remain)
+{
+  const __m512i Zero    = _mm512_setzero_si512();
+  const __m512i AllOnes = _mm512_set1_epi32(-1);
+  const __m512i Const32 = _mm512_set1_epi32(32);
+
+  //non-zero mask
+  uint64 MaskV0 = _mm512_cmpneq_epi16_mask(_mm512_loadu_si512((__m512i*)(ScanCoeff     )), Zero);
+  uint64 MaskV1 = _mm512_cmpneq_epi16_mask(_mm512_loadu_si512((__m512i*)(ScanCoeff + 32)), Zero);
+
+  //magnitude categories and remainders
+  for(int32 i = 0; i < xJPEG_Constants::c_BlockArea; i += 16)
+  {
+    __m512i CoeffV  = _mm512_cvtepi16_epi32(_mm256_loadu_si256((__m256i*)(ScanCoeff + i)));
+    __m512i LzcntV  = _mm512_lzcnt_epi32(_mm512_abs_epi32(CoeffV));
+    __m512i BitsV   = _mm512_sub_epi32(Const32, LzcntV);
+    __m512i RemMskV = _mm512_srlv_epi32(AllOnes, LzcntV); //shift by 32 gives 0
+    __m512i RemainV = _mm512_and_si512(_mm512_add_epi32(CoeffV, _mm512_srai_epi32(CoeffV, 31)), RemMskV); //subtract one if value was negative and mask off any extra bits
+    _mm512_storeu_si512((__m512i*)(NumBits + i), BitsV  );
+    _mm512_storeu_si512((__m512i*)(Remain  + i), RemainV);
+  }
+
+  return (MaskV1 << 32) | MaskV0;
+}
+#endif //X_SIMD_CAN_USE_AVX512
+
+#if X_SIMD_CAN_USE_AVX
+uint64 xEntropyCommon::extractSymbolsAVX(const int16* ScanCoeff, int32* restrict NumBits, int32* restrict Remain)
+{
+  const __m256i Zero     = _mm256_setzero_si256();
+  const __m256i AllOnes  = _mm256_set1_epi32(-1);
+  const __m256i Const32  = _mm256_set1_epi32(32);
+  const __m256i ExpBias  = _mm256_set1_epi32(126);
+
+  //non-zero mask - pack 16bit compare results to bytes (packs interleaves 128bit lanes, permute restores order)
+  __m256i CoeffV0 = _mm256_loadu_si256((__m256i*)(ScanCoeff     ));
+  __m256i CoeffV1 = _mm256_loadu_si256((__m256i*)(ScanCoeff + 16));
+  __m256i CoeffV2 = _mm256_loadu_si256((__m256i*)(ScanCoeff + 32));
+  __m256i CoeffV3 = _mm256_loadu_si256((__m256i*)(ScanCoeff + 48));
+  __m256i ZeroV01 = _mm256_permute4x64_epi64(_mm256_packs_epi16(_mm256_cmpeq_epi16(CoeffV0, Zero), _mm256_cmpeq_epi16(CoeffV1, Zero)), 0xD8);
+  __m256i ZeroV23 = _mm256_permute4x64_epi64(_mm256_packs_epi16(_mm256_cmpeq_epi16(CoeffV2, Zero), _mm256_cmpeq_epi16(CoeffV3, Zero)), 0xD8);
+  uint64  MaskV01 = (uint32)~_mm256_movemask_epi8(ZeroV01);
+  uint64  MaskV23 = (uint32)~_mm256_movemask_epi8(ZeroV23);
+
+  //magnitude categories and remainders - no vector lzcnt in AVX2, magnitude category is taken from exponent of exactly converted float (zero gives negative value clamped to 0)
+  for(int32 i = 0; i < xJPEG_Constants::c_BlockArea; i += 8)
+  {
+    __m256i CoeffV  = _mm256_cvtepi16_epi32(_mm_loadu_si128((__m128i*)(ScanCoeff + i)));
+    __m256i ExpV    = _mm256_srli_epi32(_mm256_castps_si256(_mm256_cvtepi32_ps(_mm256_abs_epi32(CoeffV))), 23);
+    __m256i BitsV   = _mm256_max_epi32(_mm256_sub_epi32(ExpV, ExpBias), Zero);
+    __m256i RemMskV = _mm256_srlv_epi32(AllOnes, _mm256_sub_epi32(Const32, BitsV)); //shift by 32 gives 0
+    __m256i RemainV = _mm256_and_si256(_mm256_add_epi32(CoeffV, _mm256_srai_epi32(CoeffV, 31)), RemMskV); //subtract one if value was negative and mask off any extra bits
+    _mm256_storeu_si256((__m256i*)(NumBits + i), BitsV  );
+    _mm256_storeu_si256((__m256i*)(Remain  + i), RemainV);
+  }
+
+  return (MaskV23 << 32) | MaskV01;
+}
+#endif //X_SIMD_CAN_USE_AVX
+
+uint64 xEntropyCommon::extractSymbolsSTD(const int16* ScanCoeff, int32* restrict NumBits, int32* restrict Remain)
+{
+  uint64 NonZeroMask = 0;
+  for(int32 i = 0; i < xJPEG_Constants::c_BlockArea; i++)
+  {
+    int32 Coeff    = ScanCoeff[i];
+    int32 SignMask = Coeff >> 31;
+    int32 NumBitsC = xNumBits((Coeff ^ SignMask) - SignMask);
+    NumBits[i]     = NumBitsC;
+    Remain [i]     = (Coeff + SignMask) & ((1 << NumBitsC) - 1);
+    NonZeroMask   |= (uint64)(Coeff != 0) << i;
+  }
+  return NonZeroMask;
+}
+
+#if X_SIMD_CAN_USE_AVX512
+uint64 xEntropyCommon::calcNonZeroMaskAVX512(const int16* ScanCoeff)
+{
+  uint64 MaskV0 = _mm512_cmpneq_epi16_mask(_mm512_loadu_si512((__m512i*)(ScanCoeff     )), _mm512_setzero_si512());
+  uint64 MaskV1 = _mm512_cmpneq_epi16_mask(_mm512_loadu_si512((__m512i*)(ScanCoeff + 32)), _mm512_setzero_si512());
+  return (MaskV1 << 32) | MaskV0;
+}
+#endif //X_SIMD_CAN_USE_AVX512
+
+#if X_SIMD_CAN_USE_AVX
+uint64 xEntropyCommon::calcNonZeroMaskAVX(const int16* ScanCoeff)
+{
+  const __m256i Zero = _mm256_setzero_si256();
+  //pack 16bit compare results to bytes (packs interleaves 128bit lanes, permute restores order)
+  __m256i CoeffV0 = _mm256_loadu_si256((__m256i*)(ScanCoeff     ));
+  __m256i CoeffV1 = _mm256_loadu_si256((__m256i*)(ScanCoeff + 16));
+  __m256i CoeffV2 = _mm256_loadu_si256((__m256i*)(ScanCoeff + 32));
+  __m256i CoeffV3 = _mm256_loadu_si256((__m256i*)(ScanCoeff + 48));
+  __m256i ZeroV01 = _mm256_permute4x64_epi64(_mm256_packs_epi16(_mm256_cmpeq_epi16(CoeffV0, Zero), _mm256_cmpeq_epi16(CoeffV1, Zero)), 0xD8);
+  __m256i ZeroV23 = _mm256_permute4x64_epi64(_mm256_packs_epi16(_mm256_cmpeq_epi16(CoeffV2, Zero), _mm256_cmpeq_epi16(CoeffV3, Zero)), 0xD8);
+  uint64  MaskV01 = (uint32)~_mm256_movemask_epi8(ZeroV01);
+  uint64  MaskV23 = (uint32)~_mm256_movemask_epi8(ZeroV23);
+  return (MaskV23 << 32) | MaskV01;
+}
+#endif //X_SIMD_CAN_USE_AVX
+
+uint64 xEntropyCommon::calcNonZeroMaskSTD(const int16* ScanCoeff)
+{
+  uint64 NonZeroMask = 0;
+  for(int32 i = 0; i < xJPEG_Constants::c_BlockArea; i++) { NonZeroMask |= (uint64)(ScanCoeff[i] != 0) << i; }
+  return NonZeroMask;
+}
+
 //=====================================================================================================================================================================================
 
 bool xEntropyDecoder::Init(std::vector<xJFIF::xHuffTable>& HuffTables)
@@ -88,14 +198,14 @@ void xEntropyDecoder::DecodeBlock(int16* ScanCoeff, eCmp Cmp, int32 HuffTableIdD
   xHuffDecoder* HD = m_HuffDecoderAC[HuffTableIdAC];
   for(int32 i=1; i < 64; i++)
   {
-    int32 AC = HD->readPrefix(&m_Bitstream);
-    int32 R = AC >> 4;
-    int32 V = AC & 0x0F;
+    int32 AC;
+    int32 Symbol = HD->readSymbol(&m_Bitstream, AC); //run/size with magnitude bits
+    int32 R = Symbol >> 4;
+    int32 V = Symbol & 0x0F;
 
     if(V)
     {
       i += R;
-      AC = HD->readSufix(&m_Bitstream, V);
       ScanCoeff[i] = (int16)AC;
     }
     else
@@ -108,6 +218,203 @@ void xEntropyDecoder::DecodeBlock(int16* ScanCoeff, eCmp Cmp, int32 HuffTableIdD
 
 //=====================================================================================================================================================================================
 
+bool xEntropyDecoderProgressive::Init(std::vector<xJFIF::xHuffTable>& HuffTables)
+{
+  bool Result = true;
+  for(xJFIF::xHuffTable& HuffTable : HuffTables)
+  {
+    xJFIF::xHuffTable::eHuffClass HuffTableClass = HuffTable.getClass();
+    int32                         HuffTableId    = HuffTable.getIdx  ();
+    switch(HuffTableClass)
+    {
+      case xJFIF::xHuffTable::eHuffClass::DC:
+        if(m_HuffDecoderDC[HuffTableId] == nullptr) { m_HuffDecoderDC[HuffTableId] = new xHuffDecoder; }
+        Result &= m_HuffDecoderDC[HuffTableId]->init(HuffTable);
+        break;
+      case xJFIF::xHuffTable::eHuffClass::AC:
+        if(m_HuffDecoderAC[HuffTableId] == nullptr) { m_HuffDecoderAC[HuffTableId] = new xHuffDecoder; }
+        Result &= m_HuffDecoderAC[HuffTableId]->init(HuffTable);
+        break;
+      default: Result = false; break;
+    }
+  }
+  return Result;
+}
+void xEntropyDecoderProgressive::UnInit()
+{
+  for(int32 HuffTableId=0; HuffTableId < xJPEG_Constants::c_MaxHuffTabs; HuffTableId++)
+  {
+    if(m_HuffDecoderDC[HuffTableId] != nullptr) { delete m_HuffDecoderDC[HuffTableId]; m_HuffDecoderDC[HuffTableId] = nullptr; }
+    if(m_HuffDecoderAC[HuffTableId] != nullptr) { delete m_HuffDecoderAC[HuffTableId]; m_HuffDecoderAC[HuffTableId] = nullptr; }
+  }
+}
+void xEntropyDecoderProgressive::StartScan(xByteBuffer* ByteBuffer, const xJFIF::xSOS& Scan)
+{
+  xResetLastDC();
+  m_SpectralStart = Scan.getSpectralSelectionStart();
+  m_SpectralEnd   = Scan.getSpectralSelectionEnd  ();
+  m_ApproxHigh    = Scan.getSuccessiveApproxHigh  ();
+  m_ApproxLow     = Scan.getSuccessiveApproxLow   ();
+  m_EOBRun        = 0;
+  m_Bitstream.bindByteBuffer(ByteBuffer);
+  m_Bitstream.init();
+}
+void xEntropyDecoderProgressive::FinishScan()
+{
+  m_Bitstream.readAlign();
+  m_Bitstream.uninit();
+  m_Bitstream.unbindByteBuffer();
+}
+void xEntropyDecoderProgressive::DecodeBlock(int16* ScanCoeff, eCmp Cmp, int32 HuffTableIdDC, int32 HuffTableIdAC)
+{
+  if(m_SpectralStart == 0) { if(m_ApproxHigh == 0) { xDecodeDCFirst(ScanCoeff, Cmp, HuffTableIdDC); } else { xDecodeDCRefine(ScanCoeff); } }
+  else                     { if(m_ApproxHigh == 0) { xDecodeACFirst(ScanCoeff, HuffTableIdAC     ); } else { xDecodeACRefine(ScanCoeff, HuffTableIdAC); } }
+}
+void xEntropyDecoderProgressive::xDecodeDCFirst(int16* ScanCoeff, eCmp Cmp, int32 HuffTableIdDC)
+{
+  int32 DeltaDC        = m_HuffDecoderDC[HuffTableIdDC]->readDC(&m_Bitstream);
+  int32 DC             = DeltaDC + (int32)m_LastDC[(int32)Cmp];
+  m_LastDC[(int32)Cmp] = (int16)DC;
+  ScanCoeff[0]         = (int16)(DC * (1 << m_ApproxLow));
+}
+void xEntropyDecoderProgressive::xDecodeDCRefine(int16* ScanCoeff)
+{
+  if(m_Bitstream.readBits(1)) { ScanCoeff[0] |= (int16)(1 << m_ApproxLow); }
+}
+void xEntropyDecoderProgressive::xDecodeACFirst(int16* ScanCoeff, int32 HuffTableIdAC)
+{
+  if(m_EOBRun > 0) { m_EOBRun--; return; } //block is a part of end-of-band run
+
+  xHuffDecoder* HD = m_HuffDecoderAC[HuffTableIdAC];
+  for(int32 k = m_SpectralStart; k <= m_SpectralEnd; k++)
+  {
+    int32 AC;
+    int32 Symbol = HD->readSymbol(&m_Bitstream, AC); //run/size with magnitude bits
+    int32 R = Symbol >> 4;
+    int32 V = Symbol & 0x0F;
+
+    if(V)
+    {
+      k += R;
+      ScanCoeff[k] = (int16)(AC * (1 << m_ApproxLow));
+    }
+    else
+    {
+      if(R != 15) { m_EOBRun = (1 << R) - 1 + (R ? (int32)m_Bitstream.readBits(R) : 0); break; } //EOBn - current block included
+      k += 15;
+    }
+  }
+}
+void xEntropyDecoderProgressive::xDecodeACRefine(int16* ScanCoeff, int32 HuffTableIdAC)
+{
+  const int32 P1 =  (1 << m_ApproxLow);
+  const int32 M1 = -(1 << m_ApproxLow);
+
+  //every already non-zero coefficient gets correction bit
+  auto RefineCoeff = [&](int16& Coeff) { if(m_Bitstream.readBits(1) && (Coeff & P1) == 0) { Coeff = (int16)(Coeff + (Coeff >= 0 ? P1 : M1)); } };
+
+  int32 k = m_SpectralStart;
+  if(m_EOBRun == 0)
+  {
+    xHuffDecoder* HD = m_HuffDecoderAC[HuffTableIdAC];
+    for(; k <= m_SpectralEnd; k++)
+    {
+      int32 Sign;
+      int32 Symbol   = HD->readSymbol(&m_Bitstream, Sign); //newly non-zero coefficient has magnitude category 1 - single bit is the sign
+      int32 R        = Symbol >> 4;
+      int32 V        = Symbol & 0x0F;
+      int32 NewCoeff = 0;
+
+      if(V) { NewCoeff = Sign > 0 ? P1 : M1; }
+      else if(R != 15) { m_EOBRun = (1 << R) + (R ? (int32)m_Bitstream.readBits(R) : 0); break; } //EOBn - remaining part of band is coded as end-of-band run
+
+      //skip R zero coefficients (refining non-zero ones on the way), stop at position of new coefficient
+      for(; k <= m_SpectralEnd; k++)
+      {
+        if(ScanCoeff[k] != 0) { RefineCoeff(ScanCoeff[k]); }
+        else if(--R < 0) { break; }
+      }
+      if(NewCoeff && k <= m_SpectralEnd) { ScanCoeff[k] = (int16)NewCoeff; }
+    }
+  }
+
+  if(m_EOBRun > 0)
+  {
+    for(; k <= m_SpectralEnd; k++) { if(ScanCoeff[k] != 0) { RefineCoeff(ScanCoeff[k]); } }
+    m_EOBRun--;
+  }
+}
+
+//=====================================================================================================================================================================================
+
+void xEntropyDecoderArith::StartSlice(xByteBuffer* ByteBuffer)
+{
+  xResetLastDC();
+  memset(m_StatsDC  , 0, sizeof(m_StatsDC  ));
+  memset(m_StatsAC  , 0, sizeof(m_StatsAC  ));
+  memset(m_ContextDC, 0, sizeof(m_ContextDC));
+  m_ArithDecoder.init(ByteBuffer);
+}
+void xEntropyDecoderArith::FinishSlice()
+{
+  m_ArithDecoder.finish();
+}
+void xEntropyDecoderArith::DecodeBlock(int16* ScanCoeff, eCmp Cmp, int32 ArithTableIdDC, int32 ArithTableIdAC)
+{
+  memset(ScanCoeff, 0, xJPEG_Constants::c_BlockArea * sizeof(int16));
+
+  //DC coefficient - ITU T.81 F.2.4.1
+  uint8* StatsDC = m_StatsDC[ArithTableIdDC];
+  int32  St      = m_ContextDC[(int32)Cmp];
+  int32  DeltaDC = 0;
+  if(m_ArithDecoder.decodeBit(StatsDC[St]) == 0) { m_ContextDC[(int32)Cmp] = 0; }
+  else
+  {
+    const int32 Sign = m_ArithDecoder.decodeBit(StatsDC[St + 1]);
+    St += 2 + Sign;
+    int32 M = m_ArithDecoder.decodeBit(StatsDC[St]);
+    if(M != 0)
+    {
+      St = xArithCommon::c_OffsetX1DC;
+      while(m_ArithDecoder.decodeBit(StatsDC[St])) { if((M <<= 1) == 0x8000) { break; } St++; } //0x8000 - corrupted data
+    }
+    m_ContextDC[(int32)Cmp] = (uint8)xArithCommon::NextContextDC(Sign, M);
+    int32 V = M;
+    St += xArithCommon::c_OffsetM;
+    while(M >>= 1) { if(m_ArithDecoder.decodeBit(StatsDC[St])) { V |= M; } }
+    V += 1;
+    DeltaDC = Sign ? -V : V;
+  }
+  int16 DC             = (int16)(DeltaDC + (int32)m_LastDC[(int32)Cmp]);
+  m_LastDC[(int32)Cmp] = (int16)DC;
+  ScanCoeff[0] = DC;
+
+  //AC coefficients - ITU T.81 F.2.4.2
+  uint8* StatsAC = m_StatsAC[ArithTableIdAC];
+  for(int32 k = 1; k < xJPEG_Constants::c_BlockArea; k++)
+  {
+    St = 3 * (k - 1);
+    if(m_ArithDecoder.decodeBit(StatsAC[St])) { break; } //EOB
+    while(m_ArithDecoder.decodeBit(StatsAC[St + 1]) == 0) { St += 3; if(++k >= xJPEG_Constants::c_BlockArea) { return; } } //run past last coefficient - corrupted data
+    const int32 Sign = m_ArithDecoder.decodeBit(m_StatFixed);
+    St += 2;
+    int32 M = m_ArithDecoder.decodeBit(StatsAC[St]);
+    if(M != 0 && m_ArithDecoder.decodeBit(StatsAC[St]))
+    {
+      M <<= 1;
+      St = k <= xArithCommon::c_DefaultKx ? xArithCommon::c_OffsetX2LowAC : xArithCommon::c_OffsetX2HighAC;
+      while(m_ArithDecoder.decodeBit(StatsAC[St])) { if((M <<= 1) == 0x8000) { break; } St++; } //0x8000 - corrupted data
+    }
+    int32 V = M;
+    St += xArithCommon::c_OffsetM;
+    while(M >>= 1) { if(m_ArithDecoder.decodeBit(StatsAC[St])) { V |= M; } }
+    V += 1;
+    ScanCoeff[k] = (int16)(Sign ? -V : V);
+  }
+}
+
+//=====================================================================================================================================================================================
+
 bool xEntropyEncoder::Init(std::vector<xJFIF::xHuffTable>& HuffTables)
 {
   bool Result = true;
@@ -150,10 +457,8 @@ void xEntropyEncoder::FinishSlice()
   m_Bitstream.uninit();
   m_Bitstream.unbindByteBuffer();
 }
-void xEntropyEncoder::EncodeBlock(const int16* ScanCoeff, eCmp Cmp, int32 HuffTableIdDC, int32 HuffTableIdAC)
+void xEntropyEncoder::xEncodeDC(int32 DC, eCmp Cmp, int32 HuffTableIdDC)
 {
-  //DC coefficient
-  int32 DC             = ScanCoeff[0];
   int32 DeltaDC        = DC - (int32)m_LastDC[(int32)Cmp];
   m_LastDC[(int32)Cmp] = (int16)DC;
 
@@ -162,34 +467,345 @@ void xEntropyEncoder::EncodeBlock(const int16* ScanCoeff, eCmp Cmp, int32 HuffTa
   int32 NumBitsDC  = xNumBits(AbsDeltaDC);
   int32 RemainDC   = (DeltaDC + SignMaskDC) & ((1 << NumBitsDC) - 1);  // subtract one if value was negative and mask off any extra bits in code
   m_HuffEncoderDC[HuffTableIdDC]->writeDC(&m_Bitstream, NumBitsDC, RemainDC);
-
-  //AC coefficients
-  xHuffEncoderAC* HE = m_HuffEncoderAC[HuffTableIdAC];
-  int32 LastNonZero = findLastNonZero(ScanCoeff);
-  int32 RunLength   = 0;
-  for(int32 i=1; i <= LastNonZero; i++)
+}
+void xEntropyEncoder::EncodeBlock(const int16* ScanCoeff, eCmp Cmp, int32 HuffTableIdDC, int32 HuffTableIdAC)
+{
+  //DC coefficient
+  xEncodeDC(ScanCoeff[0], Cmp, HuffTableIdDC);
+
+  //AC coefficients - runs are taken directly from non-zero mask
+  alignas(64) int32 NumBits[xJPEG_Constants::c_BlockArea];
+  alignas(64) int32 Remain [xJPEG_Constants::c_BlockArea];
+  xHuffEncoderAC* HE          = m_HuffEncoderAC[HuffTableIdAC];
+  uint64          NonZeroMask = extractSymbols(ScanCoeff, NumBits, Remain) & ~(uint64)1;
+  int32           LastPos     = 0;
+  while(NonZeroMask)
   {
-    int32 AC = ScanCoeff[i];
-
-    //nothing to encode
-    if(AC == 0) { RunLength++; continue; }
+    int32 Pos       = (int32)xTZCNT(NonZeroMask);
+    int32 RunLength = Pos - LastPos - 1;
+    NonZeroMask    &= NonZeroMask - 1;
+    LastPos         = Pos;
 
     //if run length > 15, must emit special run-length-16 codes (0xF0)
     while (RunLength > 15) { HE->writeZRL(&m_Bitstream); RunLength -= 16; }
 
     //Emit Huffman symbol for run length / number of bits
-    int32 SignMaskAC = AC >> 31;                       // make a mask of the sign bit
-    int32 AbsAC      = (AC ^ SignMaskAC) - SignMaskAC; // toggle the bits and add one if value is negative
-    int32 NumBitsAC  = xNumBits(AbsAC);
-    int32 CodeAC     = (RunLength << 4) + NumBitsAC;
-    int32 RemainAC   = (AC + SignMaskAC) & ((1 << NumBitsAC) - 1);  // subtract one if value was negative and mask off any extra bits in code
-    HE->writeAC(&m_Bitstream, CodeAC, NumBitsAC, RemainAC);
+    HE->writeAC(&m_Bitstream, (RunLength << 4) + NumBits[Pos], NumBits[Pos], Remain[Pos]);
+  }
+  //If the last coef(s) were zero, emit an end-of-block code
+  if (LastPos < 63) { HE->writeEOB(&m_Bitstream); }
+}
+void xEntropyEncoder::EncodeBlock(const int16* ScanCoeff, const xBlockInfo& Info, eCmp Cmp, int32 HuffTableIdDC, int32 HuffTableIdAC)
+{
+  //DC coefficient
+  xEncodeDC(ScanCoeff[0], Cmp, HuffTableIdDC);
 
-    //reset run length
+  //AC coefficients - magnitude categories and remainders of non-zero coefficients only
+  xHuffEncoderAC* HE          = m_HuffEncoderAC[HuffTableIdAC];
+  uint64          NonZeroMask = Info.getACMask();
+  int32           LastPos     = 0;
+  while(NonZeroMask)
+  {
+    int32 Pos       = (int32)xTZCNT(NonZeroMask);
+    int32 RunLength = Pos - LastPos - 1;
+    NonZeroMask    &= NonZeroMask - 1;
+    LastPos         = Pos;
+
+    int32 AC       = ScanCoeff[Pos];
+    int32 SignMask = AC >> 31;
+    int32 NumBits  = xNumBits((AC ^ SignMask) - SignMask);
+    int32 Remain   = (AC + SignMask) & ((1 << NumBits) - 1);
+
+    while (RunLength > 15) { HE->writeZRL(&m_Bitstream); RunLength -= 16; }
+    HE->writeAC(&m_Bitstream, (RunLength << 4) + NumBits, NumBits, Remain);
+  }
+  if (LastPos < 63) { HE->writeEOB(&m_Bitstream); }
+}
+
+//=====================================================================================================================================================================================
+
+bool xEntropyEncoderProgressive::Init(std::vector<xJFIF::xHuffTable>& HuffTables)
+{
+  bool Result = true;
+  for(xJFIF::xHuffTable& HuffTable : HuffTables)
+  {
+    xJFIF::xHuffTable::eHuffClass HuffTableClass = HuffTable.getClass();
+    int32                         HuffTableId    = HuffTable.getIdx  ();
+    switch(HuffTableClass)
+    {
+      case xJFIF::xHuffTable::eHuffClass::DC:
+        if(m_HuffEncoderDC[HuffTableId] == nullptr) { m_HuffEncoderDC[HuffTableId] = new xHuffEncoderDC; }
+        Result &= m_HuffEncoderDC[HuffTableId]->init(HuffTable);
+        break;
+      case xJFIF::xHuffTable::eHuffClass::AC:
+        if(m_HuffEncoderAC[HuffTableId] == nullptr) { m_HuffEncoderAC[HuffTableId] = new xHuffEncoderAC; }
+        Result &= m_HuffEncoderAC[HuffTableId]->init(HuffTable);
+        break;
+      default: Result = false; break;
+    }
+  }
+  return Result;
+}
+void xEntropyEncoderProgressive::UnInit()
+{
+  for(int32 HuffTableId=0; HuffTableId < xJPEG_Constants::c_MaxHuffTabs; HuffTableId++)
+  {
+    if(m_HuffEncoderDC[HuffTableId] != nullptr) { delete m_HuffEncoderDC[HuffTableId]; m_HuffEncoderDC[HuffTableId] = nullptr; }
+    if(m_HuffEncoderAC[HuffTableId] != nullptr) { delete m_HuffEncoderAC[HuffTableId]; m_HuffEncoderAC[HuffTableId] = nullptr; }
+  }
+}
+void xEntropyEncoderProgressive::StartScan(xByteBuffer* ByteBuffer, const xJFIF::xSOS& Scan)
+{
+  xResetLastDC();
+  m_SpectralStart = Scan.getSpectralSelectionStart();
+  m_SpectralEnd   = Scan.getSpectralSelectionEnd  ();
+  m_ApproxHigh    = Scan.getSuccessiveApproxHigh  ();
+  m_ApproxLow     = Scan.getSuccessiveApproxLow   ();
+  m_EOBRun        = 0;
+  m_EOBRunTabId   = 0;
+  m_NumCorrBits   = 0;
+  m_GatherStats   = ByteBuffer == nullptr;
+
+  if(m_GatherStats)
+  {
+    for(int32 HuffTableId=0; HuffTableId < xJPEG_Constants::c_MaxHuffTabs; HuffTableId++) { m_HuffCounterDC[HuffTableId].init(); m_HuffCounterAC[HuffTableId].init(); }
+  }
+  else
+  {
+    m_Bitstream.bindByteBuffer(ByteBuffer);
+    m_Bitstream.init();
+  }
+}
+void xEntropyEncoderProgressive::FinishScan()
+{
+  xFlushEOBRun();
+  if(m_GatherStats) { return; }
+  m_Bitstream.writeAlign(1);
+  m_Bitstream.uninit();
+  m_Bitstream.unbindByteBuffer();
+}
+void xEntropyEncoderProgressive::EncodeBlock(const int16* ScanCoeff, eCmp Cmp, int32 HuffTableIdDC, int32 HuffTableIdAC)
+{
+  if(m_SpectralStart == 0) { if(m_ApproxHigh == 0) { xEncodeDCFirst(ScanCoeff, Cmp, HuffTableIdDC); } else { xEncodeDCRefine(ScanCoeff); } }
+  else                     { if(m_ApproxHigh == 0) { xEncodeACFirst(ScanCoeff, HuffTableIdAC     ); } else { xEncodeACRefine(ScanCoeff, HuffTableIdAC); } }
+}
+void xEntropyEncoderProgressive::BuildOptimalTables(std::vector<xJFIF::xHuffTable>& HuffTables) const
+{
+  for(xJFIF::xHuffTable& HuffTable : HuffTables)
+  {
+    const int32 HuffTableId = HuffTable.getIdx();
+    if(HuffTable.isDC()) { HuffTable.InitOptimal((uint8)HuffTableId, xJFIF::xHuffTable::eHuffClass::DC, m_HuffCounterDC[HuffTableId].getSymbolCount(), xJPEG_Constants::c_MaxNumCodeSymbolsDC); }
+    else                 { HuffTable.InitOptimal((uint8)HuffTableId, xJFIF::xHuffTable::eHuffClass::AC, m_HuffCounterAC[HuffTableId].getSymbolCount(), xJPEG_Constants::c_MaxNumCodeSymbolsAC); }
+  }
+}
+void xEntropyEncoderProgressive::xEncodeDCFirst(const int16* ScanCoeff, eCmp Cmp, int32 HuffTableIdDC)
+{
+  int32 DC             = (int32)ScanCoeff[0] >> m_ApproxLow; //point transform - arithmetic shift (ITU T.81 G.1.2.1)
+  int32 DeltaDC        = DC - (int32)m_LastDC[(int32)Cmp];
+  m_LastDC[(int32)Cmp] = (int16)DC;
+
+  int32 SignMaskDC = DeltaDC >> 31;
+  int32 AbsDeltaDC = (DeltaDC ^ SignMaskDC) - SignMaskDC;
+  int32 NumBitsDC  = xNumBits(AbsDeltaDC);
+  int32 RemainDC   = (DeltaDC + SignMaskDC) & ((1 << NumBitsDC) - 1);
+  xEmitDC(HuffTableIdDC, NumBitsDC, RemainDC);
+}
+void xEntropyEncoderProgressive::xEncodeDCRefine(const int16* ScanCoeff)
+{
+  xEmitBit(((int32)ScanCoeff[0] >> m_ApproxLow) & 1);
+}
+void xEntropyEncoderProgressive::xEncodeACFirst(const int16* ScanCoeff, int32 HuffTableIdAC)
+{
+  int32 RunLength = 0;
+  for(int32 k = m_SpectralStart; k <= m_SpectralEnd; k++)
+  {
+    int32 AC       = ScanCoeff[k];
+    int32 SignMask = AC >> 31;
+    int32 AbsAC    = ((AC ^ SignMask) - SignMask) >> m_ApproxLow; //point transform - magnitude shift (ITU T.81 G.1.2.2)
+
+    if(AbsAC == 0) { RunLength++; continue; }
+
+    xFlushEOBRun();
+    while(RunLength > 15) { xEmitZRL(HuffTableIdAC); RunLength -= 16; }
+
+    int32 NumBits = xNumBits(AbsAC);
+    int32 Remain  = (AbsAC ^ SignMask) & ((1 << NumBits) - 1); //one's complement of magnitude for negative values
+    xEmitAC(HuffTableIdAC, (RunLength << 4) + NumBits, NumBits, Remain);
     RunLength = 0;
   }
-  //If the last coef(s) were zero, emit an end-of-block code
-  if (LastNonZero < 63) { HE->writeEOB(&m_Bitstream); }
+
+  //trailing zeros - extend end-of-band run
+  if(RunLength > 0)
+  {
+    m_EOBRun++;
+    m_EOBRunTabId = HuffTableIdAC;
+    if(m_EOBRun == c_MaxEOBRun) { xFlushEOBRun(); }
+  }
+}
+void xEntropyEncoderProgressive::xEncodeACRefine(const int16* ScanCoeff, int32 HuffTableIdAC)
+{
+  //magnitudes after point transform and position of last newly non-zero coefficient
+  int32 AbsCoeff[xJPEG_Constants::c_BlockArea];
+  int32 LastNewPos = 0;
+  for(int32 k = m_SpectralStart; k <= m_SpectralEnd; k++)
+  {
+    int32 AC       = ScanCoeff[k];
+    int32 SignMask = AC >> 31;
+    AbsCoeff[k]    = ((AC ^ SignMask) - SignMask) >> m_ApproxLow;
+    if(AbsCoeff[k] == 1) { LastNewPos = k; }
+  }
+
+  int32  RunLength     = 0;
+  uint8* BlockCorrBits = m_CorrBits + m_NumCorrBits; //correction bits of this block are appended after pending ones
+  int32  NumBlockBits  = 0;
+  for(int32 k = m_SpectralStart; k <= m_SpectralEnd; k++)
+  {
+    int32 AbsAC = AbsCoeff[k];
+    if(AbsAC == 0) { RunLength++; continue; }
+
+    //ZRL has to be emitted only if newly non-zero coefficient follows
+    while(RunLength > 15 && k <= LastNewPos)
+    {
+      xFlushEOBRun();
+      xEmitZRL(HuffTableIdAC);
+      RunLength -= 16;
+      xEmitCorrBits(BlockCorrBits, NumBlockBits);
+      BlockCorrBits = m_CorrBits;
+      NumBlockBits  = 0;
+    }
+
+    //previously non-zero coefficient - correction bit only
+    if(AbsAC > 1) { BlockCorrBits[NumBlockBits++] = (uint8)(AbsAC & 1); continue; }
+
+    //newly non-zero coefficient - run/size symbol with sign bit followed by correction bits of skipped coefficients
+    xFlushEOBRun();
+    xEmitAC(HuffTableIdAC, (RunLength << 4) + 1, 1, ScanCoeff[k] < 0 ? 0 : 1);
+    xEmitCorrBits(BlockCorrBits, NumBlockBits);
+    BlockCorrBits = m_CorrBits;
+    NumBlockBits  = 0;
+    RunLength     = 0;
+  }
+
+  //remaining zeros or correction bits - extend end-of-band run
+  if(RunLength > 0 || NumBlockBits > 0)
+  {
+    m_EOBRun++;
+    m_EOBRunTabId  = HuffTableIdAC;
+    m_NumCorrBits += NumBlockBits;
+    if(m_EOBRun == c_MaxEOBRun || m_NumCorrBits > c_MaxCorrBits - xJPEG_Constants::c_BlockArea + 1) { xFlushEOBRun(); }
+  }
+}
+void xEntropyEncoderProgressive::xFlushEOBRun()
+{
+  if(m_EOBRun == 0) { return; }
+
+  //EOBn symbol - n = floor(log2(EOBRun)), followed by n low bits of run length
+  int32 NumBits = xNumBits(m_EOBRun) - 1;
+  xEmitAC(m_EOBRunTabId, NumBits << 4, NumBits, m_EOBRun & ((1 << NumBits) - 1));
+  m_EOBRun = 0;
+
+  xEmitCorrBits(m_CorrBits, m_NumCorrBits);
+  m_NumCorrBits = 0;
+}
+void xEntropyEncoderProgressive::xEmitCorrBits(const uint8* CorrBits, int32 NumCorrBits)
+{
+  if(m_GatherStats) { return; }
+
+  for(int32 i = 0; i < NumCorrBits; )
+  {
+    const int32 NumChunkBits = xMin(NumCorrBits - i, 24);
+    uint32      Chunk        = 0;
+    for(int32 j = 0; j < NumChunkBits; j++) { Chunk = (Chunk << 1) | CorrBits[i + j]; }
+    m_Bitstream.writeBits(Chunk, NumChunkBits);
+    i += NumChunkBits;
+  }
+}
+
+//=====================================================================================================================================================================================
+
+void xEntropyEncoderArith::StartSlice(xByteBuffer* ByteBuffer)
+{
+  xResetLastDC();
+  memset(m_StatsDC  , 0, sizeof(m_StatsDC  ));
+  memset(m_StatsAC  , 0, sizeof(m_StatsAC  ));
+  memset(m_ContextDC, 0, sizeof(m_ContextDC));
+  m_GatherStats = ByteBuffer == nullptr;
+  if(!m_GatherStats) { m_ArithEncoder.init(ByteBuffer); }
+}
+void xEntropyEncoderArith::FinishSlice()
+{
+  if(m_GatherStats) { return; }
+  m_ArithEncoder.finish();
+}
+void xEntropyEncoderArith::xEncodeBlock(const int16* ScanCoeff, uint64 NonZeroMask, eCmp Cmp, int32 ArithTableIdDC, int32 ArithTableIdAC)
+{
+  //DC coefficient - ITU T.81 F.1.4.1
+  int32 DC             = ScanCoeff[0];
+  int32 DeltaDC        = DC - (int32)m_LastDC[(int32)Cmp];
+  m_LastDC[(int32)Cmp] = (int16)DC;
+
+  int32 St = m_ContextDC[(int32)Cmp];
+  if(DeltaDC == 0) { xEmitDC(ArithTableIdDC, St, 0); m_ContextDC[(int32)Cmp] = 0; }
+  else
+  {
+    const int32 Sign = DeltaDC < 0 ? 1 : 0;
+    const int32 V    = (Sign ? -DeltaDC : DeltaDC) - 1;
+    xEmitDC(ArithTableIdDC, St    , 1   );
+    xEmitDC(ArithTableIdDC, St + 1, Sign);
+    St += 2 + Sign;
+    int32 M = 0;
+    if(V)
+    {
+      xEmitDC(ArithTableIdDC, St, 1);
+      M  = 1;
+      St = xArithCommon::c_OffsetX1DC;
+      for(int32 V2 = V >> 1; V2; V2 >>= 1) { xEmitDC(ArithTableIdDC, St, 1); M <<= 1; St++; }
+    }
+    xEmitDC(ArithTableIdDC, St, 0);
+    m_ContextDC[(int32)Cmp] = (uint8)xArithCommon::NextContextDC(Sign, M);
+    St += xArithCommon::c_OffsetM;
+    while(M >>= 1) { xEmitDC(ArithTableIdDC, St, (M & V) ? 1 : 0); }
+  }
+
+  //AC coefficients - ITU T.81 F.1.4.2, runs are taken directly from non-zero mask
+  NonZeroMask &= ~(uint64)1;
+  int32 k = 1;
+  while(NonZeroMask)
+  {
+    const int32 Pos = (int32)xTZCNT(NonZeroMask);
+    NonZeroMask &= NonZeroMask - 1;
+
+    St = 3 * (k - 1);
+    xEmitAC(ArithTableIdAC, St, 0); //not EOB
+    for(; k < Pos; k++, St += 3) { xEmitAC(ArithTableIdAC, St + 1, 0); } //zero run
+    xEmitAC(ArithTableIdAC, St + 1, 1);
+
+    const int32 Coeff = ScanCoeff[Pos];
+    const int32 Sign  = Coeff < 0 ? 1 : 0;
+    const int32 V     = (Sign ? -Coeff : Coeff) - 1;
+    xEmitSign(Sign);
+    St += 2;
+    int32 M = 0;
+    if(V)
+    {
+      xEmitAC(ArithTableIdAC, St, 1);
+      M = 1;
+      int32 V2 = V >> 1;
+      if(V2)
+      {
+        xEmitAC(ArithTableIdAC, St, 1);
+        M  = 2;
+        St = Pos <= xArithCommon::c_DefaultKx ? xArithCommon::c_OffsetX2LowAC : xArithCommon::c_OffsetX2HighAC;
+        while(V2 >>= 1) { xEmitAC(ArithTableIdAC, St, 1); M <<= 1; St++; }
+      }
+    }
+    xEmitAC(ArithTableIdAC, St, 0);
+    St += xArithCommon::c_OffsetM;
+    while(M >>= 1) { xEmitAC(ArithTableIdAC, St, (M & V) ? 1 : 0); }
+    k = Pos + 1;
+  }
+  //EOB is coded only if last coefficient is zero
+  if(k < xJPEG_Constants::c_BlockArea) { xEmitAC(ArithTableIdAC, 3 * (k - 1), 1); }
 }
 
 //=====================================================================================================================================================================================
@@ -271,31 +887,26 @@ void xEntropyEncoderDefault::xEncodeBlockL(const int16* ScanCoeff)
   int32 RemainDC   = (DeltaDC + SignMaskDC) & ((1 << NumBitsDC) - 1);  // subtract one if value was negative and mask off any extra bits in code
   xHuffDefaultEncoder::writeLumaDC(&m_Bitstream, NumBitsDC, RemainDC);
 
-  //AC coefficients
-  int32 LastNonZero = findLastNonZero(ScanCoeff);
-  int32 RunLength   = 0;
-  for(int32 i=1; i <= LastNonZero; i++)
+  //AC coefficients - runs are taken directly from non-zero mask
+  alignas(64) int32 NumBits[xJPEG_Constants::c_BlockArea];
+  alignas(64) int32 Remain [xJPEG_Constants::c_BlockArea];
+  uint64 NonZeroMask = extractSymbols(ScanCoeff, NumBits, Remain) & ~(uint64)1;
+  int32  LastPos     = 0;
+  while(NonZeroMask)
   {
-    int32 AC = ScanCoeff[i];
-
-    //nothing to encode
-    if(AC == 0) { RunLength++; continue; }
+    int32 Pos       = (int32)xTZCNT(NonZeroMask);
+    int32 RunLength = Pos - LastPos - 1;
+    NonZeroMask    &= NonZeroMask - 1;
+    LastPos         = Pos;
 
     //if run length > 15, must emit special run-length-16 codes (0xF0)
     while (RunLength > 15) { xHuffDefaultEncoder::writeLumaZRL(&m_Bitstream); RunLength -= 16; }
 
     //Emit Huffman symbol for run length / number of bits
-    int32 SignMaskAC = AC >> 31;                       // make a mask of the sign bit
-    int32 AbsAC      = (AC ^ SignMaskAC) - SignMaskAC; // toggle the bits and add one if value is negative
-    int32 NumBitsAC  = xNumSignificantBits((uint32)AbsAC);
-    int32 RemainAC   = (AC + SignMaskAC) & ((1 << NumBitsAC) - 1);  // subtract one if value was negative and mask off any extra bits in code
-    xHuffDefaultEncoder::writeLumaAC(&m_Bitstream, RunLength, NumBitsAC, RemainAC);
-
-    //reset run length
-    RunLength = 0;
+    xHuffDefaultEncoder::writeLumaAC(&m_Bitstream, RunLength, NumBits[Pos], Remain[Pos]);
   }
   //If the last coef(s) were zero - emit an end-of-block code
-  if(LastNonZero < 63) { xHuffDefaultEncoder::writeLumaEOB(&m_Bitstream); }
+  if(LastPos < 63) { xHuffDefaultEncoder::writeLumaEOB(&m_Bitstream); }
 }
 void xEntropyEncoderDefault::xEncodeBlockC(const int16* ScanCoeff, eCmp Cmp)
 {
@@ -310,31 +921,26 @@ void xEntropyEncoderDefault::xEncodeBlockC(const int16* ScanCoeff, eCmp Cmp)
   int32 RemainDC   = (DeltaDC + SignMaskDC) & ((1 << NumBitsDC) - 1);  // subtract one if value was negative and mask off any extra bits in code
   xHuffDefaultEncoder::writeChromaDC(&m_Bitstream, NumBitsDC, RemainDC);
 
-  //AC coefficients
-  int32 LastNonZero = findLastNonZero(ScanCoeff);
-  int32 RunLength   = 0;
-  for(int32 i=1; i <= LastNonZero; i++)
+  //AC coefficients - runs are taken directly from non-zero mask
+  alignas(64) int32 NumBits[xJPEG_Constants::c_BlockArea];
+  alignas(64) int32 Remain [xJPEG_Constants::c_BlockArea];
+  uint64 NonZeroMask = extractSymbols(ScanCoeff, NumBits, Remain) & ~(uint64)1;
+  int32  LastPos     = 0;
+  while(NonZeroMask)
   {
-    int32 AC = ScanCoeff[i];
-
-    //nothing to encode
-    if(AC == 0) { RunLength++; continue; }
+    int32 Pos       = (int32)xTZCNT(NonZeroMask);
+    int32 RunLength = Pos - LastPos - 1;
+    NonZeroMask    &= NonZeroMask - 1;
+    LastPos         = Pos;
 
     //if run length > 15, must emit special run-length-16 codes (0xF0)
     while (RunLength > 15) { xHuffDefaultEncoder::writeChromaZRL(&m_Bitstream); RunLength -= 16; }
 
     //Emit Huffman symbol for run length / number of bits
-    int32 SignMaskAC = AC >> 31;                       // make a mask of the sign bit
-    int32 AbsAC      = (AC ^ SignMaskAC) - SignMaskAC; // toggle the bits and add one if value is negative
-    int32 NumBitsAC  = xNumSignificantBits((uint32)AbsAC);
-    int32 RemainAC   = (AC + SignMaskAC) & ((1 << NumBitsAC) - 1);  // subtract one if value was negative and mask off any extra bits in code
-    xHuffDefaultEncoder::writeChromaAC(&m_Bitstream, RunLength, NumBitsAC, RemainAC);
-
-    //reset run length
-    RunLength = 0;
+    xHuffDefaultEncoder::writeChromaAC(&m_Bitstream, RunLength, NumBits[Pos], Remain[Pos]);
   }
-  //If the last coef(s) were zero, emit an end-of-block code
-  if (LastNonZero < 63) { xHuffDefaultEncoder::writeChromaEOB(&m_Bitstream); }
+  //If the last coef(s) were zero - emit an end-of-block code
+  if(LastPos < 63) { xHuffDefaultEncoder::writeChromaEOB(&m_Bitstream); }
 }
 
 
@@ -342,6 +948,7 @@ void xEntropyEncoderDefault::xEncodeBlockC(const int16* ScanCoeff, eCmp Cmp)
 
 bool xEntropyEstimator::Init(std::vector<xJFIF::xHuffTable>& HuffTables)
 {
+  m_Arithmetic = false;
   bool Result = true;
   for(xJFIF::xHuffTable& HuffTable : HuffTables)
   {
@@ -362,6 +969,19 @@ bool xEntropyEstimator::Init(std::vector<xJFIF::xHuffTable>& HuffTables)
   }
   return Result;
 }
+bool xEntropyEstimator::InitArith(const xArithCounterDC* ArithCountersDC, const xArithCounterAC* ArithCountersAC)
+{
+  bool Result = true;
+  for(int32 ArithTableId = 0; ArithTableId < xJPEG_Constants::c_MaxArithTabs; ArithTableId++)
+  {
+    if(m_ArithEstimatorDC[ArithTableId] == nullptr) { m_ArithEstimatorDC[ArithTableId] = new xArithEstimatorDC; }
+    if(m_ArithEstimatorAC[ArithTableId] == nullptr) { m_ArithEstimatorAC[ArithTableId] = new xArithEstimatorAC; }
+    Result &= m_ArithEstimatorDC[ArithTableId]->init(ArithCountersDC[ArithTableId]);
+    Result &= m_ArithEstimatorAC[ArithTableId]->init(ArithCountersAC[ArithTableId]);
+  }
+  m_Arithmetic = Result;
+  return Result;
+}
 void xEntropyEstimator::UnInit()
 {
   for(int32 HuffTableId=0; HuffTableId < xJPEG_Constants::c_MaxHuffTabs; HuffTableId++)
@@ -369,6 +989,12 @@ void xEntropyEstimator::UnInit()
     if(m_HuffEstimatorDC[HuffTableId] != nullptr) { delete m_HuffEstimatorDC[HuffTableId]; m_HuffEstimatorDC[HuffTableId] = nullptr; }
     if(m_HuffEstimatorAC[HuffTableId] != nullptr) { delete m_HuffEstimatorAC[HuffTableId]; m_HuffEstimatorAC[HuffTableId] = nullptr; }
   }
+  for(int32 ArithTableId = 0; ArithTableId < xJPEG_Constants::c_MaxArithTabs; ArithTableId++)
+  {
+    if(m_ArithEstimatorDC[ArithTableId] != nullptr) { delete m_ArithEstimatorDC[ArithTableId]; m_ArithEstimatorDC[ArithTableId] = nullptr; }
+    if(m_ArithEstimatorAC[ArithTableId] != nullptr) { delete m_ArithEstimatorAC[ArithTableId]; m_ArithEstimatorAC[ArithTableId] = nullptr; }
+  }
+  m_Arithmetic = false;
 }
 int32 xEntropyEstimator::EstimateBlock(const int16* ScanCoeff, eCmp Cmp, int32 HuffTableIdDC, int32 HuffTableIdAC)
 {
@@ -377,16 +1003,57 @@ int32 xEntropyEstimator::EstimateBlock(const int16* ScanCoeff, eCmp Cmp, int32 H
   int32 DeltaDC        = DC - (int32)m_LastDC[(int32)Cmp];
   m_LastDC[(int32)Cmp] = (int16)DC;
 
+  if(m_Arithmetic)
+  {
+    const int32 ContextDC   = m_ContextDC[(int32)Cmp];
+    m_ContextDC[(int32)Cmp] = (uint8)xArithCommon::NextContextDC(DeltaDC);
+    return xEstimateBlockArith(ScanCoeff, calcNonZeroMask(ScanCoeff), DeltaDC, ContextDC, HuffTableIdDC, HuffTableIdAC);
+  }
   return xEstimateBlockCommon(ScanCoeff, DeltaDC, HuffTableIdDC, HuffTableIdAC);
 }
+int32 xEntropyEstimator::EstimateBlock(const int16* ScanCoeff, const xBlockInfo& Info, eCmp Cmp, int32 HuffTableIdDC, int32 HuffTableIdAC)
+{
+  //DC coefficient
+  int32 DC             = ScanCoeff[0];
+  int32 DeltaDC        = DC - (int32)m_LastDC[(int32)Cmp];
+  m_LastDC[(int32)Cmp] = (int16)DC;
+
+  if(m_Arithmetic)
+  {
+    const int32 ContextDC   = m_ContextDC[(int32)Cmp];
+    m_ContextDC[(int32)Cmp] = (uint8)xArithCommon::NextContextDC(DeltaDC);
+    return xEstimateBlockArith(ScanCoeff, Info.getNonZeroMask(), DeltaDC, ContextDC, HuffTableIdDC, HuffTableIdAC);
+  }
+  return m_HuffEstimatorDC[HuffTableIdDC]->calcDC(xAbsNumBits(DeltaDC)) + xEstimateACMask(ScanCoeff, Info.getACMask(), m_HuffEstimatorAC[HuffTableIdAC]);
+}
 int32 xEntropyEstimator::EstimateBlockStateless(const int16* ScanCoeff, int32 LastDC, int32 HuffTableIdDC, int32 HuffTableIdAC) const
 {
   //DC coefficient
   int32 DC         = ScanCoeff[0];
   int32 DeltaDC    = DC - LastDC;
 
+  if(m_Arithmetic) { return xEstimateBlockArith(ScanCoeff, calcNonZeroMask(ScanCoeff), DeltaDC, 0, HuffTableIdDC, HuffTableIdAC); }
   return xEstimateBlockCommon(ScanCoeff, DeltaDC, HuffTableIdDC, HuffTableIdAC);
 }
+int32 xEntropyEstimator::xEstimateBlockArith(const int16* ScanCoeff, uint64 NonZeroMask, int32 DeltaDC, int32 ContextDC, int32 ArithTableIdDC, int32 ArithTableIdAC) const
+{
+  int32 Cost = m_ArithEstimatorDC[ArithTableIdDC]->calcDC(DeltaDC, ContextDC);
+
+  //AC coefficients
+  const xArithEstimatorAC* AE = m_ArithEstimatorAC[ArithTableIdAC];
+  NonZeroMask &= ~(uint64)1;
+  int32 LastPos = 0;
+  while(NonZeroMask)
+  {
+    const int32 Pos = (int32)xTZCNT(NonZeroMask);
+    NonZeroMask &= NonZeroMask - 1;
+    Cost   += AE->calcRun(LastPos, Pos, xAbs((int32)ScanCoeff[Pos]));
+    LastPos = Pos;
+  }
+  Cost += AE->calcEOB(LastPos);
+
+  return Cost;
+}
 int32 xEntropyEstimator::xEstimateBlockCommon(const int16* ScanCoeff, int32 DeltaDC, int32 HuffTableIdDC, int32 HuffTableIdAC) const
 {
   int32 SignMaskDC = DeltaDC >> 31;                       // make a mask of the sign bit
@@ -395,7 +1062,113 @@ int32 xEntropyEstimator::xEstimateBlockCommon(const int16* ScanCoeff, int32 Delt
   int32 CalcNumBits = m_HuffEstimatorDC[HuffTableIdDC]->calcDC(NumBitsDC);
 
   //AC coefficients
-  xHuffEstimatorAC* HE = m_HuffEstimatorAC[HuffTableIdAC];
+  CalcNumBits += xEstimateAC(ScanCoeff, m_HuffEstimatorAC[HuffTableIdAC]);
+
+  return CalcNumBits;
+}
+#if X_SIMD_CAN_USE_AVX512
+int32 xEntropyEstimator::xEstimateACAVX512(const int16* ScanCoeff, const xHuffEstimatorAC* HE)
+{
+  const __m512i Zero     = _mm512_setzero_si512();
+  const __m512i One      = _mm512_set1_epi32(1);
+  const __m512i Const32  = _mm512_set1_epi32(32);
+  const __m512i Mask4b   = _mm512_set1_epi32(0xF);
+  const __m512i Mask8b   = _mm512_set1_epi32(0xFF);
+  const __m512i ZRLBitsV = _mm512_set1_epi32(HE->calcZRL());
+  const __m512i LaneIdxV = _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+  const __m512i PrevIdxV = _mm512_setr_epi32(0, 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14);
+  const uint8*  HuffLen  = HE->getHuffLen();
+
+  //non-zero mask of AC coefficients
+  uint64 MaskV0 = _mm512_cmpneq_epi16_mask(_mm512_loadu_si512((__m512i*)(ScanCoeff     )), Zero);
+  uint64 MaskV1 = _mm512_cmpneq_epi16_mask(_mm512_loadu_si512((__m512i*)(ScanCoeff + 32)), Zero);
+  uint64 NonZeroMask = ((MaskV1 << 32) | MaskV0) & ~(uint64)1;
+  if(NonZeroMask == 0) { return HE->calcEOB(); }
+  const int32 LastPos = 63 - (int32)xLZCNT(NonZeroMask);
+
+  //non-zero coefficients are compressed to consecutive lanes, run length is a distance to position in previous lane (position of previous non-zero coefficient)
+  __m512i NumBitsV = Zero;
+  int32   PrevPos  = 0;
+  for(int32 i = 0; i < xJPEG_Constants::c_BlockArea; i += 16)
+  {
+    uint32 ChunkMask = (uint32)(NonZeroMask >> i) & 0xFFFF;
+    if(ChunkMask == 0) { continue; }
+    __mmask16 LaneMask  = (__mmask16)((1u << _mm_popcnt_u32(ChunkMask)) - 1);
+
+    __m512i CoeffV  = _mm512_cvtepi16_epi32(_mm256_loadu_si256((__m256i*)(ScanCoeff + i)));
+    __m512i BitsV   = _mm512_sub_epi32(Const32, _mm512_lzcnt_epi32(_mm512_abs_epi32(CoeffV)));
+    __m512i CmpBitV = _mm512_maskz_compress_epi32((__mmask16)ChunkMask, BitsV);
+    __m512i CmpPosV = _mm512_maskz_compress_epi32((__mmask16)ChunkMask, _mm512_add_epi32(LaneIdxV, _mm512_set1_epi32(i)));
+    __m512i PrvPosV = _mm512_mask_permutexvar_epi32(_mm512_set1_epi32(PrevPos), 0xFFFE, PrevIdxV, CmpPosV);
+    __m512i RunV    = _mm512_sub_epi32(_mm512_sub_epi32(CmpPosV, PrvPosV), One);
+
+    //run/size symbols - code lengths gathered from byte table, runs longer than 15 are preceded by ZRL codes
+    __m512i SymbolV = _mm512_or_si512(_mm512_slli_epi32(_mm512_and_si512(RunV, Mask4b), 4), CmpBitV);
+    __m512i CodeLenV = _mm512_and_si512(_mm512_mask_i32gather_epi32(Zero, LaneMask, SymbolV, HuffLen, 1), Mask8b);
+    __m512i ZRLLenV  = _mm512_mullo_epi32(_mm512_srli_epi32(RunV, 4), ZRLBitsV);
+    NumBitsV = _mm512_mask_add_epi32(NumBitsV, LaneMask, NumBitsV, _mm512_add_epi32(_mm512_add_epi32(CodeLenV, CmpBitV), ZRLLenV));
+
+    PrevPos = i + 31 - (int32)xLZCNT(ChunkMask);
+  }
+
+  int32 CalcNumBits = xHorVecSum_epi32(NumBitsV);
+  //If the last coef(s) were zero, emit an end-of-block code
+  if(LastPos < 63) { CalcNumBits += HE->calcEOB(); }
+  return CalcNumBits;
+}
+#endif //X_SIMD_CAN_USE_AVX512
+#if X_SIMD_CAN_USE_AVX
+int32 xEntropyEstimator::xEstimateACAVX(const int16* ScanCoeff, const xHuffEstimatorAC* HE)
+{
+  const __m256i Zero    = _mm256_setzero_si256();
+  const __m256i ExpBias = _mm256_set1_epi32(126);
+  const uint8*  HuffLen = HE->getHuffLen();
+  const int32   ZRLBits = HE->calcZRL();
+
+  //non-zero mask - pack 16bit compare results to bytes (packs interleaves 128bit lanes, permute restores order)
+  __m256i CoeffV0 = _mm256_loadu_si256((__m256i*)(ScanCoeff     ));
+  __m256i CoeffV1 = _mm256_loadu_si256((__m256i*)(ScanCoeff + 16));
+  __m256i CoeffV2 = _mm256_loadu_si256((__m256i*)(ScanCoeff + 32));
+  __m256i CoeffV3 = _mm256_loadu_si256((__m256i*)(ScanCoeff + 48));
+  __m256i ZeroV01 = _mm256_permute4x64_epi64(_mm256_packs_epi16(_mm256_cmpeq_epi16(CoeffV0, Zero), _mm256_cmpeq_epi16(CoeffV1, Zero)), 0xD8);
+  __m256i ZeroV23 = _mm256_permute4x64_epi64(_mm256_packs_epi16(_mm256_cmpeq_epi16(CoeffV2, Zero), _mm256_cmpeq_epi16(CoeffV3, Zero)), 0xD8);
+  uint64  MaskV01 = (uint32)~_mm256_movemask_epi8(ZeroV01);
+  uint64  MaskV23 = (uint32)~_mm256_movemask_epi8(ZeroV23);
+  uint64  NonZeroMask = ((MaskV23 << 32) | MaskV01) & ~(uint64)1;
+  if(NonZeroMask == 0) { return HE->calcEOB(); }
+
+  //magnitude categories - taken from exponent of exactly converted float, sum of categories (number of remainder bits) is reduced in registers
+  alignas(32) int32 NumBits[xJPEG_Constants::c_BlockArea];
+  __m256i NumBitsV = Zero;
+  for(int32 i = 0; i < xJPEG_Constants::c_BlockArea; i += 8)
+  {
+    __m256i CoeffV = _mm256_cvtepi16_epi32(_mm_loadu_si128((__m128i*)(ScanCoeff + i)));
+    __m256i ExpV   = _mm256_srli_epi32(_mm256_castps_si256(_mm256_cvtepi32_ps(_mm256_abs_epi32(CoeffV))), 23);
+    __m256i BitsV  = _mm256_max_epi32(_mm256_sub_epi32(ExpV, ExpBias), Zero);
+    _mm256_store_si256((__m256i*)(NumBits + i), BitsV);
+    NumBitsV = _mm256_add_epi32(NumBitsV, BitsV);
+  }
+  int32 CalcNumBits = xHorVecSum_epi32(NumBitsV) - NumBits[0];
+
+  //run/size symbols of non-zero coefficients only
+  int32 LastPos = 0;
+  while(NonZeroMask)
+  {
+    int32 Pos       = (int32)xTZCNT(NonZeroMask);
+    int32 RunLength = Pos - LastPos - 1;
+    CalcNumBits += (RunLength >> 4) * ZRLBits + HuffLen[((RunLength & 0xF) << 4) + NumBits[Pos]];
+    LastPos      = Pos;
+    NonZeroMask &= NonZeroMask - 1;
+  }
+
+  //If the last coef(s) were zero, emit an end-of-block code
+  if(LastPos < 63) { CalcNumBits += HE->calcEOB(); }
+  return CalcNumBits;
+}
+#endif //X_SIMD_CAN_USE_AVX
+int32 xEntropyEstimator::xEstimateACSTD(const int16* ScanCoeff, const xHuffEstimatorAC* HE)
+{
+  int32 CalcNumBits = 0;
   int32 LastNonZero = findLastNonZero(ScanCoeff);
   int32 RunLength   = 0;
   for(int32 i=1; i <= LastNonZero; i++)
@@ -423,6 +1196,180 @@ int32 xEntropyEstimator::xEstimateBlockCommon(const int16* ScanCoeff, int32 Delt
 
   return CalcNumBits;
 }
+int32 xEntropyEstimator::xEstimateACMask(const int16* ScanCoeff, uint64 ACMask, const xHuffEstimatorAC* HE)
+{
+  const uint8* HuffLen     = HE->getHuffLen();
+  const int32  ZRLBits     = HE->calcZRL();
+  int32        CalcNumBits = 0;
+  int32        LastPos     = 0;
+  while(ACMask)
+  {
+    int32 Pos       = (int32)xTZCNT(ACMask);
+    int32 RunLength = Pos - LastPos - 1;
+    int32 NumBitsAC = xAbsNumBits(ScanCoeff[Pos]);
+    CalcNumBits += (RunLength >> 4) * ZRLBits + HuffLen[((RunLength & 0xF) << 4) + NumBitsAC] + NumBitsAC;
+    LastPos      = Pos;
+    ACMask      &= ACMask - 1;
+  }
+  if(LastPos < 63) { CalcNumBits += HE->calcEOB(); }
+  return CalcNumBits;
+}
+void xEntropyEstimator::InitBlockState(xBlockState& State, const int16* ScanCoeff, int32 LastDC, int32 HuffTableIdDC, int32 HuffTableIdAC) const
+{
+  memcpy(State.m_ScanCoeff, ScanCoeff, xJPEG_Constants::c_BlockArea * sizeof(int16));
+  State.m_NonZeroMask   = calcNonZeroMask(ScanCoeff) | (uint64)1;
+  State.m_LastDC        = LastDC;
+  State.m_HuffTableIdDC = HuffTableIdDC;
+  State.m_HuffTableIdAC = HuffTableIdAC;
+  State.m_NumBits       = EstimateBlockStateless(ScanCoeff, LastDC, HuffTableIdDC, HuffTableIdAC);
+}
+void xEntropyEstimator::InitBlockState(xBlockState& State, const int16* ScanCoeff, const xBlockInfo& Info, int32 LastDC, int32 HuffTableIdDC, int32 HuffTableIdAC) const
+{
+  memcpy(State.m_ScanCoeff, ScanCoeff, xJPEG_Constants::c_BlockArea * sizeof(int16));
+  State.m_NonZeroMask   = Info.getNonZeroMask();
+  State.m_LastDC        = LastDC;
+  State.m_HuffTableIdDC = HuffTableIdDC;
+  State.m_HuffTableIdAC = HuffTableIdAC;
+  if(Info.isNumBitsValid()) { State.m_NumBits = Info.getNumBits(); return; }
+  const int32 DeltaDC = ScanCoeff[0] - LastDC;
+  if(m_Arithmetic) { State.m_NumBits = xEstimateBlockArith(ScanCoeff, Info.getNonZeroMask(), DeltaDC, 0, HuffTableIdDC, HuffTableIdAC); }
+  else             { State.m_NumBits = m_HuffEstimatorDC[HuffTableIdDC]->calcDC(xAbsNumBits(DeltaDC)) + xEstimateACMask(ScanCoeff, Info.getACMask(), m_HuffEstimatorAC[HuffTableIdAC]); }
+}
+int32 xEntropyEstimator::EstimateDelta(const xBlockState& State, int32 Pos, int16 NewCoeff) const
+{
+  const int32 OrgCoeff = State.m_ScanCoeff[Pos];
+  if(OrgCoeff == NewCoeff) { return 0; }
+  if(m_Arithmetic) { int32 DeltaBits; xEstimateDeltasArith(State, Pos, &NewCoeff, &DeltaBits, 1); return DeltaBits; }
+
+  //DC coefficient - only category of DC difference changes
+  if(Pos == 0)
+  {
+    const xHuffEstimatorDC* HD = m_HuffEstimatorDC[State.m_HuffTableIdDC];
+    return HD->calcDC(xAbsNumBits(NewCoeff - State.m_LastDC)) - HD->calcDC(xAbsNumBits(OrgCoeff - State.m_LastDC));
+  }
+
+  //AC coefficients - only symbol at Pos, symbol of next nonzero coefficient (its run length) and EOB can change
+  const xHuffEstimatorAC* HE          = m_HuffEstimatorAC[State.m_HuffTableIdAC];
+  const uint64            NonZeroMask = State.m_NonZeroMask;
+  const uint64            LowerMask   = NonZeroMask & (((uint64)1 << Pos) - 1);  //contains DC bit, never empty
+  const uint64            UpperMask   = NonZeroMask & ~(((uint64)2 << Pos) - 1); //for Pos == 63 shift wraps to 0
+  const int32             PrevPos     = 63 - (int32)xLZCNT(LowerMask);
+  const int32             OrgNumBits  = xAbsNumBits(OrgCoeff);
+  const int32             NewNumBits  = xAbsNumBits(NewCoeff);
+
+  //nonzero to nonzero - category change only
+  if(OrgCoeff != 0 && NewCoeff != 0)
+  {
+    if(OrgNumBits == NewNumBits) { return 0; }
+    const int32 RunLength = Pos - PrevPos - 1;
+    return HE->calcRun(RunLength, NewNumBits) - HE->calcRun(RunLength, OrgNumBits);
+  }
+
+  //zero to nonzero (insertion) or nonzero to zero (removal) - run of next nonzero coefficient is split or merged
+  const bool  Insert    = OrgCoeff == 0;
+  const int32 SymbBits  = HE->calcRun(Pos - PrevPos - 1, Insert ? NewNumBits : OrgNumBits);
+  int32       DeltaBits = Insert ? SymbBits : -SymbBits;
+  if(UpperMask != 0)
+  {
+    const int32 NextPos     = 63 - (int32)xLZCNT(UpperMask & (~UpperMask + 1)); //isolate lowest set bit
+    const int32 NextNumBits = xAbsNumBits(State.m_ScanCoeff[NextPos]);
+    const int32 SplitBits   = HE->calcRun(NextPos - Pos     - 1, NextNumBits);
+    const int32 MergedBits  = HE->calcRun(NextPos - PrevPos - 1, NextNumBits);
+    DeltaBits += Insert ? SplitBits - MergedBits : MergedBits - SplitBits;
+  }
+  else if(Pos == 63) //last coefficient toggles presence of EOB
+  {
+    DeltaBits += Insert ? -HE->calcEOB() : HE->calcEOB();
+  }
+  return DeltaBits;
+}
+void xEntropyEstimator::EstimateDeltas(const xBlockState& State, int32 Pos, const int16* NewCoeffs, int32* DeltaBits, int32 NumCandidates) const
+{
+  if(m_Arithmetic) { xEstimateDeltasArith(State, Pos, NewCoeffs, DeltaBits, NumCandidates); return; }
+
+  const int32 OrgCoeff = State.m_ScanCoeff[Pos];
+
+  //DC coefficient - only category of DC difference changes
+  if(Pos == 0)
+  {
+    const xHuffEstimatorDC* HD      = m_HuffEstimatorDC[State.m_HuffTableIdDC];
+    const int32             OrgBits = HD->calcDC(xAbsNumBits(OrgCoeff - State.m_LastDC));
+    for(int32 k = 0; k < NumCandidates; k++) { DeltaBits[k] = HD->calcDC(xAbsNumBits(NewCoeffs[k] - State.m_LastDC)) - OrgBits; }
+    return;
+  }
+
+  //AC coefficients - previous and next nonzero coefficient are shared by all candidates
+  const xHuffEstimatorAC* HE          = m_HuffEstimatorAC[State.m_HuffTableIdAC];
+  const uint64            NonZeroMask = State.m_NonZeroMask;
+  const uint64            LowerMask   = NonZeroMask & (((uint64)1 << Pos) - 1);  //contains DC bit, never empty
+  const uint64            UpperMask   = NonZeroMask & ~(((uint64)2 << Pos) - 1); //for Pos == 63 shift wraps to 0
+  const int32             PrevPos     = 63 - (int32)xLZCNT(LowerMask);
+  const int32             RunLength   = Pos - PrevPos - 1;
+
+  //bits of symbol following Pos (next nonzero or EOB) - split when coefficient at Pos is nonzero, merged otherwise
+  int32 SplitBits  = 0;
+  int32 MergedBits = 0;
+  if(UpperMask != 0)
+  {
+    const int32 NextPos     = (int32)xTZCNT(UpperMask);
+    const int32 NextNumBits = xAbsNumBits(State.m_ScanCoeff[NextPos]);
+    SplitBits  = HE->calcRun(NextPos - Pos     - 1, NextNumBits);
+    MergedBits = HE->calcRun(NextPos - PrevPos - 1, NextNumBits);
+  }
+  else if(Pos == 63) { MergedBits = HE->calcEOB(); } //last coefficient toggles presence of EOB
+
+  const int32 OrgBits = OrgCoeff != 0 ? HE->calcRun(RunLength, xAbsNumBits(OrgCoeff)) + SplitBits : MergedBits;
+  for(int32 k = 0; k < NumCandidates; k++)
+  {
+    const int32 NewCoeff = NewCoeffs[k];
+    const int32 NewBits  = NewCoeff != 0 ? HE->calcRun(RunLength, xAbsNumBits(NewCoeff)) + SplitBits : MergedBits;
+    DeltaBits[k] = NewBits - OrgBits;
+  }
+}
+void xEntropyEstimator::xEstimateDeltasArith(const xBlockState& State, int32 Pos, const int16* NewCoeffs, int32* DeltaBits, int32 NumCandidates) const
+{
+  const int32 OrgCoeff = State.m_ScanCoeff[Pos];
+
+  //DC coefficient - zero conditioning category (same as stateless estimation)
+  if(Pos == 0)
+  {
+    const xArithEstimatorDC* AD      = m_ArithEstimatorDC[State.m_HuffTableIdDC];
+    const int32              OrgBits = AD->calcDC(OrgCoeff - State.m_LastDC, 0);
+    for(int32 k = 0; k < NumCandidates; k++) { DeltaBits[k] = AD->calcDC(NewCoeffs[k] - State.m_LastDC, 0) - OrgBits; }
+    return;
+  }
+
+  //AC coefficients - contexts depend on position only, so only segment between previous and next nonzero coefficient (or EOB) changes
+  const xArithEstimatorAC* AE          = m_ArithEstimatorAC[State.m_HuffTableIdAC];
+  const uint64             NonZeroMask = State.m_NonZeroMask;
+  const uint64             LowerMask   = NonZeroMask & (((uint64)1 << Pos) - 1);  //contains DC bit, never empty
+  const uint64             UpperMask   = NonZeroMask & ~(((uint64)2 << Pos) - 1); //for Pos == 63 shift wraps to 0
+  const int32              PrevPos     = 63 - (int32)xLZCNT(LowerMask);
+
+  //cost of segment following Pos - split when coefficient at Pos is nonzero, merged otherwise
+  int32 SplitBits  = 0;
+  int32 MergedBits = 0;
+  if(UpperMask != 0)
+  {
+    const int32 NextPos   = (int32)xTZCNT(UpperMask);
+    const int32 NextCoeff = xAbs((int32)State.m_ScanCoeff[NextPos]);
+    SplitBits  = AE->calcRun(Pos    , NextPos, NextCoeff);
+    MergedBits = AE->calcRun(PrevPos, NextPos, NextCoeff);
+  }
+  else
+  {
+    SplitBits  = AE->calcEOB(Pos    );
+    MergedBits = AE->calcEOB(PrevPos);
+  }
+
+  const int32 OrgBits = OrgCoeff != 0 ? AE->calcRun(PrevPos, Pos, xAbs(OrgCoeff)) + SplitBits : MergedBits;
+  for(int32 k = 0; k < NumCandidates; k++)
+  {
+    const int32 NewCoeff = NewCoeffs[k];
+    const int32 NewBits  = NewCoeff != 0 ? AE->calcRun(PrevPos, Pos, xAbs(NewCoeff)) + SplitBits : MergedBits;
+    DeltaBits[k] = NewBits - OrgBits;
+  }
+}
 
 //=====================================================================================================================================================================================
 
@@ -576,6 +1523,59 @@ void xEntropyCounter::CountBlock(const int16* ScanCoeff, int32 LastDC, int32 Huf
   //If the last coef(s) were zero, emit an end-of-block code
   if (LastNonZero < 63) { HE->countEOB(); }
 }
+void xEntropyCounter::CountBlock(const int16* ScanCoeff, const xBlockInfo& Info, int32 LastDC, int32 HuffTableIdDC, int32 HuffTableIdAC)
+{
+  //DC coefficient
+  int32 DeltaDC    = ScanCoeff[0] - LastDC;
+  int32 SignMaskDC = DeltaDC >> 31;
+  m_HuffCounterDC[HuffTableIdDC]->countDC(xNumBits((DeltaDC ^ SignMaskDC) - SignMaskDC));
+
+  //AC coefficients
+  xHuffCounterAC* HE          = m_HuffCounterAC[HuffTableIdAC];
+  uint64          NonZeroMask = Info.getACMask();
+  int32           LastPos     = 0;
+  while(NonZeroMask)
+  {
+    int32 Pos       = (int32)xTZCNT(NonZeroMask);
+    int32 RunLength = Pos - LastPos - 1;
+    int32 AC        = ScanCoeff[Pos];
+    int32 SignMask  = AC >> 31;
+    NonZeroMask    &= NonZeroMask - 1;
+    LastPos         = Pos;
+    while (RunLength > 15) { HE->countZRL(); RunLength -= 16; }
+    HE->countAC((RunLength << 4) + xNumBits((AC ^ SignMask) - SignMask));
+  }
+  if (LastPos < 63) { HE->countEOB(); }
+}
+void xEntropyCounter::BuildOptimalTables(std::vector<xJFIF::xHuffTable>& HuffTables, bool CoverAllSymbols) const
+{
+  for(xJFIF::xHuffTable& HuffTable : HuffTables)
+  {
+    const int32 HuffTableId = HuffTable.getIdx();
+    if(HuffTable.isDC())
+    {
+      uint32 SymbolCount[xJPEG_Constants::c_MaxNumCodeSymbolsDC];
+      memcpy(SymbolCount, m_HuffCounterDC[HuffTableId]->getSymbolCount(), sizeof(SymbolCount));
+      if(CoverAllSymbols) { for(int32 NumBits = 0; NumBits <= 11; NumBits++) { SymbolCount[NumBits] = xMax(SymbolCount[NumBits], (uint32)1); } }
+      HuffTable.InitOptimal((uint8)HuffTableId, xJFIF::xHuffTable::eHuffClass::DC, SymbolCount, xJPEG_Constants::c_MaxNumCodeSymbolsDC);
+    }
+    else
+    {
+      uint32 SymbolCount[xJPEG_Constants::c_MaxNumCodeSymbolsAC];
+      memcpy(SymbolCount, m_HuffCounterAC[HuffTableId]->getSymbolCount(), sizeof(SymbolCount));
+      if(CoverAllSymbols)
+      {
+        SymbolCount[0x00] = xMax(SymbolCount[0x00], (uint32)1); //EOB
+        SymbolCount[0xF0] = xMax(SymbolCount[0xF0], (uint32)1); //ZRL
+        for(int32 Run = 0; Run < 16; Run++)
+        {
+          for(int32 NumBits = 1; NumBits <= 10; NumBits++) { SymbolCount[(Run << 4) + NumBits] = xMax(SymbolCount[(Run << 4) + NumBits], (uint32)1); }
+        }
+      }
+      HuffTable.InitOptimal((uint8)HuffTableId, xJFIF::xHuffTable::eHuffClass::AC, SymbolCount, xJPEG_Constants::c_MaxNumCodeSymbolsAC);
+    }
+  }
+}
 
 //=====================================================================================================================================================================================
 
@@ -6,10 +6,33 @@
 #include "xCommonDefJPEG.h"
 #include "xJFIF.h"
 #include "xJPEG_Huffman.h"
+#include "xJPEG_Arithmetic.h"
 #include "xBitstream.h"
 
 namespace PMBB_NAMESPACE::JPEG {
 
+//=====================================================================================================================================================================================
+// side information of quantized block (zig-zag order) - derived once after quantization and kept in sync by RDOQ
+// runs of zeros are given by distances between set bits of non-zero mask, so rate estimation and entropy coding visit non-zero coefficients only
+//=====================================================================================================================================================================================
+
+class xBlockInfo
+{
+protected:
+  uint64 m_NonZeroMask = 1;         //bit i set if ScanCoeff[i] != 0, bit 0 (DC) is always set - serves as run start for first AC coefficient
+  int32  m_LastPos     = 0;         //position of last non-zero coefficient (0 - no AC coefficients)
+  int32  m_NumBits     = NOT_VALID; //cached rate estimate - valid for tables (and DC predictor) it was computed with
+
+public:
+  void   set          (uint64 NonZeroMask, int32 NumBits) { m_NonZeroMask = NonZeroMask | (uint64)1; m_LastPos = 63 - (int32)xLZCNT(m_NonZeroMask); m_NumBits = NumBits; }
+  void   setNumBits   (int32 NumBits) { m_NumBits = NumBits; }
+  uint64 getNonZeroMask() const { return m_NonZeroMask; }
+  uint64 getACMask     () const { return m_NonZeroMask & ~(uint64)1; }
+  int32  getLastPos    () const { return m_LastPos; }
+  int32  getNumBits    () const { return m_NumBits; }
+  bool   isNumBitsValid() const { return m_NumBits != NOT_VALID; }
+};
+
 //=====================================================================================================================================================================================
 
 class xEntropyCommon
@@ -19,6 +42,7 @@ protected:
 
 public:
   uint32 getLastDC   (eCmp   Cmp) const { return m_LastDC[(uint32)Cmp]; }
+  void   setLastDC   (eCmp   Cmp, int16 LastDC) { m_LastDC[(uint32)Cmp] = LastDC; }
 
 protected:
   static uint32 xNumBits    (uint32 Val) { return 32 - xLZCNT(Val);  }
@@ -33,12 +57,45 @@ protected:
     
   static int32 findLastNonZeroSTD(const int16* ScanCoeff);
 
+  //bulk symbol extraction - returns mask of non-zero coefficients (bit i set if ScanCoeff[i] != 0), computes magnitude category (NumBits) and remainder bits of every coefficient
+#if X_SIMD_CAN_USE_AVX512
+  static uint64 extractSymbolsAVX512(const int16* ScanCoeff, int32* restrict NumBits, int32* restrict Remain);
+#endif //X_SIMD_CAN_USE_AVX512
+
+#if X_SIMD_CAN_USE_AVX
+#define X_CAN_USE_AVX 1
+  static uint64 extractSymbolsAVX   (const int16* ScanCoeff, int32* restrict NumBits, int32* restrict Remain);
+#else //X_SIMD_CAN_USE_AVX
+#define X_CAN_USE_AVX 0
+#endif //X_SIMD_CAN_USE_AVX
+
+  static uint64 extractSymbolsSTD   (const int16* ScanCoeff, int32* restrict NumBits, int32* restrict Remain);
+
+  //non-zero mask only (bit i set if ScanCoeff[i] != 0)
+#if X_SIMD_CAN_USE_AVX512
+  static uint64 calcNonZeroMaskAVX512(const int16* ScanCoeff);
+#endif //X_SIMD_CAN_USE_AVX512
+#if X_SIMD_CAN_USE_AVX
+  static uint64 calcNonZeroMaskAVX   (const int16* ScanCoeff);
+#endif //X_SIMD_CAN_USE_AVX
+  static uint64 calcNonZeroMaskSTD   (const int16* ScanCoeff);
+
 public:
 #if X_CAN_USE_AVX512
-  static inline int32 findLastNonZero(const int16* ScanCoeff) { return findLastNonZeroAVX512(ScanCoeff); }
+  static inline int32  findLastNonZero(const int16* ScanCoeff) { return findLastNonZeroAVX512(ScanCoeff); }
+  static inline uint64 extractSymbols (const int16* ScanCoeff, int32* NumBits, int32* Remain) { return extractSymbolsAVX512(ScanCoeff, NumBits, Remain); }
+  static inline uint64 calcNonZeroMask(const int16* ScanCoeff) { return calcNonZeroMaskAVX512(ScanCoeff); }
+#elif X_CAN_USE_AVX
+  static inline int32  findLastNonZero(const int16* ScanCoeff) { return 63 - (int32)xLZCNT(calcNonZeroMaskAVX(ScanCoeff) | (uint64)1); } //DC treated as nonzero (0 returned for all zero block)
+  static inline uint64 extractSymbols (const int16* ScanCoeff, int32* NumBits, int32* Remain) { return extractSymbolsAVX   (ScanCoeff, NumBits, Remain); }
+  static inline uint64 calcNonZeroMask(const int16* ScanCoeff) { return calcNonZeroMaskAVX   (ScanCoeff); }
 #else
-  static inline int32 findLastNonZero(const int16* ScanCoeff) { return findLastNonZeroSTD   (ScanCoeff); }
+  static inline int32  findLastNonZero(const int16* ScanCoeff) { return findLastNonZeroSTD   (ScanCoeff); }
+  static inline uint64 extractSymbols (const int16* ScanCoeff, int32* NumBits, int32* Remain) { return extractSymbolsSTD   (ScanCoeff, NumBits, Remain); }
+  static inline uint64 calcNonZeroMask(const int16* ScanCoeff) { return calcNonZeroMaskSTD   (ScanCoeff); }
 #endif
+
+  static inline void   deriveBlockInfo(xBlockInfo& Info, const int16* ScanCoeff) { Info.set(calcNonZeroMask(ScanCoeff), NOT_VALID); }
 };
 
 //=====================================================================================================================================================================================
@@ -46,9 +103,9 @@ public:
 class xEntropyDecoder : public xEntropyCommon
 {
 protected:
-  xHuffDecoder*    m_HuffDecoderDC[xJPEG_Constants::c_MaxHuffTabs];
-  xHuffDecoder*    m_HuffDecoderAC[xJPEG_Constants::c_MaxHuffTabs];
-  xBitstreamReader m_Bitstream;
+  xHuffDecoder*        m_HuffDecoderDC[xJPEG_Constants::c_MaxHuffTabs];
+  xHuffDecoder*        m_HuffDecoderAC[xJPEG_Constants::c_MaxHuffTabs];
+  xBitstreamReaderJPEG m_Bitstream; //reads stuffed data directly from input
 
 public:
   xEntropyDecoder () { memset(m_HuffDecoderDC, 0, sizeof(m_HuffDecoderDC)); memset(m_HuffDecoderAC, 0, sizeof(m_HuffDecoderAC)); }
@@ -61,14 +118,68 @@ public:
   void DecodeBlock(int16* ScanCoeff, eCmp Cmp, int32 HuffTableIdDC, int32 HuffTableIdAC);
 };
 
+//=====================================================================================================================================================================================
+// Progressive (SOF2) entropy decoding - ITU T.81 G.1.2, single scan at a time
+// coefficients are accumulated in place - every block has to be decoded by all scans in order
+//=====================================================================================================================================================================================
+
+class xEntropyDecoderProgressive : public xEntropyCommon
+{
+protected:
+  xHuffDecoder*        m_HuffDecoderDC[xJPEG_Constants::c_MaxHuffTabs];
+  xHuffDecoder*        m_HuffDecoderAC[xJPEG_Constants::c_MaxHuffTabs];
+  xBitstreamReaderJPEG m_Bitstream;
+  int32                m_SpectralStart = 0;
+  int32                m_SpectralEnd   = 0;
+  int32                m_ApproxHigh    = 0;
+  int32                m_ApproxLow     = 0;
+  int32                m_EOBRun        = 0; //remaining blocks of end-of-band run
+
+public:
+  xEntropyDecoderProgressive () { memset(m_HuffDecoderDC, 0, sizeof(m_HuffDecoderDC)); memset(m_HuffDecoderAC, 0, sizeof(m_HuffDecoderAC)); }
+  ~xEntropyDecoderProgressive() { UnInit(); }
+  bool Init  (std::vector<xJFIF::xHuffTable>& HuffTables); //tables of other class/index are kept - DHT may appear between scans
+  void UnInit();
+
+  void StartScan  (xByteBuffer* ByteBuffer, const xJFIF::xSOS& Scan);
+  void FinishScan ();
+  void DecodeBlock(int16* ScanCoeff, eCmp Cmp, int32 HuffTableIdDC, int32 HuffTableIdAC);
+
+protected:
+  void xDecodeDCFirst (int16* ScanCoeff, eCmp Cmp, int32 HuffTableIdDC);
+  void xDecodeDCRefine(int16* ScanCoeff);
+  void xDecodeACFirst (int16* ScanCoeff, int32 HuffTableIdAC);
+  void xDecodeACRefine(int16* ScanCoeff, int32 HuffTableIdAC);
+};
+
+//=====================================================================================================================================================================================
+// Sequential arithmetic coded (SOF9) entropy decoding - ITU T.81 F.2.4, default conditioning (no DAC segment support)
+// statistics of every conditioning table are reset at start of slice
+//=====================================================================================================================================================================================
+
+class xEntropyDecoderArith : public xEntropyCommon
+{
+protected:
+  xArithDecoder m_ArithDecoder;
+  uint8         m_StatsDC  [xJPEG_Constants::c_MaxArithTabs][xArithCommon::c_NumBinsDC];
+  uint8         m_StatsAC  [xJPEG_Constants::c_MaxArithTabs][xArithCommon::c_NumBinsAC];
+  uint8         m_StatFixed = xArithCommon::c_StateFixed;
+  uint8         m_ContextDC[xJPEG_Constants::c_MaxComponents];
+
+public:
+  void StartSlice (xByteBuffer* ByteBuffer);
+  void FinishSlice();
+  void DecodeBlock(int16* ScanCoeff, eCmp Cmp, int32 ArithTableIdDC, int32 ArithTableIdAC);
+};
+
 //=====================================================================================================================================================================================
 
 class xEntropyEncoder : public xEntropyCommon
 {
 protected:
-  xHuffEncoderDC*  m_HuffEncoderDC[xJPEG_Constants::c_MaxHuffTabs];
-  xHuffEncoderAC*  m_HuffEncoderAC[xJPEG_Constants::c_MaxHuffTabs];
-  xBitstreamWriter m_Bitstream;
+  xHuffEncoderDC*      m_HuffEncoderDC[xJPEG_Constants::c_MaxHuffTabs];
+  xHuffEncoderAC*      m_HuffEncoderAC[xJPEG_Constants::c_MaxHuffTabs];
+  xBitstreamWriterJPEG m_Bitstream; //writes stuffed data directly to output
 
 public:
   xEntropyEncoder () { memset(m_HuffEncoderDC, 0, sizeof(m_HuffEncoderDC)); memset(m_HuffEncoderAC, 0, sizeof(m_HuffEncoderAC)); }
@@ -79,6 +190,101 @@ public:
   void  StartSlice (xByteBuffer* ByteBuffer);
   void  FinishSlice();
   void  EncodeBlock(const int16* ScanCoeff, eCmp Cmp, int32 HuffTableIdDC, int32 HuffTableIdAC);
+  void  EncodeBlock(const int16* ScanCoeff, const xBlockInfo& Info, eCmp Cmp, int32 HuffTableIdDC, int32 HuffTableIdAC); //non-zero coefficients taken from block info
+
+protected:
+  inline void xEncodeDC(int32 DC, eCmp Cmp, int32 HuffTableIdDC);
+};
+
+//=====================================================================================================================================================================================
+// Progressive (SOF2) entropy encoding - ITU T.81 G.1.2, single scan at a time
+// DC scans may be interleaved, AC scans contain single component and join empty bands of consecutive blocks into end-of-band runs
+// scan coded without output buffer only gathers symbol statistics (scan specific Huffman tables - default tables do not define EOB run symbols)
+//=====================================================================================================================================================================================
+
+class xEntropyEncoderProgressive : public xEntropyCommon
+{
+protected:
+  static constexpr int32 c_MaxEOBRun   = 0x7FFF;
+  static constexpr int32 c_MaxCorrBits = 1000; //correction bits buffered until end of pending EOB run (same limit as IJG libjpeg)
+
+  xHuffEncoderDC*      m_HuffEncoderDC[xJPEG_Constants::c_MaxHuffTabs];
+  xHuffEncoderAC*      m_HuffEncoderAC[xJPEG_Constants::c_MaxHuffTabs];
+  xHuffCounterDC       m_HuffCounterDC[xJPEG_Constants::c_MaxHuffTabs];
+  xHuffCounterAC       m_HuffCounterAC[xJPEG_Constants::c_MaxHuffTabs];
+  xBitstreamWriterJPEG m_Bitstream;
+  bool                 m_GatherStats   = false;
+  int32                m_SpectralStart = 0;
+  int32                m_SpectralEnd   = 0;
+  int32                m_ApproxHigh    = 0;
+  int32                m_ApproxLow     = 0;
+  int32                m_EOBRun        = 0; //blocks of pending end-of-band run
+  int32                m_EOBRunTabId   = 0;
+  int32                m_NumCorrBits   = 0;
+  uint8                m_CorrBits[c_MaxCorrBits];
+
+public:
+  xEntropyEncoderProgressive () { memset(m_HuffEncoderDC, 0, sizeof(m_HuffEncoderDC)); memset(m_HuffEncoderAC, 0, sizeof(m_HuffEncoderAC)); }
+  ~xEntropyEncoderProgressive() { UnInit(); }
+  bool  Init  (std::vector<xJFIF::xHuffTable>& HuffTables);
+  void  UnInit();
+
+  void  StartScan  (xByteBuffer* ByteBuffer, const xJFIF::xSOS& Scan); //ByteBuffer == nullptr - gather symbol statistics only
+  void  FinishScan ();
+  void  EncodeBlock(const int16* ScanCoeff, eCmp Cmp, int32 HuffTableIdDC, int32 HuffTableIdAC);
+
+  //replaces every table with optimal one for statistics gathered during last scan
+  void  BuildOptimalTables(std::vector<xJFIF::xHuffTable>& HuffTables) const;
+
+protected:
+  void  xEncodeDCFirst (const int16* ScanCoeff, eCmp Cmp, int32 HuffTableIdDC);
+  void  xEncodeDCRefine(const int16* ScanCoeff);
+  void  xEncodeACFirst (const int16* ScanCoeff, int32 HuffTableIdAC);
+  void  xEncodeACRefine(const int16* ScanCoeff, int32 HuffTableIdAC);
+
+  void  xFlushEOBRun  ();
+  void  xEmitCorrBits (const uint8* CorrBits, int32 NumCorrBits);
+  void  xEmitDC (int32 HuffTableId, int32 NumBits, uint32 Remainder) { if(m_GatherStats) { m_HuffCounterDC[HuffTableId].countDC(NumBits); } else { m_HuffEncoderDC[HuffTableId]->writeDC(&m_Bitstream, NumBits, Remainder); } }
+  void  xEmitAC (int32 HuffTableId, int32 Code, int32 NumBits, uint32 Remainder) { if(m_GatherStats) { m_HuffCounterAC[HuffTableId].countAC(Code); } else { m_HuffEncoderAC[HuffTableId]->writeAC(&m_Bitstream, Code, NumBits, Remainder); } }
+  void  xEmitZRL(int32 HuffTableId) { if(m_GatherStats) { m_HuffCounterAC[HuffTableId].countZRL(); } else { m_HuffEncoderAC[HuffTableId]->writeZRL(&m_Bitstream); } }
+  void  xEmitBit(uint32 Bit) { if(!m_GatherStats) { m_Bitstream.writeBits(Bit, 1); } }
+};
+
+//=====================================================================================================================================================================================
+// Sequential arithmetic coded (SOF9) entropy encoding - ITU T.81 F.1.4, default conditioning (no DAC segment is needed)
+// statistics of every conditioning table are reset at start of slice
+// slice coded without output buffer only counts binary decisions (rate estimation model), counters are kept until ResetCounters()
+//=====================================================================================================================================================================================
+
+class xEntropyEncoderArith : public xEntropyCommon
+{
+protected:
+  xArithEncoder   m_ArithEncoder;
+  uint8           m_StatsDC  [xJPEG_Constants::c_MaxArithTabs][xArithCommon::c_NumBinsDC];
+  uint8           m_StatsAC  [xJPEG_Constants::c_MaxArithTabs][xArithCommon::c_NumBinsAC];
+  uint8           m_StatFixed = xArithCommon::c_StateFixed;
+  uint8           m_ContextDC[xJPEG_Constants::c_MaxComponents];
+  xArithCounterDC m_ArithCounterDC[xJPEG_Constants::c_MaxArithTabs];
+  xArithCounterAC m_ArithCounterAC[xJPEG_Constants::c_MaxArithTabs];
+  bool            m_GatherStats = false;
+
+public:
+  xEntropyEncoderArith() { ResetCounters(); }
+
+  void  StartSlice (xByteBuffer* ByteBuffer); //ByteBuffer == nullptr - count binary decisions only
+  void  FinishSlice();
+  void  EncodeBlock(const int16* ScanCoeff,                         eCmp Cmp, int32 ArithTableIdDC, int32 ArithTableIdAC) { xEncodeBlock(ScanCoeff, calcNonZeroMask(ScanCoeff), Cmp, ArithTableIdDC, ArithTableIdAC); }
+  void  EncodeBlock(const int16* ScanCoeff, const xBlockInfo& Info, eCmp Cmp, int32 ArithTableIdDC, int32 ArithTableIdAC) { xEncodeBlock(ScanCoeff, Info.getNonZeroMask() , Cmp, ArithTableIdDC, ArithTableIdAC); }
+
+  void  ResetCounters() { for(int32 TabId = 0; TabId < xJPEG_Constants::c_MaxArithTabs; TabId++) { m_ArithCounterDC[TabId].init(); m_ArithCounterAC[TabId].init(); } }
+  const xArithCounterDC* getArithCountersDC() const { return m_ArithCounterDC; }
+  const xArithCounterAC* getArithCountersAC() const { return m_ArithCounterAC; }
+
+protected:
+  void  xEncodeBlock(const int16* ScanCoeff, uint64 NonZeroMask, eCmp Cmp, int32 ArithTableIdDC, int32 ArithTableIdAC);
+  void  xEmitDC  (int32 TabId, int32 BinIdx, int32 Bit) { if(m_GatherStats) { m_ArithCounterDC[TabId].count(BinIdx, Bit); } else { m_ArithEncoder.encodeBit(m_StatsDC[TabId][BinIdx], Bit); } }
+  void  xEmitAC  (int32 TabId, int32 BinIdx, int32 Bit) { if(m_GatherStats) { m_ArithCounterAC[TabId].count(BinIdx, Bit); } else { m_ArithEncoder.encodeBit(m_StatsAC[TabId][BinIdx], Bit); } }
+  void  xEmitSign(int32 Bit) { if(!m_GatherStats) { m_ArithEncoder.encodeBit(m_StatFixed, Bit); } }
 };
 
 //=====================================================================================================================================================================================
@@ -107,22 +313,92 @@ protected:
 
 class xEntropyEstimator : public xEntropyCommon
 {
+public:
+  //block state for incremental (single coefficient change) rate estimation
+  class xBlockState
+  {
+  protected:
+    int16  m_ScanCoeff[xJPEG_Constants::c_BlockArea];
+    uint64 m_NonZeroMask   = 0; //bit 0 (DC) is always set - serves as run start for first AC coefficient
+    int32  m_NumBits       = 0;
+    int32  m_LastDC        = 0;
+    int32  m_HuffTableIdDC = 0; //conditioning table in arithmetic coding mode
+    int32  m_HuffTableIdAC = 0; //conditioning table in arithmetic coding mode
+
+  public:
+    int32        getNumBits   (         ) const { return m_NumBits; }
+    int16        getCoeff     (int32 Pos) const { return m_ScanCoeff[Pos]; }
+    const int16* getScanCoeffs(         ) const { return m_ScanCoeff; }
+
+    void update(int32 Pos, int16 NewCoeff, int32 DeltaBits)
+    {
+      m_ScanCoeff[Pos] = NewCoeff;
+      if(Pos != 0) { m_NonZeroMask = NewCoeff != 0 ? m_NonZeroMask | ((uint64)1 << Pos) : m_NonZeroMask & ~((uint64)1 << Pos); }
+      m_NumBits += DeltaBits;
+    }
+    void storeBlockInfo(xBlockInfo& Info) const { Info.set(m_NonZeroMask, m_NumBits); }
+
+    friend class xEntropyEstimator;
+  };
+
 protected:
   xHuffEstimatorDC*  m_HuffEstimatorDC[xJPEG_Constants::c_MaxHuffTabs];
   xHuffEstimatorAC*  m_HuffEstimatorAC[xJPEG_Constants::c_MaxHuffTabs];
+  //arithmetic coding rate model - rate is expressed in 1/xArithCommon::c_CostScale bit units
+  //stateless estimation assumes zero DC conditioning category (DC coefficient is not modified by RDOQ)
+  bool               m_Arithmetic = false;
+  xArithEstimatorDC* m_ArithEstimatorDC[xJPEG_Constants::c_MaxArithTabs];
+  xArithEstimatorAC* m_ArithEstimatorAC[xJPEG_Constants::c_MaxArithTabs];
+  uint8              m_ContextDC       [xJPEG_Constants::c_MaxComponents];
 
 public:
-  xEntropyEstimator () { memset(m_HuffEstimatorDC, 0, sizeof(m_HuffEstimatorDC)); memset(m_HuffEstimatorAC, 0, sizeof(m_HuffEstimatorAC)); }
+  xEntropyEstimator () { memset(m_HuffEstimatorDC, 0, sizeof(m_HuffEstimatorDC)); memset(m_HuffEstimatorAC, 0, sizeof(m_HuffEstimatorAC)); memset(m_ArithEstimatorDC, 0, sizeof(m_ArithEstimatorDC)); memset(m_ArithEstimatorAC, 0, sizeof(m_ArithEstimatorAC)); }
   ~xEntropyEstimator() { UnInit(); }
-  bool  Init  (std::vector<xJFIF::xHuffTable>& HuffTables);
+  bool  Init     (std::vector<xJFIF::xHuffTable>& HuffTables); //Huffman coding rate
+  bool  InitArith(const xArithCounterDC* ArithCountersDC, const xArithCounterAC* ArithCountersAC); //arithmetic coding rate - c_MaxArithTabs counters of decisions per class
   void  UnInit();
 
-  void  StartSlice() { xResetLastDC(); }
+  bool  isArithmetic() const { return m_Arithmetic; }
+  int32 getRateScale() const { return m_Arithmetic ? xArithCommon::c_CostScale : 1; } //rate units per bit
+
+  void  StartSlice() { xResetLastDC(); memset(m_ContextDC, 0, sizeof(m_ContextDC)); }
   int32 EstimateBlock(const int16* ScanCoeff, eCmp Cmp, int32 HuffTableIdDC, int32 HuffTableIdAC);
+  int32 EstimateBlock(const int16* ScanCoeff, const xBlockInfo& Info, eCmp Cmp, int32 HuffTableIdDC, int32 HuffTableIdAC); //non-zero coefficients taken from block info
   int32 EstimateBlockStateless(const int16* ScanCoeff, int32 LastDC, int32 HuffTableIdDC, int32 HuffTableIdAC) const;
 
+  //incremental estimation - O(1) bit delta for change of single coefficient, bit-exact with EstimateBlockStateless
+  void  InitBlockState(xBlockState& State, const int16* ScanCoeff, int32 LastDC, int32 HuffTableIdDC, int32 HuffTableIdAC) const;
+  void  InitBlockState(xBlockState& State, const int16* ScanCoeff, const xBlockInfo& Info, int32 LastDC, int32 HuffTableIdDC, int32 HuffTableIdAC) const; //reuses mask and cached rate (if valid)
+  int32 EstimateDelta (const xBlockState& State, int32 Pos, int16 NewCoeff) const;
+  //batched incremental estimation - bit deltas of NumCandidates alternative values of coefficient at Pos, neighbourhood of Pos is evaluated once for all candidates
+  void  EstimateDeltas(const xBlockState& State, int32 Pos, const int16* NewCoeffs, int32* DeltaBits, int32 NumCandidates) const;
+
+  const xHuffEstimatorDC* getHuffEstimatorDC(int32 HuffTableId) const { return m_HuffEstimatorDC[HuffTableId]; }
+  const xHuffEstimatorAC* getHuffEstimatorAC(int32 HuffTableId) const { return m_HuffEstimatorAC[HuffTableId]; }
+
 protected:
   int32 xEstimateBlockCommon(const int16* ScanCoeff, int32 DeltaDC, int32 HuffTableIdDC, int32 HuffTableIdAC) const;
+  int32 xEstimateBlockArith (const int16* ScanCoeff, uint64 NonZeroMask, int32 DeltaDC, int32 ContextDC, int32 ArithTableIdDC, int32 ArithTableIdAC) const;
+  void  xEstimateDeltasArith(const xBlockState& State, int32 Pos, const int16* NewCoeffs, int32* DeltaBits, int32 NumCandidates) const;
+  static inline int32 xAbsNumBits (int32 Val) { int32 SignMask = Val >> 31; return xNumBits((Val ^ SignMask) - SignMask); }
+
+  //AC coefficients rate - SIMD variants compute non-zero mask and magnitude categories in registers and look up code lengths of non-zero coefficients only
+#if X_SIMD_CAN_USE_AVX512
+  static int32 xEstimateACAVX512(const int16* ScanCoeff, const xHuffEstimatorAC* HE);
+#endif //X_SIMD_CAN_USE_AVX512
+#if X_SIMD_CAN_USE_AVX
+  static int32 xEstimateACAVX   (const int16* ScanCoeff, const xHuffEstimatorAC* HE);
+#endif //X_SIMD_CAN_USE_AVX
+  static int32 xEstimateACSTD   (const int16* ScanCoeff, const xHuffEstimatorAC* HE);
+  static int32 xEstimateACMask  (const int16* ScanCoeff, uint64 ACMask, const xHuffEstimatorAC* HE); //known non-zero mask - magnitude categories of non-zero coefficients only
+
+#if X_CAN_USE_AVX512
+  static inline int32 xEstimateAC(const int16* ScanCoeff, const xHuffEstimatorAC* HE) { return xEstimateACAVX512(ScanCoeff, HE); }
+#elif X_CAN_USE_AVX
+  static inline int32 xEstimateAC(const int16* ScanCoeff, const xHuffEstimatorAC* HE) { return xEstimateACAVX   (ScanCoeff, HE); }
+#else
+  static inline int32 xEstimateAC(const int16* ScanCoeff, const xHuffEstimatorAC* HE) { return xEstimateACSTD   (ScanCoeff, HE); }
+#endif
 };
 
 //=====================================================================================================================================================================================
@@ -160,6 +436,10 @@ public:
   void  UnInit();
 
   void  CountBlock(const int16* ScanCoeff, int32 LastDC, int32 HuffTableIdDC, int32 HuffTableIdAC);
+  void  CountBlock(const int16* ScanCoeff, const xBlockInfo& Info, int32 LastDC, int32 HuffTableIdDC, int32 HuffTableIdAC); //non-zero coefficients taken from block info
+
+  //replaces every table with optimal one for gathered symbol statistics
+  void  BuildOptimalTables(std::vector<xJFIF::xHuffTable>& HuffTables, bool CoverAllSymbols = false) const; //CoverAllSymbols - every valid symbol gets a code (for rate estimation)
 };
 
 //=====================================================================================================================================================================================
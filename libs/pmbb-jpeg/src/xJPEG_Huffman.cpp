@@ -3,6 +3,7 @@
     SPDX-License-Identifier: BSD-3-Clause
 */
 #include "xJPEG_Huffman.h"
+#include <algorithm>
 
 namespace PMBB_NAMESPACE::JPEG {
 
@@ -84,10 +85,6 @@ bool xHuffDecoder::xInitTables(const xJFIF::xHuffTable& HuffTable)
   uint32 TmpCode[257];
   uint8  TmpLen [257];
 
-  //copy code symbols from HuffTable
-  memset(m_CodeSymbols, 0, 256);
-  memcpy(m_CodeSymbols, TabCodeSymbols.data(), TabCodeSymbols.size());
-
   //generate length
   int32 NumLengths = xFillTmpLengths(TmpLen, TabCodeLengths);
   if(NumLengths == NOT_VALID) { return false; }
@@ -96,97 +93,60 @@ bool xHuffDecoder::xInitTables(const xJFIF::xHuffTable& HuffTable)
   bool Result = xFillTmpCodes(TmpCode, TmpLen, NumLengths);
   if(!Result) { return false; }
 
+  if(HuffTable.isDC())
   {
-    int32 p = 0;
-    for(int32 l = 1; l <= 16; l++)
-    {
-      if(TabCodeLengths[l - 1])
-      {
-        m_ValOffset[l] = p - (int32)TmpCode[p];
-        p += TabCodeLengths[l - 1];
-        m_MaxCode[l] = TmpCode[p - 1];
-      }
-      else
-      {
-        m_MaxCode[l] = -1;
-      }
-    }
-    m_ValOffset[17] = 0;
-    m_MaxCode  [17] = 0xFFFFFL;
-  }
-
-#if X_PMBB_JPEG_MULTI_LEVEL_LOOKAHEAD
-  for(int32 i = 0; i < (1 << c_LookAhead1st); i++)
-  {
-    m_Lookup1st[i] = (uint16)((c_LookAhead1st + 1) << c_LookAhead1st);
-  }
-  {
-    int32 p = 0;
-    for(int32 l = 1; l <= c_LookAhead1st; l++)
-    {
-      for(uint32 i = 1; i <= (int32)TabCodeLengths[l - 1]; i++, p++)
-      {
-        int32 LookBits = TmpCode[p] << (c_LookAhead1st - l);
-        for(int32 ctr = 1 << (c_LookAhead1st - l); ctr > 0; ctr--)
-        {
-          m_Lookup1st[LookBits] = (l << c_LookAhead1st) | TabCodeSymbols[p];
-          LookBits++;
-        }
-      }
-    }
+    for(int32 i = 0; i < NumLengths; i++) { if(TabCodeSymbols[i] > 15) { return false; } }
   }
 
-  for(int32 i = 0; i < (1 << c_LookAhead2nd); i++)
-  {
-    m_Lookup2nd[i] = (uint32)((c_LookAhead2nd + 1) << c_LookAhead2nd);
-  }
+  //1st level - short codes, magnitude bits resolved when they fit within lookahead
+  memset(m_Lookup1st, 0, sizeof(m_Lookup1st));
+  int32 p = 0;
+  for(int32 l = 1; l <= c_LookAhead1st; l++)
   {
-    int32 p = 0;
-    for(uint32 l = 1; l <= c_LookAhead2nd; l++)
+    for(int32 i = 0; i < (int32)TabCodeLengths[l - 1]; i++, p++)
     {
-      for(int32 i = 1; i <= (int32)TabCodeLengths[l - 1]; i++, p++)
+      const uint32 Symbol   = TabCodeSymbols[p];
+      const int32  NumBits  = Symbol & 0x0F;
+      const int32  NumExtra = c_LookAhead1st - l;
+      const uint32 LookBits = TmpCode[p] << NumExtra;
+      for(int32 e = 0; e < (1 << NumExtra); e++)
       {
-        int32 LookBits = TmpCode[p] << (c_LookAhead2nd - l);
-        for(int32 ctr = 1 << (c_LookAhead2nd - l); ctr > 0; ctr--)
+        uint32 Lookup = (Symbol << 8) | l;
+        if(NumBits <= NumExtra)
         {
-          m_Lookup2nd[LookBits] = ((l << c_LookAhead2nd) | TabCodeSymbols[p]);
-          LookBits++;
+          int32 Value = NumBits ? xExtend(e >> (NumExtra - NumBits), NumBits) : 0;
+          Lookup |= ((l + NumBits) << 4) | ((uint32)Value << 16);
         }
+        m_Lookup1st[LookBits + e] = Lookup;
       }
     }
   }
 
-#else
-
-  for(int32 i = 0; i < (1 << c_LookAhead); i++)
+  //2nd level - subtable for every 1st level prefix of long codes, remaining (invalid) prefixes share one subtable
+  //invalid codes (corrupted stream) consume 16 bits and give symbol 0
+  constexpr int32 SubTabSize = 1 << c_LookAhead2nd;
+  constexpr int32 Invalid    = 16 << 8;
+  int32 SubTabOffset[1 << c_LookAhead1st];
+  std::fill_n(SubTabOffset, 1 << c_LookAhead1st, (int32)NOT_VALID);
+  m_Lookup2nd.clear();
+  for(int32 q = p; q < NumLengths; q++)
   {
-    m_Lookup[i] = (c_LookAhead + 1) << c_LookAhead;
+    uint32 Prefix = TmpCode[q] >> (TmpLen[q] - c_LookAhead1st);
+    if(SubTabOffset[Prefix] == NOT_VALID) { SubTabOffset[Prefix] = (int32)m_Lookup2nd.size(); m_Lookup2nd.resize(m_Lookup2nd.size() + SubTabSize, (uint16)Invalid); }
+    int32  NumExtra = 16 - TmpLen[q];
+    uint32 LookBits = SubTabOffset[Prefix] + ((TmpCode[q] << NumExtra) & (SubTabSize - 1));
+    for(int32 e = 0; e < (1 << NumExtra); e++) { m_Lookup2nd[LookBits + e] = (uint16)((TmpLen[q] << 8) | TabCodeSymbols[q]); }
   }
+  int32 InvalidOffset = NOT_VALID;
+  for(int32 i = 0; i < (1 << c_LookAhead1st); i++)
   {
-    int32 p = 0;
-    for(int32 l = 1; l <= c_LookAhead; l++)
-    {
-      for(int32 i = 1; i <= (int32)TabCodeLengths[l - 1]; i++, p++)
-      {
-        int32 LookBits = TmpCode[p] << (c_LookAhead - l);
-        for(int32 ctr = 1 << (c_LookAhead - l); ctr > 0; ctr--)
-        {
-          m_Lookup[LookBits] = (l << c_LookAhead) | TabCodeSymbols[p];
-          LookBits++;
-        }
-      }
-    }
-  }
-
-#endif
-
-  if (HuffTable.isDC())
-  {
-    for (int32 i = 0; i < NumLengths; i++)
+    if(m_Lookup1st[i] != 0) { continue; } //short code
+    if(SubTabOffset[i] == NOT_VALID)
     {
-      int sym = TabCodeSymbols[i];
-      if(sym < 0 || sym > 15) { return false; }
+      if(InvalidOffset == NOT_VALID) { InvalidOffset = (int32)m_Lookup2nd.size(); m_Lookup2nd.resize(m_Lookup2nd.size() + SubTabSize, (uint16)Invalid); }
+      SubTabOffset[i] = InvalidOffset;
     }
+    m_Lookup1st[i] = (uint32)SubTabOffset[i] << 16;
   }
 
   return true;
@@ -6,8 +6,8 @@
 #include "xCommonDefJPEG.h"
 #include "xJFIF.h"
 #include "xBitstream.h"
+#include "xJPEG_Bitstream.h"
 
-#define X_PMBB_JPEG_MULTI_LEVEL_LOOKAHEAD 0
 
 namespace PMBB_NAMESPACE::JPEG {
 
@@ -27,107 +27,68 @@ protected:
 class xHuffDecoder : public xHuffCommon
 {
 protected:
-#if X_PMBB_JPEG_MULTI_LEVEL_LOOKAHEAD
-  static const int32 c_LookAhead1st =  8; //fixed size
-  static const int32 c_LookAhead2nd = 16; //fixed size
-#else
-  static const int32 c_LookAhead    = 10; //can be up to 16
-#endif
-
-  uint8  m_CodeSymbols[256];
-  int32  m_MaxCode    [18 ]; //largest code of length k (-1 if none)
-  int32  m_ValOffset  [18 ]; //huffval[] offset for codes of length k
-#if X_PMBB_JPEG_MULTI_LEVEL_LOOKAHEAD
-  uint16 m_Lookup1st  [1<<c_LookAhead1st];
-  uint32 m_Lookup2nd  [1<<c_LookAhead2nd];
-#else
-  uint32  m_Lookup    [1<<c_LookAhead   ];
-#endif
+  //1st level entry - resolves code and (if fits within lookahead) magnitude bits in single lookup
+  //[ 0.. 3] - code length (0 means code longer than c_LookAhead1st - resolved by 2nd level)
+  //[ 4.. 7] - code + magnitude length (0 if magnitude does not fit within lookahead)
+  //[ 8..15] - symbol
+  //[16..31] - decoded magnitude (signed) or offset of 2nd level table
+  static const int32 c_LookAhead1st = 10; //fixed size
+  static const int32 c_LookAhead2nd = 16 - c_LookAhead1st;
+
+  //2nd level entry - [0..7] symbol, [8..12] code length
+  uint32              m_Lookup1st[1<<c_LookAhead1st];
+  std::vector<uint16> m_Lookup2nd; //one subtable (1<<c_LookAhead2nd entries) per 1st level prefix of long codes
 
 public:
-  bool init(const xJFIF::xHuffTable& HuffTable)
-  {     
-    //return xCreateDerrivedDecoder(m_CodeSymbols, m_MaxCode, m_ValOffset, m_Lookup, HuffTable);
-    return xInitTables(HuffTable);
-  }
-#if X_PMBB_JPEG_MULTI_LEVEL_LOOKAHEAD
-  int32 readPrefix(xBitstreamReader* Bitstream)
+  bool init(const xJFIF::xHuffTable& HuffTable) { return xInitTables(HuffTable); }
+
+  //decodes symbol and magnitude bits - returns symbol, magnitude category is in low nibble
+  int32 readSymbol(xBitstreamReaderJPEG* Bitstream, int32& Value)
   {
-    uint32 Peek1st    = Bitstream->peekBits(c_LookAhead1st);
-    uint32 Lockup1st  = m_Lookup1st[Peek1st];
-    uint32 NumBits1st = Lockup1st >> c_LookAhead1st;
+    uint32 Peek    = Bitstream->peekBits(c_LookAhead1st);
+    uint32 Lookup  = m_Lookup1st[Peek];
+    uint32 FullLen = (Lookup >> 4) & 0x0F;
 
-    if(NumBits1st <= c_LookAhead1st)
+    if(FullLen) //code and magnitude resolved
     {
-      Bitstream->skipBits(NumBits1st);
-      return Lockup1st & ((1 << c_LookAhead1st) - 1);
+      Bitstream->skipBits(FullLen);
+      Value = (int32)Lookup >> 16;
+      return (Lookup >> 8) & 0xFF;
     }
-    else
-    {
-      uint32 Peek2nd    = Bitstream->peekBits(c_LookAhead2nd);
-      uint32 Lockup2nd  = m_Lookup2nd[Peek2nd];
-      uint32 NumBits2nd = Lockup2nd >> c_LookAhead2nd;
-      if(NumBits2nd <= c_LookAhead2nd)
-      {
-        Bitstream->skipBits(NumBits2nd);
-        return Lockup2nd & ((1 << c_LookAhead2nd) - 1);
-      }
-      else
-      {
-        int32 S = Bitstream->readBits(NumBits2nd);
-        while(S > m_MaxCode[NumBits2nd])
-        {
-          S <<= 1;
-          S |= Bitstream->readBit();
-          NumBits2nd++;
-        }
-        S = m_CodeSymbols[(S + m_ValOffset[NumBits2nd]) & 0xFF];
-        return S;
-      }
-    }
-  }
-#else
-  int32 readPrefix(xBitstreamReader* Bitstream)
-  {
-    uint32 Peek    = Bitstream->peekBits(c_LookAhead);
-    uint32 Lockup  = m_Lookup[Peek];
-    uint32 NumBits = Lockup >> c_LookAhead;
 
-    if(NumBits <= c_LookAhead)
+    int32 Symbol;
+    uint32 CodeLen = Lookup & 0x0F;
+    if(CodeLen) //code resolved
     {
-      Bitstream->skipBits(NumBits);
-      return Lockup & ((1 << c_LookAhead) - 1);
+      Bitstream->skipBits(CodeLen);
+      Symbol = (Lookup >> 8) & 0xFF;
     }
-    else
+    else //long code
     {
-      int32 S = Bitstream->readBits(NumBits);
-      while(S > m_MaxCode[NumBits])
-      {
-        S <<= 1;
-        S |= Bitstream->readBit();
-        NumBits++;
-      }
-      S = m_CodeSymbols[(S + m_ValOffset[NumBits]) & 0xFF];
-      return S;
-    }    
+      uint32 Peek2nd   = Bitstream->peekBits(16) & ((1 << c_LookAhead2nd) - 1);
+      uint32 Lookup2nd = m_Lookup2nd[(Lookup >> 16) + Peek2nd];
+      Bitstream->skipBits(Lookup2nd >> 8);
+      Symbol = Lookup2nd & 0xFF;
+    }
+    int32 NumBits = Symbol & 0x0F;
+    Value = NumBits ? readSufix(Bitstream, NumBits) : 0;
+    return Symbol;
   }
-#endif
-  int32 readSufix(xBitstreamReader* Bitstream, int32 NumBits)
+  static int32 readSufix(xBitstreamReaderJPEG* Bitstream, int32 NumBits)
   {
     int32 R = Bitstream->readBits(NumBits);
-    int32 Value = R + (((R - (1 << (NumBits - 1))) >> 31) & ((((uint32)-1) << NumBits) + 1));
-    return Value;
+    return xExtend(R, NumBits);
   }
-  int32 readDC(xBitstreamReader* Bitstream)
+  int32 readDC(xBitstreamReaderJPEG* Bitstream)
   {
-    int32 DC = readPrefix(Bitstream);
-    if(DC) { DC = readSufix(Bitstream, DC); }
+    int32 DC;
+    readSymbol(Bitstream, DC);
     return DC;
   }
 
 protected:
+  static inline int32 xExtend(int32 R, int32 NumBits) { return R + (((R - (1 << (NumBits - 1))) >> 31) & ((((uint32)-1) << NumBits) + 1)); }
   bool xInitTables(const xJFIF::xHuffTable& HuffTable);
-
 };
 
 //=====================================================================================================================================================================================
@@ -140,7 +101,7 @@ protected:
 
 public:
   bool init    (const xJFIF::xHuffTable& HuffTable) { if(HuffTable.getClass() != xJFIF::xHuffTable::eHuffClass::DC) { return false; } return xInitEncoderTables(m_HuffCode, m_HuffLen, HuffTable); }
-  void writeDC (xBitstreamWriter* Bitstream, int32 NumBits, uint32 Remainder) { Bitstream->writeBits(m_HuffCode[NumBits], m_HuffLen[NumBits]); Bitstream->writeBits(Remainder, NumBits); }
+  void writeDC (xBitstreamWriterJPEG* Bitstream, int32 NumBits, uint32 Remainder) { Bitstream->writeBits((m_HuffCode[NumBits] << NumBits) | Remainder, m_HuffLen[NumBits] + NumBits); } //code and magnitude in single write (up to 27 bits)
 };
 
 class xHuffEncoderAC : public xHuffCommon
@@ -151,9 +112,9 @@ protected:
 
 public:
   bool init    (xJFIF::xHuffTable& HuffTable) { if(HuffTable.getClass() != xJFIF::xHuffTable::eHuffClass::AC) { return false; } return xInitEncoderTables(m_HuffCode, m_HuffLen, HuffTable); }
-  void writeAC (xBitstreamWriter* Bitstream, int32 Code, int32 NumBits, uint32 Remainder) { Bitstream->writeBits(m_HuffCode[Code], m_HuffLen[Code]); Bitstream->writeBits(Remainder, NumBits); }
-  void writeZRL(xBitstreamWriter* Bitstream) { Bitstream->writeBits(m_HuffCode[0xF0], m_HuffLen[0xF0]); }
-  void writeEOB(xBitstreamWriter* Bitstream) { Bitstream->writeBits(m_HuffCode[0x00], m_HuffLen[0x00]); }
+  void writeAC (xBitstreamWriterJPEG* Bitstream, int32 Code, int32 NumBits, uint32 Remainder) { Bitstream->writeBits((m_HuffCode[Code] << NumBits) | Remainder, m_HuffLen[Code] + NumBits); } //code and magnitude in single write (up to 26 bits)
+  void writeZRL(xBitstreamWriterJPEG* Bitstream) { Bitstream->writeBits(m_HuffCode[0xF0], m_HuffLen[0xF0]); }
+  void writeEOB(xBitstreamWriterJPEG* Bitstream) { Bitstream->writeBits(m_HuffCode[0x00], m_HuffLen[0x00]); }
 };
 
 //=====================================================================================================================================================================================
@@ -177,7 +138,7 @@ public:
 class xHuffEstimatorAC : public xHuffCommon
 {
 protected:
-  uint8  m_HuffLen [xJPEG_Constants::c_MaxNumCodeSymbolsAC];
+  uint8  m_HuffLen [xJPEG_Constants::c_MaxNumCodeSymbolsAC + 3]; //padded - allows 32bit gathers of last entry
 
 public:
   bool init(const xJFIF::xHuffTable& HuffTable)
@@ -190,6 +151,9 @@ public:
   int32 calcAC (int32 Code, int32 NumBits) const { return m_HuffLen[Code] + NumBits; }
   int32 calcZRL() const { return m_HuffLen[0xF0]; }
   int32 calcEOB() const { return m_HuffLen[0x00]; }
+  int32 calcRun(int32 RunLength, int32 NumBits) const { return (RunLength >> 4) * calcZRL() + calcAC(((RunLength & 0xF) << 4) + NumBits, NumBits); } //ZRLs + run/size symbol
+
+  const uint8* getHuffLen() const { return m_HuffLen; }
 };
 
 //=====================================================================================================================================================================================
@@ -202,6 +166,8 @@ protected:
 public:
   bool init   (          ) { memset(m_SymbolCount, 0, xJPEG_Constants::c_MaxNumCodeSymbolsDC * sizeof(uint32)); return true; }
   void countDC(int32 Code) { m_SymbolCount[Code]++; }
+
+  const uint32* getSymbolCount() const { return m_SymbolCount; }
 };
 
 class xHuffCounterAC
@@ -214,6 +180,8 @@ public:
   void countAC (int32 Code) { m_SymbolCount[Code]++; }
   void countZRL(          ) { m_SymbolCount[0xF0]++; }
   void countEOB(          ) { m_SymbolCount[0x00]++; }
+
+  const uint32* getSymbolCount() const { return m_SymbolCount; }
 };
 
 //=====================================================================================================================================================================================
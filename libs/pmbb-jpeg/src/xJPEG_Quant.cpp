@@ -3,6 +3,9 @@
     SPDX-License-Identifier: BSD-3-Clause
 */
 #include "xJPEG_Quant.h"
+#include "xJPEG_TransformConstants.h"
+#include "xJPEG_Scan.h"
+#include "xDistortion.h"
 #include "xHelpersSIMD.h"
 
 namespace PMBB_NAMESPACE::JPEG {
@@ -180,6 +183,28 @@ void xQuantizer::Init(const xJFIF::xQuantTable& QuantTable)
   assert(QuantTable.getPrecision() == 0);
   xInit((uint8*)(QuantTable.getTableData().data()));
 }
+#if !X_SIMD_CAN_USE_AVX512 && !X_SIMD_CAN_USE_AVX
+void xQuantizer::FwdTransformQuantScan(int16* ScanCoeff, const uint16* Samples) const
+{
+  int16 CoeffsTrans[xJPEG_Constants::c_BlockArea];
+  int16 CoeffsQuant[xJPEG_Constants::c_BlockArea];
+  xTransform::FwdTransformDCT_8x8(CoeffsTrans, Samples);
+  CoeffsTrans[0] -= xTransformConstants::c_FwdDcCorr; //DC correction
+  QuantScale(CoeffsQuant, CoeffsTrans);
+  xScan::Scan(ScanCoeff, CoeffsQuant);
+}
+uint64 xQuantizer::InvScanQuantTransformSSD(const int16* ScanCoeff, const uint16* SamplesOrg, int32 LastPos) const
+{
+  int16  CoeffsQuant[xJPEG_Constants::c_BlockArea];
+  int16  CoeffsTrans[xJPEG_Constants::c_BlockArea];
+  uint16 SamplesRec [xJPEG_Constants::c_BlockArea];
+  xScan::InvScan(CoeffsQuant, ScanCoeff);
+  InvScale(CoeffsTrans, CoeffsQuant);
+  CoeffsTrans[0] += xTransformConstants::c_InvDcCorr; //DC correction
+  xTransform::InvTransformDCT_8x8(SamplesRec, CoeffsTrans, LastPos);
+  return xDistortion::CalcSSD(SamplesOrg, SamplesRec, xJPEG_Constants::c_BlockSize, xJPEG_Constants::c_BlockSize, xJPEG_Constants::c_BlockSize, xJPEG_Constants::c_BlockSize);
+}
+#endif //!X_SIMD_CAN_USE_AVX512 && !X_SIMD_CAN_USE_AVX
 void xQuantizer::xInit(const uint8* QuantTable)
 {
   for(int32 i=0; i < 64; i++)
@@ -187,6 +212,7 @@ void xQuantizer::xInit(const uint8* QuantTable)
     int32  ZigZagIdx = xJPEG_Constants::m_InvScanZigZag[i];
     uint16 QuantCoeff = QuantTable[ZigZagIdx];
     m_QuantCoeff[i] = QuantCoeff;
+    m_QuantCoeffScan[ZigZagIdx] = QuantCoeff;
     xComputeReciprocal(QuantCoeff<<4, m_Reciprocal[i], m_Correction[i], m_Scale[i], m_Shift[i]);
   }
 }
@@ -5,6 +5,7 @@
 #pragma once
 #include "xCommonDefJPEG.h"
 #include "xJFIF.h"
+#include "xJPEG_Transform.h"
 
 namespace PMBB_NAMESPACE::JPEG {
 
@@ -73,7 +74,8 @@ public:
 class xQuantizer
 {
 protected:
-  uint16 m_QuantCoeff[64];
+  uint16 m_QuantCoeff    [64];
+  uint16 m_QuantCoeffScan[64]; //zig-zag order
 
   uint16 m_Reciprocal[64];
   uint16 m_Correction[64];
@@ -86,6 +88,9 @@ public:
 
   std::string FormatCoeffs(const std::string& Prefix) const;
 
+  const uint16* getQuantCoeffs    () const { return m_QuantCoeff    ; }
+  const uint16* getQuantCoeffsScan() const { return m_QuantCoeffScan; }
+
 #if X_CAN_USE_AVX512
   void QuantScale(int16* Dst, const int16* Src) const { xQuantAVX512::QuantScale(Dst, Src, m_Correction, m_Reciprocal, m_Scale); }
   void InvScale  (int16* Dst, const int16* Src) const { xQuantAVX512::InvScale  (Dst, Src, m_QuantCoeff                       ); }
@@ -100,6 +105,32 @@ public:
   void InvScale  (int16* Dst, const int16* Src) const { xQuantSTD   ::InvScale  (Dst, Src, m_QuantCoeff                       ); }
 #endif
 
+  //samples to quantized coeffs in zig-zag order (forward transform, DC correction, QuantScale and scan) - equivalent of separate steps
+#if X_CAN_USE_AVX512
+  void FwdTransformQuantScan(int16* ScanCoeff, const uint16* Samples) const { xTransformAVX512::FwdTransformQuantScan_8x8_M16(ScanCoeff, Samples, m_Correction, m_Reciprocal, m_Scale); }
+#elif X_CAN_USE_AVX
+  void FwdTransformQuantScan(int16* ScanCoeff, const uint16* Samples) const { xTransformAVX   ::FwdTransformQuantScan_8x8_M16(ScanCoeff, Samples, m_Correction, m_Reciprocal, m_Scale); }
+#else
+  void FwdTransformQuantScan(int16* ScanCoeff, const uint16* Samples) const;
+#endif
+  //quantized coeffs in zig-zag order to SSD of reconstructed block (InvScale, inverse scan, DC correction, inverse transform and SSD) - equivalent of separate steps
+  //LastPos - position of last nonzero coeff in zig-zag order (upper bound is also valid), selects sparse inverse transform
+#if X_CAN_USE_AVX512
+  uint64 InvScanQuantTransformSSD(const int16* ScanCoeff, const uint16* SamplesOrg, int32 LastPos = xJPEG_Constants::c_BlockArea - 1) const
+  {
+    if(LastPos <= xTransform::c_LastPos4x4) { return xTransformAVX512::InvScanQuantTransformSSD_8x8_4x4_M16(ScanCoeff, m_QuantCoeffScan, SamplesOrg); }
+    return xTransformAVX512::InvScanQuantTransformSSD_8x8_M16(ScanCoeff, m_QuantCoeffScan, SamplesOrg);
+  }
+#elif X_CAN_USE_AVX
+  uint64 InvScanQuantTransformSSD(const int16* ScanCoeff, const uint16* SamplesOrg, int32 LastPos = xJPEG_Constants::c_BlockArea - 1) const
+  {
+    if(LastPos <= xTransform::c_LastPos4x4) { return xTransformAVX   ::InvScanQuantTransformSSD_8x8_4x4_M16(ScanCoeff, m_QuantCoeffScan, SamplesOrg); }
+    return xTransformAVX   ::InvScanQuantTransformSSD_8x8_M16(ScanCoeff, m_QuantCoeffScan, SamplesOrg);
+  }
+#else
+  uint64 InvScanQuantTransformSSD(const int16* ScanCoeff, const uint16* SamplesOrg, int32 LastPos = xJPEG_Constants::c_BlockArea - 1) const;
+#endif
+
 protected:
   void  xInit(const uint8* QuantTable);
 
@@ -119,8 +150,12 @@ public:
 
   const xQuantizer& getQuantizer(int32 QuantTableId) const { return m_Quantizers[QuantTableId]; }
 
-  void  QuantScale(int16* Dst, const int16* Src, int32 QuantTableId) { m_Quantizers[QuantTableId].QuantScale(Dst, Src); }
-  void  InvScale  (int16* Dst, const int16* Src, int32 QuantTableId) { m_Quantizers[QuantTableId].InvScale  (Dst, Src); }
+  void  QuantScale(int16* Dst, const int16* Src, int32 QuantTableId) const { m_Quantizers[QuantTableId].QuantScale(Dst, Src); }
+  void  InvScale  (int16* Dst, const int16* Src, int32 QuantTableId) const { m_Quantizers[QuantTableId].InvScale  (Dst, Src); }
+
+  void  FwdTransformQuantScan(int16* ScanCoeff, const uint16* Samples, int32 QuantTableId) const { m_Quantizers[QuantTableId].FwdTransformQuantScan(ScanCoeff, Samples); }
+  uint64 InvScanQuantTransformSSD(const int16* ScanCoeff, const uint16* SamplesOrg, int32 QuantTableId) const { return m_Quantizers[QuantTableId].InvScanQuantTransformSSD(ScanCoeff, SamplesOrg); }
+  uint64 InvScanQuantTransformSSD(const int16* ScanCoeff, const uint16* SamplesOrg, int32 QuantTableId, int32 LastPos) const { return m_Quantizers[QuantTableId].InvScanQuantTransformSSD(ScanCoeff, SamplesOrg, LastPos); }
 };
 
 //=====================================================================================================================================================================================
@@ -0,0 +1,202 @@
+/*
+    SPDX-FileCopyrightText: 2020-2024 Jakub Stankowski <jakub.stankowski@put.poznan.pl>
+    SPDX-License-Identifier: BSD-3-Clause
+*/
+#include "xJPEG_Stuffing.h"
+#include "xHelpersSIMD.h"
+#include <cstring>
+
+namespace PMBB_NAMESPACE::JPEG {
+
+//=============================================================================================================================================================================
+// xStuffingSTD
+//=============================================================================================================================================================================
+int32 xStuffingSTD::AddStuffing(byte* restrict Dst, const byte* Src, int32 SrcSize)
+{
+  const byte* LastSrc = Src + SrcSize;
+  byte*       DstBeg  = Dst;
+
+  while(Src < LastSrc)
+  {
+    *(Dst++) = *(Src++);
+    if(*(Src - 1) == 0xFF) { *(Dst++) = 0x00; }
+  }
+
+  return (int32)(Dst - DstBeg);
+}
+int32 xStuffingSTD::RemoveStuffing(byte* restrict Dst, const byte* Src, int32 SrcSize, int32& NumRead)
+{
+  const byte* SrcBeg  = Src;
+  const byte* LastSrc = Src + SrcSize;
+  byte*       DstBeg  = Dst;
+
+  while(Src < LastSrc)
+  {
+    if(*Src == 0xFF)
+    {
+      if(Src + 1 < LastSrc && *(Src + 1) == 0x00) { *(Dst++) = 0xFF; Src += 2; } //stuffing
+      else                                         { break; } //marker
+    }
+    else { *(Dst++) = *(Src++); }
+  }
+
+  NumRead = (int32)(Src - SrcBeg);
+  return (int32)(Dst - DstBeg);
+}
+
+//=============================================================================================================================================================================
+// xStuffingSSE
+//=============================================================================================================================================================================
+#if X_SIMD_CAN_USE_SSE
+int32 xStuffingSSE::AddStuffing(byte* restrict Dst, const byte* Src, int32 SrcSize)
+{
+  const __m128i MarkerV = _mm_set1_epi8((char)0xFF);
+  const byte*   LastSrc = Src + SrcSize;
+  byte*         DstBeg  = Dst;
+
+  while(Src + 16 <= LastSrc)
+  {
+    __m128i DataV = _mm_loadu_si128((const __m128i*)Src);
+    uint32  Mask  = (uint32)_mm_movemask_epi8(_mm_cmpeq_epi8(DataV, MarkerV));
+    _mm_storeu_si128((__m128i*)Dst, DataV); //output grows by at least 16 bytes - always within final output
+    if(Mask == 0) { Src += 16; Dst += 16; continue; }
+    //clean run up to (including) first 0xFF
+    int32 RunLen = (int32)xTZCNT(Mask) + 1;
+    Src += RunLen; Dst += RunLen;
+    *(Dst++) = 0x00;
+  }
+
+  Dst += xStuffingSTD::AddStuffing(Dst, Src, (int32)(LastSrc - Src));
+  return (int32)(Dst - DstBeg);
+}
+int32 xStuffingSSE::RemoveStuffing(byte* restrict Dst, const byte* Src, int32 SrcSize, int32& NumRead)
+{
+  const __m128i MarkerV = _mm_set1_epi8((char)0xFF);
+  const byte*   SrcBeg  = Src;
+  const byte*   LastSrc = Src + SrcSize;
+  byte*         DstBeg  = Dst;
+
+  while(Src + 16 <= LastSrc)
+  {
+    __m128i DataV = _mm_loadu_si128((const __m128i*)Src);
+    uint32  Mask  = (uint32)_mm_movemask_epi8(_mm_cmpeq_epi8(DataV, MarkerV));
+    if(Mask == 0) { _mm_storeu_si128((__m128i*)Dst, DataV); Src += 16; Dst += 16; continue; }
+    //clean run up to (excluding) first 0xFF
+    int32 RunLen = (int32)xTZCNT(Mask);
+    std::memcpy(Dst, Src, RunLen); Src += RunLen; Dst += RunLen;
+    if(Src + 1 < LastSrc && *(Src + 1) == 0x00) { *(Dst++) = 0xFF; Src += 2; } //stuffing
+    else { NumRead = (int32)(Src - SrcBeg); return (int32)(Dst - DstBeg); } //marker
+  }
+
+  int32 NumReadTail = 0;
+  Dst += xStuffingSTD::RemoveStuffing(Dst, Src, (int32)(LastSrc - Src), NumReadTail);
+  NumRead = (int32)(Src - SrcBeg) + NumReadTail;
+  return (int32)(Dst - DstBeg);
+}
+#endif //X_SIMD_CAN_USE_SSE
+
+//=============================================================================================================================================================================
+// xStuffingAVX
+//=============================================================================================================================================================================
+#if X_SIMD_CAN_USE_AVX
+int32 xStuffingAVX::AddStuffing(byte* restrict Dst, const byte* Src, int32 SrcSize)
+{
+  const __m256i MarkerV = _mm256_set1_epi8((char)0xFF);
+  const byte*   LastSrc = Src + SrcSize;
+  byte*         DstBeg  = Dst;
+
+  while(Src + 32 <= LastSrc)
+  {
+    __m256i DataV = _mm256_loadu_si256((const __m256i*)Src);
+    uint32  Mask  = (uint32)_mm256_movemask_epi8(_mm256_cmpeq_epi8(DataV, MarkerV));
+    _mm256_storeu_si256((__m256i*)Dst, DataV); //output grows by at least 32 bytes - always within final output
+    if(Mask == 0) { Src += 32; Dst += 32; continue; }
+    //clean run up to (including) first 0xFF
+    int32 RunLen = (int32)xTZCNT(Mask) + 1;
+    Src += RunLen; Dst += RunLen;
+    *(Dst++) = 0x00;
+  }
+
+  Dst += xStuffingSTD::AddStuffing(Dst, Src, (int32)(LastSrc - Src));
+  return (int32)(Dst - DstBeg);
+}
+int32 xStuffingAVX::RemoveStuffing(byte* restrict Dst, const byte* Src, int32 SrcSize, int32& NumRead)
+{
+  const __m256i MarkerV = _mm256_set1_epi8((char)0xFF);
+  const byte*   SrcBeg  = Src;
+  const byte*   LastSrc = Src + SrcSize;
+  byte*         DstBeg  = Dst;
+
+  while(Src + 32 <= LastSrc)
+  {
+    __m256i DataV = _mm256_loadu_si256((const __m256i*)Src);
+    uint32  Mask  = (uint32)_mm256_movemask_epi8(_mm256_cmpeq_epi8(DataV, MarkerV));
+    if(Mask == 0) { _mm256_storeu_si256((__m256i*)Dst, DataV); Src += 32; Dst += 32; continue; }
+    //clean run up to (excluding) first 0xFF
+    int32 RunLen = (int32)xTZCNT(Mask);
+    std::memcpy(Dst, Src, RunLen); Src += RunLen; Dst += RunLen;
+    if(Src + 1 < LastSrc && *(Src + 1) == 0x00) { *(Dst++) = 0xFF; Src += 2; } //stuffing
+    else { NumRead = (int32)(Src - SrcBeg); return (int32)(Dst - DstBeg); } //marker
+  }
+
+  int32 NumReadTail = 0;
+  Dst += xStuffingSTD::RemoveStuffing(Dst, Src, (int32)(LastSrc - Src), NumReadTail);
+  NumRead = (int32)(Src - SrcBeg) + NumReadTail;
+  return (int32)(Dst - DstBeg);
+}
+#endif //X_SIMD_CAN_USE_AVX
+
+//=============================================================================================================================================================================
+// xStuffingAVX512
+//=============================================================================================================================================================================
+#if X_SIMD_CAN_USE_AVX512
+int32 xStuffingAVX512::AddStuffing(byte* restrict Dst, const byte* Src, int32 SrcSize)
+{
+  const __m512i MarkerV = _mm512_set1_epi8((char)0xFF);
+  const byte*   LastSrc = Src + SrcSize;
+  byte*         DstBeg  = Dst;
+
+  while(Src + 64 <= LastSrc)
+  {
+    __m512i DataV = _mm512_loadu_si512((const __m512i*)Src);
+    uint64  Mask  = (uint64)_mm512_cmpeq_epi8_mask(DataV, MarkerV);
+    _mm512_storeu_si512((__m512i*)Dst, DataV); //output grows by at least 64 bytes - always within final output
+    if(Mask == 0) { Src += 64; Dst += 64; continue; }
+    //clean run up to (including) first 0xFF
+    int32 RunLen = (int32)xTZCNT(Mask) + 1;
+    Src += RunLen; Dst += RunLen;
+    *(Dst++) = 0x00;
+  }
+
+  Dst += xStuffingSTD::AddStuffing(Dst, Src, (int32)(LastSrc - Src));
+  return (int32)(Dst - DstBeg);
+}
+int32 xStuffingAVX512::RemoveStuffing(byte* restrict Dst, const byte* Src, int32 SrcSize, int32& NumRead)
+{
+  const __m512i MarkerV = _mm512_set1_epi8((char)0xFF);
+  const byte*   SrcBeg  = Src;
+  const byte*   LastSrc = Src + SrcSize;
+  byte*         DstBeg  = Dst;
+
+  while(Src + 64 <= LastSrc)
+  {
+    __m512i DataV = _mm512_loadu_si512((const __m512i*)Src);
+    uint64  Mask  = (uint64)_mm512_cmpeq_epi8_mask(DataV, MarkerV);
+    if(Mask == 0) { _mm512_storeu_si512((__m512i*)Dst, DataV); Src += 64; Dst += 64; continue; }
+    //clean run up to (excluding) first 0xFF
+    int32 RunLen = (int32)xTZCNT(Mask);
+    std::memcpy(Dst, Src, RunLen); Src += RunLen; Dst += RunLen;
+    if(Src + 1 < LastSrc && *(Src + 1) == 0x00) { *(Dst++) = 0xFF; Src += 2; } //stuffing
+    else { NumRead = (int32)(Src - SrcBeg); return (int32)(Dst - DstBeg); } //marker
+  }
+
+  int32 NumReadTail = 0;
+  Dst += xStuffingSTD::RemoveStuffing(Dst, Src, (int32)(LastSrc - Src), NumReadTail);
+  NumRead = (int32)(Src - SrcBeg) + NumReadTail;
+  return (int32)(Dst - DstBeg);
+}
+#endif //X_SIMD_CAN_USE_AVX512
+
+//=============================================================================================================================================================================
+
+} //end of namespace PMBB::JPEG
@@ -0,0 +1,87 @@
+/*
+    SPDX-FileCopyrightText: 2020-2024 Jakub Stankowski <jakub.stankowski@put.poznan.pl>
+    SPDX-License-Identifier: BSD-3-Clause
+*/
+#pragma once
+#include "xCommonDefJPEG.h"
+
+namespace PMBB_NAMESPACE::JPEG {
+
+//=====================================================================================================================================================================================
+// Byte stuffing of entropy coded segment
+// AddStuffing    - inserts 0x00 after every 0xFF, returns number of written bytes
+// RemoveStuffing - removes 0x00 following 0xFF, stops before marker (0xFF followed by non zero byte), returns number of written bytes
+//=====================================================================================================================================================================================
+
+class xStuffingSTD
+{
+public:
+  static int32 AddStuffing   (byte* restrict Dst, const byte* Src, int32 SrcSize);
+  static int32 RemoveStuffing(byte* restrict Dst, const byte* Src, int32 SrcSize, int32& NumRead);
+};
+
+//=====================================================================================================================================================================================
+
+#if X_SIMD_CAN_USE_SSE
+#define X_CAN_USE_SSE 1
+class xStuffingSSE
+{
+public:
+  static int32 AddStuffing   (byte* restrict Dst, const byte* Src, int32 SrcSize);
+  static int32 RemoveStuffing(byte* restrict Dst, const byte* Src, int32 SrcSize, int32& NumRead);
+};
+#else //X_SIMD_CAN_USE_SSE
+#define X_CAN_USE_SSE 0
+#endif //X_SIMD_CAN_USE_SSE
+
+//=====================================================================================================================================================================================
+
+#if X_SIMD_CAN_USE_AVX
+#define X_CAN_USE_AVX 1
+class xStuffingAVX
+{
+public:
+  static int32 AddStuffing   (byte* restrict Dst, const byte* Src, int32 SrcSize);
+  static int32 RemoveStuffing(byte* restrict Dst, const byte* Src, int32 SrcSize, int32& NumRead);
+};
+#else //X_SIMD_CAN_USE_AVX
+#define X_CAN_USE_AVX 0
+#endif //X_SIMD_CAN_USE_AVX
+
+//=====================================================================================================================================================================================
+
+#if X_SIMD_CAN_USE_AVX512
+#define X_CAN_USE_AVX512 1
+class xStuffingAVX512
+{
+public:
+  static int32 AddStuffing   (byte* restrict Dst, const byte* Src, int32 SrcSize);
+  static int32 RemoveStuffing(byte* restrict Dst, const byte* Src, int32 SrcSize, int32& NumRead);
+};
+#else //X_SIMD_CAN_USE_AVX512
+#define X_CAN_USE_AVX512 0
+#endif //X_SIMD_CAN_USE_AVX512
+
+//=====================================================================================================================================================================================
+
+class xStuffing
+{
+public:
+#if X_CAN_USE_AVX512
+  static inline int32 AddStuffing   (byte* Dst, const byte* Src, int32 SrcSize               ) { return xStuffingAVX512::AddStuffing   (Dst, Src, SrcSize         ); }
+  static inline int32 RemoveStuffing(byte* Dst, const byte* Src, int32 SrcSize, int32& NumRead) { return xStuffingAVX512::RemoveStuffing(Dst, Src, SrcSize, NumRead); }
+#elif X_CAN_USE_AVX
+  static inline int32 AddStuffing   (byte* Dst, const byte* Src, int32 SrcSize               ) { return xStuffingAVX   ::AddStuffing   (Dst, Src, SrcSize         ); }
+  static inline int32 RemoveStuffing(byte* Dst, const byte* Src, int32 SrcSize, int32& NumRead) { return xStuffingAVX   ::RemoveStuffing(Dst, Src, SrcSize, NumRead); }
+#elif X_CAN_USE_SSE
+  static inline int32 AddStuffing   (byte* Dst, const byte* Src, int32 SrcSize               ) { return xStuffingSSE   ::AddStuffing   (Dst, Src, SrcSize         ); }
+  static inline int32 RemoveStuffing(byte* Dst, const byte* Src, int32 SrcSize, int32& NumRead) { return xStuffingSSE   ::RemoveStuffing(Dst, Src, SrcSize, NumRead); }
+#else
+  static inline int32 AddStuffing   (byte* Dst, const byte* Src, int32 SrcSize               ) { return xStuffingSTD   ::AddStuffing   (Dst, Src, SrcSize         ); }
+  static inline int32 RemoveStuffing(byte* Dst, const byte* Src, int32 SrcSize, int32& NumRead) { return xStuffingSTD   ::RemoveStuffing(Dst, Src, SrcSize, NumRead); }
+#endif
+};
+
+//=====================================================================================================================================================================================
+
+} //end of namespace PMBB::JPEG
@@ -14,6 +14,14 @@ namespace PMBB_NAMESPACE::JPEG {
 static constexpr int32 PASS1_BITS = 2;
 using tTC = xTransformConstants;
 
+//two neighbouring coefficients of transform matrix row k (or column k if Transposed) packed as madd_epi16 operand
+template<bool Transposed> static inline int32 xPackPairTC(int32 k, int32 p)
+{
+  const int16 C0 = Transposed ? tTC::c_TrM_DCT8x8_16bit[2*p    ][k] : tTC::c_TrM_DCT8x8_16bit[k][2*p    ];
+  const int16 C1 = Transposed ? tTC::c_TrM_DCT8x8_16bit[2*p + 1][k] : tTC::c_TrM_DCT8x8_16bit[k][2*p + 1];
+  return (int32)(((uint32)(uint16)C1 << 16) | (uint32)(uint16)C0);
+}
+
 //=====================================================================================================================================================================================
 // xTransformFLT
 //=====================================================================================================================================================================================
@@ -308,6 +316,64 @@ void xTransformSTD::InvTransformDCT_8x8_BTF(uint16* restrict Dst, const int16* S
     Dst+= 8;
   }
 }
+void xTransformSTD::InvTransformDCT_8x8_DC_M16(uint16* restrict Dst, const int16* Src)
+{
+  //only first basis function contributes (all its coeffs are equal), intermediate saturated as in SIMD variants
+  const int32 Tmp = xClipS16(((int32)Src[0] * (int32)tTC::c_TrM_DCT8x8_16bit[0][0] + tTC::c_InvAdd1st_16bit) >> tTC::c_InvShift1st_16bit);
+  const uint16 V  = (uint16)xClipU16((Tmp * (int32)tTC::c_TrM_DCT8x8_16bit[0][0] + tTC::c_InvAdd2nd_16bit) >> tTC::c_InvShift2nd_16bit);
+  for(int32 i=0; i < xJPEG_Constants::c_BlockArea; i++) { Dst[i] = V; }
+}
+void xTransformSTD::InvTransformDCT_8x8_DC_BTF(uint16* restrict Dst, const int16* Src)
+{
+  const int32 Shift1st  = tTC::c_CoeffPrec_BTF - PASS1_BITS;
+  const int32 Add1st    = 1<<(Shift1st-1); 
+  const int32 Shift2nd  = tTC::c_CoeffPrec_BTF + PASS1_BITS + 3;
+  const int32 Add2nd    = 1<<(Shift2nd-1); 
+
+  //only even part of first column (vertical) and first row (horizontal) is nonzero
+  const int32  Tmp = (int16)((((int32)Src[0] << tTC::c_CoeffPrec_BTF) + Add1st)>>Shift1st);
+  const uint16 V   = (uint16)xClipU16(xClipS16(((Tmp << tTC::c_CoeffPrec_BTF) + Add2nd)>>Shift2nd));
+  for(int32 i=0; i < xJPEG_Constants::c_BlockArea; i++) { Dst[i] = V; }
+}
+template<int32 Log2Scale> static inline void xInvTransformDCT_8x8_Scaled_M16(uint16* restrict Dst, const int16* Src)
+{
+  //N-point basis functions are subsampled 8-point ones (row u<<Log2Scale, first N columns) - normalization and rounding of 8x8 transform is kept, so DC only block gives same value as full transform
+  constexpr int32 Size = xJPEG_Constants::c_BlockSize >> Log2Scale;
+  int16 Tmp[8][8]; //partial transformed
+
+  for(int32 j=0; j < Size; j++) //vertical transform
+  {
+    for(int32 u=0; u < Size; u++)
+    {
+      int32 Coeff = 0;
+      for(int32 y=0; y < Size; y++) { Coeff += (int32)Src[y*8] * (int32)tTC::c_TrM_DCT8x8_16bit[y << Log2Scale][u]; }
+      Tmp[u][j] = (int16)xClipS16((Coeff + tTC::c_InvAdd1st_16bit) >> tTC::c_InvShift1st_16bit);
+    }
+    Src++;
+  }
+
+  for(int32 j=0; j < Size; j++) //horizontal transform
+  {
+    for(int32 u=0; u < Size; u++)
+    {
+      int32 Coeff = 0;
+      for(int32 x=0; x < Size; x++) { Coeff += (int32)Tmp[j][x] * (int32)tTC::c_TrM_DCT8x8_16bit[x << Log2Scale][u]; }
+      Dst[u] = (uint16)xClipU16((Coeff + tTC::c_InvAdd2nd_16bit) >> tTC::c_InvShift2nd_16bit);
+    }
+    Dst += 8;
+  }
+}
+void xTransformSTD::InvTransformDCT_8x8_Scaled_M16(uint16* restrict Dst, const int16* Src, int32 Log2Scale)
+{
+  switch(Log2Scale)
+  {
+    case 0: xInvTransformDCT_8x8_Scaled_M16<0>(Dst, Src); break;
+    case 1: xInvTransformDCT_8x8_Scaled_M16<1>(Dst, Src); break;
+    case 2: xInvTransformDCT_8x8_Scaled_M16<2>(Dst, Src); break;
+    case 3: xInvTransformDCT_8x8_Scaled_M16<3>(Dst, Src); break;
+    default: assert(0); break;
+  }
+}
 
 //=====================================================================================================================================================================================
 // xTransformSSE
@@ -608,7 +674,7 @@ void xTransformSSE::InvTransformDCT_8x8_M16(uint16* restrict Dst, const int16* r
 // xTransformAVX
 //=====================================================================================================================================================================================
 #if X_SIMD_CAN_USE_AVX
-void xTransformAVX::FwdTransformDCT_8x8_M16(int16* restrict Dst, const uint16* Src)
+static inline void xFwdTransformDCT_8x8_M16_AVX(__m256i* Dst_I16_V, const uint16* Src)
 {
   const __m256i Add1stV  = _mm256_set1_epi32(tTC::c_FrwAdd1st_16bit);
   const __m256i Add2ndV  = _mm256_set1_epi32(tTC::c_FrwAdd2nd_16bit);
@@ -672,18 +738,50 @@ void xTransformAVX::FwdTransformDCT_8x8_M16(int16* restrict Dst, const uint16* S
   __m256i TrsV6_I32_V = _mm256_permutevar8x32_epi32(_mm256_srai_epi32(_mm256_add_epi32(TrV6_I32_V, Add2ndV), tTC::c_FrwShift2nd_16bit), PermCtlV);
   __m256i TrsV7_I32_V = _mm256_permutevar8x32_epi32(_mm256_srai_epi32(_mm256_add_epi32(TrV7_I32_V, Add2ndV), tTC::c_FrwShift2nd_16bit), PermCtlV);
 
-  __m256i Dst_I16_V0 = _mm256_permute4x64_epi64(_mm256_packs_epi32(TrsV0_I32_V, TrsV1_I32_V), 0xD8);
-  __m256i Dst_I16_V1 = _mm256_permute4x64_epi64(_mm256_packs_epi32(TrsV2_I32_V, TrsV3_I32_V), 0xD8);
-  __m256i Dst_I16_V2 = _mm256_permute4x64_epi64(_mm256_packs_epi32(TrsV4_I32_V, TrsV5_I32_V), 0xD8);
-  __m256i Dst_I16_V3 = _mm256_permute4x64_epi64(_mm256_packs_epi32(TrsV6_I32_V, TrsV7_I32_V), 0xD8);
+  Dst_I16_V[0] = _mm256_permute4x64_epi64(_mm256_packs_epi32(TrsV0_I32_V, TrsV1_I32_V), 0xD8);
+  Dst_I16_V[1] = _mm256_permute4x64_epi64(_mm256_packs_epi32(TrsV2_I32_V, TrsV3_I32_V), 0xD8);
+  Dst_I16_V[2] = _mm256_permute4x64_epi64(_mm256_packs_epi32(TrsV4_I32_V, TrsV5_I32_V), 0xD8);
+  Dst_I16_V[3] = _mm256_permute4x64_epi64(_mm256_packs_epi32(TrsV6_I32_V, TrsV7_I32_V), 0xD8);
+}
+void xTransformAVX::FwdTransformDCT_8x8_M16(int16* restrict Dst, const uint16* Src)
+{
+  __m256i Dst_I16_V[4];
+  xFwdTransformDCT_8x8_M16_AVX(Dst_I16_V, Src);
 
   //store
-  _mm256_storeu_si256((__m256i*)(Dst     ), Dst_I16_V0);
-  _mm256_storeu_si256((__m256i*)(Dst + 16), Dst_I16_V1);
-  _mm256_storeu_si256((__m256i*)(Dst + 32), Dst_I16_V2);
-  _mm256_storeu_si256((__m256i*)(Dst + 48), Dst_I16_V3);
+  _mm256_storeu_si256((__m256i*)(Dst     ), Dst_I16_V[0]);
+  _mm256_storeu_si256((__m256i*)(Dst + 16), Dst_I16_V[1]);
+  _mm256_storeu_si256((__m256i*)(Dst + 32), Dst_I16_V[2]);
+  _mm256_storeu_si256((__m256i*)(Dst + 48), Dst_I16_V[3]);
 }
-void xTransformAVX::InvTransformDCT_8x8_M16(uint16* restrict Dst, const int16* Src)
+void xTransformAVX::FwdTransformQuantScan_8x8_M16(int16* restrict ScanCoeff, const uint16* Src, const uint16* Correction, const uint16* Reciprocal, const uint16* Scale)
+{
+  const __m256i OneV    = _mm256_set1_epi16(1);
+  const __m256i DcCorrV = _mm256_setr_epi16(tTC::c_FwdDcCorr, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0);
+
+  //transform & DC correction
+  __m256i Coeff_I16_V[4];
+  xFwdTransformDCT_8x8_M16_AVX(Coeff_I16_V, Src);
+  Coeff_I16_V[0] = _mm256_sub_epi16(Coeff_I16_V[0], DcCorrV);
+
+  //quant (same as xQuantAVX::QuantScale)
+  int16 CoeffsQuant[xJPEG_Constants::c_BlockArea];
+  for(int32 i = 0; i < 4; i++)
+  {
+    __m256i CorrcV = _mm256_loadu_si256((__m256i*)(Correction + 16 * i));
+    __m256i RecipV = _mm256_loadu_si256((__m256i*)(Reciprocal + 16 * i));
+    __m256i ScaleV = _mm256_loadu_si256((__m256i*)(Scale      + 16 * i));
+    __m256i SignV  = _mm256_sign_epi16(OneV, Coeff_I16_V[i]);
+    __m256i CoeffV = _mm256_abs_epi16(Coeff_I16_V[i]);
+    CoeffV = _mm256_mulhi_epu16(_mm256_mulhi_epu16(_mm256_add_epi16(CoeffV, CorrcV), RecipV), ScaleV);
+    CoeffV = _mm256_sign_epi16(CoeffV, SignV);
+    _mm256_storeu_si256((__m256i*)(CoeffsQuant + 16 * i), CoeffV);
+  }
+
+  //scan - no cross-lane 16 bit permutation in AVX2, block is read back from L1
+  for(int32 i = 0; i < xJPEG_Constants::c_BlockArea; i++) { ScanCoeff[i] = CoeffsQuant[xJPEG_Constants::m_ScanZigZag[i]]; }
+}
+static inline void xInvTransformDCT_8x8_M16_AVX(__m256i* Dst_U16_V, const __m256i* SrcT_I16_V)
 {
   const __m256i Add1stV  = _mm256_set1_epi32(tTC::c_InvAdd1st_16bit);
   const __m256i Add2ndV  = _mm256_set1_epi32(tTC::c_InvAdd2nd_16bit);
@@ -698,47 +796,15 @@ void xTransformAVX::InvTransformDCT_8x8_M16(uint16* restrict Dst, const int16* S
   const __m256i xTC6_V = _mm256_setr_epi16(16384,-19266,  8867,  4520,-16384, 22725,-21407, 12873,   16384,-19266,  8867,  4520,-16384, 22725,-21407, 12873);
   const __m256i xTC7_V = _mm256_setr_epi16(16384,-22725, 21407,-19266, 16384,-12873,  8867, -4520,   16384,-22725, 21407,-19266, 16384,-12873,  8867, -4520);
 
-  //load
-  __m256i Src_I16_V0 = _mm256_loadu_si256((__m256i*)(Src     ));
-  __m256i Src_I16_V1 = _mm256_loadu_si256((__m256i*)(Src + 16));
-  __m256i Src_I16_V2 = _mm256_loadu_si256((__m256i*)(Src + 32));
-  __m256i Src_I16_V3 = _mm256_loadu_si256((__m256i*)(Src + 48));
-
-  //transpose  
-  __m256i SrcT_I16_A0 = _mm256_permute4x64_epi64(Src_I16_V0, 0xD8);
-  __m256i SrcT_I16_A1 = _mm256_permute4x64_epi64(Src_I16_V1, 0xD8);
-  __m256i SrcT_I16_A2 = _mm256_permute4x64_epi64(Src_I16_V2, 0xD8);
-  __m256i SrcT_I16_A3 = _mm256_permute4x64_epi64(Src_I16_V3, 0xD8);
-
-  __m256i SrcT_I16_B0 = _mm256_unpacklo_epi16(SrcT_I16_A0, SrcT_I16_A2);
-  __m256i SrcT_I16_B1 = _mm256_unpackhi_epi16(SrcT_I16_A0, SrcT_I16_A2);
-  __m256i SrcT_I16_B2 = _mm256_unpacklo_epi16(SrcT_I16_A1, SrcT_I16_A3);
-  __m256i SrcT_I16_B3 = _mm256_unpackhi_epi16(SrcT_I16_A1, SrcT_I16_A3);
-
-  __m256i SrcT_I16_C0 = _mm256_unpacklo_epi16(SrcT_I16_B0, SrcT_I16_B2);
-  __m256i SrcT_I16_C1 = _mm256_unpackhi_epi16(SrcT_I16_B0, SrcT_I16_B2);
-  __m256i SrcT_I16_C2 = _mm256_unpacklo_epi16(SrcT_I16_B1, SrcT_I16_B3);
-  __m256i SrcT_I16_C3 = _mm256_unpackhi_epi16(SrcT_I16_B1, SrcT_I16_B3);
-
-  __m256i SrcT_I16_D0 = _mm256_unpacklo_epi16(SrcT_I16_C0, SrcT_I16_C2);
-  __m256i SrcT_I16_D1 = _mm256_unpackhi_epi16(SrcT_I16_C0, SrcT_I16_C2);
-  __m256i SrcT_I16_D2 = _mm256_unpacklo_epi16(SrcT_I16_C1, SrcT_I16_C3);
-  __m256i SrcT_I16_D3 = _mm256_unpackhi_epi16(SrcT_I16_C1, SrcT_I16_C3);
-
-  __m256i SrcT_I16_V0 = _mm256_permute2x128_si256(SrcT_I16_D0, SrcT_I16_D1, 0x20);
-  __m256i SrcT_I16_V1 = _mm256_permute2x128_si256(SrcT_I16_D2, SrcT_I16_D3, 0x20);
-  __m256i SrcT_I16_V2 = _mm256_permute2x128_si256(SrcT_I16_D0, SrcT_I16_D1, 0x31);
-  __m256i SrcT_I16_V3 = _mm256_permute2x128_si256(SrcT_I16_D2, SrcT_I16_D3, 0x31);
-
   //horizontal transform
-  __m256i TrH0_I32_V = _mm256_hadd_epi32(_mm256_hadd_epi32(_mm256_madd_epi16(SrcT_I16_V0, xTC0_V), _mm256_madd_epi16(SrcT_I16_V1, xTC0_V)), _mm256_hadd_epi32(_mm256_madd_epi16(SrcT_I16_V2, xTC0_V), _mm256_madd_epi16(SrcT_I16_V3, xTC0_V)));
-  __m256i TrH1_I32_V = _mm256_hadd_epi32(_mm256_hadd_epi32(_mm256_madd_epi16(SrcT_I16_V0, xTC1_V), _mm256_madd_epi16(SrcT_I16_V1, xTC1_V)), _mm256_hadd_epi32(_mm256_madd_epi16(SrcT_I16_V2, xTC1_V), _mm256_madd_epi16(SrcT_I16_V3, xTC1_V)));
-  __m256i TrH2_I32_V = _mm256_hadd_epi32(_mm256_hadd_epi32(_mm256_madd_epi16(SrcT_I16_V0, xTC2_V), _mm256_madd_epi16(SrcT_I16_V1, xTC2_V)), _mm256_hadd_epi32(_mm256_madd_epi16(SrcT_I16_V2, xTC2_V), _mm256_madd_epi16(SrcT_I16_V3, xTC2_V)));
-  __m256i TrH3_I32_V = _mm256_hadd_epi32(_mm256_hadd_epi32(_mm256_madd_epi16(SrcT_I16_V0, xTC3_V), _mm256_madd_epi16(SrcT_I16_V1, xTC3_V)), _mm256_hadd_epi32(_mm256_madd_epi16(SrcT_I16_V2, xTC3_V), _mm256_madd_epi16(SrcT_I16_V3, xTC3_V)));
-  __m256i TrH4_I32_V = _mm256_hadd_epi32(_mm256_hadd_epi32(_mm256_madd_epi16(SrcT_I16_V0, xTC4_V), _mm256_madd_epi16(SrcT_I16_V1, xTC4_V)), _mm256_hadd_epi32(_mm256_madd_epi16(SrcT_I16_V2, xTC4_V), _mm256_madd_epi16(SrcT_I16_V3, xTC4_V)));
-  __m256i TrH5_I32_V = _mm256_hadd_epi32(_mm256_hadd_epi32(_mm256_madd_epi16(SrcT_I16_V0, xTC5_V), _mm256_madd_epi16(SrcT_I16_V1, xTC5_V)), _mm256_hadd_epi32(_mm256_madd_epi16(SrcT_I16_V2, xTC5_V), _mm256_madd_epi16(SrcT_I16_V3, xTC5_V)));
-  __m256i TrH6_I32_V = _mm256_hadd_epi32(_mm256_hadd_epi32(_mm256_madd_epi16(SrcT_I16_V0, xTC6_V), _mm256_madd_epi16(SrcT_I16_V1, xTC6_V)), _mm256_hadd_epi32(_mm256_madd_epi16(SrcT_I16_V2, xTC6_V), _mm256_madd_epi16(SrcT_I16_V3, xTC6_V)));
-  __m256i TrH7_I32_V = _mm256_hadd_epi32(_mm256_hadd_epi32(_mm256_madd_epi16(SrcT_I16_V0, xTC7_V), _mm256_madd_epi16(SrcT_I16_V1, xTC7_V)), _mm256_hadd_epi32(_mm256_madd_epi16(SrcT_I16_V2, xTC7_V), _mm256_madd_epi16(SrcT_I16_V3, xTC7_V)));
+  __m256i TrH0_I32_V = _mm256_hadd_epi32(_mm256_hadd_epi32(_mm256_madd_epi16(SrcT_I16_V[0], xTC0_V), _mm256_madd_epi16(SrcT_I16_V[1], xTC0_V)), _mm256_hadd_epi32(_mm256_madd_epi16(SrcT_I16_V[2], xTC0_V), _mm256_madd_epi16(SrcT_I16_V[3], xTC0_V)));
+  __m256i TrH1_I32_V = _mm256_hadd_epi32(_mm256_hadd_epi32(_mm256_madd_epi16(SrcT_I16_V[0], xTC1_V), _mm256_madd_epi16(SrcT_I16_V[1], xTC1_V)), _mm256_hadd_epi32(_mm256_madd_epi16(SrcT_I16_V[2], xTC1_V), _mm256_madd_epi16(SrcT_I16_V[3], xTC1_V)));
+  __m256i TrH2_I32_V = _mm256_hadd_epi32(_mm256_hadd_epi32(_mm256_madd_epi16(SrcT_I16_V[0], xTC2_V), _mm256_madd_epi16(SrcT_I16_V[1], xTC2_V)), _mm256_hadd_epi32(_mm256_madd_epi16(SrcT_I16_V[2], xTC2_V), _mm256_madd_epi16(SrcT_I16_V[3], xTC2_V)));
+  __m256i TrH3_I32_V = _mm256_hadd_epi32(_mm256_hadd_epi32(_mm256_madd_epi16(SrcT_I16_V[0], xTC3_V), _mm256_madd_epi16(SrcT_I16_V[1], xTC3_V)), _mm256_hadd_epi32(_mm256_madd_epi16(SrcT_I16_V[2], xTC3_V), _mm256_madd_epi16(SrcT_I16_V[3], xTC3_V)));
+  __m256i TrH4_I32_V = _mm256_hadd_epi32(_mm256_hadd_epi32(_mm256_madd_epi16(SrcT_I16_V[0], xTC4_V), _mm256_madd_epi16(SrcT_I16_V[1], xTC4_V)), _mm256_hadd_epi32(_mm256_madd_epi16(SrcT_I16_V[2], xTC4_V), _mm256_madd_epi16(SrcT_I16_V[3], xTC4_V)));
+  __m256i TrH5_I32_V = _mm256_hadd_epi32(_mm256_hadd_epi32(_mm256_madd_epi16(SrcT_I16_V[0], xTC5_V), _mm256_madd_epi16(SrcT_I16_V[1], xTC5_V)), _mm256_hadd_epi32(_mm256_madd_epi16(SrcT_I16_V[2], xTC5_V), _mm256_madd_epi16(SrcT_I16_V[3], xTC5_V)));
+  __m256i TrH6_I32_V = _mm256_hadd_epi32(_mm256_hadd_epi32(_mm256_madd_epi16(SrcT_I16_V[0], xTC6_V), _mm256_madd_epi16(SrcT_I16_V[1], xTC6_V)), _mm256_hadd_epi32(_mm256_madd_epi16(SrcT_I16_V[2], xTC6_V), _mm256_madd_epi16(SrcT_I16_V[3], xTC6_V)));
+  __m256i TrH7_I32_V = _mm256_hadd_epi32(_mm256_hadd_epi32(_mm256_madd_epi16(SrcT_I16_V[0], xTC7_V), _mm256_madd_epi16(SrcT_I16_V[1], xTC7_V)), _mm256_hadd_epi32(_mm256_madd_epi16(SrcT_I16_V[2], xTC7_V), _mm256_madd_epi16(SrcT_I16_V[3], xTC7_V)));
 
   __m256i TrsH0_I32_V = _mm256_permutevar8x32_epi32(_mm256_srai_epi32(_mm256_add_epi32(TrH0_I32_V, Add1stV), tTC::c_InvShift1st_16bit), PermCtlV);
   __m256i TrsH1_I32_V = _mm256_permutevar8x32_epi32(_mm256_srai_epi32(_mm256_add_epi32(TrH1_I32_V, Add1stV), tTC::c_InvShift1st_16bit), PermCtlV);
@@ -799,16 +865,335 @@ void xTransformAVX::InvTransformDCT_8x8_M16(uint16* restrict Dst, const int16* S
   __m256i DstT_U16_D2 = _mm256_unpacklo_epi16(DstT_U16_C1, DstT_U16_C3);
   __m256i DstT_U16_D3 = _mm256_unpackhi_epi16(DstT_U16_C1, DstT_U16_C3);
 
-  __m256i DstT_U16_V0 = _mm256_permute2x128_si256(DstT_U16_D0, DstT_U16_D1, 0x20);
-  __m256i DstT_U16_V1 = _mm256_permute2x128_si256(DstT_U16_D2, DstT_U16_D3, 0x20);
-  __m256i DstT_U16_V2 = _mm256_permute2x128_si256(DstT_U16_D0, DstT_U16_D1, 0x31);
-  __m256i DstT_U16_V3 = _mm256_permute2x128_si256(DstT_U16_D2, DstT_U16_D3, 0x31);
+  Dst_U16_V[0] = _mm256_permute2x128_si256(DstT_U16_D0, DstT_U16_D1, 0x20);
+  Dst_U16_V[1] = _mm256_permute2x128_si256(DstT_U16_D2, DstT_U16_D3, 0x20);
+  Dst_U16_V[2] = _mm256_permute2x128_si256(DstT_U16_D0, DstT_U16_D1, 0x31);
+  Dst_U16_V[3] = _mm256_permute2x128_si256(DstT_U16_D2, DstT_U16_D3, 0x31);
+}
+void xTransformAVX::InvTransformDCT_8x8_M16(uint16* restrict Dst, const int16* Src)
+{
+  //load
+  __m256i Src_I16_V0 = _mm256_loadu_si256((__m256i*)(Src     ));
+  __m256i Src_I16_V1 = _mm256_loadu_si256((__m256i*)(Src + 16));
+  __m256i Src_I16_V2 = _mm256_loadu_si256((__m256i*)(Src + 32));
+  __m256i Src_I16_V3 = _mm256_loadu_si256((__m256i*)(Src + 48));
+
+  //transpose
+  __m256i SrcT_I16_V[4];
+  __m256i SrcT_I16_A0 = _mm256_permute4x64_epi64(Src_I16_V0, 0xD8);
+  __m256i SrcT_I16_A1 = _mm256_permute4x64_epi64(Src_I16_V1, 0xD8);
+  __m256i SrcT_I16_A2 = _mm256_permute4x64_epi64(Src_I16_V2, 0xD8);
+  __m256i SrcT_I16_A3 = _mm256_permute4x64_epi64(Src_I16_V3, 0xD8);
+
+  __m256i SrcT_I16_B0 = _mm256_unpacklo_epi16(SrcT_I16_A0, SrcT_I16_A2);
+  __m256i SrcT_I16_B1 = _mm256_unpackhi_epi16(SrcT_I16_A0, SrcT_I16_A2);
+  __m256i SrcT_I16_B2 = _mm256_unpacklo_epi16(SrcT_I16_A1, SrcT_I16_A3);
+  __m256i SrcT_I16_B3 = _mm256_unpackhi_epi16(SrcT_I16_A1, SrcT_I16_A3);
+
+  __m256i SrcT_I16_C0 = _mm256_unpacklo_epi16(SrcT_I16_B0, SrcT_I16_B2);
+  __m256i SrcT_I16_C1 = _mm256_unpackhi_epi16(SrcT_I16_B0, SrcT_I16_B2);
+  __m256i SrcT_I16_C2 = _mm256_unpacklo_epi16(SrcT_I16_B1, SrcT_I16_B3);
+  __m256i SrcT_I16_C3 = _mm256_unpackhi_epi16(SrcT_I16_B1, SrcT_I16_B3);
+
+  __m256i SrcT_I16_D0 = _mm256_unpacklo_epi16(SrcT_I16_C0, SrcT_I16_C2);
+  __m256i SrcT_I16_D1 = _mm256_unpackhi_epi16(SrcT_I16_C0, SrcT_I16_C2);
+  __m256i SrcT_I16_D2 = _mm256_unpacklo_epi16(SrcT_I16_C1, SrcT_I16_C3);
+  __m256i SrcT_I16_D3 = _mm256_unpackhi_epi16(SrcT_I16_C1, SrcT_I16_C3);
+
+  SrcT_I16_V[0] = _mm256_permute2x128_si256(SrcT_I16_D0, SrcT_I16_D1, 0x20);
+  SrcT_I16_V[1] = _mm256_permute2x128_si256(SrcT_I16_D2, SrcT_I16_D3, 0x20);
+  SrcT_I16_V[2] = _mm256_permute2x128_si256(SrcT_I16_D0, SrcT_I16_D1, 0x31);
+  SrcT_I16_V[3] = _mm256_permute2x128_si256(SrcT_I16_D2, SrcT_I16_D3, 0x31);
+
+  //transform
+  __m256i Dst_U16_V[4];
+  xInvTransformDCT_8x8_M16_AVX(Dst_U16_V, SrcT_I16_V);
 
   //store
-  _mm256_storeu_si256((__m256i*)(Dst     ), DstT_U16_V0);
-  _mm256_storeu_si256((__m256i*)(Dst + 16), DstT_U16_V1);
-  _mm256_storeu_si256((__m256i*)(Dst + 32), DstT_U16_V2);
-  _mm256_storeu_si256((__m256i*)(Dst + 48), DstT_U16_V3);
+  _mm256_storeu_si256((__m256i*)(Dst     ), Dst_U16_V[0]);
+  _mm256_storeu_si256((__m256i*)(Dst + 16), Dst_U16_V[1]);
+  _mm256_storeu_si256((__m256i*)(Dst + 32), Dst_U16_V[2]);
+  _mm256_storeu_si256((__m256i*)(Dst + 48), Dst_U16_V[3]);
+}
+//inverse zig-zag scan fused with transposition - 16 bit element of (transposed) block is gathered by byte shuffle from one of 8 coefficient chunks broadcasted to both 128 bit lanes
+struct xInvScanTransposeCtlAVX
+{
+  int8  Shuffle  [4][8][32]; //[register][chunk][byte], negative - zero
+  uint8 ChunkMask[4];        //chunks contributing to register
+};
+static constexpr xInvScanTransposeCtlAVX xGenInvScanTransposeCtlAVX()
+{
+  xInvScanTransposeCtlAVX Ctl = {};
+  for(int32 r = 0; r < 4; r++) { for(int32 c = 0; c < 8; c++) { for(int32 b = 0; b < 32; b++) { Ctl.Shuffle[r][c][b] = -128; } } }
+  for(int32 s = 0; s < xJPEG_Constants::c_BlockArea; s++)
+  {
+    const int32 p = xJPEG_Constants::m_ScanZigZag[s];       //raster position
+    const int32 q = ((p & 7) << 3) + (p >> 3);              //transposed position
+    const int32 r = q >> 4, b = (q & 15) << 1, c = s >> 3, e = (s & 7) << 1;
+    Ctl.Shuffle[r][c][b    ] = (int8)(e    );
+    Ctl.Shuffle[r][c][b + 1] = (int8)(e + 1);
+    Ctl.ChunkMask[r] |= (uint8)(1 << c);
+  }
+  return Ctl;
+}
+static constexpr xInvScanTransposeCtlAVX c_InvScanTransposeCtlAVX = xGenInvScanTransposeCtlAVX();
+
+uint64 xTransformAVX::InvScanQuantTransformSSD_8x8_M16(const int16* ScanCoeff, const uint16* QuantCoeffScan, const uint16* Org)
+{
+  const __m256i DcCorrV = _mm256_setr_epi16(tTC::c_InvDcCorr, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0);
+
+  //dequant - in zig-zag order, every chunk of 8 coeffs is broadcasted to both lanes
+  __m256i Chunk_I16_V[8];
+  for(int32 c = 0; c < 8; c++)
+  {
+    __m256i Coeff_I16_V = _mm256_broadcastsi128_si256(_mm_loadu_si128((__m128i*)(ScanCoeff      + 8 * c)));
+    __m256i Quant_U16_V = _mm256_broadcastsi128_si256(_mm_loadu_si128((__m128i*)(QuantCoeffScan + 8 * c)));
+    Chunk_I16_V[c] = _mm256_mullo_epi16(Coeff_I16_V, Quant_U16_V);
+  }
+
+  //inverse scan & transpose & DC correction
+  __m256i SrcT_I16_V[4];
+  for(int32 r = 0; r < 4; r++)
+  {
+    __m256i Acc_I16_V = _mm256_setzero_si256();
+    for(int32 c = 0; c < 8; c++)
+    {
+      if(!(c_InvScanTransposeCtlAVX.ChunkMask[r] & (1 << c))) { continue; }
+      const __m256i ShuffleV = _mm256_loadu_si256((__m256i*)c_InvScanTransposeCtlAVX.Shuffle[r][c]);
+      Acc_I16_V = _mm256_or_si256(Acc_I16_V, _mm256_shuffle_epi8(Chunk_I16_V[c], ShuffleV));
+    }
+    SrcT_I16_V[r] = Acc_I16_V;
+  }
+  SrcT_I16_V[0] = _mm256_add_epi16(SrcT_I16_V[0], DcCorrV);
+
+  //transform
+  __m256i Rec_U16_V[4];
+  xInvTransformDCT_8x8_M16_AVX(Rec_U16_V, SrcT_I16_V);
+
+  //SSD (same as xDistortionAVX::CalcSSD)
+  __m256i SSD_I64_V = _mm256_setzero_si256();
+  for(int32 r = 0; r < 4; r++)
+  {
+    __m256i Org_U16_V  = _mm256_loadu_si256((__m256i*)(Org + 16 * r));
+    __m256i Diff_I16_V = _mm256_sub_epi16     (Org_U16_V, Rec_U16_V[r]);
+    __m256i Pow_I32_V  = _mm256_madd_epi16    (Diff_I16_V, Diff_I16_V);
+    __m256i PowA_I64_V = _mm256_unpacklo_epi32(Pow_I32_V, _mm256_setzero_si256());
+    __m256i PowB_I64_V = _mm256_unpackhi_epi32(Pow_I32_V, _mm256_setzero_si256());
+    SSD_I64_V = _mm256_add_epi64(SSD_I64_V, _mm256_add_epi64(PowA_I64_V, PowB_I64_V));
+  }
+  return (uint64)xHorVecSum_epi64(SSD_I64_V);
+}
+
+//sparse variant - nonzero coeffs limited to top-left 4x4 quarter, both passes use first 4 basis functions only
+//Src_I16_X01 and Src_I16_X23 hold coeffs of rows 0-1 and 2-3 (columns 0..3) interleaved as madd_epi16 pairs
+static inline void xInvTransformDCT_8x8_4x4_M16_AVX(__m256i* Dst_U16_V, __m128i Src_I16_X01, __m128i Src_I16_X23)
+{
+  const __m256i Add1stV = _mm256_set1_epi32(tTC::c_InvAdd1st_16bit);
+  const __m256i Add2ndV = _mm256_set1_epi32(tTC::c_InvAdd2nd_16bit);
+
+  //vertical transform - 128 bit lane k of xTCxx_V[i] produces row 2*i+k
+  const __m256i xTC01_V[4] = {
+    _mm256_setr_epi16( 16384, 22725, 16384, 22725, 16384, 22725, 16384, 22725,    16384, 19266, 16384, 19266, 16384, 19266, 16384, 19266),
+    _mm256_setr_epi16( 16384, 12873, 16384, 12873, 16384, 12873, 16384, 12873,    16384,  4520, 16384,  4520, 16384,  4520, 16384,  4520),
+    _mm256_setr_epi16( 16384, -4520, 16384, -4520, 16384, -4520, 16384, -4520,    16384,-12873, 16384,-12873, 16384,-12873, 16384,-12873),
+    _mm256_setr_epi16( 16384,-19266, 16384,-19266, 16384,-19266, 16384,-19266,    16384,-22725, 16384,-22725, 16384,-22725, 16384,-22725),
+  };
+  const __m256i xTC23_V[4] = {
+    _mm256_setr_epi16( 21407, 19266, 21407, 19266, 21407, 19266, 21407, 19266,     8867, -4520,  8867, -4520,  8867, -4520,  8867, -4520),
+    _mm256_setr_epi16( -8867,-22725, -8867,-22725, -8867,-22725, -8867,-22725,   -21407,-12873,-21407,-12873,-21407,-12873,-21407,-12873),
+    _mm256_setr_epi16(-21407, 12873,-21407, 12873,-21407, 12873,-21407, 12873,    -8867, 22725, -8867, 22725, -8867, 22725, -8867, 22725),
+    _mm256_setr_epi16(  8867,  4520,  8867,  4520,  8867,  4520,  8867,  4520,    21407,-19266, 21407,-19266, 21407,-19266, 21407,-19266),
+  };
+  const __m256i xTC01_L = _mm256_setr_epi16( 16384, 22725, 16384, 19266, 16384, 12873, 16384,  4520,    16384, 22725, 16384, 19266, 16384, 12873, 16384,  4520);
+  const __m256i xTC23_L = _mm256_setr_epi16( 21407, 19266,  8867, -4520, -8867,-22725,-21407,-12873,    21407, 19266,  8867, -4520, -8867,-22725,-21407,-12873);
+  const __m256i xTC01_H = _mm256_setr_epi16( 16384, -4520, 16384,-12873, 16384,-19266, 16384,-22725,    16384, -4520, 16384,-12873, 16384,-19266, 16384,-22725);
+  const __m256i xTC23_H = _mm256_setr_epi16(-21407, 12873, -8867, 22725,  8867,  4520, 21407,-19266,   -21407, 12873, -8867, 22725,  8867,  4520, 21407,-19266);
+
+  //vertical transform - lane k of Tri_I16_V[i] holds columns 0..3 of rows 2*i+k and 2*i+k+4
+  __m256i Src_I16_V01 = _mm256_broadcastsi128_si256(Src_I16_X01);
+  __m256i Src_I16_V23 = _mm256_broadcastsi128_si256(Src_I16_X23);
+  __m256i Tri_I16_V[2];
+  for(int32 i = 0; i < 2; i++)
+  {
+    __m256i TrLo_I32_V = _mm256_add_epi32(_mm256_madd_epi16(Src_I16_V01, xTC01_V[i    ]), _mm256_madd_epi16(Src_I16_V23, xTC23_V[i    ]));
+    __m256i TrHi_I32_V = _mm256_add_epi32(_mm256_madd_epi16(Src_I16_V01, xTC01_V[i + 2]), _mm256_madd_epi16(Src_I16_V23, xTC23_V[i + 2]));
+    TrLo_I32_V   = _mm256_srai_epi32(_mm256_add_epi32(TrLo_I32_V, Add1stV), tTC::c_InvShift1st_16bit);
+    TrHi_I32_V   = _mm256_srai_epi32(_mm256_add_epi32(TrHi_I32_V, Add1stV), tTC::c_InvShift1st_16bit);
+    Tri_I16_V[i] = _mm256_packs_epi32(TrLo_I32_V, TrHi_I32_V);
+  }
+
+  //horizontal transform - pairs of row coeffs are broadcasted, columns 0..3 (L) and 4..7 (H) are produced separately
+  for(int32 i = 0; i < 2; i++)
+  {
+    __m256i Row01Lo_I16_V = _mm256_shuffle_epi32(Tri_I16_V[i], 0x00);
+    __m256i Row23Lo_I16_V = _mm256_shuffle_epi32(Tri_I16_V[i], 0x55);
+    __m256i Row01Hi_I16_V = _mm256_shuffle_epi32(Tri_I16_V[i], 0xAA);
+    __m256i Row23Hi_I16_V = _mm256_shuffle_epi32(Tri_I16_V[i], 0xFF);
+
+    __m256i TrLoL_I32_V = _mm256_add_epi32(_mm256_madd_epi16(Row01Lo_I16_V, xTC01_L), _mm256_madd_epi16(Row23Lo_I16_V, xTC23_L));
+    __m256i TrLoH_I32_V = _mm256_add_epi32(_mm256_madd_epi16(Row01Lo_I16_V, xTC01_H), _mm256_madd_epi16(Row23Lo_I16_V, xTC23_H));
+    __m256i TrHiL_I32_V = _mm256_add_epi32(_mm256_madd_epi16(Row01Hi_I16_V, xTC01_L), _mm256_madd_epi16(Row23Hi_I16_V, xTC23_L));
+    __m256i TrHiH_I32_V = _mm256_add_epi32(_mm256_madd_epi16(Row01Hi_I16_V, xTC01_H), _mm256_madd_epi16(Row23Hi_I16_V, xTC23_H));
+
+    TrLoL_I32_V = _mm256_srai_epi32(_mm256_add_epi32(TrLoL_I32_V, Add2ndV), tTC::c_InvShift2nd_16bit);
+    TrLoH_I32_V = _mm256_srai_epi32(_mm256_add_epi32(TrLoH_I32_V, Add2ndV), tTC::c_InvShift2nd_16bit);
+    TrHiL_I32_V = _mm256_srai_epi32(_mm256_add_epi32(TrHiL_I32_V, Add2ndV), tTC::c_InvShift2nd_16bit);
+    TrHiH_I32_V = _mm256_srai_epi32(_mm256_add_epi32(TrHiH_I32_V, Add2ndV), tTC::c_InvShift2nd_16bit);
+
+    Dst_U16_V[i    ] = _mm256_packus_epi32(TrLoL_I32_V, TrLoH_I32_V); //rows 2*i   and 2*i+1
+    Dst_U16_V[i + 2] = _mm256_packus_epi32(TrHiL_I32_V, TrHiH_I32_V); //rows 2*i+4 and 2*i+5
+  }
+}
+void xTransformAVX::InvTransformDCT_8x8_4x4_M16(uint16* restrict Dst, const int16* Src)
+{
+  __m128i Src_I16_X01 = _mm_unpacklo_epi16(_mm_loadl_epi64((__m128i*)(Src     )), _mm_loadl_epi64((__m128i*)(Src +  8)));
+  __m128i Src_I16_X23 = _mm_unpacklo_epi16(_mm_loadl_epi64((__m128i*)(Src + 16)), _mm_loadl_epi64((__m128i*)(Src + 24)));
+
+  __m256i Dst_U16_V[4];
+  xInvTransformDCT_8x8_4x4_M16_AVX(Dst_U16_V, Src_I16_X01, Src_I16_X23);
+
+  _mm256_storeu_si256((__m256i*)(Dst     ), Dst_U16_V[0]);
+  _mm256_storeu_si256((__m256i*)(Dst + 16), Dst_U16_V[1]);
+  _mm256_storeu_si256((__m256i*)(Dst + 32), Dst_U16_V[2]);
+  _mm256_storeu_si256((__m256i*)(Dst + 48), Dst_U16_V[3]);
+}
+//dequant, inverse scan and DC correction of first 16 coeffs in zig-zag order - valid when last nonzero coeff position <= 9 (all within top-left 4x4 quarter)
+static inline void xInvScanQuant_4x4_M16(__m128i& Src_I16_X01, __m128i& Src_I16_X23, const int16* ScanCoeff, const uint16* QuantCoeffScan)
+{
+  const __m128i DcCorrV  = _mm_setr_epi16(tTC::c_InvDcCorr, 0, 0, 0, 0, 0, 0, 0);
+  const __m128i Ctl01_C0 = _mm_setr_epi8(0, 1, 4, 5, 2, 3, 8, 9, 10, 11, 14, 15, 12, 13, -1, -1);
+  const __m128i Ctl23_C0 = _mm_setr_epi8(6, 7, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+  const __m128i Ctl23_C1 = _mm_setr_epi8(-1, -1, 2, 3, 0, 1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+
+  __m128i Chunk0_I16_V = _mm_mullo_epi16(_mm_loadu_si128((__m128i*)(ScanCoeff    )), _mm_loadu_si128((__m128i*)(QuantCoeffScan    )));
+  __m128i Chunk1_I16_V = _mm_mullo_epi16(_mm_loadu_si128((__m128i*)(ScanCoeff + 8)), _mm_loadu_si128((__m128i*)(QuantCoeffScan + 8)));
+  Src_I16_X01 = _mm_add_epi16(_mm_shuffle_epi8(Chunk0_I16_V, Ctl01_C0), DcCorrV);
+  Src_I16_X23 = _mm_or_si128 (_mm_shuffle_epi8(Chunk0_I16_V, Ctl23_C0), _mm_shuffle_epi8(Chunk1_I16_V, Ctl23_C1));
+}
+uint64 xTransformAVX::InvScanQuantTransformSSD_8x8_4x4_M16(const int16* ScanCoeff, const uint16* QuantCoeffScan, const uint16* Org)
+{
+  __m128i Src_I16_X01, Src_I16_X23;
+  xInvScanQuant_4x4_M16(Src_I16_X01, Src_I16_X23, ScanCoeff, QuantCoeffScan);
+
+  __m256i Rec_U16_V[4];
+  xInvTransformDCT_8x8_4x4_M16_AVX(Rec_U16_V, Src_I16_X01, Src_I16_X23);
+
+  //SSD (same as xDistortionAVX::CalcSSD)
+  __m256i SSD_I64_V = _mm256_setzero_si256();
+  for(int32 r = 0; r < 4; r++)
+  {
+    __m256i Org_U16_V  = _mm256_loadu_si256((__m256i*)(Org + 16 * r));
+    __m256i Diff_I16_V = _mm256_sub_epi16     (Org_U16_V, Rec_U16_V[r]);
+    __m256i Pow_I32_V  = _mm256_madd_epi16    (Diff_I16_V, Diff_I16_V);
+    __m256i PowA_I64_V = _mm256_unpacklo_epi32(Pow_I32_V, _mm256_setzero_si256());
+    __m256i PowB_I64_V = _mm256_unpackhi_epi32(Pow_I32_V, _mm256_setzero_si256());
+    SSD_I64_V = _mm256_add_epi64(SSD_I64_V, _mm256_add_epi64(PowA_I64_V, PowB_I64_V));
+  }
+  return (uint64)xHorVecSum_epi64(SSD_I64_V);
+}
+
+//multiple blocks - every 128 bit lane holds different block, all 8 rows (or columns) of 2 blocks are kept in 8 registers
+static inline void xTransposeRows8x8_AVX(__m256i* restrict D, const __m256i* restrict S)
+{
+  __m256i A[8], B[8];
+  for(int32 i = 0; i < 4; i++)
+  {
+    A[2*i    ] = _mm256_unpacklo_epi16(S[2*i], S[2*i + 1]);
+    A[2*i + 1] = _mm256_unpackhi_epi16(S[2*i], S[2*i + 1]);
+  }
+  for(int32 h = 0; h < 8; h += 4)
+  {
+    B[h    ] = _mm256_unpacklo_epi32(A[h    ], A[h + 2]);
+    B[h + 1] = _mm256_unpackhi_epi32(A[h    ], A[h + 2]);
+    B[h + 2] = _mm256_unpacklo_epi32(A[h + 1], A[h + 3]);
+    B[h + 3] = _mm256_unpackhi_epi32(A[h + 1], A[h + 3]);
+  }
+  for(int32 i = 0; i < 4; i++)
+  {
+    D[2*i    ] = _mm256_unpacklo_epi64(B[i], B[i + 4]);
+    D[2*i + 1] = _mm256_unpackhi_epi64(B[i], B[i + 4]);
+  }
+}
+template<bool Transposed> static inline void xInitPairTC_AVX(__m256i TC[8][4])
+{
+  for(int32 k = 0; k < 8; k++) { for(int32 p = 0; p < 4; p++) { TC[k][p] = _mm256_set1_epi32(xPackPairTC<Transposed>(k, p)); } }
+}
+template<bool Unsigned, int32 Add, int32 Shift> static inline void xTransformPass8_AVX(__m256i* restrict D, const __m256i* restrict S, const __m256i TC[8][4])
+{
+  const __m256i AddV = _mm256_set1_epi32(Add);
+  __m256i L[4], H[4];
+  for(int32 p = 0; p < 4; p++)
+  {
+    L[p] = _mm256_unpacklo_epi16(S[2*p], S[2*p + 1]);
+    H[p] = _mm256_unpackhi_epi16(S[2*p], S[2*p + 1]);
+  }
+  for(int32 k = 0; k < 8; k++)
+  {
+    __m256i SumL = AddV;
+    __m256i SumH = AddV;
+    for(int32 p = 0; p < 4; p++)
+    {
+      SumL = _mm256_add_epi32(SumL, _mm256_madd_epi16(L[p], TC[k][p]));
+      SumH = _mm256_add_epi32(SumH, _mm256_madd_epi16(H[p], TC[k][p]));
+    }
+    SumL = _mm256_srai_epi32(SumL, Shift);
+    SumH = _mm256_srai_epi32(SumH, Shift);
+    D[k] = Unsigned ? _mm256_packus_epi32(SumL, SumH) : _mm256_packs_epi32(SumL, SumH);
+  }
+}
+static inline void xLoadBlocks2_AVX(__m256i* restrict R, const int16* Src)
+{
+  constexpr int32 BA = xJPEG_Constants::c_BlockArea;
+  for(int32 q = 0; q < 4; q++)
+  {
+    const __m256i L0 = _mm256_loadu_si256((const __m256i*)(Src      + 16 * q));
+    const __m256i L1 = _mm256_loadu_si256((const __m256i*)(Src + BA + 16 * q));
+    R[2*q    ] = _mm256_permute2x128_si256(L0, L1, 0x20);
+    R[2*q + 1] = _mm256_permute2x128_si256(L0, L1, 0x31);
+  }
+}
+static inline void xStoreBlocks2_AVX(int16* restrict Dst, const __m256i* R)
+{
+  constexpr int32 BA = xJPEG_Constants::c_BlockArea;
+  for(int32 q = 0; q < 4; q++)
+  {
+    _mm256_storeu_si256((__m256i*)(Dst      + 16 * q), _mm256_permute2x128_si256(R[2*q], R[2*q + 1], 0x20));
+    _mm256_storeu_si256((__m256i*)(Dst + BA + 16 * q), _mm256_permute2x128_si256(R[2*q], R[2*q + 1], 0x31));
+  }
+}
+void xTransformAVX::FwdTransformDCT_8x8xN_M16(int16* restrict Dst, const uint16* Src, int32 NumBlocks)
+{
+  constexpr int32 BA = xJPEG_Constants::c_BlockArea;
+  __m256i TC[8][4]; xInitPairTC_AVX<false>(TC);
+
+  for(; NumBlocks >= 2; NumBlocks -= 2, Src += 2 * BA, Dst += 2 * BA)
+  {
+    __m256i R[8], T[8];
+    xLoadBlocks2_AVX(R, (const int16*)Src);
+    xTransposeRows8x8_AVX(T, R);                                                             //columns
+    xTransformPass8_AVX<false, tTC::c_FrwAdd1st_16bit, tTC::c_FrwShift1st_16bit>(R, T, TC); //horizontal transform
+    xTransposeRows8x8_AVX(T, R);                                                             //rows
+    xTransformPass8_AVX<false, tTC::c_FrwAdd2nd_16bit, tTC::c_FrwShift2nd_16bit>(R, T, TC); //vertical transform
+    xStoreBlocks2_AVX(Dst, R);
+  }
+  if(NumBlocks) { FwdTransformDCT_8x8_M16(Dst, Src); }
+}
+void xTransformAVX::InvTransformDCT_8x8xN_M16(uint16* restrict Dst, const int16* Src, int32 NumBlocks)
+{
+  constexpr int32 BA = xJPEG_Constants::c_BlockArea;
+  __m256i TC[8][4]; xInitPairTC_AVX<true>(TC);
+
+  for(; NumBlocks >= 2; NumBlocks -= 2, Src += 2 * BA, Dst += 2 * BA)
+  {
+    __m256i R[8], T[8];
+    xLoadBlocks2_AVX(R, Src);
+    xTransformPass8_AVX<false, tTC::c_InvAdd1st_16bit, tTC::c_InvShift1st_16bit>(T, R, TC); //vertical transform
+    xTransposeRows8x8_AVX(R, T);                                                             //columns
+    xTransformPass8_AVX<true , tTC::c_InvAdd2nd_16bit, tTC::c_InvShift2nd_16bit>(T, R, TC); //horizontal transform
+    xTransposeRows8x8_AVX(R, T);                                                             //rows
+    xStoreBlocks2_AVX((int16*)Dst, R);
+  }
+  if(NumBlocks) { InvTransformDCT_8x8_M16(Dst, Src); }
 }
 #endif //X_SIMD_CAN_USE_AVX
 
@@ -816,7 +1201,7 @@ void xTransformAVX::InvTransformDCT_8x8_M16(uint16* restrict Dst, const int16* S
 // xTransformAVX512
 //=====================================================================================================================================================================================
 #if X_SIMD_CAN_USE_AVX512
-void xTransformAVX512::FwdTransformDCT_8x8_M16(int16* restrict Dst, const uint16* Src)
+static inline void xFwdTransformDCT_8x8_M16_AVX512(__m512i& Dst_I16_V0, __m512i& Dst_I16_V1, const uint16* Src)
 {
   const __m512i Add1stV  = _mm512_set1_epi32(tTC::c_FrwAdd1st_16bit);
   const __m512i Add2ndV  = _mm512_set1_epi32(tTC::c_FrwAdd2nd_16bit);
@@ -868,14 +1253,57 @@ void xTransformAVX512::FwdTransformDCT_8x8_M16(int16* restrict Dst, const uint16
   __m512i TrV45_I32_V = _mm512_srai_epi32(_mm512_add_epi32(_mm512_hadd_epi32(TrV4_I32_V, TrV5_I32_V), Add2ndV), tTC::c_FrwShift2nd_16bit);
   __m512i TrV67_I32_V = _mm512_srai_epi32(_mm512_add_epi32(_mm512_hadd_epi32(TrV6_I32_V, TrV7_I32_V), Add2ndV), tTC::c_FrwShift2nd_16bit);
 
-  __m512i Dst_I16_V0 = _mm512_permutexvar_epi64(PermCtlV, _mm512_packs_epi32(TrV01_I32_V, TrV23_I32_V));
-  __m512i Dst_I16_V1 = _mm512_permutexvar_epi64(PermCtlV, _mm512_packs_epi32(TrV45_I32_V, TrV67_I32_V));
+  Dst_I16_V0 = _mm512_permutexvar_epi64(PermCtlV, _mm512_packs_epi32(TrV01_I32_V, TrV23_I32_V));
+  Dst_I16_V1 = _mm512_permutexvar_epi64(PermCtlV, _mm512_packs_epi32(TrV45_I32_V, TrV67_I32_V));
+}
+void xTransformAVX512::FwdTransformDCT_8x8_M16(int16* restrict Dst, const uint16* Src)
+{
+  __m512i Dst_I16_V0, Dst_I16_V1;
+  xFwdTransformDCT_8x8_M16_AVX512(Dst_I16_V0, Dst_I16_V1, Src);
 
   //store
   _mm512_storeu_si512((__m512i*)(Dst     ), Dst_I16_V0);
   _mm512_storeu_si512((__m512i*)(Dst + 32), Dst_I16_V1);
 }
-void xTransformAVX512::InvTransformDCT_8x8_M16(uint16* restrict Dst, const int16* Src)
+static inline __m512i xQuantScale_AVX512(__m512i CoeffSrcV, const uint16* Correction, const uint16* Reciprocal, const uint16* Scale)
+{
+  //same as xQuantAVX512::QuantScale
+  __m512i CorrectionV = _mm512_loadu_si512((__m512i*)Correction);
+  __m512i ReciprocalV = _mm512_loadu_si512((__m512i*)Reciprocal);
+  __m512i ScaleV      = _mm512_loadu_si512((__m512i*)Scale     );
+  uint32  SignMask    = _mm512_cmpgt_epi16_mask(CoeffSrcV, _mm512_setzero_si512());
+  __m512i CoeffAbsV   = _mm512_abs_epi16(CoeffSrcV);
+  __m512i CoeffQntV   = _mm512_mulhi_epu16(_mm512_mulhi_epu16(_mm512_add_epi16(CoeffAbsV, CorrectionV), ReciprocalV), ScaleV);
+  __m512i CoeffNegV   = _mm512_sub_epi16(_mm512_setzero_si512(), CoeffQntV);
+  return _mm512_mask_blend_epi16(SignMask, CoeffNegV, CoeffQntV);
+}
+void xTransformAVX512::FwdTransformQuantScan_8x8_M16(int16* restrict ScanCoeff, const uint16* Src, const uint16* Correction, const uint16* Reciprocal, const uint16* Scale)
+{
+  const __m512i DcCorrV = _mm512_setr_epi16(tTC::c_FwdDcCorr, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0);
+  //zig-zag scan selectors (same as xScanAVX512::Scan)
+  const __m512i Selector_U16_V0 = _mm512_setr_epi16( 0,  1,  8, 16,  9,  2,  3, 10,
+                                                    17, 24, 32, 25, 18, 11,  4,  5,
+                                                    12, 19, 26, 33, 40, 48, 41, 34,
+                                                    27, 20, 13,  6,  7, 14, 21, 28);
+  const __m512i Selector_U16_V1 = _mm512_setr_epi16(35, 42, 49, 56, 57, 50, 43, 36,
+                                                    29, 22, 15, 23, 30, 37, 44, 51,
+                                                    58, 59, 52, 45, 38, 31, 39, 46,
+                                                    53, 60, 61, 54, 47, 55, 62, 63);
+
+  //transform & DC correction
+  __m512i Coeff_I16_V0, Coeff_I16_V1;
+  xFwdTransformDCT_8x8_M16_AVX512(Coeff_I16_V0, Coeff_I16_V1, Src);
+  Coeff_I16_V0 = _mm512_sub_epi16(Coeff_I16_V0, DcCorrV);
+
+  //quant
+  __m512i Quant_I16_V0 = xQuantScale_AVX512(Coeff_I16_V0, Correction     , Reciprocal     , Scale     );
+  __m512i Quant_I16_V1 = xQuantScale_AVX512(Coeff_I16_V1, Correction + 32, Reciprocal + 32, Scale + 32);
+
+  //scan & store
+  _mm512_storeu_si512((__m512i*)(ScanCoeff     ), _mm512_permutex2var_epi16(Quant_I16_V0, Selector_U16_V0, Quant_I16_V1));
+  _mm512_storeu_si512((__m512i*)(ScanCoeff + 32), _mm512_permutex2var_epi16(Quant_I16_V0, Selector_U16_V1, Quant_I16_V1));
+}
+static inline void xInvTransformDCT_8x8_M16_AVX512(__m512i& Dst_U16_V0, __m512i& Dst_U16_V1, __m512i SrcT_I16_V0, __m512i SrcT_I16_V1)
 {
   const __m512i Add1stV  = _mm512_set1_epi32(tTC::c_InvAdd1st_16bit);
   const __m512i Add2ndV  = _mm512_set1_epi32(tTC::c_InvAdd2nd_16bit);
@@ -899,14 +1327,6 @@ void xTransformAVX512::InvTransformDCT_8x8_M16(uint16* restrict Dst, const int16
   const __m512i xTC6_V = _mm512_setr_epi16(16384,-19266,  8867,  4520,-16384, 22725,-21407, 12873,   16384,-19266,  8867,  4520,-16384, 22725,-21407, 12873,   16384,-19266,  8867,  4520,-16384, 22725,-21407, 12873,   16384,-19266,  8867,  4520,-16384, 22725,-21407, 12873);
   const __m512i xTC7_V = _mm512_setr_epi16(16384,-22725, 21407,-19266, 16384,-12873,  8867, -4520,   16384,-22725, 21407,-19266, 16384,-12873,  8867, -4520,   16384,-22725, 21407,-19266, 16384,-12873,  8867, -4520,   16384,-22725, 21407,-19266, 16384,-12873,  8867, -4520);
 
-  //load
-  __m512i Src_I16_V0 = _mm512_loadu_si512((__m512i*)(Src     ));
-  __m512i Src_I16_V1 = _mm512_loadu_si512((__m512i*)(Src + 32));
-
-  //transpose
-  __m512i SrcT_I16_V0 = _mm512_permutex2var_epi16(Src_I16_V0, Transpose_U16_V0, Src_I16_V1);
-  __m512i SrcT_I16_V1 = _mm512_permutex2var_epi16(Src_I16_V0, Transpose_U16_V1, Src_I16_V1);
-
   //horizontal transform & transpose
   __m512i TrH0_I32_V = _mm512_hadd_epi32(_mm512_madd_epi16(SrcT_I16_V0, xTC0_V), _mm512_madd_epi16(SrcT_I16_V1, xTC0_V));
   __m512i TrH1_I32_V = _mm512_hadd_epi32(_mm512_madd_epi16(SrcT_I16_V0, xTC1_V), _mm512_madd_epi16(SrcT_I16_V1, xTC1_V));
@@ -940,16 +1360,261 @@ void xTransformAVX512::InvTransformDCT_8x8_M16(uint16* restrict Dst, const int16
   __m512i TrV45_I32_V = _mm512_srai_epi32(_mm512_add_epi32(_mm512_hadd_epi32(TrV4_I32_V, TrV5_I32_V), Add2ndV), tTC::c_InvShift2nd_16bit);
   __m512i TrV67_I32_V = _mm512_srai_epi32(_mm512_add_epi32(_mm512_hadd_epi32(TrV6_I32_V, TrV7_I32_V), Add2ndV), tTC::c_InvShift2nd_16bit);
 
-  __m512i Dst_U16_V0 = _mm512_permutexvar_epi64(PermCtlV, _mm512_packus_epi32(TrV01_I32_V, TrV23_I32_V));
-  __m512i Dst_U16_V1 = _mm512_permutexvar_epi64(PermCtlV, _mm512_packus_epi32(TrV45_I32_V, TrV67_I32_V));
+  __m512i DstT_U16_V0 = _mm512_permutexvar_epi64(PermCtlV, _mm512_packus_epi32(TrV01_I32_V, TrV23_I32_V));
+  __m512i DstT_U16_V1 = _mm512_permutexvar_epi64(PermCtlV, _mm512_packus_epi32(TrV45_I32_V, TrV67_I32_V));
 
-  ////transpose
-  __m512i DstT_U16_V0 = _mm512_permutex2var_epi16(Dst_U16_V0, Transpose_U16_V0, Dst_U16_V1);
-  __m512i DstT_U16_V1 = _mm512_permutex2var_epi16(Dst_U16_V0, Transpose_U16_V1, Dst_U16_V1);
+  //transpose
+  Dst_U16_V0 = _mm512_permutex2var_epi16(DstT_U16_V0, Transpose_U16_V0, DstT_U16_V1);
+  Dst_U16_V1 = _mm512_permutex2var_epi16(DstT_U16_V0, Transpose_U16_V1, DstT_U16_V1);
+}
+void xTransformAVX512::InvTransformDCT_8x8_M16(uint16* restrict Dst, const int16* Src)
+{
+  const __m512i Transpose_U16_V0  = _mm512_setr_epi16(0, 8,16,24,32,40,48,56,
+                                                      1, 9,17,25,33,41,49,57,
+                                                      2,10,18,26,34,42,50,58,
+                                                      3,11,19,27,35,43,51,59);
+  const __m512i Transpose_U16_V1  = _mm512_setr_epi16(4,12,20,28,36,44,52,60,
+                                                      5,13,21,29,37,45,53,61,
+                                                      6,14,22,30,38,46,54,62,
+                                                      7,15,23,31,39,47,55,63);
+
+  //load
+  __m512i Src_I16_V0 = _mm512_loadu_si512((__m512i*)(Src     ));
+  __m512i Src_I16_V1 = _mm512_loadu_si512((__m512i*)(Src + 32));
+
+  //transpose
+  __m512i SrcT_I16_V0 = _mm512_permutex2var_epi16(Src_I16_V0, Transpose_U16_V0, Src_I16_V1);
+  __m512i SrcT_I16_V1 = _mm512_permutex2var_epi16(Src_I16_V0, Transpose_U16_V1, Src_I16_V1);
+
+  //transform
+  __m512i Dst_U16_V0, Dst_U16_V1;
+  xInvTransformDCT_8x8_M16_AVX512(Dst_U16_V0, Dst_U16_V1, SrcT_I16_V0, SrcT_I16_V1);
 
   //store
-  _mm512_storeu_si512((__m512i*)(Dst     ), DstT_U16_V0);
-  _mm512_storeu_si512((__m512i*)(Dst + 32), DstT_U16_V1);
+  _mm512_storeu_si512((__m512i*)(Dst     ), Dst_U16_V0);
+  _mm512_storeu_si512((__m512i*)(Dst + 32), Dst_U16_V1);
+}
+uint64 xTransformAVX512::InvScanQuantTransformSSD_8x8_M16(const int16* ScanCoeff, const uint16* QuantCoeffScan, const uint16* Org)
+{
+  const __m512i DcCorrV = _mm512_setr_epi16(tTC::c_InvDcCorr, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0);
+  //inverse zig-zag scan selectors combined with transposition
+  const __m512i InvScanT_U16_V0 = _mm512_setr_epi16( 0,  2,  3,  9, 10, 20, 21, 35,
+                                                     1,  4,  8, 11, 19, 22, 34, 36,
+                                                     5,  7, 12, 18, 23, 33, 37, 48,
+                                                     6, 13, 17, 24, 32, 38, 47, 49);
+  const __m512i InvScanT_U16_V1 = _mm512_setr_epi16(14, 16, 25, 31, 39, 46, 50, 57,
+                                                    15, 26, 30, 40, 45, 51, 56, 58,
+                                                    27, 29, 41, 44, 52, 55, 59, 62,
+                                                    28, 42, 43, 53, 54, 60, 61, 63);
+
+  //dequant - in zig-zag order
+  __m512i Coeff_I16_V0 = _mm512_mullo_epi16(_mm512_loadu_si512((__m512i*)(ScanCoeff     )), _mm512_loadu_si512((__m512i*)(QuantCoeffScan     )));
+  __m512i Coeff_I16_V1 = _mm512_mullo_epi16(_mm512_loadu_si512((__m512i*)(ScanCoeff + 32)), _mm512_loadu_si512((__m512i*)(QuantCoeffScan + 32)));
+
+  //inverse scan & transpose & DC correction
+  __m512i SrcT_I16_V0 = _mm512_add_epi16(_mm512_permutex2var_epi16(Coeff_I16_V0, InvScanT_U16_V0, Coeff_I16_V1), DcCorrV);
+  __m512i SrcT_I16_V1 =                  _mm512_permutex2var_epi16(Coeff_I16_V0, InvScanT_U16_V1, Coeff_I16_V1);
+
+  //transform
+  __m512i Rec_U16_V0, Rec_U16_V1;
+  xInvTransformDCT_8x8_M16_AVX512(Rec_U16_V0, Rec_U16_V1, SrcT_I16_V0, SrcT_I16_V1);
+
+  //SSD (same as xDistortionAVX512::CalcSSD)
+  __m512i Diff_I16_V0 = _mm512_sub_epi16(_mm512_loadu_si512((__m512i*)(Org     )), Rec_U16_V0);
+  __m512i Diff_I16_V1 = _mm512_sub_epi16(_mm512_loadu_si512((__m512i*)(Org + 32)), Rec_U16_V1);
+  __m512i Pow_I32_V0  = _mm512_madd_epi16(Diff_I16_V0, Diff_I16_V0);
+  __m512i Pow_I32_V1  = _mm512_madd_epi16(Diff_I16_V1, Diff_I16_V1);
+  __m512i SSD_I64_V0  = _mm512_add_epi64(_mm512_unpacklo_epi32(Pow_I32_V0, _mm512_setzero_si512()), _mm512_unpackhi_epi32(Pow_I32_V0, _mm512_setzero_si512()));
+  __m512i SSD_I64_V1  = _mm512_add_epi64(_mm512_unpacklo_epi32(Pow_I32_V1, _mm512_setzero_si512()), _mm512_unpackhi_epi32(Pow_I32_V1, _mm512_setzero_si512()));
+  return (uint64)xHorVecSum_epi64(_mm512_add_epi64(SSD_I64_V0, SSD_I64_V1));
+}
+
+//sparse variant - nonzero coeffs limited to top-left 4x4 quarter, both passes use first 4 basis functions only
+//Src_I16_X01 and Src_I16_X23 hold coeffs of rows 0-1 and 2-3 (columns 0..3) interleaved as madd_epi16 pairs
+static inline void xInvTransformDCT_8x8_4x4_M16_AVX512(__m512i& Dst_U16_V0, __m512i& Dst_U16_V1, __m128i Src_I16_X01, __m128i Src_I16_X23)
+{
+  const __m512i Add1stV = _mm512_set1_epi32(tTC::c_InvAdd1st_16bit);
+  const __m512i Add2ndV = _mm512_set1_epi32(tTC::c_InvAdd2nd_16bit);
+
+  //vertical transform - 128 bit lane k of xTCxx_V0 produces row k, of xTCxx_V1 row k+4
+  //horizontal transform - columns 0..3 (L) and 4..7 (H)
+  const __m512i xTC01_V0 = _mm512_setr_epi16( 16384, 22725, 16384, 22725, 16384, 22725, 16384, 22725,    16384, 19266, 16384, 19266, 16384, 19266, 16384, 19266,    16384, 12873, 16384, 12873, 16384, 12873, 16384, 12873,    16384,  4520, 16384,  4520, 16384,  4520, 16384,  4520);
+  const __m512i xTC23_V0 = _mm512_setr_epi16( 21407, 19266, 21407, 19266, 21407, 19266, 21407, 19266,     8867, -4520,  8867, -4520,  8867, -4520,  8867, -4520,    -8867,-22725, -8867,-22725, -8867,-22725, -8867,-22725,   -21407,-12873,-21407,-12873,-21407,-12873,-21407,-12873);
+  const __m512i xTC01_V1 = _mm512_setr_epi16( 16384, -4520, 16384, -4520, 16384, -4520, 16384, -4520,    16384,-12873, 16384,-12873, 16384,-12873, 16384,-12873,    16384,-19266, 16384,-19266, 16384,-19266, 16384,-19266,    16384,-22725, 16384,-22725, 16384,-22725, 16384,-22725);
+  const __m512i xTC23_V1 = _mm512_setr_epi16(-21407, 12873,-21407, 12873,-21407, 12873,-21407, 12873,    -8867, 22725, -8867, 22725, -8867, 22725, -8867, 22725,     8867,  4520,  8867,  4520,  8867,  4520,  8867,  4520,    21407,-19266, 21407,-19266, 21407,-19266, 21407,-19266);
+  const __m512i xTC01_L  = _mm512_setr_epi16( 16384, 22725, 16384, 19266, 16384, 12873, 16384,  4520,    16384, 22725, 16384, 19266, 16384, 12873, 16384,  4520,    16384, 22725, 16384, 19266, 16384, 12873, 16384,  4520,    16384, 22725, 16384, 19266, 16384, 12873, 16384,  4520);
+  const __m512i xTC23_L  = _mm512_setr_epi16( 21407, 19266,  8867, -4520, -8867,-22725,-21407,-12873,    21407, 19266,  8867, -4520, -8867,-22725,-21407,-12873,    21407, 19266,  8867, -4520, -8867,-22725,-21407,-12873,    21407, 19266,  8867, -4520, -8867,-22725,-21407,-12873);
+  const __m512i xTC01_H  = _mm512_setr_epi16( 16384, -4520, 16384,-12873, 16384,-19266, 16384,-22725,    16384, -4520, 16384,-12873, 16384,-19266, 16384,-22725,    16384, -4520, 16384,-12873, 16384,-19266, 16384,-22725,    16384, -4520, 16384,-12873, 16384,-19266, 16384,-22725);
+  const __m512i xTC23_H  = _mm512_setr_epi16(-21407, 12873, -8867, 22725,  8867,  4520, 21407,-19266,   -21407, 12873, -8867, 22725,  8867,  4520, 21407,-19266,   -21407, 12873, -8867, 22725,  8867,  4520, 21407,-19266,   -21407, 12873, -8867, 22725,  8867,  4520, 21407,-19266);
+
+  //vertical transform - lane k of Tri_I16_V holds columns 0..3 of rows k and k+4
+  __m512i Src_I16_V01 = _mm512_broadcast_i32x4(Src_I16_X01);
+  __m512i Src_I16_V23 = _mm512_broadcast_i32x4(Src_I16_X23);
+  __m512i TrLo_I32_V  = _mm512_add_epi32(_mm512_madd_epi16(Src_I16_V01, xTC01_V0), _mm512_madd_epi16(Src_I16_V23, xTC23_V0));
+  __m512i TrHi_I32_V  = _mm512_add_epi32(_mm512_madd_epi16(Src_I16_V01, xTC01_V1), _mm512_madd_epi16(Src_I16_V23, xTC23_V1));
+  TrLo_I32_V = _mm512_srai_epi32(_mm512_add_epi32(TrLo_I32_V, Add1stV), tTC::c_InvShift1st_16bit);
+  TrHi_I32_V = _mm512_srai_epi32(_mm512_add_epi32(TrHi_I32_V, Add1stV), tTC::c_InvShift1st_16bit);
+  __m512i Tri_I16_V = _mm512_packs_epi32(TrLo_I32_V, TrHi_I32_V);
+
+  //horizontal transform - pairs of row coeffs are broadcasted
+  __m512i Row01Lo_I16_V = _mm512_shuffle_epi32(Tri_I16_V, _MM_PERM_AAAA);
+  __m512i Row23Lo_I16_V = _mm512_shuffle_epi32(Tri_I16_V, _MM_PERM_BBBB);
+  __m512i Row01Hi_I16_V = _mm512_shuffle_epi32(Tri_I16_V, _MM_PERM_CCCC);
+  __m512i Row23Hi_I16_V = _mm512_shuffle_epi32(Tri_I16_V, _MM_PERM_DDDD);
+
+  __m512i TrLoL_I32_V = _mm512_add_epi32(_mm512_madd_epi16(Row01Lo_I16_V, xTC01_L), _mm512_madd_epi16(Row23Lo_I16_V, xTC23_L));
+  __m512i TrLoH_I32_V = _mm512_add_epi32(_mm512_madd_epi16(Row01Lo_I16_V, xTC01_H), _mm512_madd_epi16(Row23Lo_I16_V, xTC23_H));
+  __m512i TrHiL_I32_V = _mm512_add_epi32(_mm512_madd_epi16(Row01Hi_I16_V, xTC01_L), _mm512_madd_epi16(Row23Hi_I16_V, xTC23_L));
+  __m512i TrHiH_I32_V = _mm512_add_epi32(_mm512_madd_epi16(Row01Hi_I16_V, xTC01_H), _mm512_madd_epi16(Row23Hi_I16_V, xTC23_H));
+
+  TrLoL_I32_V = _mm512_srai_epi32(_mm512_add_epi32(TrLoL_I32_V, Add2ndV), tTC::c_InvShift2nd_16bit);
+  TrLoH_I32_V = _mm512_srai_epi32(_mm512_add_epi32(TrLoH_I32_V, Add2ndV), tTC::c_InvShift2nd_16bit);
+  TrHiL_I32_V = _mm512_srai_epi32(_mm512_add_epi32(TrHiL_I32_V, Add2ndV), tTC::c_InvShift2nd_16bit);
+  TrHiH_I32_V = _mm512_srai_epi32(_mm512_add_epi32(TrHiH_I32_V, Add2ndV), tTC::c_InvShift2nd_16bit);
+
+  Dst_U16_V0 = _mm512_packus_epi32(TrLoL_I32_V, TrLoH_I32_V); //rows 0..3
+  Dst_U16_V1 = _mm512_packus_epi32(TrHiL_I32_V, TrHiH_I32_V); //rows 4..7
+}
+void xTransformAVX512::InvTransformDCT_8x8_4x4_M16(uint16* restrict Dst, const int16* Src)
+{
+  __m128i Src_I16_X01 = _mm_unpacklo_epi16(_mm_loadl_epi64((__m128i*)(Src     )), _mm_loadl_epi64((__m128i*)(Src +  8)));
+  __m128i Src_I16_X23 = _mm_unpacklo_epi16(_mm_loadl_epi64((__m128i*)(Src + 16)), _mm_loadl_epi64((__m128i*)(Src + 24)));
+
+  __m512i Dst_U16_V0, Dst_U16_V1;
+  xInvTransformDCT_8x8_4x4_M16_AVX512(Dst_U16_V0, Dst_U16_V1, Src_I16_X01, Src_I16_X23);
+
+  _mm512_storeu_si512((__m512i*)(Dst     ), Dst_U16_V0);
+  _mm512_storeu_si512((__m512i*)(Dst + 32), Dst_U16_V1);
+}
+uint64 xTransformAVX512::InvScanQuantTransformSSD_8x8_4x4_M16(const int16* ScanCoeff, const uint16* QuantCoeffScan, const uint16* Org)
+{
+  __m128i Src_I16_X01, Src_I16_X23;
+  xInvScanQuant_4x4_M16(Src_I16_X01, Src_I16_X23, ScanCoeff, QuantCoeffScan);
+
+  __m512i Rec_U16_V0, Rec_U16_V1;
+  xInvTransformDCT_8x8_4x4_M16_AVX512(Rec_U16_V0, Rec_U16_V1, Src_I16_X01, Src_I16_X23);
+
+  //SSD (same as xDistortionAVX512::CalcSSD)
+  __m512i Diff_I16_V0 = _mm512_sub_epi16(_mm512_loadu_si512((__m512i*)(Org     )), Rec_U16_V0);
+  __m512i Diff_I16_V1 = _mm512_sub_epi16(_mm512_loadu_si512((__m512i*)(Org + 32)), Rec_U16_V1);
+  __m512i Pow_I32_V0  = _mm512_madd_epi16(Diff_I16_V0, Diff_I16_V0);
+  __m512i Pow_I32_V1  = _mm512_madd_epi16(Diff_I16_V1, Diff_I16_V1);
+  __m512i SSD_I64_V0  = _mm512_add_epi64(_mm512_unpacklo_epi32(Pow_I32_V0, _mm512_setzero_si512()), _mm512_unpackhi_epi32(Pow_I32_V0, _mm512_setzero_si512()));
+  __m512i SSD_I64_V1  = _mm512_add_epi64(_mm512_unpacklo_epi32(Pow_I32_V1, _mm512_setzero_si512()), _mm512_unpackhi_epi32(Pow_I32_V1, _mm512_setzero_si512()));
+  return (uint64)xHorVecSum_epi64(_mm512_add_epi64(SSD_I64_V0, SSD_I64_V1));
+}
+
+//multiple blocks - every 128 bit lane holds different block, all 8 rows (or columns) of 4 blocks are kept in 8 registers
+static inline void xTransposeRows8x8_AVX512(__m512i* restrict D, const __m512i* restrict S)
+{
+  __m512i A[8], B[8];
+  for(int32 i = 0; i < 4; i++)
+  {
+    A[2*i    ] = _mm512_unpacklo_epi16(S[2*i], S[2*i + 1]);
+    A[2*i + 1] = _mm512_unpackhi_epi16(S[2*i], S[2*i + 1]);
+  }
+  for(int32 h = 0; h < 8; h += 4)
+  {
+    B[h    ] = _mm512_unpacklo_epi32(A[h    ], A[h + 2]);
+    B[h + 1] = _mm512_unpackhi_epi32(A[h    ], A[h + 2]);
+    B[h + 2] = _mm512_unpacklo_epi32(A[h + 1], A[h + 3]);
+    B[h + 3] = _mm512_unpackhi_epi32(A[h + 1], A[h + 3]);
+  }
+  for(int32 i = 0; i < 4; i++)
+  {
+    D[2*i    ] = _mm512_unpacklo_epi64(B[i], B[i + 4]);
+    D[2*i + 1] = _mm512_unpackhi_epi64(B[i], B[i + 4]);
+  }
+}
+template<bool Transposed> static inline void xInitPairTC_AVX512(__m512i TC[8][4])
+{
+  for(int32 k = 0; k < 8; k++) { for(int32 p = 0; p < 4; p++) { TC[k][p] = _mm512_set1_epi32(xPackPairTC<Transposed>(k, p)); } }
+}
+template<bool Unsigned, int32 Add, int32 Shift> static inline void xTransformPass8_AVX512(__m512i* restrict D, const __m512i* restrict S, const __m512i TC[8][4])
+{
+  const __m512i AddV = _mm512_set1_epi32(Add);
+  __m512i L[4], H[4];
+  for(int32 p = 0; p < 4; p++)
+  {
+    L[p] = _mm512_unpacklo_epi16(S[2*p], S[2*p + 1]);
+    H[p] = _mm512_unpackhi_epi16(S[2*p], S[2*p + 1]);
+  }
+  for(int32 k = 0; k < 8; k++)
+  {
+    __m512i SumL = AddV;
+    __m512i SumH = AddV;
+    for(int32 p = 0; p < 4; p++)
+    {
+      SumL = _mm512_add_epi32(SumL, _mm512_madd_epi16(L[p], TC[k][p]));
+      SumH = _mm512_add_epi32(SumH, _mm512_madd_epi16(H[p], TC[k][p]));
+    }
+    SumL = _mm512_srai_epi32(SumL, Shift);
+    SumH = _mm512_srai_epi32(SumH, Shift);
+    D[k] = Unsigned ? _mm512_packus_epi32(SumL, SumH) : _mm512_packs_epi32(SumL, SumH);
+  }
+}
+static inline void xTransposeLanes4x4_AVX512(__m512i* V)
+{
+  const __m512i T0 = _mm512_shuffle_i64x2(V[0], V[1], 0x44);
+  const __m512i T1 = _mm512_shuffle_i64x2(V[0], V[1], 0xEE);
+  const __m512i T2 = _mm512_shuffle_i64x2(V[2], V[3], 0x44);
+  const __m512i T3 = _mm512_shuffle_i64x2(V[2], V[3], 0xEE);
+  V[0] = _mm512_shuffle_i64x2(T0, T2, 0x88);
+  V[1] = _mm512_shuffle_i64x2(T0, T2, 0xDD);
+  V[2] = _mm512_shuffle_i64x2(T1, T3, 0x88);
+  V[3] = _mm512_shuffle_i64x2(T1, T3, 0xDD);
+}
+static inline void xLoadBlocks4_AVX512(__m512i* restrict R, const int16* Src)
+{
+  constexpr int32 BA = xJPEG_Constants::c_BlockArea;
+  for(int32 h = 0; h < 8; h += 4)
+  {
+    for(int32 b = 0; b < 4; b++) { R[h + b] = _mm512_loadu_si512((const __m512i*)(Src + b * BA + 8 * h)); }
+    xTransposeLanes4x4_AVX512(R + h);
+  }
+}
+static inline void xStoreBlocks4_AVX512(int16* restrict Dst, __m512i* R)
+{
+  constexpr int32 BA = xJPEG_Constants::c_BlockArea;
+  for(int32 h = 0; h < 8; h += 4)
+  {
+    xTransposeLanes4x4_AVX512(R + h);
+    for(int32 b = 0; b < 4; b++) { _mm512_storeu_si512((__m512i*)(Dst + b * BA + 8 * h), R[h + b]); }
+  }
+}
+void xTransformAVX512::FwdTransformDCT_8x8xN_M16(int16* restrict Dst, const uint16* Src, int32 NumBlocks)
+{
+  constexpr int32 BA = xJPEG_Constants::c_BlockArea;
+  __m512i TC[8][4]; xInitPairTC_AVX512<false>(TC);
+
+  for(; NumBlocks >= 4; NumBlocks -= 4, Src += 4 * BA, Dst += 4 * BA)
+  {
+    __m512i R[8], T[8];
+    xLoadBlocks4_AVX512(R, (const int16*)Src);
+    xTransposeRows8x8_AVX512(T, R);                                                             //columns
+    xTransformPass8_AVX512<false, tTC::c_FrwAdd1st_16bit, tTC::c_FrwShift1st_16bit>(R, T, TC); //horizontal transform
+    xTransposeRows8x8_AVX512(T, R);                                                             //rows
+    xTransformPass8_AVX512<false, tTC::c_FrwAdd2nd_16bit, tTC::c_FrwShift2nd_16bit>(R, T, TC); //vertical transform
+    xStoreBlocks4_AVX512(Dst, R);
+  }
+  for(; NumBlocks > 0; NumBlocks--, Src += BA, Dst += BA) { FwdTransformDCT_8x8_M16(Dst, Src); }
+}
+void xTransformAVX512::InvTransformDCT_8x8xN_M16(uint16* restrict Dst, const int16* Src, int32 NumBlocks)
+{
+  constexpr int32 BA = xJPEG_Constants::c_BlockArea;
+  __m512i TC[8][4]; xInitPairTC_AVX512<true>(TC);
+
+  for(; NumBlocks >= 4; NumBlocks -= 4, Src += 4 * BA, Dst += 4 * BA)
+  {
+    __m512i R[8], T[8];
+    xLoadBlocks4_AVX512(R, Src);
+    xTransformPass8_AVX512<false, tTC::c_InvAdd1st_16bit, tTC::c_InvShift1st_16bit>(T, R, TC); //vertical transform
+    xTransposeRows8x8_AVX512(R, T);                                                             //columns
+    xTransformPass8_AVX512<true , tTC::c_InvAdd2nd_16bit, tTC::c_InvShift2nd_16bit>(T, R, TC); //horizontal transform
+    xTransposeRows8x8_AVX512(R, T);                                                             //rows
+    xStoreBlocks4_AVX512((int16*)Dst, R);
+  }
+  for(; NumBlocks > 0; NumBlocks--, Src += BA, Dst += BA) { InvTransformDCT_8x8_M16(Dst, Src); }
 }
 #endif //X_SIMD_CAN_USE_AVX512
 
@@ -29,6 +29,13 @@ public:
   //fancy butterfly method using 13 bit integer coefficients, HEVC style full range 16 bit output
   static void FwdTransformDCT_8x8_BTF(int16*  restrict Dst, const uint16* Src);
   static void InvTransformDCT_8x8_BTF(uint16* restrict Dst, const int16*  Src);
+
+  //sparse variants - only DC coeff is nonzero, whole block is filled with single value (bit exact with SIMD M16 variants and BTF variant respectively)
+  static void InvTransformDCT_8x8_DC_M16(uint16* restrict Dst, const int16*  Src);
+  static void InvTransformDCT_8x8_DC_BTF(uint16* restrict Dst, const int16*  Src);
+
+  //reduced size inverse transform (scaled decoding) - NxN lowest frequency coeffs to NxN samples (N = 8 >> Log2Scale), result is stored in top-left corner of Dst (8x8 block)
+  static void InvTransformDCT_8x8_Scaled_M16(uint16* restrict Dst, const int16*  Src, int32 Log2Scale);
 };
 
 //===============================================================================================================================================================================================================
@@ -57,6 +64,19 @@ public:
   //AVX direct multiplication with 8 bit transform coefficients, HEVC style full range 16 bit output
   static void FwdTransformDCT_8x8_M16(int16*  restrict Dst, const uint16* Src);
   static void InvTransformDCT_8x8_M16(uint16* restrict Dst, const int16*  Src);
+
+  //AVX batched variant - NumBlocks consecutive blocks, 2 blocks at once (one per 128 bit lane), bit exact with single block variant
+  static void FwdTransformDCT_8x8xN_M16(int16*  restrict Dst, const uint16* Src, int32 NumBlocks);
+  static void InvTransformDCT_8x8xN_M16(uint16* restrict Dst, const int16*  Src, int32 NumBlocks);
+
+  //AVX fused forward transform, DC correction, quantization (see xQuantAVX::QuantScale) and zig-zag scan - bit exact with separate steps
+  static void FwdTransformQuantScan_8x8_M16(int16* restrict ScanCoeff, const uint16* Src, const uint16* Correction, const uint16* Reciprocal, const uint16* Scale);
+  //quantized coeffs in zig-zag order to SSD of reconstructed block (InvScale in zig-zag order, inverse scan, DC correction, inverse transform and SSD against original samples)
+  static uint64 InvScanQuantTransformSSD_8x8_M16(const int16* ScanCoeff, const uint16* QuantCoeffScan, const uint16* Org);
+
+  //AVX sparse variants - nonzero coeffs limited to top-left 4x4 quarter (last nonzero coeff in zig-zag order at position <= 9), bit exact with full variants
+  static void   InvTransformDCT_8x8_4x4_M16        (uint16* restrict Dst, const int16* Src);
+  static uint64 InvScanQuantTransformSSD_8x8_4x4_M16(const int16* ScanCoeff, const uint16* QuantCoeffScan, const uint16* Org);
 };
 #else //X_SIMD_CAN_USE_AVX
 #define X_CAN_USE_AVX 0
@@ -72,6 +92,19 @@ public:
   //AVX512 direct multiplication with 8 bit transform coefficients, HEVC style full range 16 bit output
   static void FwdTransformDCT_8x8_M16(int16*  restrict Dst, const uint16* Src);
   static void InvTransformDCT_8x8_M16(uint16* restrict Dst, const int16*  Src);
+
+  //AVX512 batched variant - NumBlocks consecutive blocks, 4 blocks at once (one per 128 bit lane), bit exact with single block variant
+  static void FwdTransformDCT_8x8xN_M16(int16*  restrict Dst, const uint16* Src, int32 NumBlocks);
+  static void InvTransformDCT_8x8xN_M16(uint16* restrict Dst, const int16*  Src, int32 NumBlocks);
+
+  //AVX512 fused forward transform, DC correction, quantization (see xQuantAVX512::QuantScale) and zig-zag scan - bit exact with separate steps
+  static void FwdTransformQuantScan_8x8_M16(int16* restrict ScanCoeff, const uint16* Src, const uint16* Correction, const uint16* Reciprocal, const uint16* Scale);
+  //quantized coeffs in zig-zag order to SSD of reconstructed block (InvScale in zig-zag order, inverse scan, DC correction, inverse transform and SSD against original samples)
+  static uint64 InvScanQuantTransformSSD_8x8_M16(const int16* ScanCoeff, const uint16* QuantCoeffScan, const uint16* Org);
+
+  //AVX512 sparse variants - nonzero coeffs limited to top-left 4x4 quarter (last nonzero coeff in zig-zag order at position <= 9), bit exact with full variants
+  static void   InvTransformDCT_8x8_4x4_M16        (uint16* restrict Dst, const int16* Src);
+  static uint64 InvScanQuantTransformSSD_8x8_4x4_M16(const int16* ScanCoeff, const uint16* QuantCoeffScan, const uint16* Org);
 };
 #else //X_SIMD_CAN_USE_AVX512
 #define X_CAN_USE_AVX512 0
@@ -82,12 +115,19 @@ public:
 class xTransform
 {
 public:
+  //last nonzero coeff position (in zig-zag order) for which all nonzero coeffs lie in top-left 4x4 quarter
+  static constexpr int32 c_LastPos4x4 = 9;
+
 #if X_CAN_USE_AVX512
   static void FwdTransformDCT_8x8(int16*  Dst, const uint16* Src) { xTransformAVX512::FwdTransformDCT_8x8_M16(Dst, Src); }
   static void InvTransformDCT_8x8(uint16* Dst, const int16*  Src) { xTransformAVX512::InvTransformDCT_8x8_M16(Dst, Src); }
+  static void FwdTransformDCT_8x8xN(int16*  Dst, const uint16* Src, int32 NumBlocks) { xTransformAVX512::FwdTransformDCT_8x8xN_M16(Dst, Src, NumBlocks); }
+  static void InvTransformDCT_8x8xN(uint16* Dst, const int16*  Src, int32 NumBlocks) { xTransformAVX512::InvTransformDCT_8x8xN_M16(Dst, Src, NumBlocks); }
 #elif X_CAN_USE_AVX
   static void FwdTransformDCT_8x8(int16*  Dst, const uint16* Src) { xTransformAVX::FwdTransformDCT_8x8_M16(Dst, Src); }
   static void InvTransformDCT_8x8(uint16* Dst, const int16*  Src) { xTransformSSE::InvTransformDCT_8x8_M16(Dst, Src); }
+  static void FwdTransformDCT_8x8xN(int16*  Dst, const uint16* Src, int32 NumBlocks) { xTransformAVX::FwdTransformDCT_8x8xN_M16(Dst, Src, NumBlocks); }
+  static void InvTransformDCT_8x8xN(uint16* Dst, const int16*  Src, int32 NumBlocks) { xTransformAVX::InvTransformDCT_8x8xN_M16(Dst, Src, NumBlocks); }
 #elif X_CAN_USE_SSE
   static void FwdTransformDCT_8x8(int16*  Dst, const uint16* Src) { xTransformSSE::FwdTransformDCT_8x8_M16(Dst, Src); }
   static void InvTransformDCT_8x8(uint16* Dst, const int16*  Src) { xTransformSSE::InvTransformDCT_8x8_M16(Dst, Src); }
@@ -95,6 +135,31 @@ public:
   static void FwdTransformDCT_8x8(int16*  Dst, const uint16* Src) { xTransformSTD::FwdTransformDCT_8x8_BTF(Dst, Src); }
   static void InvTransformDCT_8x8(uint16* Dst, const int16*  Src) { xTransformSTD::InvTransformDCT_8x8_BTF(Dst, Src); }
 #endif
+#if X_CAN_USE_AVX512
+  static void InvTransformDCT_8x8_DC (uint16* Dst, const int16*  Src) { xTransformSTD   ::InvTransformDCT_8x8_DC_M16(Dst, Src); }
+  static void InvTransformDCT_8x8_4x4(uint16* Dst, const int16*  Src) { xTransformAVX512::InvTransformDCT_8x8_4x4_M16(Dst, Src); }
+#elif X_CAN_USE_AVX
+  static void InvTransformDCT_8x8_DC (uint16* Dst, const int16*  Src) { xTransformSTD   ::InvTransformDCT_8x8_DC_M16(Dst, Src); }
+  static void InvTransformDCT_8x8_4x4(uint16* Dst, const int16*  Src) { xTransformAVX   ::InvTransformDCT_8x8_4x4_M16(Dst, Src); }
+#elif X_CAN_USE_SSE
+  static void InvTransformDCT_8x8_DC (uint16* Dst, const int16*  Src) { xTransformSTD   ::InvTransformDCT_8x8_DC_M16(Dst, Src); }
+  static void InvTransformDCT_8x8_4x4(uint16* Dst, const int16*  Src) { xTransformSSE   ::InvTransformDCT_8x8_M16   (Dst, Src); }
+#else
+  static void InvTransformDCT_8x8_DC (uint16* Dst, const int16*  Src) { xTransformSTD   ::InvTransformDCT_8x8_DC_BTF(Dst, Src); }
+  static void InvTransformDCT_8x8_4x4(uint16* Dst, const int16*  Src) { xTransformSTD   ::InvTransformDCT_8x8_BTF   (Dst, Src); }
+#endif
+  static void InvTransformDCT_8x8_Scaled(uint16* Dst, const int16*  Src, int32 Log2Scale) { xTransformSTD::InvTransformDCT_8x8_Scaled_M16(Dst, Src, Log2Scale); }
+  //sparse inverse transform selected by position of last nonzero coeff in zig-zag order (upper bound is also valid)
+  static void InvTransformDCT_8x8(uint16* Dst, const int16* Src, int32 LastPos)
+  {
+    if     (LastPos == 0           ) { InvTransformDCT_8x8_DC (Dst, Src); }
+    else if(LastPos <= c_LastPos4x4) { InvTransformDCT_8x8_4x4(Dst, Src); }
+    else                             { InvTransformDCT_8x8    (Dst, Src); }
+  }
+#if !X_CAN_USE_AVX512 && !X_CAN_USE_AVX
+  static void FwdTransformDCT_8x8xN(int16*  Dst, const uint16* Src, int32 NumBlocks) { for(int32 i = 0; i < NumBlocks; i++) { FwdTransformDCT_8x8(Dst + (i << 6), Src + (i << 6)); } }
+  static void InvTransformDCT_8x8xN(uint16* Dst, const int16*  Src, int32 NumBlocks) { for(int32 i = 0; i < NumBlocks; i++) { InvTransformDCT_8x8(Dst + (i << 6), Src + (i << 6)); } }
+#endif
 };
 
 //===============================================================================================================================================================================================================
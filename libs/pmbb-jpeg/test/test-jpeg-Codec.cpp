@@ -0,0 +1,335 @@
+/*
+    SPDX-FileCopyrightText: 2019-2024 Jakub Stankowski <jakub.stankowski@put.poznan.pl>
+    SPDX-License-Identifier: BSD-3-Clause
+*/
+
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest/doctest.h>
+#include <cstring>
+#include <vector>
+#include <chrono>
+#include "xTestUtils.h"
+#include "xCommonDefJPEG.h"
+#include "xPicYUV.h"
+#include "xPixelOps.h"
+#include "xByteBuffer.h"
+#include "xThreadPool.h"
+#include "xJPEG_Encoder.h"
+#include "xJPEG_CodecSimple.h"
+#include "xJPEG_Transform.h"
+
+using namespace PMBB_NAMESPACE;
+using namespace PMBB_NAMESPACE::JPEG;
+
+//===============================================================================================================================================================================================================
+
+static int32 triangleWave(int32 Val) { Val %= 384; return Val < 192 ? Val : 383 - Val; } //periodic ramp within <0, 191>
+static void fillTestPicture(xPicYUV* Picture, int32 FrameIdx, bool Smooth = false)
+{
+  //Smooth = false - moving gradient with noise amplitude changing every few frames - forces both lambda reuse and re-estimation
+  //Smooth = true  - periodic ramps with mild noise - area average of full resolution decode is a meaningful reference for downscaled decode
+  const int32  NoiseShift = Smooth ? 5 : 8 - (FrameIdx / 5) % 3;
+  uint32       State      = xTestUtils::c_XorShiftSeed + FrameIdx;
+  for(int32 CmpIdx = 0; CmpIdx < 3; CmpIdx++)
+  {
+    const eCmp  CmpId  = (eCmp)CmpIdx;
+    const int32 Width  = Picture->getWidth (CmpId);
+    const int32 Height = Picture->getHeight(CmpId);
+    const int32 Stride = Picture->getStride(CmpId);
+    uint16*     Ptr    = Picture->getAddr  (CmpId);
+    for(int32 y = 0; y < Height; y++)
+    {
+      for(int32 x = 0; x < Width; x++)
+      {
+        State = xTestUtils::xXorShift32(State);
+        const int32 Base  = Smooth ? (CmpIdx == 0 ? 32 + triangleWave((x * 3 + y * 2) / 3) : 64 + triangleWave(CmpIdx == 1 ? (x + y * 2) / 2 : (x * 2 + y) / 2))
+                                   : (CmpIdx == 0 ? ((x + y + 3 * FrameIdx) * 2) & 0xFF : 128 + ((x - y) >> 2));
+        const int32 Noise = (int32)(State & 0xFF) - 128;
+        Ptr[x] = (uint16)xClipU8(Base + (Noise >> NoiseShift));
+      }
+      Ptr += Stride;
+    }
+  }
+}
+static void initTestEncoder(xAdvancedEncoder& Encoder, int32V2 Size, eCrF ChromaFormat, int32 Quality, eLmbS LambdaStrategy, bool Progressive = false, bool Arithmetic = false)
+{
+  Encoder.create(Size, ChromaFormat);
+  Encoder.initBaseMarkers();
+  Encoder.initQuant(Quality, eQTLa::Default);
+  Encoder.initEntropy(0);
+  Encoder.setMarkerEmit(true, true, true);
+  Encoder.setProgressive(Progressive, "");
+  Encoder.setArithmetic(Arithmetic);
+  Encoder.setRDOQ(true, true, false, 1);
+  Encoder.setLambdaStrategy(LambdaStrategy, 8, 0.2);
+  Encoder.setNumThreads(1);
+}
+
+//===============================================================================================================================================================================================================
+
+void testLambdaReuseConcurrent(int32 NumEncoders)
+{
+  constexpr int32   NumFrames = 24;
+  constexpr int32   Quality   = 60;
+  const     int32V2 Size      = { 128, 96 };
+
+  std::vector<xPicYUV*> Pictures;
+  for(int32 f = 0; f < NumFrames; f++) { Pictures.push_back(new xPicYUV(Size, 8, eCrF::CF420)); fillTestPicture(Pictures.back(), f); }
+
+  //reference - single encoder, frames in order, own reuse state
+  std::vector<std::vector<byte>> RefFrames;
+  {
+    xAdvancedEncoder Encoder; initTestEncoder(Encoder, Size, eCrF::CF420, Quality, eLmbS::Reuse);
+    xByteBuffer      Buffer(Size.getMul() * 4);
+    for(int32 f = 0; f < NumFrames; f++)
+    {
+      Buffer.reset();
+      Encoder.encode(Pictures[f], &Buffer);
+      RefFrames.emplace_back(Buffer.getReadPtr(), Buffer.getReadPtr() + Buffer.getDataSize());
+    }
+    Encoder.destroy();
+  }
+
+  //tested - frame f coded by encoder f % NumEncoders, all encoders of batch run concurrently, reuse state passed through history
+  std::vector<xAdvancedEncoder*> Encoders;
+  std::vector<xByteBuffer*     > Buffers;
+  for(int32 e = 0; e < NumEncoders; e++)
+  {
+    Encoders.push_back(new xAdvancedEncoder); initTestEncoder(*Encoders.back(), Size, eCrF::CF420, Quality, eLmbS::Reuse);
+    Buffers .push_back(new xByteBuffer(Size.getMul() * 4));
+  }
+  xLambdaHistory LambdaHistory; LambdaHistory.reset();
+  xThreadPool    ThreadPool; ThreadPool.create(NumEncoders);
+
+  for(int32 FrameIdxFirst = 0; FrameIdxFirst < NumFrames; FrameIdxFirst += NumEncoders)
+  {
+    const int32 NumFramesInBatch = xMin(NumEncoders, NumFrames - FrameIdxFirst);
+    for(int32 e = 0; e < NumFramesInBatch; e++)
+    {
+      ThreadPool.addWaitingTask([&, e, FrameIdxFirst](int32 /*ThreadIdx*/)
+      {
+        Buffers [e]->reset();
+        Encoders[e]->setLambdaHistory(&LambdaHistory, FrameIdxFirst + e);
+        Encoders[e]->encode(Pictures[FrameIdxFirst + e], Buffers[e]);
+      });
+    }
+    ThreadPool.waitUntilTasksFinished();
+
+    for(int32 e = 0; e < NumFramesInBatch; e++)
+    {
+      const std::vector<byte>& Ref = RefFrames[FrameIdxFirst + e];
+      CHECK(Buffers[e]->getDataSize() == (int32)Ref.size());
+      CHECK(std::memcmp(Buffers[e]->getReadPtr(), Ref.data(), xMin((int32)Ref.size(), Buffers[e]->getDataSize())) == 0);
+    }
+  }
+
+  ThreadPool.destroy();
+  for(int32 e = 0; e < NumEncoders; e++) { Encoders[e]->destroy(); delete Encoders[e]; delete Buffers[e]; }
+  for(xPicYUV* Picture : Pictures) { delete Picture; }
+}
+
+//===============================================================================================================================================================================================================
+
+class xAdvancedEncoderTest : public xAdvancedEncoder
+{
+public:
+  //coded (zig-zag order) coefficients of block at given position within component - RDOQ output when enabled
+  const int16* getBlockCoeffsScan(eCmp CmpId, int32 BlockPosH, int32 BlockPosV) const { return (m_UseRDOQ ? m_CmpCoeffsScanOpt : m_CmpCoeffsScan)[(int32)CmpId] + (xGetBlockIdxNonIntlv((int32)CmpId, BlockPosH, BlockPosV) << xJPEG_Constants::c_Log2BlockArea); }
+  int32        getQuantStepDC   (eCmp CmpId) const { return m_QuantMain.getQuantizer(m_SOF0.getQuantTableId(CmpId)).getQuantCoeffs()[0]; }
+};
+
+static void decodeTestPicture(xDecoderSimple& Decoder, xByteBuffer* Buffer, xPicYUV* Picture)
+{
+  //decoding consumes input buffer - restore it to allow decoding the same picture again
+  const int32 DataOffset = Buffer->getDataOffset();
+  const int32 DataSize   = Buffer->getDataSize  ();
+  Decoder.decode(Buffer, Picture);
+  Buffer->setDataOffset(DataOffset);
+  Buffer->setDataSize  (DataSize  );
+}
+static void downscaleBoxAvg(xPicYUV* Dst, const xPicYUV* Src, int32 Log2Scale)
+{
+  //area average, partial areas at bottom and right picture edges are averaged over existing samples only
+  const int32 Factor = 1 << Log2Scale;
+  for(int32 CmpIdx = 0; CmpIdx < 3; CmpIdx++)
+  {
+    const eCmp  CmpId     = (eCmp)CmpIdx;
+    const int32 SrcWidth  = Src->getWidth (CmpId);
+    const int32 SrcHeight = Src->getHeight(CmpId);
+    for(int32 y = 0; y < Dst->getHeight(CmpId); y++)
+    {
+      for(int32 x = 0; x < Dst->getWidth(CmpId); x++)
+      {
+        int32 Sum = 0, Cnt = 0;
+        for(int32 v = y * Factor; v < xMin((y + 1) * Factor, SrcHeight); v++)
+        {
+          for(int32 u = x * Factor; u < xMin((x + 1) * Factor, SrcWidth); u++) { Sum += Src->getAddr(CmpId)[v * Src->getStride(CmpId) + u]; Cnt++; }
+        }
+        Dst->getAddr(CmpId)[y * Dst->getStride(CmpId) + x] = (uint16)(Cnt ? (Sum + (Cnt >> 1)) / Cnt : 0);
+      }
+    }
+  }
+}
+static void downsampleHV(xPicYUV* Dst, const xPicYUV* Src)
+{
+  for(int32 CmpIdx = 0; CmpIdx < 3; CmpIdx++)
+  {
+    const eCmp CmpId = (eCmp)CmpIdx;
+    xPixelOps::DownsampleHV(Dst->getAddr(CmpId), Src->getAddr(CmpId), Dst->getStride(CmpId), Src->getStride(CmpId), Dst->getWidth(CmpId), Dst->getHeight(CmpId));
+  }
+}
+
+//===============================================================================================================================================================================================================
+
+void testDecodeScaled(eCrF ChromaFormat, bool Progressive, bool Arithmetic)
+{
+  constexpr int32   Quality = 90;
+  const     int32V2 Size    = { 99, 77 }; //not a multiple of MCU size - partial edge blocks in every component
+
+  xPicYUV Original(Size, 8, ChromaFormat); fillTestPicture(&Original, 0, true);
+  xByteBuffer          Buffer(Size.getMul() * 4);
+  xAdvancedEncoderTest Encoder; initTestEncoder(Encoder, Size, ChromaFormat, Quality, eLmbS::Model, Progressive, Arithmetic);
+  Encoder.encode(&Original, &Buffer);
+
+  xDecoderSimple Decoder; Decoder.create();
+  CHECK(Decoder.init(&Buffer));
+
+  xPicYUV* Full = nullptr;
+  for(int32 Log2Scale = 0; Log2Scale <= xJPEG_Constants::c_Log2BlockSize; Log2Scale++)
+  {
+    Decoder.setLog2Scale(Log2Scale);
+    const int32V2 OutputSize = Decoder.getOutputSize();
+    CHECK(OutputSize == int32V2((Size.getX() + (1 << Log2Scale) - 1) >> Log2Scale, (Size.getY() + (1 << Log2Scale) - 1) >> Log2Scale));
+
+    xPicYUV Decoded(OutputSize, 8, ChromaFormat);
+    decodeTestPicture(Decoder, &Buffer, &Decoded);
+
+    if(Log2Scale == 0)
+    {
+      Full = new xPicYUV(OutputSize, 8, ChromaFormat); Full->copy(&Decoded);
+      continue;
+    }
+
+    if(Log2Scale == xJPEG_Constants::c_Log2BlockSize)
+    {
+      //1/8 - every output sample is the DC value of corresponding block (including partial edge blocks and chroma blocks)
+      for(int32 CmpIdx = 0; CmpIdx < 3; CmpIdx++)
+      {
+        const eCmp CmpId = (eCmp)CmpIdx;
+        for(int32 y = 0; y < Decoded.getHeight(CmpId); y++)
+        {
+          for(int32 x = 0; x < Decoded.getWidth(CmpId); x++)
+          {
+            alignas(64) int16  CoeffsTrans[xJPEG_Constants::c_BlockArea] = { 0 };
+            alignas(64) uint16 SamplesDC  [xJPEG_Constants::c_BlockArea];
+            CoeffsTrans[0] = (int16)(Encoder.getBlockCoeffsScan(CmpId, x, y)[0] * Encoder.getQuantStepDC(CmpId) + xTransformConstants::c_InvDcCorr);
+            xTransform::InvTransformDCT_8x8(SamplesDC, CoeffsTrans, 0);
+            CHECK(Decoded.getAddr(CmpId)[y * Decoded.getStride(CmpId) + x] == SamplesDC[0]);
+          }
+        }
+      }
+    }
+
+    //1/2, 1/4 and 1/8 - close to area average of full resolution decode
+    xPicYUV Reference(OutputSize, 8, ChromaFormat);
+    downscaleBoxAvg(&Reference, Full, Log2Scale);
+    for(int32 CmpIdx = 0; CmpIdx < 3; CmpIdx++)
+    {
+      const eCmp CmpId   = (eCmp)CmpIdx;
+      int64      SumDiff = 0;
+      int32      MaxDiff = 0;
+      for(int32 y = 0; y < Decoded.getHeight(CmpId); y++)
+      {
+        for(int32 x = 0; x < Decoded.getWidth(CmpId); x++)
+        {
+          const int32 Diff = xAbs((int32)Decoded.getAddr(CmpId)[y * Decoded.getStride(CmpId) + x] - (int32)Reference.getAddr(CmpId)[y * Reference.getStride(CmpId) + x]);
+          SumDiff += Diff; MaxDiff = xMax(MaxDiff, Diff);
+        }
+      }
+      CHECK(SumDiff * 2 <= (int64)Decoded.getWidth(CmpId) * Decoded.getHeight(CmpId)); //mean abs difference within 0.5
+      CHECK(MaxDiff <= 4);
+    }
+  }
+
+  delete Full;
+  Decoder.destroy();
+  Encoder.destroy();
+}
+
+std::pair<flt64, flt64> perfDecodeScaled(int32 Log2Scale)
+{
+  constexpr int32   Quality  = 90;
+  constexpr int32   NumIters = 64;
+  const     int32V2 Size     = { 1920, 1080 };
+
+  xPicYUV Original(Size, 8, eCrF::CF420); fillTestPicture(&Original, 0, true);
+  xByteBuffer      Buffer(Size.getMul() * 4);
+  xAdvancedEncoder Encoder; initTestEncoder(Encoder, Size, eCrF::CF420, Quality, eLmbS::Model);
+  Encoder.encode(&Original, &Buffer);
+
+  xDecoderSimple Decoder; Decoder.create();
+  Decoder.init(&Buffer);
+  xPicYUV Full  (Decoder.getOutputSize(), 8, eCrF::CF420);
+  Decoder.setLog2Scale(Log2Scale);
+  xPicYUV Scaled(Decoder.getOutputSize(), 8, eCrF::CF420);
+  std::vector<xPicYUV*> Downsampled; //1/2, 1/4, ... down to requested scale
+  for(int32 s = 1; s <= Log2Scale; s++) { Downsampled.push_back(new xPicYUV({ Size.getX() >> s, Size.getY() >> s }, 8, eCrF::CF420)); }
+
+  //scaled decode
+  tTimePoint T0 = tClock::now();
+  for(int32 i = 0; i < NumIters; i++) { decodeTestPicture(Decoder, &Buffer, &Scaled); }
+  tTimePoint T1 = tClock::now();
+
+  //full decode followed by repeated 2x2 downsampling
+  Decoder.setLog2Scale(0);
+  tTimePoint T2 = tClock::now();
+  for(int32 i = 0; i < NumIters; i++)
+  {
+    decodeTestPicture(Decoder, &Buffer, &Full);
+    const xPicYUV* Src = &Full;
+    for(xPicYUV* Dst : Downsampled) { downsampleHV(Dst, Src); Src = Dst; }
+  }
+  tTimePoint T3 = tClock::now();
+
+  for(xPicYUV* Picture : Downsampled) { delete Picture; }
+  Decoder.destroy();
+  Encoder.destroy();
+
+  const flt64 PicsPerSecScaled = NumIters / std::chrono::duration_cast<tDurationS>(T1 - T0).count();
+  const flt64 PicsPerSecFull   = NumIters / std::chrono::duration_cast<tDurationS>(T3 - T2).count();
+  return { PicsPerSecScaled, PicsPerSecFull };
+}
+
+//===============================================================================================================================================================================================================
+
+TEST_CASE("xAdvancedEncoder_LambdaReuseConcurrent")
+{
+  testLambdaReuseConcurrent(1);
+  testLambdaReuseConcurrent(4);
+}
+
+//===============================================================================================================================================================================================================
+
+TEST_CASE("xDecoderSimple_Scaled")
+{
+  for(eCrF ChromaFormat : { eCrF::CF420, eCrF::CF422, eCrF::CF444 })
+  {
+    testDecodeScaled(ChromaFormat, false, false);
+    testDecodeScaled(ChromaFormat, true , false);
+    testDecodeScaled(ChromaFormat, false, true );
+  }
+}
+
+#ifdef NDEBUG
+TEST_CASE("xDecoderSimple_Scaled-perf")
+{
+  for(int32 Log2Scale = 1; Log2Scale <= xJPEG_Constants::c_Log2BlockSize; Log2Scale++)
+  {
+    auto [Scaled, Full] = perfDecodeScaled(Log2Scale);
+    fmt::print("TIME(xDecoderSimple 1/{}                 ) = {:.2f} pic/s\n", 1 << Log2Scale, Scaled);
+    fmt::print("TIME(xDecoderSimple 1/1 + DownsampleHV x{}) = {:.2f} pic/s\n", Log2Scale     , Full  );
+  }
+}
+#endif //NDEBUG
+
+//===============================================================================================================================================================================================================
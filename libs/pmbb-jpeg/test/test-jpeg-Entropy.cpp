@@ -12,6 +12,7 @@
 #include <functional>
 #include <utility>
 #include <array>
+#include <vector>
 #include "xTestUtils.h"
 #include "xMemory.h"
 #include "xCommonDefJPEG.h"
@@ -48,7 +49,7 @@ static uint32 fillRandomTransformCoeffsBlock(int16* Dst, uint32 State)
 class xEntEncTest : public xEntropyEncoder
 {
 public:
-  const xBitstreamWriter* getBitstream() const { return &m_Bitstream; }
+  const xBitstreamWriterJPEG* getBitstream() const { return &m_Bitstream; }
 };
 
 class xEntEncDefTest : public xEntropyEncoderDefault
@@ -57,8 +58,237 @@ public:
   const xBitstreamWriter* getBitstream() const { return &m_Bitstream; }
 };
 
+class xEntComTest : public xEntropyCommon
+{
+public:
+#if X_SIMD_CAN_USE_AVX512
+  using xEntropyCommon::extractSymbolsAVX512;
+  using xEntropyCommon::calcNonZeroMaskAVX512;
+#endif
+#if X_SIMD_CAN_USE_AVX
+  using xEntropyCommon::extractSymbolsAVX;
+  using xEntropyCommon::calcNonZeroMaskAVX;
+#endif
+  using xEntropyCommon::extractSymbolsSTD;
+  using xEntropyCommon::calcNonZeroMaskSTD;
+};
+
+class xEntEstTest : public xEntropyEstimator
+{
+public:
+#if X_SIMD_CAN_USE_AVX512
+  using xEntropyEstimator::xEstimateACAVX512;
+#endif
+#if X_SIMD_CAN_USE_AVX
+  using xEntropyEstimator::xEstimateACAVX;
+#endif
+  using xEntropyEstimator::xEstimateACSTD;
+};
+
+using tEstimateAC = std::function<int32(const int16*, const xHuffEstimatorAC*)>;
+
+static std::vector<xJFIF::xHuffTable> xInitDefaultHuffTables()
+{
+  std::vector<xJFIF::xHuffTable> HT;
+  HT.resize(4);
+  HT[0].InitDefault(0, xJFIF::xHuffTable::eHuffClass::DC, eCmp::LM);
+  HT[1].InitDefault(0, xJFIF::xHuffTable::eHuffClass::AC, eCmp::LM);
+  HT[2].InitDefault(1, xJFIF::xHuffTable::eHuffClass::DC, eCmp::CB); //any chroma so use CB
+  HT[3].InitDefault(1, xJFIF::xHuffTable::eHuffClass::AC, eCmp::CB);
+  return HT;
+}
+
+//sparse block - long zero runs (including runs longer than 16) and random position of last nonzero coefficient
+static uint32 fillRandomSparseBlock(int16* Dst, uint32 State)
+{
+  memset(Dst, 0, BA * sizeof(int16));
+  State = xTestUtils::xXorShift32(State);
+  const int32 NumNonZero = State % 8;
+  for(int32 n = 0; n < NumNonZero; n++)
+  {
+    State = xTestUtils::xXorShift32(State);
+    Dst[(State >> 8) & 0x3F] = (int16)((int32)((State >> 16) & 0x7FF) - 1024);
+  }
+  return State;
+}
+
 //===============================================================================================================================================================================================================
 
+void testExtractSymbols(std::function<uint64(const int16*, int32*, int32*)> ExtractSymbols)
+{
+  constexpr int32 NumIters = 64 * 1024;
+
+  alignas(64) int16 Coeffs[BA];
+  int32 RefNumBits[BA], RefRemain[BA];
+  int32 TstNumBits[BA], TstRemain[BA];
+
+  uint32 State = xTestUtils::c_XorShiftSeed;
+
+  for(int32 j = 0; j < NumIters; j++)
+  {
+    State = fillRandomTransformCoeffsBlock(Coeffs, State);
+    if(j & 1) { State = xTestUtils::xXorShift32(State); Coeffs[State % BA] = (int16)(State >> 16); } //full 16bit range
+    if(j == 0) { memset(Coeffs, 0, sizeof(Coeffs)); Coeffs[7] = INT16_MIN; Coeffs[63] = INT16_MAX; }
+
+    uint64 RefMask = xEntComTest::extractSymbolsSTD(Coeffs, RefNumBits, RefRemain);
+    uint64 TstMask = ExtractSymbols(Coeffs, TstNumBits, TstRemain);
+    CHECK(TstMask == RefMask);
+    for(int32 i = 0; i < BA; i++)
+    {
+      CHECK(TstNumBits[i] == RefNumBits[i]);
+      CHECK(TstRemain [i] == RefRemain [i]);
+      CHECK(((RefMask >> i) & 1) == (uint64)(Coeffs[i] != 0));
+    }
+  }
+}
+
+void testEstimateAC(tEstimateAC EstimateAC)
+{
+  constexpr int32 NumIters = 64 * 1024;
+
+  std::vector<xJFIF::xHuffTable> HT = xInitDefaultHuffTables();
+  xEntropyEstimator EntropyEst; EntropyEst.Init(HT);
+
+  alignas(64) int16 Coeffs[BA];
+  uint32 State = xTestUtils::c_XorShiftSeed;
+
+  for(int32 j = 0; j < NumIters; j++)
+  {
+    State = (j & 1) ? fillRandomSparseBlock(Coeffs, State) : fillRandomTransformCoeffsBlock(Coeffs, State);
+    if(j == 0) { memset(Coeffs, 0, sizeof(Coeffs)); Coeffs[0] = 100; } //DC only
+    if(j == 2) { memset(Coeffs, 0, sizeof(Coeffs)); Coeffs[63] = -1;  } //single run of 62 zeros
+    if(j == 4) { for(int32 i = 0; i < BA; i++) { Coeffs[i] = (int16)(i - 32); } Coeffs[32] = 1023; } //no EOB
+
+    for(int32 c = 0; c <= 1; c++)
+    {
+      const xHuffEstimatorAC* HE = EntropyEst.getHuffEstimatorAC(c);
+      CHECK(EstimateAC(Coeffs, HE) == xEntEstTest::xEstimateACSTD(Coeffs, HE));
+    }
+  }
+}
+
+flt64 perfEstimateAC(tEstimateAC EstimateAC)
+{
+  constexpr int32 NumIters = 64;
+  constexpr int32 NumBlock = 4 * 1024;
+
+  std::vector<xJFIF::xHuffTable> HT = xInitDefaultHuffTables();
+  xEntropyEstimator EntropyEst; EntropyEst.Init(HT);
+  const xHuffEstimatorAC* HE = EntropyEst.getHuffEstimatorAC(0);
+
+  int16* Src = (int16*)xMemory::xAlignedMallocPageAuto(NumBlock * BA * sizeof(int16));
+  uint32 State = xTestUtils::c_XorShiftSeed;
+  for(int32 i = 0; i < NumBlock; i++) { State = (i & 1) ? fillRandomSparseBlock(Src + (i * BA), State) : fillRandomTransformCoeffsBlock(Src + (i * BA), State); }
+
+  tDuration ES = (tDuration)0;
+  int64     EB = 0;
+  for(int32 j = 0; j < NumIters; j++)
+  {
+    tTimePoint T0 = tClock::now();
+    for(int32 i = 0; i < NumBlock; i++) { EB += EstimateAC(Src + (i * BA), HE); }
+    tTimePoint T1 = tClock::now();
+    ES += T1 - T0;
+  }
+  CHECK(EB > 0);
+
+  xMemory::xAlignedFree(Src);
+
+  return (flt64)NumBlock * NumIters / std::chrono::duration_cast<tDurationS>(ES).count();
+}
+
+void testBitstreamWriterJPEG()
+{
+  constexpr int32 NumIters  = 64;
+  constexpr int32 NumWrites = 64 * 1024;
+  constexpr int32 BuffSize  = NumWrites * 4 * 2 + 64;
+
+  xByteBuffer PlainBuffer  ; PlainBuffer  .resize(BuffSize);
+  xByteBuffer RefBuffer    ; RefBuffer    .resize(BuffSize);
+  xByteBuffer StuffedBuffer; StuffedBuffer.resize(BuffSize);
+
+  xBitstreamWriter     WriterPlain;
+  xBitstreamWriterJPEG WriterJPEG;
+
+  uint32 State = xTestUtils::c_XorShiftSeed;
+
+  for(int32 j = 0; j < NumIters; j++)
+  {
+    PlainBuffer.reset(); RefBuffer.reset(); StuffedBuffer.reset();
+    StuffedBuffer.appendU8(0xD8); //data present before entropy coded segment
+    RefBuffer    .appendU8(0xD8);
+
+    WriterPlain.bindByteBuffer(&PlainBuffer  ); WriterPlain.init();
+    WriterJPEG .bindByteBuffer(&StuffedBuffer); WriterJPEG .init();
+
+    uint32 NumBitsWritten = 0;
+    for(int32 i = 0; i < NumWrites; i++)
+    {
+      State = xTestUtils::xXorShift32(State);
+      uint32 NumBits = (State >> 8) % 32;
+      uint32 Bits    = NumBits == 0 ? 0 : ((State & 0x3) == 0 ? 0xFFFFFFFF : xTestUtils::xXorShift32(State)) >> (32 - NumBits); //frequent runs of ones
+      WriterPlain.writeBits(Bits, NumBits);
+      WriterJPEG .writeBits(Bits, NumBits);
+      NumBitsWritten += NumBits;
+    }
+    CHECK(WriterJPEG.getWrittenBits() == NumBitsWritten);
+
+    WriterPlain.writeAlign(1); WriterPlain.uninit(); WriterPlain.unbindByteBuffer();
+    WriterJPEG .writeAlign(1); WriterJPEG .uninit(); WriterJPEG .unbindByteBuffer();
+
+    xJFIF::AddStuffing(&RefBuffer, &PlainBuffer);
+    CHECK(WriterJPEG.getNumStuffedBytes() > 0);
+    CHECK(StuffedBuffer.getDataSize() == RefBuffer.getDataSize());
+    CHECK(xTestUtils::isSameBuffer(StuffedBuffer.getReadPtr(), RefBuffer.getReadPtr(), RefBuffer.getDataSize(), true));
+  }
+}
+
+void testBitstreamReaderJPEG()
+{
+  constexpr int32 NumIters  = 64;
+  constexpr int32 NumWrites = 64 * 1024;
+  constexpr int32 BuffSize  = NumWrites * 4 * 2 + 64;
+
+  xByteBuffer StuffedBuffer; StuffedBuffer.resize(BuffSize);
+
+  xBitstreamWriterJPEG WriterJPEG;
+  xBitstreamReaderJPEG ReaderJPEG;
+
+  std::vector<std::pair<uint32, uint32>> Written(NumWrites);
+
+  uint32 State = xTestUtils::c_XorShiftSeed;
+
+  for(int32 j = 0; j < NumIters; j++)
+  {
+    StuffedBuffer.reset();
+    WriterJPEG.bindByteBuffer(&StuffedBuffer); WriterJPEG.init();
+    const int32 NumWritesIter = NumWrites - (j * 997); //various lengths
+    for(int32 i = 0; i < NumWritesIter; i++)
+    {
+      State = xTestUtils::xXorShift32(State);
+      uint32 NumBits = (State >> 8) % 32 + 1;
+      uint32 Bits    = ((State & 0x3) == 0 ? 0xFFFFFFFF : xTestUtils::xXorShift32(State)) >> (32 - NumBits); //frequent runs of ones
+      WriterJPEG.writeBits(Bits, NumBits);
+      Written[i] = { Bits, NumBits };
+    }
+    WriterJPEG.writeAlign(1); WriterJPEG.uninit(); WriterJPEG.unbindByteBuffer();
+    CHECK(WriterJPEG.getNumStuffedBytes() > 0);
+
+    //restart marker followed by next entropy coded segment
+    StuffedBuffer.appendU16_BE(0xFFD0 | (j & 0x7));
+    StuffedBuffer.appendU32_BE(0xFF00FF00);
+
+    ReaderJPEG.bindByteBuffer(&StuffedBuffer); ReaderJPEG.init();
+    for(int32 i = 0; i < NumWritesIter; i++)
+    {
+      uint32 Bits = ReaderJPEG.readBits(Written[i].second);
+      CHECK(Bits == Written[i].first);
+    }
+    ReaderJPEG.readAlign(); ReaderJPEG.uninit(); ReaderJPEG.unbindByteBuffer();
+    CHECK(StuffedBuffer.getDataSize() == 6);
+    CHECK(StuffedBuffer.peekU16_BE() == (0xFFD0 | (j & 0x7)));
+  }
+}
+
 void testEntropy(bool UseDefault)
 {
   constexpr int32 NumIters = 64;
@@ -107,26 +337,24 @@ void testEntropy(bool UseDefault)
         EntropyEncDef.StartSlice(&EntropyBuffer);
         for(int32 i = 0; i < NumBlock; i++) { EntropyEncDef.EncodeBlock(Src + (i * BA), eCmp(c)); }
         EntropyEncDef.FinishSlice();
+
+        //copy to output and add stuffing
+        xJFIF::AddStuffing(&FinalBuffer, &EntropyBuffer);
       }
-      else
+      else //stuffing added by entropy encoder
       {
-        EntropyEnc.StartSlice(&EntropyBuffer);
+        EntropyEnc.StartSlice(&FinalBuffer);
         for(int32 i = 0; i < NumBlock; i++) { EntropyEnc.EncodeBlock(Src + (i * BA), eCmp(c), c, c); }
         EntropyEnc.FinishSlice();
       }
 
-      //copy to output and add stuffing
-      xJFIF::AddStuffing(&FinalBuffer, &EntropyBuffer);
-
-      EntropyBuffer.reset();
-
-      //copy from input and remove stuffing until next marker
-      xJFIF::RemoveStuffing(&EntropyBuffer, &FinalBuffer);
-
-      //decode
-      EntropyDec.StartSlice(&EntropyBuffer);
+      //decode directly from stuffed data, decoder stops before marker
+      xJFIF::WriteEOI(&FinalBuffer);
+      EntropyDec.StartSlice(&FinalBuffer);
       for(int32 i = 0; i < NumBlock; i++) { EntropyDec.DecodeBlock(Dst + (i * BA), eCmp(c), c, c); }
       EntropyDec.FinishSlice();
+      CHECK(FinalBuffer.getDataSize() == 2);
+      CHECK(FinalBuffer.peekU16_BE() == 0xFFD9);
 
       //compare
       CHECK(xTestUtils::isSameBuffer(Dst, Src, NumPels, true));
@@ -211,7 +439,418 @@ void testEntropyEstimator(bool UseDefault)
   xMemory::xAlignedFree(Src);
 }
 
-std::tuple<flt64, flt64> perfEntropy(bool UseDefault)
+void testEntropyEstimatorDelta()
+{
+  constexpr int32 NumIters  = 16;
+  constexpr int32 NumBlock  = 1024;
+  constexpr int32 NumTrials = 256;
+
+  std::vector<xJFIF::xHuffTable> HT = xInitDefaultHuffTables();
+
+  xEntropyEstimator EntropyEst; EntropyEst.Init(HT);
+  xEntropyEstimator::xBlockState BlockState;
+
+  uint32 State = xTestUtils::c_XorShiftSeed;
+  int16  Block[BA];
+
+  for(int32 j = 0; j < NumIters; j++)
+  {
+    for(int32 c = 0; c <= 1; c++)
+    {
+      for(int32 i = 0; i < NumBlock; i++)
+      {
+        State = fillRandomTransformCoeffsBlock(Block, State);
+        const int32 LastDC = (int32)(State & 0x3FF) - 512;
+        EntropyEst.InitBlockState(BlockState, Block, LastDC, c, c);
+
+        int32 NumMismatch = 0;
+        for(int32 t = 0; t < NumTrials; t++)
+        {
+          State = xTestUtils::xXorShift32(State);
+          const int32 Pos      = (State >> 8) & 0x3F;
+          const int32 Mode     = (State >> 16) & 0x3;
+          const int16 NewCoeff = Mode == 0 ? 0 : Mode == 1 ? (int16)(Block[Pos] + 1) : Mode == 2 ? (int16)(Block[Pos] - 1) : (int16)((int32)(State >> 20 & 0x3FF) - 512);
+
+          const int32 DeltaBits = EntropyEst.EstimateDelta(BlockState, Pos, NewCoeff);
+
+          //batched estimation of several candidates
+          const int16 Candidates[4] = { 0, (int16)(Block[Pos] + 1), (int16)(Block[Pos] - 1), NewCoeff };
+          int32       CandDeltas[4];
+          EntropyEst.EstimateDeltas(BlockState, Pos, Candidates, CandDeltas, 4);
+          for(int32 k = 0; k < 4; k++) { if(CandDeltas[k] != EntropyEst.EstimateDelta(BlockState, Pos, Candidates[k])) { NumMismatch++; } }
+
+          const int32 OrgBits   = EntropyEst.EstimateBlockStateless(Block, LastDC, c, c);
+          Block[Pos] = NewCoeff;
+          const int32 NewBits   = EntropyEst.EstimateBlockStateless(Block, LastDC, c, c);
+          BlockState.update(Pos, NewCoeff, DeltaBits);
+
+          if(DeltaBits != NewBits - OrgBits || BlockState.getNumBits() != NewBits) { NumMismatch++; }
+        }
+        CHECK(NumMismatch == 0);
+      }
+    }
+  }
+}
+
+void testBlockInfo(std::function<uint64(const int16*)> CalcNonZeroMask)
+{
+  constexpr int32 NumIters = 16;
+  constexpr int32 NumBlock = 1024;
+
+  std::vector<xJFIF::xHuffTable> HT = xInitDefaultHuffTables();
+
+  xByteBuffer BufferRef; BufferRef.resize(NumBlock * BA * sizeof(int16) * 2);
+  xByteBuffer BufferTst; BufferTst.resize(NumBlock * BA * sizeof(int16) * 2);
+
+  xEntropyEncoder   EntropyEncRef; EntropyEncRef.Init(HT);
+  xEntropyEncoder   EntropyEncTst; EntropyEncTst.Init(HT);
+  xEntropyEstimator EntropyEstRef; EntropyEstRef.Init(HT);
+  xEntropyEstimator EntropyEstTst; EntropyEstTst.Init(HT);
+  xEntropyEstimator::xBlockState BlockStateRef;
+  xEntropyEstimator::xBlockState BlockStateTst;
+
+  std::vector<int16>      Blocks(NumBlock * BA);
+  std::vector<xBlockInfo> Infos (NumBlock);
+  uint32 State = xTestUtils::c_XorShiftSeed;
+
+  for(int32 j = 0; j < NumIters; j++)
+  {
+    //dense and sparse blocks (long zero runs, random last position)
+    for(int32 i = 0; i < NumBlock; i++)
+    {
+      int16* Block = Blocks.data() + i * BA;
+      State = (i & 1) ? fillRandomSparseBlock(Block, State) : fillRandomTransformCoeffsBlock(Block, State);
+      if(i == 0) { memset(Block, 0, BA * sizeof(int16)); Block[0] = 7; }
+      if(i == 2) { Block[63] = -3; }
+
+      uint64 RefMask = 0;
+      for(int32 k = 0; k < BA; k++) { RefMask |= (uint64)(Block[k] != 0) << k; }
+      CHECK(CalcNonZeroMask(Block) == RefMask);
+
+      xEntropyCommon::deriveBlockInfo(Infos[i], Block);
+      CHECK(Infos[i].getNonZeroMask() == (RefMask | 1));
+      CHECK(Infos[i].getLastPos    () == xEntropyCommon::findLastNonZero(Block));
+      CHECK(Infos[i].isNumBitsValid() == false);
+    }
+
+    for(int32 c = 0; c <= 1; c++)
+    {
+      //encoding from block info produces identical bitstream
+      BufferRef.reset(); EntropyEncRef.StartSlice(&BufferRef);
+      BufferTst.reset(); EntropyEncTst.StartSlice(&BufferTst);
+      for(int32 i = 0; i < NumBlock; i++)
+      {
+        EntropyEncRef.EncodeBlock(Blocks.data() + i * BA,           eCmp(c), c, c);
+        EntropyEncTst.EncodeBlock(Blocks.data() + i * BA, Infos[i], eCmp(c), c, c);
+      }
+      EntropyEncRef.FinishSlice();
+      EntropyEncTst.FinishSlice();
+      CHECK(BufferTst.getDataSize() == BufferRef.getDataSize());
+      CHECK(memcmp(BufferTst.getReadPtr(), BufferRef.getReadPtr(), BufferRef.getDataSize()) == 0);
+
+      //estimation and block state initialization from block info
+      EntropyEstRef.StartSlice();
+      EntropyEstTst.StartSlice();
+      int32 NumMismatch = 0;
+      for(int32 i = 0; i < NumBlock; i++)
+      {
+        const int16* Block  = Blocks.data() + i * BA;
+        const int32  LastDC  = (int32)EntropyEstRef.getLastDC(eCmp(c));
+        const int32  RefBits = EntropyEstRef.EstimateBlock(Block,           eCmp(c), c, c);
+        const int32  TstBits = EntropyEstTst.EstimateBlock(Block, Infos[i], eCmp(c), c, c);
+        if(TstBits != RefBits) { NumMismatch++; }
+
+        EntropyEstRef.InitBlockState(BlockStateRef, Block,           LastDC, c, c);
+        EntropyEstTst.InitBlockState(BlockStateTst, Block, Infos[i], LastDC, c, c);
+        if(BlockStateTst.getNumBits() != BlockStateRef.getNumBits() || BlockStateRef.getNumBits() != RefBits) { NumMismatch++; }
+
+        //cached rate is reused
+        xBlockInfo Cached = Infos[i]; Cached.setNumBits(RefBits + 1);
+        EntropyEstTst.InitBlockState(BlockStateTst, Block, Cached, LastDC, c, c);
+        if(BlockStateTst.getNumBits() != RefBits + 1) { NumMismatch++; }
+        BlockStateTst.storeBlockInfo(Cached);
+        if(Cached.getNonZeroMask() != Infos[i].getNonZeroMask() || Cached.getLastPos() != Infos[i].getLastPos()) { NumMismatch++; }
+      }
+      CHECK(NumMismatch == 0);
+    }
+  }
+}
+
+void testEntropyOptimal()
+{
+  constexpr int32 NumIters = 16;
+  constexpr int32 NumBlock = 4 * 1024;
+  constexpr int32 NumPels  = NumBlock * BA;
+  constexpr int64 BuffSize = NumPels * sizeof(int16);
+
+  int16* Src = (int16*)xMemory::xAlignedMallocPageAuto(BuffSize);
+  int16* Dst = (int16*)xMemory::xAlignedMallocPageAuto(BuffSize);
+
+  xByteBuffer FinalBuffer;
+  FinalBuffer.resize(BuffSize * 4);
+
+  std::vector<xJFIF::xHuffTable> HT = xInitDefaultHuffTables();
+
+  xEntropyEstimator EntropyEstDef; EntropyEstDef.Init(HT);
+  xEntropyCounter   EntropyCnt   ;
+
+  uint32 State = xTestUtils::c_XorShiftSeed;
+
+  for(int32 j = 0; j < NumIters; j++)
+  {
+    //generate
+    for(int32 i = 0; i < NumBlock; i++) { State = fillRandomTransformCoeffsBlock(Src + (i * BA), State); }
+
+    //count - luma statistics to table 0, chroma to table 1
+    EntropyCnt.Init(HT);
+    for(int32 c = 0; c <= 1; c++)
+    {
+      int32 LastDC = 0;
+      for(int32 i = 0; i < NumBlock; i++) { EntropyCnt.CountBlock(Src + (i * BA), LastDC, c, c); LastDC = Src[i * BA]; }
+    }
+
+    std::vector<xJFIF::xHuffTable> HTO = HT;
+    EntropyCnt.BuildOptimalTables(HTO);
+    for(const xJFIF::xHuffTable& HuffTable : HTO)
+    {
+      const xJFIF::xHuffTable::tCodeL& CodeLengths = HuffTable.getCodeLengths();
+      int32 NumCodes = 0; for(int32 l = 0; l < 16; l++) { NumCodes += CodeLengths[l]; }
+      CHECK(NumCodes == (int32)HuffTable.getCodeSymbols().size());
+    }
+
+    xEntropyEncoder   EntropyEnc; EntropyEnc.Init(HTO);
+    xEntropyDecoder   EntropyDec; EntropyDec.Init(HTO);
+    xEntropyEstimator EntropyEst; EntropyEst.Init(HTO);
+
+    for(int32 c = 0; c <= 1; c++)
+    {
+      //estimate - optimized tables cannot be worse than default ones
+      int32 DefBits = 0;
+      int32 OptBits = 0;
+      EntropyEstDef.StartSlice();
+      EntropyEst   .StartSlice();
+      for(int32 i = 0; i < NumBlock; i++)
+      {
+        DefBits += EntropyEstDef.EstimateBlock(Src + (i * BA), eCmp(c), c, c);
+        OptBits += EntropyEst   .EstimateBlock(Src + (i * BA), eCmp(c), c, c);
+      }
+      CHECK(OptBits <= DefBits);
+
+      //encode
+      FinalBuffer.reset();
+      EntropyEnc.StartSlice(&FinalBuffer);
+      for(int32 i = 0; i < NumBlock; i++) { EntropyEnc.EncodeBlock(Src + (i * BA), eCmp(c), c, c); }
+      EntropyEnc.FinishSlice();
+
+      //decode directly from stuffed data
+      EntropyDec.StartSlice(&FinalBuffer);
+      for(int32 i = 0; i < NumBlock; i++) { EntropyDec.DecodeBlock(Dst + (i * BA), eCmp(c), c, c); }
+      EntropyDec.FinishSlice();
+      CHECK(FinalBuffer.getDataSize() == 0);
+
+      //compare
+      CHECK(xTestUtils::isSameBuffer(Dst, Src, NumPels, true));
+    }
+  }
+
+  xMemory::xAlignedFree(Src);
+  xMemory::xAlignedFree(Dst);
+}
+
+void testHuffTableOptimalDegenerate()
+{
+  //Fibonacci counts 2..47 (reserved symbol acts as 1st one) - Figure K.1 would build 46 bit codes, beyond 32 entries of code size histogram
+  std::vector<uint32> SymbolCount(xJPEG_Constants::c_MaxNumCodeSymbolsAC, 0);
+  uint64 Prev = 1, Curr = 2;
+  for(int32 i = 0; i < 46; i++) { SymbolCount[i] = (uint32)Prev; const uint64 Next = Prev + Curr; Prev = Curr; Curr = Next; }
+
+  xJFIF::xHuffTable HuffTable;
+  HuffTable.InitOptimal(0, xJFIF::xHuffTable::eHuffClass::AC, SymbolCount.data(), xJPEG_Constants::c_MaxNumCodeSymbolsAC);
+
+  //all used symbols get a code of at most 16 bits and code lengths satisfy Kraft inequality with all-ones code reserved
+  const xJFIF::xHuffTable::tCodeL& CodeLengths = HuffTable.getCodeLengths();
+  int32  NumCodes = 0;
+  uint64 Kraft    = 0;
+  for(int32 l = 0; l < 16; l++) { NumCodes += CodeLengths[l]; Kraft += (uint64)CodeLengths[l] << (15 - l); }
+  CHECK(NumCodes == 46);
+  CHECK(NumCodes == (int32)HuffTable.getCodeSymbols().size());
+  CHECK(Kraft < ((uint64)1 << 16));
+}
+
+void testEntropyProgressive()
+{
+  constexpr int32 NumIters = 4;
+  constexpr int32 NumBlock = 4 * 1024;
+  constexpr int32 NumPels  = NumBlock * BA;
+  constexpr int64 BuffSize = NumPels * sizeof(int16);
+
+  int16* Src = (int16*)xMemory::xAlignedMallocPageAuto(BuffSize);
+  int16* Dst = (int16*)xMemory::xAlignedMallocPageAuto(BuffSize);
+
+  xByteBuffer FinalBuffer;
+  FinalBuffer.resize(BuffSize * 4);
+
+  //single component scan scripts {Ss, Se, Ah, Al} - every script sends every coefficient bit once
+  const std::vector<std::vector<std::array<int32, 4>>> ScanScripts =
+  {
+    { {0, 0, 0, 0}, {1, 63, 0, 0} },                                                                                                //spectral selection only
+    { {0, 0, 0, 1}, {1, 5, 0, 2}, {6, 63, 0, 2}, {1, 63, 2, 1}, {0, 0, 1, 0}, {1, 63, 1, 0} },                                     //libjpeg simple progression
+    { {0, 0, 0, 3}, {1, 63, 0, 3}, {0, 0, 3, 2}, {1, 63, 3, 2}, {0, 0, 2, 1}, {1, 63, 2, 1}, {0, 0, 1, 0}, {1, 63, 1, 0} }, //deep successive approximation
+  };
+
+  xEntropyEncoderProgressive EntropyEnc;
+  xEntropyDecoderProgressive EntropyDec;
+
+  uint32 State = xTestUtils::c_XorShiftSeed;
+
+  for(int32 j = 0; j < NumIters; j++)
+  {
+    //generate - dense and sparse blocks (long EOB runs and correction bit buffering in refinement scans)
+    for(int32 i = 0; i < NumBlock; i++) { State = (j & 1) ? fillRandomSparseBlock(Src + (i * BA), State) : fillRandomTransformCoeffsBlock(Src + (i * BA), State); }
+
+    for(const std::vector<std::array<int32, 4>>& ScanScript : ScanScripts)
+    {
+      memset(Dst, 0, BuffSize);
+
+      for(const std::array<int32, 4>& ScanParams : ScanScript)
+      {
+        xJFIF::xSOS Scan;
+        Scan.Init(1, 0, 0);
+        Scan.setSpectralSelection(ScanParams[0], ScanParams[1]);
+        Scan.setSuccessiveApprox (ScanParams[2], ScanParams[3]);
+        const bool IsDC = ScanParams[0] == 0;
+
+        //optimal tables (DC refinement scans do not use Huffman coding)
+        if(!IsDC || ScanParams[2] == 0)
+        {
+          std::vector<xJFIF::xHuffTable> HT(1);
+          HT[0].setIdx  (0);
+          HT[0].setClass(IsDC ? xJFIF::xHuffTable::eHuffClass::DC : xJFIF::xHuffTable::eHuffClass::AC);
+          EntropyEnc.StartScan(nullptr, Scan);
+          for(int32 i = 0; i < NumBlock; i++) { EntropyEnc.EncodeBlock(Src + (i * BA), eCmp::LM, 0, 0); }
+          EntropyEnc.FinishScan();
+          EntropyEnc.BuildOptimalTables(HT);
+          EntropyEnc.Init(HT);
+          EntropyDec.Init(HT);
+        }
+
+        //encode
+        FinalBuffer.reset();
+        EntropyEnc.StartScan(&FinalBuffer, Scan);
+        for(int32 i = 0; i < NumBlock; i++) { EntropyEnc.EncodeBlock(Src + (i * BA), eCmp::LM, 0, 0); }
+        EntropyEnc.FinishScan();
+
+        //decode directly from stuffed data, decoder stops before marker
+        xJFIF::WriteEOI(&FinalBuffer);
+        EntropyDec.StartScan(&FinalBuffer, Scan);
+        for(int32 i = 0; i < NumBlock; i++) { EntropyDec.DecodeBlock(Dst + (i * BA), eCmp::LM, 0, 0); }
+        EntropyDec.FinishScan();
+        CHECK(FinalBuffer.getDataSize() == 2);
+        CHECK(FinalBuffer.peekU16_BE() == 0xFFD9);
+      }
+
+      //compare - all scans accumulated
+      CHECK(xTestUtils::isSameBuffer(Dst, Src, NumPels, true));
+    }
+  }
+
+  xMemory::xAlignedFree(Src);
+  xMemory::xAlignedFree(Dst);
+}
+
+void testEntropyArithmetic()
+{
+  constexpr int32 NumIters  = 4;
+  constexpr int32 NumBlock  = 4 * 1024;
+  constexpr int32 NumPels   = NumBlock * BA;
+  constexpr int64 BuffSize  = NumPels * sizeof(int16);
+  constexpr int32 NumTrials = 64;
+
+  int16* Src = (int16*)xMemory::xAlignedMallocPageAuto(BuffSize);
+  int16* Dst = (int16*)xMemory::xAlignedMallocPageAuto(BuffSize);
+
+  xByteBuffer FinalBuffer;
+  FinalBuffer.resize(BuffSize * 4);
+
+  xEntropyEncoderArith EntropyEnc;
+  xEntropyDecoderArith EntropyDec;
+  xEntropyEstimator    EntropyEst;
+  xEntropyEstimator::xBlockState BlockState;
+
+  uint32 State = xTestUtils::c_XorShiftSeed;
+
+  for(int32 j = 0; j < NumIters; j++)
+  {
+    //generate - dense and sparse blocks, luma and chroma blocks use separate statistics areas
+    for(int32 i = 0; i < NumBlock; i++) { State = (j & 1) ? fillRandomSparseBlock(Src + (i * BA), State) : fillRandomTransformCoeffsBlock(Src + (i * BA), State); }
+    auto CmpOfBlock = [](int32 i) { return (i & 3) == 3 ? eCmp::CB : eCmp::LM; };
+    auto TabOfBlock = [](int32 i) { return (i & 3) == 3 ? 1 : 0; };
+
+    //encode
+    FinalBuffer.reset();
+    EntropyEnc.StartSlice(&FinalBuffer);
+    for(int32 i = 0; i < NumBlock; i++) { EntropyEnc.EncodeBlock(Src + (i * BA), CmpOfBlock(i), TabOfBlock(i), TabOfBlock(i)); }
+    EntropyEnc.FinishSlice();
+    const int32 NumBytes = FinalBuffer.getDataSize();
+
+    //decode directly from stuffed data, decoder stops before marker
+    xJFIF::WriteEOI(&FinalBuffer);
+    EntropyDec.StartSlice(&FinalBuffer);
+    for(int32 i = 0; i < NumBlock; i++) { EntropyDec.DecodeBlock(Dst + (i * BA), CmpOfBlock(i), TabOfBlock(i), TabOfBlock(i)); }
+    EntropyDec.FinishSlice();
+    CHECK(FinalBuffer.getDataSize() == 2);
+    CHECK(FinalBuffer.peekU16_BE() == 0xFFD9);
+    CHECK(xTestUtils::isSameBuffer(Dst, Src, NumPels, true));
+
+    //estimator trained on gathered statistics - block estimate within 1/8 of coded size, deltas consistent with full estimation
+    EntropyEnc.ResetCounters();
+    EntropyEnc.StartSlice(nullptr);
+    for(int32 i = 0; i < NumBlock; i++) { EntropyEnc.EncodeBlock(Src + (i * BA), CmpOfBlock(i), TabOfBlock(i), TabOfBlock(i)); }
+    EntropyEnc.FinishSlice();
+    EntropyEst.InitArith(EntropyEnc.getArithCountersDC(), EntropyEnc.getArithCountersAC());
+    CHECK(EntropyEst.isArithmetic());
+
+    EntropyEst.StartSlice();
+    int64 EstBits = 0;
+    for(int32 i = 0; i < NumBlock; i++) { EstBits += EntropyEst.EstimateBlock(Src + (i * BA), CmpOfBlock(i), TabOfBlock(i), TabOfBlock(i)); }
+    const int64 CodedBits = (int64)NumBytes * 8 * EntropyEst.getRateScale();
+    CHECK(xAbs(EstBits - CodedBits) < CodedBits / 8);
+
+    int32 NumMismatch = 0;
+    for(int32 i = 0; i < NumBlock; i += 16)
+    {
+      int16* Block = Src + (i * BA);
+      const int32 LastDC = (int32)(State & 0x3FF) - 512;
+      EntropyEst.InitBlockState(BlockState, Block, LastDC, TabOfBlock(i), TabOfBlock(i));
+      for(int32 t = 0; t < NumTrials; t++)
+      {
+        State = xTestUtils::xXorShift32(State);
+        const int32 Pos      = (State >> 8) & 0x3F;
+        const int32 Mode     = (State >> 16) & 0x3;
+        const int16 NewCoeff = Mode == 0 ? 0 : Mode == 1 ? (int16)(Block[Pos] + 1) : Mode == 2 ? (int16)(Block[Pos] - 1) : (int16)((int32)(State >> 20 & 0x3FF) - 512);
+
+        const int32 DeltaBits = EntropyEst.EstimateDelta(BlockState, Pos, NewCoeff);
+        const int16 Candidates[4] = { 0, (int16)(Block[Pos] + 1), (int16)(Block[Pos] - 1), NewCoeff };
+        int32       CandDeltas[4];
+        EntropyEst.EstimateDeltas(BlockState, Pos, Candidates, CandDeltas, 4);
+        for(int32 k = 0; k < 4; k++) { if(CandDeltas[k] != EntropyEst.EstimateDelta(BlockState, Pos, Candidates[k])) { NumMismatch++; } }
+
+        const int32 OrgBits = EntropyEst.EstimateBlockStateless(Block, LastDC, TabOfBlock(i), TabOfBlock(i));
+        Block[Pos] = NewCoeff;
+        const int32 NewBits = EntropyEst.EstimateBlockStateless(Block, LastDC, TabOfBlock(i), TabOfBlock(i));
+        BlockState.update(Pos, NewCoeff, DeltaBits);
+
+        if(DeltaBits != NewBits - OrgBits || BlockState.getNumBits() != NewBits) { NumMismatch++; }
+      }
+    }
+    CHECK(NumMismatch == 0);
+  }
+
+  xMemory::xAlignedFree(Src);
+  xMemory::xAlignedFree(Dst);
+}
+
+std::tuple<flt64, flt64, flt64> perfEntropy(bool UseDefault)
 {
   constexpr int32 NumIters = 16;
   constexpr int32 NumBlock = 1024 * 1024;
@@ -219,9 +858,12 @@ std::tuple<flt64, flt64> perfEntropy(bool UseDefault)
   constexpr int64 BuffSize = NumPels * sizeof(int16);
 
   int16* Src = (int16*)xMemory::xAlignedMallocPageAuto(BuffSize);
+  int16* Dst = (int16*)xMemory::xAlignedMallocPageAuto(BuffSize);
 
   xByteBuffer EntropyBuffer;
   EntropyBuffer.resize(BuffSize * 2);
+  xByteBuffer StuffedBuffer;
+  StuffedBuffer.resize(BuffSize * 4);
 
   std::vector<xJFIF::xHuffTable> HT;
   HT.resize(4);
@@ -234,11 +876,13 @@ std::tuple<flt64, flt64> perfEntropy(bool UseDefault)
   xEntEncDefTest           EntropyEncDef;
   xEntropyEstimator        EntropyEst   ; EntropyEst.Init(HT);
   xEntropyEstimatorDefault EntropyEstDef;
+  xEntropyDecoder          EntropyDec   ; EntropyDec.Init(HT);
 
   uint32 State = xTestUtils::c_XorShiftSeed;
 
   tDuration EN = (tDuration)0;
   tDuration ES = (tDuration)0;
+  tDuration DE = (tDuration)0;
 
   for(int32 j = 0; j < NumIters; j++)
   {
@@ -288,24 +932,111 @@ std::tuple<flt64, flt64> perfEntropy(bool UseDefault)
         //EntropyEst.FinishSlice();
       }
 
+      //decode
+      StuffedBuffer.reset();
+      if(UseDefault) { xJFIF::AddStuffing(&StuffedBuffer, &EntropyBuffer); }
+      else           { StuffedBuffer.append(&EntropyBuffer);               }
+      {
+        EntropyDec.StartSlice(&StuffedBuffer);
+        tTimePoint T = tClock::now();
+        for(int32 i = 0; i < NumBlock; i++) { EntropyDec.DecodeBlock(Dst + (i * BA), eCmp(c), c, c); }
+        DE += tClock::now() - T;
+        EntropyDec.FinishSlice();
+      }
+
       //compare
       CHECK(EncBits == EstBits);
+      CHECK(xTestUtils::isSameBuffer(Dst, Src, NumPels, true));
     }
   }
 
   int64 TotalNumBlock = NumBlock * NumIters;
   flt64 BlocksPerSecEN = TotalNumBlock / std::chrono::duration_cast<tDurationS>(EN).count();
   flt64 BlocksPerSecES = TotalNumBlock / std::chrono::duration_cast<tDurationS>(ES).count();
+  flt64 BlocksPerSecDE = TotalNumBlock / std::chrono::duration_cast<tDurationS>(DE).count();
 
   xMemory::xAlignedFree(Src);
+  xMemory::xAlignedFree(Dst);
 
-  return { BlocksPerSecEN, BlocksPerSecES };
+  return { BlocksPerSecEN, BlocksPerSecES, BlocksPerSecDE };
 }
 
 //===============================================================================================================================================================================================================
 
+TEST_CASE("testExtractSymbolsSTD")
+{
+  testExtractSymbols(xEntComTest::extractSymbolsSTD);
+}
+
+#if X_SIMD_CAN_USE_AVX
+TEST_CASE("testExtractSymbolsAVX")
+{
+  testExtractSymbols(xEntComTest::extractSymbolsAVX);
+}
+#endif
+
+#if X_SIMD_CAN_USE_AVX512
+TEST_CASE("testExtractSymbolsAVX512")
+{
+  testExtractSymbols(xEntComTest::extractSymbolsAVX512);
+}
+#endif
+
+TEST_CASE("testEstimateACSTD")
+{
+  testEstimateAC(xEntEstTest::xEstimateACSTD);
+}
+
+#if X_SIMD_CAN_USE_AVX
+TEST_CASE("testEstimateACAVX")
+{
+  testEstimateAC(xEntEstTest::xEstimateACAVX);
+}
+#endif
+
+#if X_SIMD_CAN_USE_AVX512
+TEST_CASE("testEstimateACAVX512")
+{
+  testEstimateAC(xEntEstTest::xEstimateACAVX512);
+}
+#endif
+
+TEST_CASE("testBlockInfoSTD")
+{
+  testBlockInfo(xEntComTest::calcNonZeroMaskSTD);
+}
+
+#if X_SIMD_CAN_USE_AVX
+TEST_CASE("testBlockInfoAVX")
+{
+  testBlockInfo(xEntComTest::calcNonZeroMaskAVX);
+}
+#endif
+
+#if X_SIMD_CAN_USE_AVX512
+TEST_CASE("testBlockInfoAVX512")
+{
+  testBlockInfo(xEntComTest::calcNonZeroMaskAVX512);
+}
+#endif
+
+TEST_CASE("testHuffTableOptimalDegenerate")
+{
+  testHuffTableOptimalDegenerate();
+}
+
 #ifdef NDEBUG 
 
+TEST_CASE("testBitstreamWriterJPEG")
+{
+  testBitstreamWriterJPEG();
+}
+
+TEST_CASE("testBitstreamReaderJPEG")
+{
+  testBitstreamReaderJPEG();
+}
+
 TEST_CASE("testEntropy")
 {
   testEntropy(false);
@@ -326,17 +1057,50 @@ TEST_CASE("testEstimatorDefault")
   testEntropyEstimator(true);
 }
 
+TEST_CASE("testEstimatorDelta")
+{
+  testEntropyEstimatorDelta();
+}
+
+TEST_CASE("testEntropyOptimal")
+{
+  testEntropyOptimal();
+}
+
+TEST_CASE("testEntropyProgressive")
+{
+  testEntropyProgressive();
+}
+
+TEST_CASE("testEntropyArithmetic")
+{
+  testEntropyArithmetic();
+}
+
 TEST_CASE("testEntropy-perf")
 {
-  auto [EN, ES] = perfEntropy(false);
+  auto [EN, ES, DE] = perfEntropy(false);
   fmt::print("TIME(xEntropyEncoder  ) = {:.2f} kBlock/s\n", EN / (1024));
   fmt::print("TIME(xEntropyEstimator) = {:.2f} kBlock/s\n", ES / (1024));
+  fmt::print("TIME(xEntropyDecoder  ) = {:.2f} kBlock/s\n", DE / (1024));
 }
 TEST_CASE("testEntropyDefault-perf")
 {
-  auto [EN, ES] = perfEntropy(true);
+  auto [EN, ES, DE] = perfEntropy(true);
   fmt::print("TIME(xEntropyDefaultEncoder  ) = {:.2f} kBlock/s\n", EN / (1024));
   fmt::print("TIME(xEntropyDefaultEstimator) = {:.2f} kBlock/s\n", ES / (1024));
+  fmt::print("TIME(xEntropyDecoder         ) = {:.2f} kBlock/s\n", DE / (1024));
+}
+
+TEST_CASE("testEstimateAC-perf")
+{
+  fmt::print("TIME(xEstimateACSTD   ) = {:.2f} kBlock/s\n", perfEstimateAC(xEntEstTest::xEstimateACSTD   ) / 1024);
+#if X_SIMD_CAN_USE_AVX
+  fmt::print("TIME(xEstimateACAVX   ) = {:.2f} kBlock/s\n", perfEstimateAC(xEntEstTest::xEstimateACAVX   ) / 1024);
+#endif
+#if X_SIMD_CAN_USE_AVX512
+  fmt::print("TIME(xEstimateACAVX512) = {:.2f} kBlock/s\n", perfEstimateAC(xEntEstTest::xEstimateACAVX512) / 1024);
+#endif
 }
 
 #endif //def NDEBUG
@@ -10,6 +10,7 @@
 #define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
 #include <doctest/doctest.h>
 #include <functional>
+#include <algorithm>
 #include <utility>
 #include <array>
 #include "xTestUtils.h"
@@ -17,6 +18,10 @@
 #include "xCommonDefJPEG.h"
 #include "xJPEG_Quant.h"
 #include "xJPEG_Constants.h"
+#include "xJPEG_Transform.h"
+#include "xJPEG_TransformConstants.h"
+#include "xJPEG_Scan.h"
+#include "xDistortion.h"
 
 using namespace PMBB_NAMESPACE;
 using namespace PMBB_NAMESPACE::JPEG;
@@ -50,6 +55,7 @@ protected:
 public:
   const uint16* getQuantFlt  () const { return m_QuantFlt  ; };
   const uint16* getQuantCoeff() const { return m_QuantCoeff; };
+  const uint16* getQuantScan () const { return m_QuantCoeffScan; };
   const uint16* getReciprocal() const { return m_Reciprocal; };
   const uint16* getCorrection() const { return m_Correction; };
   const uint16* getScale     () const { return m_Scale     ; };
@@ -181,6 +187,81 @@ void testQuantSIMD(std::function <void(int16*, const int16*, const uint16*, cons
   }
 }
 
+void testFwdTransformQuantScan(std::function <void(int16*, const uint16*)>FwdTransform, std::function <void(int16*, const int16*, const uint16*, const uint16*, const uint16*)>QuantScale,
+                               std::function <void(int16*, const uint16*, const uint16*, const uint16*, const uint16*)>FwdTransformQuantScan)
+{
+  xQuantTest Quantizer;
+  std::array<uint16, BA> Src;
+  std::array< int16, BA> TmpT;
+  std::array< int16, BA> TmpQ;
+  std::array< int16, BA> RefS;
+  std::array< int16, BA> TstS;
+
+  uint32 State = xTestUtils::c_XorShiftSeed;
+  for(int32 Quality = 100; Quality >= 0; Quality -= 5)
+  {
+    Quantizer.Init(Quality & 1 ? eCmp::CB : eCmp::LM, Quality);
+    for(int32 r = 0; r < 256; r++)
+    {
+      State = xTestUtils::fillRandom(Src.data(), NOT_VALID, BA, 1, 8, State);
+      if(r == 0) { Src.fill(0); } else if(r == 1) { Src.fill(255); } //extreme DC
+
+      FwdTransform(TmpT.data(), Src.data());
+      TmpT[0] -= xTransformConstants::c_FwdDcCorr;
+      QuantScale(TmpQ.data(), TmpT.data(), Quantizer.getCorrection(), Quantizer.getReciprocal(), Quantizer.getScale());
+      xScanSTD::Scan(RefS.data(), TmpQ.data());
+
+      FwdTransformQuantScan(TstS.data(), Src.data(), Quantizer.getCorrection(), Quantizer.getReciprocal(), Quantizer.getScale());
+      CHECK(xTestUtils::isSameBuffer(TstS.data(), RefS.data(), BA, true));
+    }
+  }
+}
+
+void testInvScanQuantTransformSSD(std::function <void(uint16*, const int16*)>InvTransform, std::function <uint64(const int16*, const uint16*, const uint16*)>InvScanQuantTransformSSD, int32 LastPos = BA - 1)
+{
+  xQuantTest Quantizer;
+  std::array<uint16, BA> Org;
+  std::array<uint16, BA> Rec;
+  std::array< int16, BA> TmpQ;
+  std::array< int16, BA> TmpT;
+  std::array< int16, BA> ScanQ;
+
+  uint32 State = xTestUtils::c_XorShiftSeed;
+  for(int32 Quality = 100; Quality >= 0; Quality -= 5)
+  {
+    Quantizer.Init(Quality & 1 ? eCmp::CB : eCmp::LM, Quality);
+    for(int32 r = 0; r < 256; r++)
+    {
+      //quantized coeffs of random block (or random coeffs), compared against another random block
+      State = xTestUtils::fillRandom(Org.data(), NOT_VALID, BA, 1, 8, State);
+      if(r & 1)
+      {
+        State = xTestUtils::fillRandom((uint16*)ScanQ.data(), NOT_VALID, BA, 1, 8, State);
+        for(int32 i = 0; i < BA; i++) { ScanQ[i] -= 128; }
+      }
+      else
+      {
+        xTransformSTD::FwdTransformDCT_8x8_M16(TmpT.data(), Org.data());
+        TmpT[0] -= xTransformConstants::c_FwdDcCorr;
+        xQuantSTD::QuantScale(TmpQ.data(), TmpT.data(), Quantizer.getCorrection(), Quantizer.getReciprocal(), Quantizer.getShift());
+        xScanSTD::Scan(ScanQ.data(), TmpQ.data());
+        State = xTestUtils::fillRandom(Org.data(), NOT_VALID, BA, 1, 8, State);
+      }
+      if(r == 0) { ScanQ.fill(0); Org.fill(255); } else if(r == 1) { ScanQ.fill(0); ScanQ[0] = 1023; Org.fill(0); } //extreme DC
+      std::fill(ScanQ.begin() + LastPos + 1, ScanQ.end(), (int16)0);
+
+      xScanSTD::InvScan(TmpQ.data(), ScanQ.data());
+      xQuantSTD::InvScale(TmpT.data(), TmpQ.data(), Quantizer.getQuantCoeff());
+      TmpT[0] += xTransformConstants::c_InvDcCorr;
+      InvTransform(Rec.data(), TmpT.data());
+      uint64 RefSSD = xDistortion::CalcSSD(Org.data(), Rec.data(), 8, 8, 8, 8);
+
+      uint64 TstSSD = InvScanQuantTransformSSD(ScanQ.data(), Quantizer.getQuantScan(), Org.data());
+      CHECK(TstSSD == RefSSD);
+    }
+  }
+}
+
 std::tuple<flt64, flt64> perfQuant(std::function <void(int16*, const int16*, const uint16*, const uint16*, const uint16*)>QuantScale,
                                    std::function <void(int16*, const int16*, const uint16*)>InvScale,
                                    bool MultiplicationBased, bool SimpleFloat)
@@ -268,6 +349,54 @@ TEST_CASE("xQuantAVX512")
 }
 #endif
 
+#if X_SIMD_CAN_USE_AVX
+TEST_CASE("xFwdTransformQuantScanAVX")
+{
+  testFwdTransformQuantScan(xTransformAVX::FwdTransformDCT_8x8_M16, xQuantAVX::QuantScale, xTransformAVX::FwdTransformQuantScan_8x8_M16);
+}
+#endif
+
+#if X_SIMD_CAN_USE_AVX512
+TEST_CASE("xFwdTransformQuantScanAVX512")
+{
+  testFwdTransformQuantScan(xTransformAVX512::FwdTransformDCT_8x8_M16, xQuantAVX512::QuantScale, xTransformAVX512::FwdTransformQuantScan_8x8_M16);
+}
+#endif
+
+#if X_SIMD_CAN_USE_AVX
+TEST_CASE("xInvScanQuantTransformSSDAVX")
+{
+  testInvScanQuantTransformSSD(xTransformAVX::InvTransformDCT_8x8_M16, xTransformAVX::InvScanQuantTransformSSD_8x8_M16);
+}
+#endif
+
+#if X_SIMD_CAN_USE_AVX
+TEST_CASE("xInvScanQuantTransformSSDAVX_4x4")
+{
+  for(int32 LastPos = 0; LastPos <= xTransform::c_LastPos4x4; LastPos++)
+  {
+    testInvScanQuantTransformSSD(xTransformAVX::InvTransformDCT_8x8_M16, xTransformAVX::InvScanQuantTransformSSD_8x8_4x4_M16, LastPos);
+  }
+}
+#endif
+
+#if X_SIMD_CAN_USE_AVX512
+TEST_CASE("xInvScanQuantTransformSSDAVX512")
+{
+  testInvScanQuantTransformSSD(xTransformAVX512::InvTransformDCT_8x8_M16, xTransformAVX512::InvScanQuantTransformSSD_8x8_M16);
+}
+#endif
+
+#if X_SIMD_CAN_USE_AVX512
+TEST_CASE("xInvScanQuantTransformSSDAVX512_4x4")
+{
+  for(int32 LastPos = 0; LastPos <= xTransform::c_LastPos4x4; LastPos++)
+  {
+    testInvScanQuantTransformSSD(xTransformAVX512::InvTransformDCT_8x8_M16, xTransformAVX512::InvScanQuantTransformSSD_8x8_4x4_M16, LastPos);
+  }
+}
+#endif
+
 //===============================================================================================================================================================================================================
 
 #ifdef NDEBUG 
@@ -0,0 +1,192 @@
+/*
+    SPDX-FileCopyrightText: 2019-2023 Jakub Stankowski <jakub.stankowski@put.poznan.pl>
+    SPDX-License-Identifier: BSD-3-Clause
+*/
+
+#if defined(_MSC_VER) && !defined(_CRT_SECURE_NO_WARNINGS)
+#define _CRT_SECURE_NO_WARNINGS
+#endif
+
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest/doctest.h>
+#include <functional>
+#include <utility>
+#include <vector>
+#include "xTestUtils.h"
+#include "xMemory.h"
+#include "xCommonDefJPEG.h"
+#include "xJPEG_Stuffing.h"
+
+using namespace PMBB_NAMESPACE;
+using namespace PMBB_NAMESPACE::JPEG;
+
+//===============================================================================================================================================================================================================
+
+using tAddStuffing    = std::function<int32(byte*, const byte*, int32)>;
+using tRemoveStuffing = std::function<int32(byte*, const byte*, int32, int32&)>;
+
+//Log2Density - probability of forced 0xFF byte is 2^-Log2Density (random bytes give additional 1/256)
+static uint32 fillRandomEntropyData(byte* Dst, int32 Size, int32 Log2Density, uint32 State)
+{
+  const uint32 DensityMask = (1u << Log2Density) - 1;
+  for(int32 i = 0; i < Size; i++)
+  {
+    State  = xTestUtils::xXorShift32(State);
+    Dst[i] = (State >> 24) & DensityMask ? (byte)(State & 0xFF) : (byte)0xFF;
+  }
+  return State;
+}
+
+//===============================================================================================================================================================================================================
+
+void testStuffing(tAddStuffing AddStuffing, tRemoveStuffing RemoveStuffing)
+{
+  constexpr int32 MaxSize = 512;
+
+  std::vector<byte> Src(MaxSize + 16);
+  std::vector<byte> Ref(MaxSize * 2 + 16);
+  std::vector<byte> Tst(MaxSize * 2 + 16);
+  std::vector<byte> Rev(MaxSize * 2 + 16);
+
+  uint32 State = xTestUtils::c_XorShiftSeed;
+
+  for(int32 Log2Density : { 1, 3, 8, 16 })
+  {
+    for(int32 Size = 0; Size <= MaxSize; Size++)
+    {
+      State = fillRandomEntropyData(Src.data(), Size, Log2Density, State);
+
+      //add
+      int32 RefSize = xStuffingSTD::AddStuffing(Ref.data(), Src.data(), Size);
+      int32 TstSize = AddStuffing(Tst.data(), Src.data(), Size);
+      CHECK(TstSize == RefSize);
+      CHECK(xTestUtils::isSameBuffer(Tst.data(), Ref.data(), RefSize, true));
+
+      //remove - entire stuffed segment consumed
+      int32 NumRead = 0;
+      int32 RevSize = RemoveStuffing(Rev.data(), Ref.data(), RefSize, NumRead);
+      CHECK(NumRead == RefSize);
+      CHECK(RevSize == Size);
+      CHECK(xTestUtils::isSameBuffer(Rev.data(), Src.data(), Size, true));
+
+      //remove - stops before marker
+      Ref[RefSize] = 0xFF; Ref[RefSize + 1] = 0xD0; Ref[RefSize + 2] = 0xAA; Ref[RefSize + 3] = 0xFF;
+      RevSize = RemoveStuffing(Rev.data(), Ref.data(), RefSize + 4, NumRead);
+      CHECK(NumRead == RefSize);
+      CHECK(RevSize == Size);
+      CHECK(xTestUtils::isSameBuffer(Rev.data(), Src.data(), Size, true));
+    }
+  }
+}
+
+std::tuple<flt64, flt64, flt64, flt64> perfStuffing(tAddStuffing AddStuffing, tRemoveStuffing RemoveStuffing)
+{
+  constexpr int32 NumIters = 32;
+  constexpr int32 Size     = 4 * 1024 * 1024;
+
+  byte* Src = (byte*)xMemory::xAlignedMallocPageAuto(Size            );
+  byte* Stf = (byte*)xMemory::xAlignedMallocPageAuto(Size * 2 + 1024);
+  byte* Dst = (byte*)xMemory::xAlignedMallocPageAuto(Size     + 1024);
+
+  //high entropy (low Q) data - uniformly distributed bytes, 0xFF every 256 bytes on average
+  fillRandomEntropyData(Src, Size, 31, xTestUtils::c_XorShiftSeed);
+
+  tDuration AS = (tDuration)0; uint64 AT = 0;
+  tDuration RS = (tDuration)0; uint64 RT = 0;
+
+  int32 StfSize = AddStuffing(Stf, Src, Size); //warmup
+  for(int32 j = 0; j < NumIters; j++)
+  {
+    tTimePoint T0 = tClock::now(); uint64 C0 = xTSC();
+    StfSize = AddStuffing(Stf, Src, Size);
+    tTimePoint T1 = tClock::now(); uint64 C1 = xTSC();
+    int32 NumRead = 0;
+    int32 DstSize = RemoveStuffing(Dst, Stf, StfSize, NumRead);
+    tTimePoint T2 = tClock::now(); uint64 C2 = xTSC();
+    CHECK(DstSize == Size);
+    AS += T1 - T0; AT += C1 - C0;
+    RS += T2 - T1; RT += C2 - C1;
+  }
+  CHECK(xTestUtils::isSameBuffer(Dst, Src, Size, true));
+
+  int64 NumBytes         = (int64)Size * NumIters;
+  flt64 BytesPerSecAdd   = NumBytes / std::chrono::duration_cast<tDurationS>(AS).count();
+  flt64 BytesPerSecRem   = NumBytes / std::chrono::duration_cast<tDurationS>(RS).count();
+  flt64 BytesPerTickAdd  = (flt64)NumBytes / (flt64)AT;
+  flt64 BytesPerTickRem  = (flt64)NumBytes / (flt64)RT;
+
+  xMemory::xAlignedFree(Src);
+  xMemory::xAlignedFree(Stf);
+  xMemory::xAlignedFree(Dst);
+
+  return { BytesPerSecAdd, BytesPerSecRem, BytesPerTickAdd, BytesPerTickRem };
+}
+
+static void printPerfStuffing(const std::string& Name, tAddStuffing AddStuffing, tRemoveStuffing RemoveStuffing)
+{
+  auto [AS, RS, AT, RT] = perfStuffing(AddStuffing, RemoveStuffing);
+  fmt::print("TIME({}::AddStuffing   ) = {:.2f} MiB/s ({:.2f} B/tick)\n", Name, AS / (1024 * 1024), AT);
+  fmt::print("TIME({}::RemoveStuffing) = {:.2f} MiB/s ({:.2f} B/tick)\n", Name, RS / (1024 * 1024), RT);
+}
+
+//===============================================================================================================================================================================================================
+
+TEST_CASE("xStuffingSTD")
+{
+  testStuffing(xStuffingSTD::AddStuffing, xStuffingSTD::RemoveStuffing);
+}
+
+#if X_SIMD_CAN_USE_SSE
+TEST_CASE("xStuffingSSE")
+{
+  testStuffing(xStuffingSSE::AddStuffing, xStuffingSSE::RemoveStuffing);
+}
+#endif
+
+#if X_SIMD_CAN_USE_AVX
+TEST_CASE("xStuffingAVX")
+{
+  testStuffing(xStuffingAVX::AddStuffing, xStuffingAVX::RemoveStuffing);
+}
+#endif
+
+#if X_SIMD_CAN_USE_AVX512
+TEST_CASE("xStuffingAVX512")
+{
+  testStuffing(xStuffingAVX512::AddStuffing, xStuffingAVX512::RemoveStuffing);
+}
+#endif
+
+//===============================================================================================================================================================================================================
+
+#ifdef NDEBUG
+
+TEST_CASE("xStuffingSTD-perf")
+{
+  printPerfStuffing("xStuffingSTD", xStuffingSTD::AddStuffing, xStuffingSTD::RemoveStuffing);
+}
+
+#if X_SIMD_CAN_USE_SSE
+TEST_CASE("xStuffingSSE-perf")
+{
+  printPerfStuffing("xStuffingSSE", xStuffingSSE::AddStuffing, xStuffingSSE::RemoveStuffing);
+}
+#endif
+
+#if X_SIMD_CAN_USE_AVX
+TEST_CASE("xStuffingAVX-perf")
+{
+  printPerfStuffing("xStuffingAVX", xStuffingAVX::AddStuffing, xStuffingAVX::RemoveStuffing);
+}
+#endif
+
+#if X_SIMD_CAN_USE_AVX512
+TEST_CASE("xStuffingAVX512-perf")
+{
+  printPerfStuffing("xStuffingAVX512", xStuffingAVX512::AddStuffing, xStuffingAVX512::RemoveStuffing);
+}
+#endif
+
+#endif //def NDEBUG
+
+//===============================================================================================================================================================================================================
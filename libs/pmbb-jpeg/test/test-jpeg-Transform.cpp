@@ -6,6 +6,7 @@
 #define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
 #include <doctest/doctest.h>
 #include <functional>
+#include <algorithm>
 #include <utility>
 #include <array>
 #include "xTestUtils.h"
@@ -13,6 +14,7 @@
 #include "xCommonDefJPEG.h"
 #include "xJPEG_Transform.h"
 #include "xJPEG_TransformConstants.h"
+#include "xJPEG_Constants.h"
 
 using namespace PMBB_NAMESPACE;
 using namespace PMBB_NAMESPACE::JPEG;
@@ -93,6 +95,123 @@ void testTransformSIMD(std::function <void(int16*, const uint16*)>RefTr, std::fu
   }
 }
 
+void testTransformBatch(std::function <void(int16*, const uint16*)>RefTr, std::function <void(uint16*, const int16*)>RefInvTr,
+                        std::function <void(int16*, const uint16*, int32)>TstTr, std::function <void(uint16*, const int16*, int32)>TstInvTr)
+{
+  constexpr int32 NumIters  = 256;
+  constexpr int32 MaxBlocks = 8;
+  constexpr int32 MaxArea   = MaxBlocks * BA;
+
+  std::array<uint16, MaxArea> Src;
+  std::array< int16, MaxArea> Coeffs;
+  std::array< int16, MaxArea> TrC_Ref;
+  std::array< int16, MaxArea> TrC_Tst;
+  std::array<uint16, MaxArea> Rec_Ref;
+  std::array<uint16, MaxArea> Rec_Tst;
+
+  uint32 State = xTestUtils::c_XorShiftSeed;
+  for(int32 j = 0; j < NumIters; j++)
+  {
+    for(int32 NumBlocks = 1; NumBlocks <= MaxBlocks; NumBlocks++)
+    {
+      const int32 Area = NumBlocks * BA;
+      State = xTestUtils::fillRandom(Src   .data(), NOT_VALID, Area, 1,  8, State);
+      State = xTestUtils::fillRandom(Coeffs.data(), NOT_VALID, Area, 1, 16, State); //full range - saturation in both passes
+      if((j & 7) == 0) { std::fill_n(Src.data() + (NumBlocks - 1) * BA, BA, (uint16)255); }
+
+      for(int32 b = 0; b < NumBlocks; b++) { RefTr(TrC_Ref.data() + b * BA, Src.data() + b * BA); }
+      TstTr(TrC_Tst.data(), Src.data(), NumBlocks);
+      CHECK(xTestUtils::isSameBuffer(TrC_Ref.data(), TrC_Tst.data(), Area, true));
+
+      for(int32 b = 0; b < NumBlocks; b++) { RefInvTr(Rec_Ref.data() + b * BA, Coeffs.data() + b * BA); }
+      TstInvTr(Rec_Tst.data(), Coeffs.data(), NumBlocks);
+      CHECK(xTestUtils::isSameBuffer(Rec_Ref.data(), Rec_Tst.data(), Area, true));
+
+      for(int32 i = 0; i < Area; i++) { TrC_Ref[i] = TrC_Ref[i] / 16; }
+      for(int32 b = 0; b < NumBlocks; b++) { RefInvTr(Rec_Ref.data() + b * BA, TrC_Ref.data() + b * BA); }
+      TstInvTr(Rec_Tst.data(), TrC_Ref.data(), NumBlocks);
+      CHECK(xTestUtils::isSameBuffer(Rec_Ref.data(), Rec_Tst.data(), Area, true));
+    }
+  }
+}
+
+void testTransformSparse(std::function <void(uint16*, const int16*)>RefInvTr, std::function <void(uint16*, const int16*)>TstInvTr, int32 LastPos)
+{
+  constexpr int32 NumIters = 4096;
+  constexpr int16 ExtremeDC[4] = { INT16_MIN, INT16_MAX, 0, -1024 };
+
+  std::array< int16, BA> Coeffs;
+  std::array<uint16, BA> Rec_Ref;
+  std::array<uint16, BA> Rec_Tst;
+
+  uint32 State = xTestUtils::c_XorShiftSeed;
+  for(int32 j = 0; j < NumIters; j++)
+  {
+    //only coeffs up to LastPos (in zig-zag order) are nonzero, full range or reduced range (typical for dequantized coeffs)
+    State = xTestUtils::fillRandom(Coeffs.data(), NOT_VALID, BA, 1, 16, State);
+    const int32 Div = (j & 1) ? 1 : 16;
+    for(int32 i = 0; i < BA; i++) { Coeffs[xJPEG_Constants::m_ScanZigZag[i]] = i <= LastPos ? (int16)(Coeffs[xJPEG_Constants::m_ScanZigZag[i]] / Div) : 0; }
+    if(j < 4) { Coeffs[0] = ExtremeDC[j]; }
+
+    RefInvTr(Rec_Ref.data(), Coeffs.data());
+    TstInvTr(Rec_Tst.data(), Coeffs.data());
+    CHECK(xTestUtils::isSameBuffer(Rec_Ref.data(), Rec_Tst.data(), BA, true));
+  }
+}
+
+void testTransformScaled(int32 Log2Scale)
+{
+  constexpr int32 NumIters = 1024;
+  const     int32 Size     = xJPEG_Constants::c_BlockSize >> Log2Scale;
+  const     int32 Factor   = 1 << Log2Scale;
+
+  std::array<uint16, BA> Src;
+  std::array< int16, BA> Coeffs;
+  std::array<uint16, BA> Rec_Ref;
+  std::array<uint16, BA> Rec_Tst;
+
+  uint32 State = xTestUtils::c_XorShiftSeed;
+  for(int32 j = 0; j < NumIters; j++)
+  {
+    //DC only - every reduced size is exact
+    State = xTestUtils::fillRandom(Coeffs.data(), NOT_VALID, BA, 1, 16, State);
+    std::fill(Coeffs.begin() + 1, Coeffs.end(), (int16)0);
+    xTransformSTD::InvTransformDCT_8x8_DC_M16    (Rec_Ref.data(), Coeffs.data());
+    xTransformSTD::InvTransformDCT_8x8_Scaled_M16(Rec_Tst.data(), Coeffs.data(), Log2Scale);
+    for(int32 y = 0; y < Size; y++) { CHECK(xTestUtils::isSameBuffer(Rec_Ref.data(), Rec_Tst.data() + y * 8, Size, true)); }
+
+    //smooth content (linear gradient) - reduced block approximates average of Factor x Factor areas of full size block
+    const int32 Base = (int32)(State % 128) + 64, GradH = (int32)((State >> 8) % 15) - 7, GradV = (int32)((State >> 16) % 15) - 7;
+    for(int32 y = 0; y < 8; y++) { for(int32 x = 0; x < 8; x++) { Src[y * 8 + x] = (uint16)xClipU8(Base + GradH * x + GradV * y); } }
+    xTransformSTD::FwdTransformDCT_8x8_M16(Coeffs.data(), Src.data());
+    for(int32 i = 0; i < BA; i++) { Coeffs[i] = Coeffs[i] / 16; }
+    xTransformSTD::InvTransformDCT_8x8_M16(Rec_Ref.data(), Coeffs.data());
+    xTransformSTD::InvTransformDCT_8x8_Scaled_M16(Rec_Tst.data(), Coeffs.data(), Log2Scale);
+    for(int32 y = 0; y < Size; y++)
+    {
+      for(int32 x = 0; x < Size; x++)
+      {
+        int32 Sum = 0;
+        for(int32 v = 0; v < Factor; v++) { for(int32 u = 0; u < Factor; u++) { Sum += Rec_Ref[(y * Factor + v) * 8 + x * Factor + u]; } }
+        const int32 Avg = (Sum + (Factor * Factor / 2)) / (Factor * Factor);
+        CHECK(xAbs(Avg - (int32)Rec_Tst[y * 8 + x]) <= 2 + (xAbs(GradH) + xAbs(GradV)) / 4); //2-point basis functions deviate from area average for steep gradients
+      }
+    }
+
+    //no scaling - has to be bit exact with full size inverse transform
+    if(Log2Scale == 0)
+    {
+      CHECK(xTestUtils::isSameBuffer(Rec_Ref.data(), Rec_Tst.data(), BA, true));
+      State = xTestUtils::fillRandom(Src.data(), NOT_VALID, BA, 1, 8, State);
+      xTransformSTD::FwdTransformDCT_8x8_M16(Coeffs.data(), Src.data());
+      for(int32 i = 0; i < BA; i++) { Coeffs[i] = Coeffs[i] / 16; }
+      xTransformSTD::InvTransformDCT_8x8_M16       (Rec_Ref.data(), Coeffs.data());
+      xTransformSTD::InvTransformDCT_8x8_Scaled_M16(Rec_Tst.data(), Coeffs.data(), 0);
+      CHECK(xTestUtils::isSameBuffer(Rec_Ref.data(), Rec_Tst.data(), BA, true));
+    }
+  }
+}
+
 std::tuple<flt64, flt64> perfTransform(std::function <void(int16*, const uint16*)>RefTr, std::function <void(uint16*, const int16*)>RefInvTr,
                                        std::function <void(int16*, const uint16*)>TstTr, std::function <void(uint16*, const int16*)>TstInvTr)
 {
@@ -148,6 +267,52 @@ std::tuple<flt64, flt64> perfTransform(std::function <void(int16*, const uint16*
   return { BytesPerSecFT, BytesPerSecIT };
 }
 
+std::tuple<flt64, flt64> perfTransformBatch(std::function <void(int16*, const uint16*, int32)>TstTr, std::function <void(uint16*, const int16*, int32)>TstInvTr)
+{
+  constexpr int32 NumIters = 4;
+  constexpr int32 NumBatch = 8;
+  constexpr int32 NumBlock = 1024 * 1024;
+  constexpr int32 NumPels  = NumBlock * BA;
+  constexpr int64 BuffSize = NumPels * sizeof(int16);
+  uint16* Src = (uint16*)xMemory::xAlignedMallocPageAuto(BuffSize);
+  int16*  Tmp = ( int16*)xMemory::xAlignedMallocPageAuto(BuffSize);
+  uint16* Dst = (uint16*)xMemory::xAlignedMallocPageAuto(BuffSize);
+
+  xTestUtils::fillRandom((uint16*)Src, NOT_VALID, NumPels, 1, 8);
+
+  tDuration FT = (tDuration)0;
+  tDuration IT = (tDuration)0;
+
+  //warmup
+  for(int32 i = 0; i < NumPels; i += NumBatch * BA) { TstTr   (Tmp + i, Src + i, NumBatch); }
+  for(int32 i = 0; i < NumPels; i++                ) { Tmp[i] = Tmp[i] / 16; }
+  for(int32 i = 0; i < NumPels; i += NumBatch * BA) { TstInvTr(Dst + i, Tmp + i, NumBatch); }
+
+  //measure
+  for(int32 j = 0; j < NumIters; j++)
+  {
+    tTimePoint T0 = tClock::now();
+    for(int32 i = 0; i < NumPels; i += NumBatch * BA) { TstTr(Tmp + i, Src + i, NumBatch); }
+    tTimePoint T1 = tClock::now();
+    for(int32 i = 0; i < NumPels; i++) { Tmp[i] = Tmp[i] / 16; }
+    tTimePoint T2 = tClock::now();
+    for(int32 i = 0; i < NumPels; i += NumBatch * BA) { TstInvTr(Dst + i, Tmp + i, NumBatch); }
+    tTimePoint T3 = tClock::now();
+    FT += T1 - T0;
+    IT += T3 - T2;
+  }
+
+  int64 NumBytes      = BuffSize * NumIters;
+  flt64 BytesPerSecFT = NumBytes / std::chrono::duration_cast<tDurationS>(FT).count();
+  flt64 BytesPerSecIT = NumBytes / std::chrono::duration_cast<tDurationS>(IT).count();
+
+  xMemory::xAlignedFree(Src);
+  xMemory::xAlignedFree(Tmp);
+  xMemory::xAlignedFree(Dst);
+
+  return { BytesPerSecFT, BytesPerSecIT };
+}
+
 //===============================================================================================================================================================================================================
 
 TEST_CASE("xTransformSTD")
@@ -176,6 +341,53 @@ TEST_CASE("xTransformAVX512_M16")
 }
 #endif //X_SIMD_CAN_USE_AVX512
 
+#if X_SIMD_CAN_USE_AVX
+TEST_CASE("xTransformAVX_M16xN")
+{
+  testTransformBatch(xTransformAVX::FwdTransformDCT_8x8_M16, xTransformAVX::InvTransformDCT_8x8_M16, xTransformAVX::FwdTransformDCT_8x8xN_M16, xTransformAVX::InvTransformDCT_8x8xN_M16);
+}
+#endif //X_SIMD_CAN_USE_AVX
+
+#if X_SIMD_CAN_USE_AVX512
+TEST_CASE("xTransformAVX512_M16xN")
+{
+  testTransformBatch(xTransformAVX512::FwdTransformDCT_8x8_M16, xTransformAVX512::InvTransformDCT_8x8_M16, xTransformAVX512::FwdTransformDCT_8x8xN_M16, xTransformAVX512::InvTransformDCT_8x8xN_M16);
+}
+#endif //X_SIMD_CAN_USE_AVX512
+
+TEST_CASE("xTransformSTD_DC")
+{
+  testTransformSparse(xTransformSTD::InvTransformDCT_8x8_BTF, xTransformSTD::InvTransformDCT_8x8_DC_BTF, 0);
+#if X_SIMD_CAN_USE_SSE
+  testTransformSparse(xTransformSSE::InvTransformDCT_8x8_M16, xTransformSTD::InvTransformDCT_8x8_DC_M16, 0);
+#endif //X_SIMD_CAN_USE_SSE
+}
+
+TEST_CASE("xTransformSTD_Scaled")
+{
+  for(int32 Log2Scale = 0; Log2Scale <= xJPEG_Constants::c_Log2BlockSize; Log2Scale++) { testTransformScaled(Log2Scale); }
+}
+
+#if X_SIMD_CAN_USE_AVX
+TEST_CASE("xTransformAVX_M16_4x4")
+{
+  for(int32 LastPos = 0; LastPos <= xTransform::c_LastPos4x4; LastPos++)
+  {
+    testTransformSparse(xTransformAVX::InvTransformDCT_8x8_M16, xTransformAVX::InvTransformDCT_8x8_4x4_M16, LastPos);
+  }
+}
+#endif //X_SIMD_CAN_USE_AVX
+
+#if X_SIMD_CAN_USE_AVX512
+TEST_CASE("xTransformAVX512_M16_4x4")
+{
+  for(int32 LastPos = 0; LastPos <= xTransform::c_LastPos4x4; LastPos++)
+  {
+    testTransformSparse(xTransformAVX512::InvTransformDCT_8x8_M16, xTransformAVX512::InvTransformDCT_8x8_4x4_M16, LastPos);
+  }
+}
+#endif //X_SIMD_CAN_USE_AVX512
+
 //===============================================================================================================================================================================================================
 
 #ifdef NDEBUG 
@@ -228,6 +440,24 @@ TEST_CASE("xTransformAVX512_M16-perf")
 }
 #endif
 
+#if X_SIMD_CAN_USE_AVX
+TEST_CASE("xTransformAVX_M16xN-perf")
+{
+  auto [FT, IT] = perfTransformBatch(xTransformAVX::FwdTransformDCT_8x8xN_M16, xTransformAVX::InvTransformDCT_8x8xN_M16);
+  fmt::print("TIME(xTransformAVX::FwdTransformDCT_8x8xN_M16) = {:.2f} MiB/s\n", FT / (1024 * 1024));
+  fmt::print("TIME(xTransformAVX::InvTransformDCT_8x8xN_M16) = {:.2f} MiB/s\n", IT / (1024 * 1024));
+}
+#endif
+
+#if X_SIMD_CAN_USE_AVX512
+TEST_CASE("xTransformAVX512_M16xN-perf")
+{
+  auto [FT, IT] = perfTransformBatch(xTransformAVX512::FwdTransformDCT_8x8xN_M16, xTransformAVX512::InvTransformDCT_8x8xN_M16);
+  fmt::print("TIME(xTransformAVX512::FwdTransformDCT_8x8xN_M16) = {:.2f} MiB/s\n", FT / (1024 * 1024));
+  fmt::print("TIME(xTransformAVX512::InvTransformDCT_8x8xN_M16) = {:.2f} MiB/s\n", IT / (1024 * 1024));
+}
+#endif
+
 #endif //def NDEBUG
 
 //===============================================================================================================================================================================================================